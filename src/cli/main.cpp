@@ -0,0 +1,314 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          main.cpp
+// Description:   Headless command line front-end (WavePaintCli) over core and io.
+//======================================================================
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "core/core.h"
+#include "core/VcdLibrary.h"
+#include "core/GlitchFinder.h"
+#include "core/WaveDiff.h"
+#include "io/VcdImporter.h"
+#include "io/VcdFilter.h"
+#include "utils/FormatUtils.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream s(stdout);
+    return s;
+}
+
+QTextStream &err()
+{
+    static QTextStream s(stderr);
+    return s;
+}
+
+bool loadDocument(WaveDocument &doc, const QCommandLineParser &parser, const QString &fileName)
+{
+    VcdImportOptions options;
+    options.proceduralClocks = parser.isSet("procedural-clocks");
+    options.include = parser.values("include");
+    options.exclude = parser.values("exclude");
+    options.maxScopeDepth = parser.value("max-depth").toInt();
+    options.useIndexCache = !parser.isSet("no-index");
+
+    QString filterError;
+    if (!VcdSignalFilter::compile(options, nullptr, &filterError)) {
+        err() << "error: " << filterError << Qt::endl;
+        return false;
+    }
+
+    bool ok = WaveVcdImporter::isVcdFile(fileName)   ? doc.loadFromVcd(fileName, options)
+              : WaveVcdImporter::isFstFile(fileName) ? doc.loadFromFst(fileName, options)
+                                                     : doc.loadFromFile(fileName);
+    if (!ok)
+        err() << "error: could not load " << fileName << Qt::endl;
+    return ok;
+}
+
+// stats: memory report of a document (same numbers as the Document statistics dialog)
+int runStats(const QCommandLineParser &parser, const QString &fileName)
+{
+    WaveDocument doc;
+    if (!loadDocument(doc, parser, fileName))
+        return 1;
+
+    int topN = parser.value("top").toInt();
+    if (topN < 0)
+        topN = 0;
+
+    const MemoryStats st = doc.memoryStats();
+    out() << "file:             " << fileName << "\n"
+          << "samples:          " << doc.sampleCount() << "\n"
+          << "visible signals:  " << static_cast<qint64>(doc.signalList().size()) << "\n"
+          << "library signals:  " << static_cast<qint64>(doc.vcdSignalList().size()) << "\n"
+          << "\n"
+          << "memory by subsystem\n"
+          << "  visible signals   " << formatBytes(st.visibleSignals) << "\n"
+          << "  vcd library       " << formatBytes(st.vcdLibrary) << "\n"
+          << "  undo history      " << formatBytes(st.undoHistory) << "\n"
+          << "  redo history      " << formatBytes(st.redoHistory) << "\n"
+          << "  signal clipboard  " << formatBytes(st.signalClipboard) << "\n"
+          << "  block clipboard   " << formatBytes(st.blockClipboard) << "\n"
+          << "  markers & arrows  " << formatBytes(st.annotations) << "\n"
+          << "  total             " << formatBytes(st.total()) << "\n";
+
+    const std::vector<SignalMemoryUsage> usage = doc.signalMemoryUsage();
+    const int n = std::min(static_cast<int>(usage.size()), topN);
+    if (n > 0)
+    {
+        out() << "\nlargest signals\n";
+        for (int i = 0; i < n; ++i)
+        {
+            out() << "  " << formatBytes(usage[i].bytes).rightJustified(10)
+                  << (usage[i].inLibrary ? "  [lib] " : "  [vis] ")
+                  << usage[i].name << "\n";
+        }
+    }
+    out().flush();
+
+    const qint64 budget = parser.value("budget-mb").toLongLong() * 1024 * 1024;
+    if (budget > 0 && st.total() > budget)
+    {
+        err() << "warning: " << formatBytes(st.total()) << " exceeds the "
+              << formatBytes(budget) << " budget" << Qt::endl;
+        return 2;
+    }
+    return 0;
+}
+
+// clocks: signals of a VCD that the importer recognised as clocks
+int runClocks(const QCommandLineParser &parser, const QString &fileName)
+{
+    WaveDocument doc;
+    if (!loadDocument(doc, parser, fileName))
+        return 1;
+
+    const VcdLibraryPtr lib = doc.vcdLibrary();
+    if (!lib)
+    {
+        err() << "error: " << fileName << " is not a VCD dump" << Qt::endl;
+        return 1;
+    }
+
+    int found = 0;
+    for (int i = 0; i < lib->size(); ++i)
+    {
+        const ClockInfo &info = lib->clockInfo(i);
+        if (!info.isClock)
+            continue;
+        out() << lib->clockLabel(i).rightJustified(14)
+              << "  duty " << QString::number(info.duty * 100.0, 'f', 1).rightJustified(5) << "%"
+              << "  " << QString::number(info.cycles).rightJustified(9) << " cycles"
+              << (info.uniform ? "  uniform    " : "  irregular  ")
+              << lib->nameAt(i) << "\n";
+        ++found;
+    }
+    out() << found << " clock(s) in " << lib->size() << " signals\n";
+    out().flush();
+    return 0;
+}
+
+// glitches: pulses narrower than --min-width and zero-width glitches, in a
+// VCD scope (every signal by default) or in the signals of a document
+int runGlitches(const QCommandLineParser &parser, const QString &fileName)
+{
+    WaveDocument doc;
+    if (!loadDocument(doc, parser, fileName))
+        return 1;
+
+    const VcdLibraryPtr lib = doc.vcdLibrary();
+    std::vector<Signal> sigs;
+    GlitchScanOptions options;
+    options.minWidth = std::max(1LL, parser.value("min-width").toLongLong());
+    int sampleCount = doc.sampleCount();
+    if (lib)
+    {
+        const int scopeId = lib->findScope(parser.value("scope"));
+        if (scopeId < 0)
+        {
+            err() << "error: unknown scope " << parser.value("scope") << Qt::endl;
+            return 1;
+        }
+        options.libraryIndex = lib->signalsUnder(scopeId);
+        lib->preload(options.libraryIndex);   // FST: decode the scope in one parallel pass
+        for (int idx : options.libraryIndex)
+            sigs.push_back(lib->at(idx));
+        options.library = lib.get();
+        if (parser.isSet("time-units"))
+            options.sampleTimes = &lib->timing().sampleTimes;
+        sampleCount = static_cast<int>(lib->timing().sampleTimes.size());
+    }
+    else
+    {
+        sigs = doc.signalList();
+    }
+
+    const GlitchScanResult res = findGlitches(sigs, 0, sampleCount, doc.signalResolver(), options);
+    const char *unit = options.sampleTimes ? " t" : " smp";
+    for (const PulseViolation &v : res.violations)
+    {
+        out() << QString::number(v.start).rightJustified(10) << "  "
+              << (v.zeroWidth() ? QString("zero-width") : QString::number(v.width) + unit).rightJustified(12)
+              << "  " << (v.value == UNDEFINED_VALUE ? QString("X") : QString::number(v.value)).rightJustified(6)
+              << "  " << sigs[v.signal].name << "\n";
+    }
+    out() << static_cast<qint64>(res.violations.size()) << " violation(s) in " << static_cast<qint64>(sigs.size())
+          << " signals, " << res.pulses << " pulses checked in "
+          << QString::number(res.elapsedNs / 1.0e6, 'f', 1) << " ms"
+          << (res.truncated ? " (limit reached)" : "") << "\n";
+    out().flush();
+    return res.violations.empty() ? 0 : 2;
+}
+
+// diff: signals that differ between two documents / VCD runs, matched by
+// full name; positions are VCD times when both files are dumps
+int runDiff(const QCommandLineParser &parser, const QString &fileA, const QString &fileB)
+{
+    WaveDocument docA;
+    WaveDocument docB;
+    if (!loadDocument(docA, parser, fileA) || !loadDocument(docB, parser, fileB))
+        return 1;
+
+    const DiffSide a = DiffSide::fromDocument(docA);
+    const DiffSide b = DiffSide::fromDocument(docB);
+    const WaveDiffResult res = diffWaveforms(a, b);
+    const int maxIntervals = std::max(0, parser.value("intervals").toInt());
+
+    for (const SignalDiff &d : res.differing)
+    {
+        out() << QString::number(d.firstMismatch()).rightJustified(12)
+              << QString::number(static_cast<qint64>(d.mismatches.size())).rightJustified(8) << " interval(s)  "
+              << d.name << (d.typeMismatch ? "  [bit vs vector]" : "") << "\n";
+        const int n = std::min(static_cast<int>(d.mismatches.size()), maxIntervals);
+        for (int i = 0; i < n; ++i)
+            out() << "              [" << d.mismatches[i].start << ", " << d.mismatches[i].end << ")\n";
+    }
+
+    out() << "\n" << (res.timeAxis ? "axis:             VCD time" : "axis:             samples");
+    if (res.timeAxis && res.timescale > 0.0)
+        out() << " (" << QString::number(res.timescale, 'g', 3) << " s units)";
+    out() << "\n";
+    if (res.timescaleMismatch)
+        out() << "warning:          timescales cannot be matched, compared sample by sample\n";
+    out() << "matched signals:  " << res.matched << "\n"
+          << "differing:        " << static_cast<qint64>(res.differing.size()) << "\n"
+          << "first mismatch:   " << res.firstMismatch() << "\n"
+          << "only in " << QFileInfo(fileA).fileName() << ": " << static_cast<qint64>(res.onlyInA.size()) << "\n"
+          << "only in " << QFileInfo(fileB).fileName() << ": " << static_cast<qint64>(res.onlyInB.size()) << "\n";
+    if (res.endA != res.endB)
+        out() << "lengths differ:   " << res.endA << " vs " << res.endB << " (compared up to the shorter)\n";
+    out() << "elapsed:          " << QString::number(res.elapsedNs / 1.0e6, 'f', 1) << " ms\n";
+    out().flush();
+    return res.differing.empty() ? 0 : 2;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WavePaintCli");
+
+    Tracer::initFromEnvironment();
+    Tracer::setThreadName(QStringLiteral("main"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless WavePaint tools.\n\n"
+                                     "Commands:\n"
+                                     "  stats <file>     memory report of a .wp/.json/.vcd/.fst document\n"
+                                     "  clocks <file>    clocks detected in a .vcd dump\n"
+                                     "  glitches <file>  pulses narrower than --min-width and zero-width glitches\n"
+                                     "  diff <a> <b>     signals that differ between two documents or VCD/FST runs");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "Command to run.");
+    parser.addPositionalArgument("file", "Input document.");
+    parser.addOption({"top", "Number of largest signals to list (stats).", "n", "20"});
+    parser.addOption({"budget-mb", "Exit with code 2 if the document uses more than <mb> (stats).", "mb", "0"});
+    parser.addOption({"procedural-clocks", "Store detected VCD clocks as clock(...) expressions."});
+    parser.addOption({"include", "Only import VCD signals matching <pattern> (repeatable).", "pattern"});
+    parser.addOption({"exclude", "Skip VCD signals matching <pattern> (repeatable).", "pattern"});
+    parser.addOption({"max-depth", "Only import VCD signals at most <n> scopes deep (0 = any).", "n", "0"});
+    parser.addOption({"no-index", "Parse large VCDs again instead of reading their cached index."});
+    parser.addOption({"min-width", "Report pulses narrower than <n> (glitches).", "n", "2"});
+    parser.addOption({"scope", "Only scan the VCD scope <path> and below (glitches).", "path"});
+    parser.addOption({"time-units", "Measure pulse widths in VCD time units, not samples (glitches)."});
+    parser.addOption({"intervals", "Mismatching intervals listed per signal (diff).", "n", "5"});
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() < 2)
+        parser.showHelp(1);
+
+    int rc = 1;
+    const QString command = args.at(0);
+    if (command == "stats")
+    {
+        rc = runStats(parser, args.at(1));
+    }
+    else if (command == "clocks")
+    {
+        rc = runClocks(parser, args.at(1));
+    }
+    else if (command == "glitches")
+    {
+        rc = runGlitches(parser, args.at(1));
+    }
+    else if (command == "diff")
+    {
+        if (args.size() < 3)
+            parser.showHelp(1);
+        rc = runDiff(parser, args.at(1), args.at(2));
+    }
+    else
+    {
+        err() << "error: unknown command " << command << Qt::endl;
+        parser.showHelp(1);
+    }
+
+    Tracer::shutdown();
+    return rc;
+}
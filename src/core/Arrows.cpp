@@ -44,10 +44,12 @@
 //======================================================================
 
 #include "core/core.h"
+#include "utils/Trace.h"
 
 int WaveDocument::addArrow(int startSignal, int startSample,
                            int endSignal,   int endSample)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addArrow", &m_lastMutationNs);
     pushUndoSnapshot();
     int sigCount = static_cast<int>(m_signals.size());
     if (startSignal < 0 || startSignal >= sigCount) return -1;
@@ -69,6 +71,7 @@ int WaveDocument::addArrow(int startSignal, int startSample,
 
 void WaveDocument::subArrowById(int arrowId)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::subArrowById", &m_lastMutationNs);
     pushUndoSnapshot();
     auto it = std::find_if(m_arrows.begin(), m_arrows.end(),
                            [arrowId](const Arrow &a){ return a.id == arrowId; });
@@ -93,6 +96,7 @@ void WaveDocument::subArrowById(int arrowId)
 
 void WaveDocument::clearArrows()
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clearArrows", &m_lastMutationNs);
     pushUndoSnapshot();
     m_arrows.clear();
     m_nextArrowId = 1;
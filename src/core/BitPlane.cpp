@@ -0,0 +1,223 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          BitPlane.cpp
+// Description:   Bit-packed sample storage (level + validity planes) for Bit signals.
+//======================================================================
+
+#include "core/BitPlane.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int W = BitPlane::kWordBits;
+
+inline int wordsFor(int samples)
+{
+    return (samples + W - 1) / W;
+}
+
+// Bits [lo, hi) of a word, 0 <= lo < hi <= 64
+inline quint64 rangeMask(int lo, int hi)
+{
+    const quint64 upper = (hi >= W) ? ~quint64(0) : ((quint64(1) << hi) - 1);
+    return upper & ~((quint64(1) << lo) - 1);
+}
+
+} // namespace
+
+BitPlane::BitPlane(int samples, int value)
+    : m_size(std::max(0, samples)),
+      m_level(static_cast<std::size_t>(wordsFor(m_size)), 0),
+      m_valid(static_cast<std::size_t>(wordsFor(m_size)), 0)
+{
+    if (value >= 0)
+        fill(0, m_size, value);
+}
+
+BitPlane BitPlane::fromValues(const int *values, int count)
+{
+    BitPlane p(count);
+    std::vector<quint64> &level = p.m_level.mut();
+    std::vector<quint64> &valid = p.m_valid.mut();
+    for (int w = 0; w * W < count; ++w) {
+        const int base = w * W;
+        const int n = std::min(W, count - base);
+        quint64 l = 0, v = 0;
+        for (int b = 0; b < n; ++b) {
+            const int x = values[base + b];
+            v |= quint64(x >= 0) << b;
+            l |= quint64(x > 0) << b;
+        }
+        level[w] = l;
+        valid[w] = v;
+    }
+    return p;
+}
+
+void BitPlane::set(int t, int value)
+{
+    if (t < 0 || t >= m_size)
+        return;
+    const quint64 bit = quint64(1) << (t % W);
+    const int w = t / W;
+    quint64 &l = m_level.mut()[w];
+    quint64 &v = m_valid.mut()[w];
+    if (value < 0) {
+        l &= ~bit;
+        v &= ~bit;
+    } else {
+        v |= bit;
+        l = (value > 0) ? (l | bit) : (l & ~bit);
+    }
+}
+
+void BitPlane::fill(int t0, int t1, int value)
+{
+    t0 = std::max(t0, 0);
+    t1 = std::min(t1, m_size);
+    if (t1 <= t0)
+        return;
+
+    std::vector<quint64> &level = m_level.mut();
+    std::vector<quint64> &valid = m_valid.mut();
+    const int w0 = t0 / W;
+    const int w1 = (t1 - 1) / W;
+    for (int w = w0; w <= w1; ++w) {
+        const int lo = (w == w0) ? t0 % W : 0;
+        const int hi = (w == w1) ? (t1 - 1) % W + 1 : W;
+        const quint64 m = rangeMask(lo, hi);
+        if (value < 0) {
+            level[w] &= ~m;
+            valid[w] &= ~m;
+        } else {
+            valid[w] |= m;
+            level[w] = (value > 0) ? (level[w] | m) : (level[w] & ~m);
+        }
+    }
+}
+
+void BitPlane::resize(int samples)
+{
+    samples = std::max(0, samples);
+    if (samples == m_size)
+        return;
+    const int nw = wordsFor(samples);
+    std::vector<quint64> &level = m_level.mut();
+    std::vector<quint64> &valid = m_valid.mut();
+    level.resize(nw, 0);
+    valid.resize(nw, 0);
+    if (samples < m_size && samples % W) {
+        // Keep the "zero past size()" invariant for a later grow
+        const quint64 keep = rangeMask(0, samples % W);
+        level[nw - 1] &= keep;
+        valid[nw - 1] &= keep;
+    }
+    m_size = samples;
+}
+
+quint64 BitPlane::extract(const quint64 *words, int wordCount, qint64 bitPos)
+{
+    // floor division, so negative positions work too
+    const qint64 w = (bitPos >= 0) ? bitPos / W : -((-bitPos + W - 1) / W);
+    const int s = static_cast<int>(bitPos - w * W);
+    auto word = [&](qint64 i) { return (i >= 0 && i < wordCount) ? words[i] : quint64(0); };
+    if (s == 0)
+        return word(w);
+    return (word(w) >> s) | (word(w + 1) << (W - s));
+}
+
+BitPlane BitPlane::slice(int t0, int count) const
+{
+    BitPlane out(count);
+    if (count <= 0)
+        return out;
+    std::vector<quint64> &level = out.m_level.mut();
+    std::vector<quint64> &valid = out.m_valid.mut();
+    const int nw = wordCount();
+    for (int w = 0; w < out.wordCount(); ++w) {
+        const qint64 pos = static_cast<qint64>(t0) + static_cast<qint64>(w) * W;
+        level[w] = extract(m_level.data(), nw, pos);
+        valid[w] = extract(m_valid.data(), nw, pos);
+    }
+    if (count % W) {
+        const quint64 keep = rangeMask(0, count % W);
+        level.back() &= keep;
+        valid.back() &= keep;
+    }
+    return out;
+}
+
+void BitPlane::paste(int dst, const BitPlane &src, int srcT0, int count)
+{
+    // Clip to this plane; the source side is read with extract() (X outside)
+    if (dst < 0) {
+        srcT0 -= dst;
+        count += dst;
+        dst = 0;
+    }
+    count = std::min(count, m_size - dst);
+    if (count <= 0)
+        return;
+
+    // src may share buffers with this plane: read from a snapshot
+    const BitPlane from = src;
+    std::vector<quint64> &level = m_level.mut();
+    std::vector<quint64> &valid = m_valid.mut();
+    const int snw = from.wordCount();
+    const int t1 = dst + count;
+    const int w0 = dst / W;
+    const int w1 = (t1 - 1) / W;
+    for (int w = w0; w <= w1; ++w) {
+        const int lo = (w == w0) ? dst % W : 0;
+        const int hi = (w == w1) ? (t1 - 1) % W + 1 : W;
+        const quint64 m = rangeMask(lo, hi);
+        // source sample aligned with bit 0 of destination word w
+        const qint64 pos = static_cast<qint64>(srcT0) + (static_cast<qint64>(w) * W - dst);
+        const quint64 l = extract(from.m_level.data(), snw, pos);
+        const quint64 v = extract(from.m_valid.data(), snw, pos);
+        level[w] = (level[w] & ~m) | (l & m);
+        valid[w] = (valid[w] & ~m) | (v & m);
+    }
+}
+
+void BitPlane::unpack(int t0, int t1, int *out) const
+{
+    for (int t = t0; t < t1; ++t)
+        *out++ = value(t);
+}
+
+quint64 BitPlane::changeWord(int w) const
+{
+    const quint64 l = m_level[w];
+    const quint64 v = m_valid[w];
+    // previous sample of every bit: shift in the top bit of the word before
+    const quint64 lp = (l << 1) | (w > 0 ? m_level[w - 1] >> (W - 1) : 0);
+    const quint64 vp = (v << 1) | (w > 0 ? m_valid[w - 1] >> (W - 1) : 0);
+    quint64 diff = (l ^ lp) | (v ^ vp);
+    if (w == 0)
+        diff &= ~quint64(1);                   // sample 0 has no predecessor
+    if (w == wordCount() - 1 && m_size % W)
+        diff &= rangeMask(0, m_size % W);      // the X tail is not a change
+    return diff;
+}
+
+int BitPlane::transitionCount() const
+{
+    int n = 0;
+    for (int w = 0; w < wordCount(); ++w)
+        n += static_cast<int>(qPopulationCount(changeWord(w)));
+    return n;
+}
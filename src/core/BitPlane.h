@@ -0,0 +1,123 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          BitPlane.h
+// Description:   Bit-packed sample storage (level + validity planes) for Bit signals.
+//======================================================================
+
+#ifndef BITPLANE_H
+#define BITPLANE_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+#include <memory>
+#include <vector>
+#include "core/CowVector.h"
+
+// Packed samples of a Bit signal: one level bit and one validity bit per
+// sample (2 bits instead of an int plus a QString label). A sample that is
+// not valid is X (-1, UNDEFINED_VALUE) and its level bit is kept at 0, so
+// two samples are equal exactly when both planes are. Bits past size() are
+// always 0.
+//
+// The planes are implicitly shared like CowVector (they are CowVectors) and
+// every mutator works on whole 64-sample words where it can.
+class BitPlane
+{
+public:
+    static constexpr int kWordBits = 64;
+
+    BitPlane() = default;
+    explicit BitPlane(int samples, int value = -1);
+
+    // Packs plain values: < 0 is X, 0 is 0, anything else is 1
+    static BitPlane fromValues(const int *values, int count);
+
+    int  size() const  { return m_size; }
+    bool empty() const { return m_size == 0; }
+    int  wordCount() const { return static_cast<int>(m_level.size()); }
+
+    // 0, 1 or -1 (X); -1 outside [0, size())
+    int value(int t) const
+    {
+        if (t < 0 || t >= m_size)
+            return -1;
+        const quint64 bit = quint64(1) << (t % kWordBits);
+        const int w = t / kWordBits;
+        if (!(m_valid[w] & bit))
+            return -1;
+        return (m_level[w] & bit) ? 1 : 0;
+    }
+
+    void set(int t, int value);
+    void fill(int t0, int t1, int value);          // samples [t0, t1)
+    void resize(int samples);                      // new samples are X
+
+    // Samples [t0, t0 + count) as a new plane; outside this plane they are X
+    BitPlane slice(int t0, int count) const;
+    // Overwrites [dst, dst + count) with src samples [srcT0, srcT0 + count)
+    void paste(int dst, const BitPlane &src, int srcT0, int count);
+
+    // Unpacks [t0, t1) into out[0 .. t1 - t0)
+    void unpack(int t0, int t1, int *out) const;
+
+    // Samples t >= 1 whose value differs from t - 1
+    int transitionCount() const;
+    template <typename Fn>
+    void forEachTransition(Fn fn) const;
+
+    const quint64 *levelWords() const { return m_level.data(); }
+    const quint64 *validWords() const { return m_valid.data(); }
+
+    // Both planes are always detached together, so the level buffer
+    // identifies the pair for memory accounting
+    const void *bufferId() const  { return m_level.bufferId(); }
+    qint64 bufferBytes() const    { return m_level.bufferBytes() + m_valid.bufferBytes(); }
+    void freeze()                 { m_level.freeze(); m_valid.freeze(); }
+    bool isFrozen() const         { return m_level.isFrozen(); }
+
+    // Cached data computed from the samples (see CowVector::derived)
+    template <typename D, typename Build>
+    std::shared_ptr<const D> derived(Build build) const
+    {
+        return m_level.derived<D>([this, &build](const std::vector<quint64> &) { return build(*this); });
+    }
+
+private:
+    int m_size = 0;
+    CowVector<quint64> m_level;
+    CowVector<quint64> m_valid;
+
+    // Bit t of the concatenated words, 64 at a time from any (even negative)
+    // position; zeros outside the plane
+    static quint64 extract(const quint64 *words, int wordCount, qint64 bitPos);
+    // Word w of "sample t differs from t - 1"
+    quint64 changeWord(int w) const;
+};
+
+template <typename Fn>
+void BitPlane::forEachTransition(Fn fn) const
+{
+    const int nw = wordCount();
+    for (int w = 0; w < nw; ++w) {
+        quint64 diff = changeWord(w);
+        while (diff) {
+            const int b = static_cast<int>(qCountTrailingZeroBits(diff));
+            fn(w * kWordBits + b);
+            diff &= diff - 1;
+        }
+    }
+}
+
+#endif // BITPLANE_H
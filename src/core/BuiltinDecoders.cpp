@@ -0,0 +1,373 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          BuiltinDecoders.cpp
+// Description:   Built-in UART, SPI and I2C protocol decoders.
+//======================================================================
+
+#include "core/BuiltinDecoders.h"
+#include "core/ProtocolDecoder.h"
+
+#include <algorithm>
+
+namespace {
+
+QString byteLabel(int value)
+{
+    return "0x" + QString::number(value, 16).toUpper().rightJustified(2, '0');
+}
+
+// ---------------------------------------------------------------------------
+// UART: one line, idle high, LSB first. Bits are read at their centres,
+// timed from the falling edge of the start bit.
+// ---------------------------------------------------------------------------
+class UartDecoder : public ProtocolDecoder
+{
+public:
+    QString id() const override { return QStringLiteral("uart"); }
+    QString description() const override { return QStringLiteral("UART (asynchronous serial)"); }
+    std::vector<DecoderChannel> channels() const override { return {{QStringLiteral("rx"), false}}; }
+    QStringList outputs() const override { return {QStringLiteral("data")}; }
+    std::vector<DecoderOption> options() const override
+    {
+        return {
+            {QStringLiteral("bitSamples"), QStringLiteral("Samples per bit"), 16, 1, 1 << 24},
+            {QStringLiteral("dataBits"),   QStringLiteral("Data bits"),        8,  5, 9},
+            {QStringLiteral("parity"),     QStringLiteral("Parity (0 none, 1 odd, 2 even)"), 0, 0, 2},
+            {QStringLiteral("stopBits"),   QStringLiteral("Stop bits"),        1,  1, 2},
+            {QStringLiteral("inverted"),   QStringLiteral("Inverted line"),    0,  0, 1},
+        };
+    }
+
+    void begin(int, const int *levels) override
+    {
+        m_bitSamples = option("bitSamples");
+        m_dataBits = option("dataBits");
+        m_parity = option("parity");
+        m_stopBits = option("stopBits");
+        m_inverted = option("inverted") != 0;
+        m_level = level(levels[0]);
+        m_busy = false;
+    }
+
+    void step(int sample, const int *, const int *cur) override
+    {
+        advance(sample);
+        const int next = level(cur[0]);
+        if (!m_busy && m_level == 1 && next == 0)
+            startFrame(sample);
+        m_level = next;
+    }
+
+    void end(int sample) override { advance(sample); }
+
+private:
+    int  m_bitSamples = 16;
+    int  m_dataBits = 8;
+    int  m_parity = 0;
+    int  m_stopBits = 1;
+    bool m_inverted = false;
+
+    int  m_level = UNDEFINED_VALUE;
+    bool m_busy = false;
+    int  m_frameStart = 0;
+    int  m_bit = 0;          // 0 = start bit, then data, parity, stop
+    int  m_nextPoint = 0;    // centre of m_bit
+    int  m_value = 0;
+    int  m_ones = 0;
+    bool m_parityError = false;
+
+    int level(int v) const
+    {
+        return (v == UNDEFINED_VALUE || !m_inverted) ? v : (v ^ 1);
+    }
+
+    void startFrame(int sample)
+    {
+        m_busy = true;
+        m_frameStart = sample;
+        m_bit = 0;
+        m_nextPoint = sample + m_bitSamples / 2;
+        m_value = 0;
+        m_ones = 0;
+        m_parityError = false;
+    }
+
+    // Reads every bit centre before `sample`; the line holds m_level there
+    void advance(int sample)
+    {
+        const int parityBits = m_parity ? 1 : 0;
+        while (m_busy && m_nextPoint < sample) {
+            const int b = m_level;
+            if (b == UNDEFINED_VALUE) {
+                m_busy = false;                     // X on the line: drop the frame
+                break;
+            }
+            if (m_bit == 0) {
+                if (b != 0) {
+                    m_busy = false;                 // glitch, not a start bit
+                    break;
+                }
+            } else if (m_bit <= m_dataBits) {
+                m_value |= b << (m_bit - 1);
+                m_ones += b;
+            } else if (m_bit <= m_dataBits + parityBits) {
+                const int ones = m_ones + b;
+                m_parityError = (m_parity == 1) ? (ones % 2 == 0) : (ones % 2 != 0);
+            } else {
+                // Stop bit(s): a low level here is a framing error
+                const int last = m_dataBits + parityBits + m_stopBits;
+                if (b != 1 || m_bit == last) {
+                    QString label = byteLabel(m_value);
+                    if (m_value >= 0x20 && m_value < 0x7F)
+                        label += QStringLiteral(" '%1'").arg(QChar(m_value));
+                    if (b != 1)
+                        label = QStringLiteral("FE ") + label;
+                    else if (m_parityError)
+                        label = QStringLiteral("PE ") + label;
+                    annotate(0, m_frameStart, m_frameStart + (m_bit + 1) * m_bitSamples, m_value, label);
+                    m_busy = false;
+                    break;
+                }
+            }
+            ++m_bit;
+            m_nextPoint += m_bitSamples;
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// SPI: words shifted on the sampling edge of SCLK while CS is active. CPOL /
+// CPHA select the edge as usual (modes 0..3). MOSI and MISO are decoded on
+// separate rows; each word spans from its first to past its last sampling edge.
+// ---------------------------------------------------------------------------
+class SpiDecoder : public ProtocolDecoder
+{
+public:
+    QString id() const override { return QStringLiteral("spi"); }
+    QString description() const override { return QStringLiteral("SPI (serial peripheral interface)"); }
+    std::vector<DecoderChannel> channels() const override
+    {
+        return {{QStringLiteral("sclk"), false}, {QStringLiteral("mosi"), true},
+                {QStringLiteral("miso"), true},  {QStringLiteral("cs"), true}};
+    }
+    QStringList outputs() const override { return {QStringLiteral("mosi"), QStringLiteral("miso")}; }
+    std::vector<DecoderOption> options() const override
+    {
+        return {
+            {QStringLiteral("cpol"),         QStringLiteral("CPOL"),           0, 0, 1},
+            {QStringLiteral("cpha"),         QStringLiteral("CPHA"),           0, 0, 1},
+            {QStringLiteral("wordBits"),     QStringLiteral("Bits per word"),  8, 1, 31},
+            {QStringLiteral("lsbFirst"),     QStringLiteral("LSB first"),      0, 0, 1},
+            {QStringLiteral("csActiveHigh"), QStringLiteral("CS active high"), 0, 0, 1},
+        };
+    }
+
+    void begin(int, const int *levels) override
+    {
+        m_risingSamples = option("cpol") == option("cpha");
+        m_wordBits = option("wordBits");
+        m_lsbFirst = option("lsbFirst") != 0;
+        m_csActive = option("csActiveHigh") ? 1 : 0;
+        m_selected = selected(levels[kCs]);
+        resetWord();
+    }
+
+    void step(int sample, const int *prev, const int *cur) override
+    {
+        const bool sel = selected(cur[kCs]);
+        if (sel != m_selected) {
+            resetWord();                  // CS edge: a partial word is dropped
+            m_selected = sel;
+        }
+        if (!m_selected || prev[kSclk] == UNDEFINED_VALUE || cur[kSclk] == UNDEFINED_VALUE)
+            return;
+        const bool edge = m_risingSamples ? (prev[kSclk] == 0 && cur[kSclk] == 1)
+                                          : (prev[kSclk] == 1 && cur[kSclk] == 0);
+        if (!edge)
+            return;
+
+        // Data is read as it was just before the edge (setup, not hold)
+        if (m_bits == 0)
+            m_wordStart = sample;
+        shiftIn(0, prev[kMosi]);
+        shiftIn(1, prev[kMiso]);
+        m_lastEdge = sample;
+        if (++m_bits == m_wordBits) {
+            const int bitLen = m_wordBits > 1 ? (m_lastEdge - m_wordStart) / (m_wordBits - 1) : 1;
+            const int endSample = m_lastEdge + std::max(1, bitLen);
+            for (int row = 0; row < 2; ++row)
+                if (m_valid[row])
+                    annotate(row, m_wordStart, endSample, m_word[row], byteLabel(m_word[row]));
+            resetWord();
+        }
+    }
+
+    void end(int) override {}
+
+private:
+    enum { kSclk, kMosi, kMiso, kCs };
+
+    bool m_risingSamples = true;
+    int  m_wordBits = 8;
+    bool m_lsbFirst = false;
+    int  m_csActive = 0;
+    bool m_selected = true;
+
+    int  m_bits = 0;
+    int  m_wordStart = 0;
+    int  m_lastEdge = 0;
+    int  m_word[2] = {0, 0};
+    bool m_valid[2] = {true, true};
+
+    // An unconnected (or X) CS counts as always selected
+    bool selected(int cs) const { return cs == UNDEFINED_VALUE || cs == m_csActive; }
+
+    void resetWord()
+    {
+        m_bits = 0;
+        m_word[0] = m_word[1] = 0;
+        m_valid[0] = m_valid[1] = true;
+    }
+
+    void shiftIn(int row, int b)
+    {
+        if (b == UNDEFINED_VALUE) {
+            m_valid[row] = false;
+            return;
+        }
+        if (m_lsbFirst)
+            m_word[row] |= b << m_bits;
+        else
+            m_word[row] = (m_word[row] << 1) | b;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// I2C: START/STOP conditions, address byte (7-bit + R/W) and data bytes, each
+// with its ACK/NAK. Bits are read on the rising edge of SCL.
+// ---------------------------------------------------------------------------
+class I2cDecoder : public ProtocolDecoder
+{
+public:
+    QString id() const override { return QStringLiteral("i2c"); }
+    QString description() const override { return QStringLiteral("I2C (two-wire bus)"); }
+    std::vector<DecoderChannel> channels() const override
+    {
+        return {{QStringLiteral("scl"), false}, {QStringLiteral("sda"), false}};
+    }
+    QStringList outputs() const override { return {QStringLiteral("frames")}; }
+
+    void begin(int, const int *) override
+    {
+        m_inFrame = false;
+        m_bits = 0;
+    }
+
+    void step(int sample, const int *prev, const int *cur) override
+    {
+        const bool sclHigh = prev[kScl] == 1 && cur[kScl] == 1;
+        if (sclHigh && prev[kSda] == 1 && cur[kSda] == 0) {
+            // START, or repeated START inside a transfer
+            closeStart(sample);
+            m_startLabel = m_inFrame ? QStringLiteral("Sr") : QStringLiteral("S");
+            m_startSample = sample;
+            m_pendingStart = true;
+            m_inFrame = true;
+            m_address = true;
+            m_bits = 0;
+            m_byte = 0;
+            return;
+        }
+        if (sclHigh && prev[kSda] == 0 && cur[kSda] == 1) {
+            closeStart(sample);
+            if (m_inFrame)
+                annotate(0, sample, sample + 1, 0, QStringLiteral("P"));
+            m_inFrame = false;
+            return;
+        }
+        if (!m_inFrame || !(prev[kScl] == 0 && cur[kScl] == 1))
+            return;
+
+        // Rising SCL: data bit (or ACK after the 8th); SDA as held before the edge
+        const int b = prev[kSda];
+        if (b == UNDEFINED_VALUE) {
+            m_inFrame = false;            // bus in X: resynchronise on the next START
+            m_pendingStart = false;
+            return;
+        }
+        if (m_bits == 0) {
+            closeStart(sample);
+            m_byteStart = sample;
+        }
+        if (m_bits < 8) {
+            m_byte = (m_byte << 1) | b;
+            ++m_bits;
+            return;
+        }
+
+        const QString ack = b == 0 ? QStringLiteral("ACK") : QStringLiteral("NAK");
+        QString label;
+        if (m_address)
+            label = QStringLiteral("Addr %1 %2 %3").arg(byteLabel(m_byte >> 1))
+                                                  .arg((m_byte & 1) ? QStringLiteral("R") : QStringLiteral("W"))
+                                                  .arg(ack);
+        else
+            label = byteLabel(m_byte) + ' ' + ack;
+        annotate(0, m_byteStart, sample + 1, m_byte, label);
+        m_address = false;
+        m_bits = 0;
+        m_byte = 0;
+    }
+
+    void end(int sample) override { closeStart(sample); }
+
+private:
+    enum { kScl, kSda };
+
+    bool    m_inFrame = false;
+    bool    m_address = false;
+    int     m_bits = 0;
+    int     m_byte = 0;
+    int     m_byteStart = 0;
+    bool    m_pendingStart = false;
+    int     m_startSample = 0;
+    QString m_startLabel;
+
+    // The START annotation lasts until the first bit (or the next condition)
+    void closeStart(int sample)
+    {
+        if (!m_pendingStart)
+            return;
+        annotate(0, m_startSample, std::max(sample, m_startSample + 1), 0, m_startLabel);
+        m_pendingStart = false;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<ProtocolDecoder> makeUartDecoder()
+{
+    return std::make_unique<UartDecoder>();
+}
+
+std::unique_ptr<ProtocolDecoder> makeSpiDecoder()
+{
+    return std::make_unique<SpiDecoder>();
+}
+
+std::unique_ptr<ProtocolDecoder> makeI2cDecoder()
+{
+    return std::make_unique<I2cDecoder>();
+}
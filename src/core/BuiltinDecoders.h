@@ -0,0 +1,31 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          BuiltinDecoders.h
+// Description:   Built-in UART, SPI and I2C protocol decoders.
+//======================================================================
+
+#ifndef BUILTINDECODERS_H
+#define BUILTINDECODERS_H
+
+#include <memory>
+
+class ProtocolDecoder;
+
+// Decoders registered by default (see ProtocolDecoder.h)
+std::unique_ptr<ProtocolDecoder> makeUartDecoder();
+std::unique_ptr<ProtocolDecoder> makeSpiDecoder();
+std::unique_ptr<ProtocolDecoder> makeI2cDecoder();
+
+#endif // BUILTINDECODERS_H
@@ -0,0 +1,212 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Clock.cpp
+// Description:   Clock detection and procedural clock waveforms.
+//======================================================================
+
+#include "core/Clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+qint64 floorDiv(qint64 a, qint64 b)
+{
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+}
+
+// Smallest x >= t with x = base (mod period)
+qint64 firstAtOrAfter(qint64 base, qint64 t, qint64 period)
+{
+    return base + (floorDiv(t - base - 1, period) + 1) * period;
+}
+
+// Largest x <= t with x = base (mod period)
+qint64 lastAtOrBefore(qint64 base, qint64 t, qint64 period)
+{
+    return base + floorDiv(t - base, period) * period;
+}
+
+} // namespace
+
+int ClockShape::valueAt(int t) const
+{
+    if (t < begin || t >= end || period <= 0)
+        return UNDEFINED_VALUE;
+    const qint64 pos = qint64(t) - phase - floorDiv(qint64(t) - phase, period) * period;
+    return pos < high ? 1 : 0;
+}
+
+int ClockShape::nextEdge(int fromSample, EdgeKind kind) const
+{
+    if (period <= 0)
+        return -1;
+    // A rising/falling edge at t needs a defined sample at t - 1
+    const qint64 lo = std::max<qint64>(qint64(fromSample) + 1, qint64(begin) + 1);
+    qint64 best = end;
+    if (kind != EdgeKind::Falling)
+        best = std::min(best, firstAtOrAfter(phase, lo, period));
+    if (kind != EdgeKind::Rising)
+        best = std::min(best, firstAtOrAfter(qint64(phase) + high, lo, period));
+    // X -> value at `begin` is a change too
+    if (kind == EdgeKind::Any && begin > 0 && begin > fromSample)
+        best = begin;
+    return best < end ? static_cast<int>(best) : -1;
+}
+
+int ClockShape::prevEdge(int fromSample, EdgeKind kind) const
+{
+    if (period <= 0)
+        return -1;
+    const qint64 hi = std::min<qint64>(qint64(fromSample) - 1, qint64(end) - 1);
+    qint64 best = -1;
+    if (kind != EdgeKind::Falling)
+        best = std::max(best, lastAtOrBefore(phase, hi, period));
+    if (kind != EdgeKind::Rising)
+        best = std::max(best, lastAtOrBefore(qint64(phase) + high, hi, period));
+    if (best > begin)
+        return static_cast<int>(best);
+    return (kind == EdgeKind::Any && begin > 0 && begin < fromSample) ? begin : -1;
+}
+
+qint64 ClockShape::risingEdges(int t0, int t1) const
+{
+    if (period <= 0)
+        return 0;
+    const qint64 lo = std::max(t0, begin + 1);
+    const qint64 hi = std::min(t1, end);
+    if (hi <= lo)
+        return 0;
+    const qint64 first = firstAtOrAfter(phase, lo, period);
+    return first < hi ? (hi - 1 - first) / period + 1 : 0;
+}
+
+ClockShape ClockShape::sliced(int first, int count) const
+{
+    ClockShape s = *this;
+    s.phase = static_cast<int>(phase - first - floorDiv(qint64(phase) - first, period) * period);
+    s.begin = std::max(0, begin - first);
+    s.end = std::max(s.begin, std::min(end - first, count));
+    return s;
+}
+
+ClockInfo detectClock(const BitPlane &bits, const std::vector<qint64> &sampleTimes)
+{
+    ClockInfo info;
+    const int n = bits.size();
+    if (n < 2 * kMinClockCycles)
+        return info;
+    // Cheap reject before collecting anything: too few changes
+    if (bits.transitionCount() < 2 * kMinClockCycles - 1)
+        return info;
+
+    // Defined from `begin` on; X is only accepted before it
+    std::vector<int> rises;
+    std::vector<int> falls;
+    int begin = bits.value(0) == UNDEFINED_VALUE ? -1 : 0;
+    bool bad = false;
+    bits.forEachTransition([&](int t) {
+        if (bad)
+            return;
+        const int before = bits.value(t - 1);
+        const int after = bits.value(t);
+        if (before == UNDEFINED_VALUE && begin < 0 && after != UNDEFINED_VALUE)
+            begin = t;
+        else if (before == 0 && after == 1)
+            rises.push_back(t);
+        else if (before == 1 && after == 0)
+            falls.push_back(t);
+        else
+            bad = true;
+    });
+    if (bad || begin < 0 || static_cast<int>(rises.size()) < kMinClockCycles || falls.empty())
+        return info;
+
+    // High time of each cycle: the fall that follows every rise
+    std::vector<int> highs;
+    highs.reserve(rises.size());
+    {
+        size_t f = 0;
+        for (int r : rises) {
+            while (f < falls.size() && falls[f] < r)
+                ++f;
+            if (f < falls.size())
+                highs.push_back(falls[f] - r);
+        }
+    }
+    if (highs.empty())
+        return info;
+
+    // Periodic in samples: every edge where the shape puts one
+    const int ps = rises[1] - rises[0];
+    const int hs = highs[0];
+    bool uniform = hs > 0 && hs < ps;
+    for (size_t i = 1; uniform && i < rises.size(); ++i)
+        uniform = rises[i] - rises[i - 1] == ps;
+    for (size_t i = 0; uniform && i < highs.size(); ++i)
+        uniform = highs[i] == hs;
+    ClockShape shape{ps, rises[0] % ps, hs, begin, n};
+    if (uniform) {
+        // Every recorded edge lies on the grid of the shape, there are as many
+        // as the shape has after `begin` and the first value agrees: same waveform
+        ClockShape fallGrid = shape;
+        fallGrid.phase += hs;
+        for (size_t i = 0; uniform && i < falls.size(); ++i)
+            uniform = (falls[i] - fallGrid.phase) % ps == 0;
+        uniform = uniform && shape.valueAt(begin) == bits.value(begin) &&
+                  static_cast<qint64>(rises.size()) == shape.risingEdges(0, n) &&
+                  static_cast<qint64>(falls.size()) == fallGrid.risingEdges(0, n);
+    }
+
+    info.cycles = static_cast<qint64>(rises.size());
+    const bool timed = static_cast<int>(sampleTimes.size()) >= n;
+    if (timed) {
+        // Regular in time: every period and high time within 2 % of the mean
+        const double period = double(sampleTimes[rises.back()] - sampleTimes[rises.front()]) / double(rises.size() - 1);
+        double highSum = 0.0;
+        for (size_t i = 0; i < highs.size(); ++i)
+            highSum += double(sampleTimes[rises[i] + highs[i]] - sampleTimes[rises[i]]);
+        const double high = highSum / double(highs.size());
+        const double tol = std::max(period * 0.02, 0.5);
+        bool regular = period > 0.0 && high > 0.0 && high < period;
+        for (size_t i = 1; regular && i < rises.size(); ++i)
+            regular = std::abs(double(sampleTimes[rises[i]] - sampleTimes[rises[i - 1]]) - period) <= tol;
+        for (size_t i = 0; regular && i < highs.size(); ++i)
+            regular = std::abs(double(sampleTimes[rises[i] + highs[i]] - sampleTimes[rises[i]]) - high) <= tol;
+        info.isClock = regular;
+        info.period = std::llround(period);
+        info.duty = period > 0.0 ? high / period : 0.0;
+    } else {
+        info.isClock = uniform;
+        info.period = ps;
+        info.duty = double(hs) / double(ps);
+    }
+    info.uniform = info.isClock && uniform;
+    if (info.uniform)
+        info.shape = shape;
+    return info;
+}
+
+QString formatFrequency(double hz)
+{
+    static const char *const units[] = {"Hz", "kHz", "MHz", "GHz", "THz"};
+    int u = 0;
+    while (hz >= 1000.0 && u < 4) {
+        hz /= 1000.0;
+        ++u;
+    }
+    return QString::number(hz, 'g', 4) + ' ' + units[u];
+}
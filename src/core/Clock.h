@@ -0,0 +1,74 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Clock.h
+// Description:   Clock detection and procedural clock waveforms.
+//======================================================================
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <QString>
+#include <vector>
+#include "core/core.h"
+#include "core/Edges.h"
+
+// A periodic Bit waveform described by four numbers instead of its samples:
+// rising edges at phase + k * period, `high` samples at 1 after each of them,
+// defined over [begin, end) and X outside.
+struct ClockShape
+{
+    int period = 0;
+    int phase = 0;
+    int high = 0;
+    int begin = 0;
+    int end = 0;
+
+    bool isValid() const { return period >= 2 && high > 0 && high < period && begin < end; }
+
+    int valueAt(int t) const;
+
+    // Same contract as nextEdge()/prevEdge() in Edges.h, in O(1)
+    int nextEdge(int fromSample, EdgeKind kind) const;
+    int prevEdge(int fromSample, EdgeKind kind) const;
+
+    // Rising edges (cycles) in [t0, t1)
+    qint64 risingEdges(int t0, int t1) const;
+
+    // The shape after cutting the samples before `first` and keeping `count`
+    ClockShape sliced(int first, int count) const;
+};
+
+// Result of analysing one Bit signal at import
+struct ClockInfo
+{
+    bool   isClock = false;   // stable period and duty cycle
+    bool   uniform = false;   // also periodic in samples: `shape` reproduces it exactly
+    qint64 period = 0;        // in VCD time units (samples if there are no timestamps)
+    double duty = 0.0;        // high time / period
+    qint64 cycles = 0;        // rising edges
+    ClockShape shape;
+};
+
+// Detects a clock: at least kMinClockCycles rising edges, only X before the
+// first defined sample, and equal periods and high times (within 2 % in
+// time, exact in samples). `sampleTimes` holds the VCD time of every sample
+// and may be empty.
+static constexpr int kMinClockCycles = 4;
+ClockInfo detectClock(const BitPlane &bits, const std::vector<qint64> &sampleTimes);
+
+// "100 MHz", "32.8 kHz"
+QString formatFrequency(double hz);
+
+#endif // CLOCK_H
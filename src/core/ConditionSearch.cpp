@@ -0,0 +1,596 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ConditionSearch.cpp
+// Description:   Compiled value/condition search over the visible signals.
+//======================================================================
+
+#include "core/ConditionSearch.h"
+#include "core/DerivedSignal.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+#include <climits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WP_HAVE_SSE2 1
+#endif
+
+namespace {
+
+// Chunks are at least this long: below it thread hand-off dominates
+constexpr int kMinChunkSamples = 1 << 16;
+
+// A chunk with more than one run per kDenseSamplesPerRun samples is
+// evaluated with the mask kernels instead of run by run
+constexpr int kDenseSamplesPerRun = 16;
+
+inline bool compareScalar(int v, ConditionOp op, int k)
+{
+    switch (op) {
+    case ConditionOp::Eq: return v == k;
+    case ConditionOp::Ne: return v != k;
+    case ConditionOp::Lt: return v >= 0 && v < k;
+    case ConditionOp::Le: return v >= 0 && v <= k;
+    case ConditionOp::Gt: return v >= 0 && v > k;
+    case ConditionOp::Ge: return v >= 0 && v >= k;
+    }
+    return false;
+}
+
+ConditionOp mirrored(ConditionOp op)
+{
+    switch (op) {
+    case ConditionOp::Lt: return ConditionOp::Gt;
+    case ConditionOp::Le: return ConditionOp::Ge;
+    case ConditionOp::Gt: return ConditionOp::Lt;
+    case ConditionOp::Ge: return ConditionOp::Le;
+    default:              return op;
+    }
+}
+
+// out[i] = (v[i] op k) ? 1 : 0
+template <ConditionOp Op>
+void compareKernel(const int *v, int n, int k, quint8 *out)
+{
+    int i = 0;
+#ifdef WP_HAVE_SSE2
+    const __m128i kk = _mm_set1_epi32(k);
+    const __m128i undef = _mm_set1_epi32(UNDEFINED_VALUE);
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i one8 = _mm_set1_epi8(1);
+    for (; i + 16 <= n; i += 16) {
+        __m128i m[4];
+        for (int j = 0; j < 4; ++j) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + i + 4 * j));
+            const __m128i defined = _mm_cmpgt_epi32(x, undef);
+            __m128i r;
+            switch (Op) {
+            case ConditionOp::Eq: r = _mm_cmpeq_epi32(x, kk); break;
+            case ConditionOp::Ne: r = _mm_xor_si128(_mm_cmpeq_epi32(x, kk), ones); break;
+            case ConditionOp::Lt: r = _mm_and_si128(_mm_cmplt_epi32(x, kk), defined); break;
+            case ConditionOp::Le: r = _mm_and_si128(_mm_xor_si128(_mm_cmpgt_epi32(x, kk), ones), defined); break;
+            case ConditionOp::Gt: r = _mm_and_si128(_mm_cmpgt_epi32(x, kk), defined); break;
+            case ConditionOp::Ge: r = _mm_and_si128(_mm_xor_si128(_mm_cmplt_epi32(x, kk), ones), defined); break;
+            }
+            m[j] = r;
+        }
+        // 16 x int32 lanes (0 / -1) -> 16 bytes (0 / 1)
+        const __m128i w = _mm_packs_epi16(_mm_packs_epi32(m[0], m[1]), _mm_packs_epi32(m[2], m[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_and_si128(w, one8));
+    }
+#endif
+    for (; i < n; ++i)
+        out[i] = compareScalar(v[i], Op, k) ? 1 : 0;
+}
+
+void compareMask(const int *v, int n, ConditionOp op, int k, quint8 *out)
+{
+    switch (op) {
+    case ConditionOp::Eq: compareKernel<ConditionOp::Eq>(v, n, k, out); break;
+    case ConditionOp::Ne: compareKernel<ConditionOp::Ne>(v, n, k, out); break;
+    case ConditionOp::Lt: compareKernel<ConditionOp::Lt>(v, n, k, out); break;
+    case ConditionOp::Le: compareKernel<ConditionOp::Le>(v, n, k, out); break;
+    case ConditionOp::Gt: compareKernel<ConditionOp::Gt>(v, n, k, out); break;
+    case ConditionOp::Ge: compareKernel<ConditionOp::Ge>(v, n, k, out); break;
+    }
+}
+
+// First index >= i whose byte equals b (0 or 1), or n
+int findByte(const quint8 *m, int n, int i, quint8 b)
+{
+#ifdef WP_HAVE_SSE2
+    const __m128i bb = _mm_set1_epi8(static_cast<char>(b));
+    for (; i + 16 <= n; i += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(m + i));
+        const int bits = _mm_movemask_epi8(_mm_cmpeq_epi8(x, bb));
+        if (bits != 0) {
+            for (int j = 0; j < 16; ++j)
+                if (bits & (1 << j))
+                    return i + j;
+        }
+    }
+#endif
+    for (; i < n; ++i)
+        if (m[i] == b)
+            return i;
+    return n;
+}
+
+void appendHit(std::vector<ConditionHit> &out, int start, int end)
+{
+    if (!out.empty() && out.back().end == start)
+        out.back().end = end;
+    else
+        out.push_back({start, end});
+}
+
+QStringList tokenize(const QString &expr)
+{
+    static const char *const twoChar[] = {"&&", "||", "==", "!=", "<=", ">="};
+    const QString special = QStringLiteral("&|=!<>()");
+
+    QStringList toks;
+    int i = 0;
+    const int n = expr.size();
+    while (i < n) {
+        const QChar c = expr[i];
+        if (c.isSpace()) {
+            ++i;
+            continue;
+        }
+        bool matched = false;
+        for (const char *op : twoChar) {
+            if (expr.mid(i, 2) == QLatin1String(op)) {
+                toks << QString::fromLatin1(op);
+                i += 2;
+                matched = true;
+                break;
+            }
+        }
+        if (matched)
+            continue;
+        if (special.contains(c)) {
+            toks << (c == '=' ? QStringLiteral("==") : QString(c));   // '=' reads as '=='
+            ++i;
+            continue;
+        }
+        int j = i;
+        while (j < n && !expr[j].isSpace() && !special.contains(expr[j]))
+            ++j;
+        toks << expr.mid(i, j - i);
+        i = j;
+    }
+    return toks;
+}
+
+bool isComparison(const QString &tok, ConditionOp &op)
+{
+    if (tok == "==") op = ConditionOp::Eq;
+    else if (tok == "!=") op = ConditionOp::Ne;
+    else if (tok == "<")  op = ConditionOp::Lt;
+    else if (tok == "<=") op = ConditionOp::Le;
+    else if (tok == ">")  op = ConditionOp::Gt;
+    else if (tok == ">=") op = ConditionOp::Ge;
+    else return false;
+    return true;
+}
+
+bool isOperator(const QString &tok)
+{
+    ConditionOp op;
+    return isComparison(tok, op) || tok == "&&" || tok == "||" || tok == "!" ||
+           tok == "(" || tok == ")";
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Compilation
+// ---------------------------------------------------------------------------
+
+bool ConditionSearch::fail(const QString &msg)
+{
+    if (m_error.isEmpty())
+        m_error = msg;
+    return false;
+}
+
+int ConditionSearch::addNode(const Node &n)
+{
+    m_nodes.push_back(n);
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+bool ConditionSearch::compile(const QString &expr, const WaveDocument &doc)
+{
+    m_nodes.clear();
+    m_slots.clear();
+    m_slotNames.clear();
+    m_unpacked.clear();
+    m_error.clear();
+    m_root = -1;
+    m_sampleCount = doc.sampleCount();
+
+    m_tokens = tokenize(expr);
+    m_pos = 0;
+    if (m_tokens.isEmpty())
+        return fail(QObject::tr("Empty condition"));
+
+    const int root = parseOr(doc);
+    if (root < 0)
+        return false;
+    if (m_pos < m_tokens.size())
+        return fail(QObject::tr("Unexpected '%1'").arg(m_tokens[m_pos]));
+
+    m_root = root;
+    m_tokens.clear();
+    return true;
+}
+
+int ConditionSearch::parseOr(const WaveDocument &doc)
+{
+    int lhs = parseAnd(doc);
+    while (lhs >= 0 && m_pos < m_tokens.size() && m_tokens[m_pos] == "||") {
+        ++m_pos;
+        const int rhs = parseAnd(doc);
+        if (rhs < 0)
+            return -1;
+        Node n;
+        n.kind = Node::Or;
+        n.lhs = lhs;
+        n.rhs = rhs;
+        lhs = addNode(n);
+    }
+    return lhs;
+}
+
+int ConditionSearch::parseAnd(const WaveDocument &doc)
+{
+    int lhs = parseUnary(doc);
+    while (lhs >= 0 && m_pos < m_tokens.size() && m_tokens[m_pos] == "&&") {
+        ++m_pos;
+        const int rhs = parseUnary(doc);
+        if (rhs < 0)
+            return -1;
+        Node n;
+        n.kind = Node::And;
+        n.lhs = lhs;
+        n.rhs = rhs;
+        lhs = addNode(n);
+    }
+    return lhs;
+}
+
+int ConditionSearch::parseUnary(const WaveDocument &doc)
+{
+    if (m_pos >= m_tokens.size()) {
+        fail(QObject::tr("Unexpected end of condition"));
+        return -1;
+    }
+
+    if (m_tokens[m_pos] == "!") {
+        ++m_pos;
+        const int inner = parseUnary(doc);
+        if (inner < 0)
+            return -1;
+        Node n;
+        n.kind = Node::Not;
+        n.lhs = inner;
+        return addNode(n);
+    }
+
+    if (m_tokens[m_pos] == "(") {
+        ++m_pos;
+        const int inner = parseOr(doc);
+        if (inner < 0)
+            return -1;
+        if (m_pos >= m_tokens.size() || m_tokens[m_pos] != ")") {
+            fail(QObject::tr("Missing ')'"));
+            return -1;
+        }
+        ++m_pos;
+        return inner;
+    }
+
+    return parseComparison(doc);
+}
+
+int ConditionSearch::parseComparison(const WaveDocument &doc)
+{
+    const QString a = m_tokens[m_pos++];
+    if (isOperator(a)) {
+        fail(QObject::tr("Expected a signal name before '%1'").arg(a));
+        return -1;
+    }
+
+    Node n;
+    n.kind = Node::Cmp;
+
+    ConditionOp op;
+    if (m_pos >= m_tokens.size() || !isComparison(m_tokens[m_pos], op)) {
+        // Bare signal: true while its value is > 0
+        n.slot = signalSlot(a, doc);
+        if (n.slot < 0) {
+            fail(QObject::tr("Unknown signal '%1' (only signals shown in the waveform can be searched)").arg(a));
+            return -1;
+        }
+        n.op = ConditionOp::Gt;
+        n.value = 0;
+        return addNode(n);
+    }
+    ++m_pos;
+
+    if (m_pos >= m_tokens.size() || isOperator(m_tokens[m_pos])) {
+        fail(QObject::tr("Expected a value after '%1'").arg(m_tokens[m_pos - 1]));
+        return -1;
+    }
+    const QString b = m_tokens[m_pos++];
+
+    int value = 0;
+    if ((n.slot = signalSlot(a, doc)) >= 0) {
+        if (!parseValueLiteral(b, value)) {
+            fail(QObject::tr("'%1' is not a number (comparing two signals is not supported)").arg(b));
+            return -1;
+        }
+        n.op = op;
+    } else if (parseValueLiteral(a, value) && (n.slot = signalSlot(b, doc)) >= 0) {
+        n.op = mirrored(op);   // "5 < bus" == "bus > 5"
+    } else {
+        fail(QObject::tr("Unknown signal '%1' (only signals shown in the waveform can be searched)").arg(a));
+        return -1;
+    }
+
+    if (value == UNDEFINED_VALUE && n.op != ConditionOp::Eq && n.op != ConditionOp::Ne) {
+        fail(QObject::tr("X can only be compared with == or !="));
+        return -1;
+    }
+    n.value = value;
+    return addNode(n);
+}
+
+int ConditionSearch::signalSlot(const QString &name, const WaveDocument &doc)
+{
+    const int known = m_slotNames.indexOf(name);
+    if (known >= 0)
+        return known;
+
+    for (const Signal &s : doc.signalList()) {
+        if (s.name == name) {
+            if (s.isDerived()) {
+                // No stored samples: scan an evaluated copy (procedural
+                // clocks, expressions)
+                Signal copy(s.name, s.type, 0);
+                std::vector<int> vals = SignalExpr::sampleValues(s, 0, doc.sampleCount(),
+                                                                       doc.signalResolver());
+                if (s.type == SignalType::Bit)
+                    copy.bits = BitPlane::fromValues(vals.data(), static_cast<int>(vals.size()));
+                else
+                    copy.values = std::move(vals);
+                m_slots.push_back(std::move(copy));
+            } else {
+                m_slots.push_back(s);   // shares the buffers
+            }
+            m_slotNames << name;
+            m_unpacked.emplace_back();
+            const Signal &slot = m_slots.back();
+            if (slot.isPacked()) {
+                m_unpacked.back().resize(slot.sampleCount());
+                slot.bits.unpack(0, slot.sampleCount(), m_unpacked.back().data());
+            }
+            return static_cast<int>(m_slots.size()) - 1;
+        }
+    }
+    return -1;
+}
+
+bool parseValueLiteral(const QString &tok, int &value)
+{
+    QString t = tok;
+    t.remove('_');
+    if (t.compare("x", Qt::CaseInsensitive) == 0 || t.compare("'x", Qt::CaseInsensitive) == 0) {
+        value = UNDEFINED_VALUE;
+        return true;
+    }
+
+    int base = 10;
+    QString digits = t;
+    const int q = t.indexOf('\'');
+    if (q >= 0) {
+        // Verilog style: [width]'h1F, 'd31, 'b11111, 'o37 (the width is ignored)
+        if (q + 1 >= t.size())
+            return false;
+        const QChar b = t[q + 1].toLower();
+        if (b == 'h') base = 16;
+        else if (b == 'd') base = 10;
+        else if (b == 'b') base = 2;
+        else if (b == 'o') base = 8;
+        else return false;
+        digits = t.mid(q + 2);
+    } else if (t.startsWith("0x", Qt::CaseInsensitive)) {
+        base = 16;
+        digits = t.mid(2);
+    } else if (t.startsWith("0b", Qt::CaseInsensitive)) {
+        base = 2;
+        digits = t.mid(2);
+    }
+
+    bool ok = false;
+    const qint64 v = digits.toLongLong(&ok, base);
+    if (!ok || v < 0 || v > INT_MAX)
+        return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation
+// ---------------------------------------------------------------------------
+
+bool ConditionSearch::evalAt(int node, const int *const *vals, int t) const
+{
+    const Node &n = m_nodes[node];
+    switch (n.kind) {
+    case Node::Cmp: return compareScalar(vals[n.slot][t], n.op, n.value);
+    case Node::And: return evalAt(n.lhs, vals, t) && evalAt(n.rhs, vals, t);
+    case Node::Or:  return evalAt(n.lhs, vals, t) || evalAt(n.rhs, vals, t);
+    case Node::Not: return !evalAt(n.lhs, vals, t);
+    }
+    return false;
+}
+
+void ConditionSearch::evalMask(int node, const int *const *vals, int c0, int len,
+                               std::vector<std::vector<quint8>> &scratch, int depth,
+                               quint8 *out) const
+{
+    const Node &n = m_nodes[node];
+    if (n.kind == Node::Cmp) {
+        compareMask(vals[n.slot] + c0, len, n.op, n.value, out);
+        return;
+    }
+
+    evalMask(n.lhs, vals, c0, len, scratch, depth + 1, out);
+    if (n.kind == Node::Not) {
+        for (int i = 0; i < len; ++i)
+            out[i] ^= 1;
+        return;
+    }
+
+    if (static_cast<int>(scratch.size()) <= depth)
+        scratch.resize(depth + 1);
+    std::vector<quint8> &tmp = scratch[depth];
+    tmp.resize(len);
+    evalMask(n.rhs, vals, c0, len, scratch, depth + 1, tmp.data());
+
+    // Plain byte loops: the compiler vectorizes them
+    const quint8 *r = tmp.data();
+    if (n.kind == Node::And) {
+        for (int i = 0; i < len; ++i)
+            out[i] &= r[i];
+    } else {
+        for (int i = 0; i < len; ++i)
+            out[i] |= r[i];
+    }
+}
+
+void ConditionSearch::runSparse(int c0, int c1, const int *const *vals,
+                                const std::vector<std::shared_ptr<const TransitionIndex>> &idx,
+                                std::vector<ConditionHit> &out) const
+{
+    // pos[s]: next transition of slot s after the current run start
+    const int k = static_cast<int>(idx.size());
+    std::vector<const int *> pos(k), end(k);
+    for (int s = 0; s < k; ++s) {
+        const std::vector<int> &e = idx[s]->samples;
+        pos[s] = e.data() + (std::upper_bound(e.begin(), e.end(), c0) - e.begin());
+        end[s] = e.data() + e.size();
+    }
+
+    int t = c0;
+    while (t < c1) {
+        int next = c1;
+        for (int s = 0; s < k; ++s)
+            if (pos[s] != end[s] && *pos[s] < next)
+                next = *pos[s];
+
+        if (evalAt(m_root, vals, t))
+            appendHit(out, t, next);
+
+        for (int s = 0; s < k; ++s)
+            while (pos[s] != end[s] && *pos[s] <= next)
+                ++pos[s];
+        t = next;
+    }
+}
+
+void ConditionSearch::runDense(int c0, int c1, const int *const *vals,
+                               std::vector<ConditionHit> &out) const
+{
+    const int len = c1 - c0;
+    std::vector<quint8> mask(len);
+    std::vector<std::vector<quint8>> scratch;
+    evalMask(m_root, vals, c0, len, scratch, 0, mask.data());
+
+    int i = 0;
+    while (i < len) {
+        const int start = findByte(mask.data(), len, i, 1);
+        if (start >= len)
+            break;
+        i = findByte(mask.data(), len, start, 0);
+        appendHit(out, c0 + start, c0 + i);
+    }
+}
+
+ConditionResult ConditionSearch::run() const
+{
+    WP_TRACE_SCOPE("search", "ConditionSearch::run");
+    ConditionResult res;
+    const qint64 t0 = Tracer::nowNs();
+    if (m_root < 0 || m_slots.empty())
+        return res;
+
+    int n = m_sampleCount;
+    const int k = static_cast<int>(m_slots.size());
+    std::vector<const int *> vals(k);
+    std::vector<std::shared_ptr<const TransitionIndex>> idx(k);
+    for (int s = 0; s < k; ++s) {
+        n = std::min(n, m_slots[s].sampleCount());
+        vals[s] = m_slots[s].isPacked() ? m_unpacked[s].data() : m_slots[s].values.data();
+        idx[s] = transitionIndex(m_slots[s]);   // cached on the buffer after the first search
+    }
+    if (n <= 0)
+        return res;
+
+    const int parts = parallelWorkers() * 4;
+    const int chunkLen = std::max(kMinChunkSamples, (n + parts - 1) / parts);
+    const int chunks = (n + chunkLen - 1) / chunkLen;
+    std::vector<std::vector<ConditionHit>> perChunk(chunks);
+    std::vector<char> dense(chunks, 0);
+
+    parallelFor(chunks, [&](int c) {
+        const int c0 = c * chunkLen;
+        const int c1 = std::min(n, c0 + chunkLen);
+
+        // Runs in the chunk = 1 + changes of any operand (upper bound)
+        qint64 runs = 1;
+        for (int s = 0; s < k; ++s) {
+            const std::vector<int> &e = idx[s]->samples;
+            runs += std::lower_bound(e.begin(), e.end(), c1) - std::upper_bound(e.begin(), e.end(), c0);
+        }
+
+        if (runs * kDenseSamplesPerRun > c1 - c0) {
+            dense[c] = 1;
+            runDense(c0, c1, vals.data(), perChunk[c]);
+        } else {
+            runSparse(c0, c1, vals.data(), idx, perChunk[c]);
+        }
+    });
+
+    // Stitch: a hit ending at a chunk border continues in the next chunk
+    size_t total = 0;
+    for (const auto &hits : perChunk)
+        total += hits.size();
+    res.hits.reserve(total);
+    for (const auto &hits : perChunk)
+        for (const ConditionHit &h : hits)
+            appendHit(res.hits, h.start, h.end);
+
+    res.chunks = chunks;
+    for (char d : dense)
+        res.denseChunks += d;
+    res.elapsedNs = Tracer::nowNs() - t0;
+    return res;
+}
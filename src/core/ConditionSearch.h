@@ -0,0 +1,117 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ConditionSearch.h
+// Description:   Compiled value/condition search over the visible signals.
+//======================================================================
+
+#ifndef CONDITIONSEARCH_H
+#define CONDITIONSEARCH_H
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+#include "core/core.h"
+#include "core/Edges.h"
+
+enum class ConditionOp { Eq, Ne, Lt, Le, Gt, Ge };
+
+// Parses a value literal: decimal, 0x.., 0b.., Verilog [width]'h/'d/'b/'o
+// (width ignored), '_' separators, or X for UNDEFINED_VALUE
+bool parseValueLiteral(const QString &tok, int &value);
+
+// Half-open sample range [start, end) where a condition holds
+struct ConditionHit
+{
+    int start;
+    int end;
+};
+
+struct ConditionResult
+{
+    std::vector<ConditionHit> hits;
+    int    chunks = 0;
+    int    denseChunks = 0;     // chunks evaluated with the SIMD kernels
+    qint64 elapsedNs = 0;
+};
+
+// Finds where a boolean condition over the visible signals holds, e.g.
+//
+//     bus == 0xDEAD && valid == 1
+//     (state == 'h3 || state >= 5) && !rst
+//
+// Operators: == != < <= > >= && || ! and parentheses. A comparison is a
+// signal against a literal (decimal, 0x.., 0b.., Verilog 'h/'d/'b/'o, or X
+// for undefined); a bare signal means "> 0". Ordered comparisons are false
+// on undefined samples.
+//
+// run() splits the time axis into chunks evaluated in parallel. A sparse
+// chunk is walked run by run: the transition indices of the operands give
+// the samples where any of them changes, and the condition is evaluated
+// once per run. A dense chunk (many changes per sample) is evaluated with
+// SSE2 compare kernels into byte masks that are combined and scanned.
+class ConditionSearch
+{
+public:
+    // Resolves names against doc's visible signals (by exact name). The
+    // signals are copied (O(1), shared), so run() does not touch doc.
+    bool compile(const QString &expr, const WaveDocument &doc);
+    QString errorString() const { return m_error; }
+
+    // Thread-safe; may run on a worker thread
+    ConditionResult run() const;
+
+private:
+    struct Node
+    {
+        enum Kind { Cmp, And, Or, Not } kind;
+        int   slot = -1;     // Cmp: operand signal
+        ConditionOp op = ConditionOp::Eq;
+        int   value = 0;
+        int   lhs = -1;      // And/Or/Not children
+        int   rhs = -1;
+    };
+
+    std::vector<Node>   m_nodes;
+    int                 m_root = -1;
+    std::vector<Signal> m_slots;
+    QStringList         m_slotNames;
+    std::vector<std::vector<int>> m_unpacked;   // int copy of packed Bit slots (kernels read ints)
+    int                 m_sampleCount = 0;
+    QString             m_error;
+
+    // Parser
+    QStringList m_tokens;
+    int         m_pos = 0;
+    int  parseOr(const WaveDocument &doc);
+    int  parseAnd(const WaveDocument &doc);
+    int  parseUnary(const WaveDocument &doc);
+    int  parseComparison(const WaveDocument &doc);
+    int  signalSlot(const QString &name, const WaveDocument &doc);
+    int  addNode(const Node &n);
+    bool fail(const QString &msg);
+
+    bool evalAt(int node, const int *const *vals, int t) const;
+    void evalMask(int node, const int *const *vals, int c0, int len,
+                  std::vector<std::vector<quint8>> &scratch, int depth,
+                  quint8 *out) const;
+    void runSparse(int c0, int c1, const int *const *vals,
+                   const std::vector<std::shared_ptr<const TransitionIndex>> &idx,
+                   std::vector<ConditionHit> &out) const;
+    void runDense(int c0, int c1, const int *const *vals,
+                  std::vector<ConditionHit> &out) const;
+};
+
+#endif // CONDITIONSEARCH_H
@@ -0,0 +1,210 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          CowVector.h
+// Description:   Copy-on-write (implicitly shared) vector used for signal payloads.
+//======================================================================
+
+#ifndef COWVECTOR_H
+#define COWVECTOR_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <QtGlobal>
+
+// Bytes of shared, unfrozen buffers that an owner stopped referencing (a
+// detach or a replacement), per thread. The document charges them to its
+// newest undo step between two snapshots (WaveDocument::onDocumentMutated).
+struct CowStats
+{
+    static qint64 &releasedBytes()
+    {
+        thread_local qint64 bytes = 0;
+        return bytes;
+    }
+};
+
+// std::vector with implicit sharing (copy-on-write), in the spirit of Qt's
+// containers. Copying a CowVector is O(1); the buffer is deep-copied the
+// first time a shared copy is modified.
+//
+// Const access never detaches. Non-const access (operator[], begin/end,
+// resize, mut()) detaches first, so on a non-const object that is only
+// read, bind a const reference (std::as_const) to avoid a needless copy.
+//
+// derived() caches data computed from the buffer (e.g. a transition index)
+// next to it: every owner of the buffer shares it, and mut() drops it. A
+// reference returned by mut() must not be written after derived() has been
+// called again on the same object.
+template <typename T>
+class CowVector
+{
+public:
+    using value_type     = T;
+    using const_iterator = typename std::vector<T>::const_iterator;
+    using iterator       = typename std::vector<T>::iterator;
+
+    CowVector() : d(std::make_shared<Block>()) {}
+    explicit CowVector(std::size_t n, const T &v = T())
+        : d(std::make_shared<Block>(std::vector<T>(n, v))) {}
+    CowVector(std::vector<T> &&v)
+        : d(std::make_shared<Block>(std::move(v))) {}
+
+    CowVector &operator=(std::vector<T> &&v)
+    {
+        release();
+        d = std::make_shared<Block>(std::move(v));
+        return *this;
+    }
+
+    // A moved-from CowVector is empty and usable: it shares one frozen empty
+    // block, so the move stays noexcept (no allocation) and its first write
+    // detaches as usual
+    CowVector(const CowVector &) = default;
+    CowVector(CowVector &&other) noexcept
+        : d(std::exchange(other.d, emptyBlock())) {}
+    CowVector &operator=(const CowVector &other)
+    {
+        if (d != other.d) {
+            release();
+            d = other.d;
+        }
+        return *this;
+    }
+    CowVector &operator=(CowVector &&other) noexcept
+    {
+        if (this != &other) {
+            if (d != other.d)
+                release();
+            d = std::exchange(other.d, emptyBlock());
+        }
+        return *this;
+    }
+
+    // --- read-only ---
+    std::size_t size() const     { return d->data.size(); }
+    bool        empty() const    { return d->data.empty(); }
+    std::size_t capacity() const { return d->data.capacity(); }
+    const T &operator[](std::size_t i) const { return d->data[i]; }
+    const T *data() const        { return d->data.data(); }
+    const_iterator begin() const { return d->data.cbegin(); }
+    const_iterator end() const   { return d->data.cend(); }
+    const std::vector<T> &vec() const { return d->data; }
+
+    // Sharing information (memory accounting)
+    const void *bufferId() const { return d.get(); }
+    qint64      bufferBytes() const { return static_cast<qint64>(d->data.capacity()) * sizeof(T); }
+
+    // A frozen buffer belongs to an immutable store (the VCD library): it is
+    // never modified in place, even when this is the last reference.
+    void freeze()
+    {
+        if (!d->frozen)   // the shared empty block is already frozen
+            d->frozen = true;
+    }
+    bool isFrozen() const        { return d->frozen; }
+
+    // Returns the cached D for this buffer, calling build(vec()) on a miss.
+    // Safe to call from several threads (two racing builders both compute,
+    // one result is kept).
+    template <typename D, typename Build>
+    std::shared_ptr<const D> derived(Build build) const
+    {
+        const void *tag = derivedTag<D>();
+        std::shared_ptr<const Derived> cur = std::atomic_load(&d->derived);
+        if (cur && cur->tag == tag)
+            return std::static_pointer_cast<const D>(cur->value);
+
+        std::shared_ptr<const D> value = build(d->data);
+        auto slot = std::make_shared<const Derived>(Derived{tag, value});
+        std::atomic_store(&d->derived, std::shared_ptr<const Derived>(slot));
+        return value;
+    }
+
+    // --- modifying (detach) ---
+    std::vector<T> &mut()
+    {
+        if (d.use_count() > 1 || d->frozen) {
+            release();
+            d = std::make_shared<Block>(std::vector<T>(d->data));
+        }
+        else if (std::atomic_load(&d->derived))
+            std::atomic_store(&d->derived, std::shared_ptr<const Derived>());
+        return d->data;
+    }
+    T &operator[](std::size_t i) { return mut()[i]; }
+    iterator begin()             { return mut().begin(); }
+    iterator end()               { return mut().end(); }
+
+    void resize(std::size_t n, const T &v = T())
+    {
+        if (n == d->data.size())
+            return;
+        mut().resize(n, v);
+    }
+
+    // Replaces the content without copying the old buffer first
+    void assign(std::size_t n, const T &v)
+    {
+        release();
+        d = std::make_shared<Block>(std::vector<T>(n, v));
+    }
+
+private:
+    // Called before this owner lets go of its buffer
+    void release() noexcept
+    {
+        if (d.use_count() > 1 && !d->frozen)
+            CowStats::releasedBytes() += bufferBytes();
+    }
+
+    struct Derived
+    {
+        const void *tag;                  // derivedTag<D>() of the cached type
+        std::shared_ptr<const void> value;
+    };
+
+    struct Block
+    {
+        Block() = default;
+        explicit Block(std::vector<T> &&v) : data(std::move(v)) {}
+
+        std::vector<T> data;
+        bool frozen = false;
+        std::shared_ptr<const Derived> derived;   // atomic_load/atomic_store only
+    };
+
+    static const std::shared_ptr<Block> &emptyBlock() noexcept
+    {
+        static const std::shared_ptr<Block> empty = [] {
+            auto block = std::make_shared<Block>();
+            block->frozen = true;
+            return block;
+        }();
+        return empty;
+    }
+
+    template <typename D>
+    static const void *derivedTag()
+    {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    std::shared_ptr<Block> d;
+};
+
+#endif // COWVECTOR_H
@@ -43,9 +43,12 @@
 //======================================================================
 
 #include "core/core.h" 
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
 
 void WaveDocument::cutRange(int startSample, int endSample)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::cutRange", &m_lastMutationNs);
     pushUndoSnapshot();
     if (m_sampleCount <= 0)
         return;
@@ -69,31 +72,46 @@ void WaveDocument::cutRange(int startSample, int endSample)
 
     // --- 1) Recortar TODAS las señales al rango [first, last] y renumerar ---
     for (Signal &s : m_signals) {
-        // Valores
-        if (static_cast<int>(s.values.size()) < m_sampleCount) {
-            s.values.resize(m_sampleCount, -1);   // -1 = indefinido
+        ClockShape clock;
+        if (s.expr && s.expr->clockShape(&clock)) {
+            // Reloj procedural: basta con desplazar la fase
+            s.expr = SignalExpr::clockExpr(clock.sliced(first, newCount));
+            continue;
+        }
+        if (s.isDerived())
+            continue;   // sin muestras propias: sigue a sus operandos
+
+        if (s.isPacked()) {
+            // Bits empaquetados: copia desplazada de 64 en 64 muestras
+            s.bits = s.bits.slice(first, newCount);
+            continue;
         }
 
-        std::vector<int> newVals(newCount, -1);
+        // Valores
+        // (lectura por referencia const: no hace falta desacoplar el buffer
+        //  compartido, se sustituye entero)
+        const CowVector<int> &oldVals = s.values;
+        std::vector<int> newVals(newCount, -1);   // -1 = indefinido
         for (int i = 0; i < newCount; ++i) {
             int src = first + i;
-            if (src >= 0 && src < static_cast<int>(s.values.size()))
-                newVals[i] = s.values[src];
+            if (src >= 0 && src < static_cast<int>(oldVals.size()))
+                newVals[i] = oldVals[src];
         }
-        s.values.swap(newVals);
+        s.values = std::move(newVals);
 
         // Labels
-        if (static_cast<int>(s.labels.size()) < m_sampleCount) {
-            s.labels.resize(m_sampleCount);
-        }
-
+        const CowVector<QString> &oldLabs = s.labels;
         std::vector<QString> newLabs(newCount);
         for (int i = 0; i < newCount; ++i) {
             int src = first + i;
-            if (src >= 0 && src < static_cast<int>(s.labels.size()))
-                newLabs[i] = s.labels[src];
+            if (src >= 0 && src < static_cast<int>(oldLabs.size()))
+                newLabs[i] = oldLabs[src];
         }
-        s.labels.swap(newLabs);
+        s.labels = std::move(newLabs);
+
+        // Inicios de anotación (sólo filas de anotación)
+        if (!s.starts.empty())
+            s.starts = s.starts.slice(first, newCount);
     }
 
     // --- 2) Ajustar MARCADORES ---
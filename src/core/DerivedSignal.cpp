@@ -0,0 +1,741 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          DerivedSignal.cpp
+// Description:   Expression-defined signals evaluated lazily over run lists.
+//======================================================================
+
+#include "core/DerivedSignal.h"
+#include "core/ConditionSearch.h"
+#include "core/Edges.h"
+#include "utils/Trace.h"
+
+#include <QHash>
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+enum UnaryOp { BitNot, LogNot };
+enum BinaryOp { LOr, LAnd, BOr, BXor, BAnd, Eq, Ne, Lt, Le, Gt, Ge };
+
+inline void pushRun(std::vector<ValueRun> &out, int start, int value)
+{
+    if (out.empty() || out.back().value != value)
+        out.push_back({start, value});
+}
+
+int applyBinary(int op, int a, int b)
+{
+    if (a < 0 || b < 0)
+        return UNDEFINED_VALUE;
+    switch (op) {
+    case LOr:  return (a > 0 || b > 0) ? 1 : 0;
+    case LAnd: return (a > 0 && b > 0) ? 1 : 0;
+    case BOr:  return a | b;
+    case BXor: return a ^ b;
+    case BAnd: return a & b;
+    case Eq:   return a == b ? 1 : 0;
+    case Ne:   return a != b ? 1 : 0;
+    case Lt:   return a < b ? 1 : 0;
+    case Le:   return a <= b ? 1 : 0;
+    case Gt:   return a > b ? 1 : 0;
+    case Ge:   return a >= b ? 1 : 0;
+    }
+    return UNDEFINED_VALUE;
+}
+
+struct Token
+{
+    enum Type { Ident, Number, Op, End } type;
+    QString text;
+};
+
+bool isIdentStart(QChar c)
+{
+    return c.isLetter() || c == '_' || c == '$' || c == '\\' || c == '.';
+}
+
+bool isIdentChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_' || c == '$' || c == '\\' || c == '.';
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+class SignalExprParser
+{
+public:
+    SignalExprParser(SignalExpr &e, const SignalExpr::Resolver &resolve)
+        : m_expr(e), m_resolve(resolve) {}
+
+    bool parse(const QString &text, QString *error)
+    {
+        if (!tokenize(text))
+            return report(error);
+        m_pos = 0;
+        m_expr.m_root = parseBinary(0);
+        if (m_expr.m_root >= 0 && peek().type != Token::End)
+            fail(QObject::tr("Unexpected '%1'").arg(peek().text));
+        return m_error.isEmpty() ? true : report(error);
+    }
+
+private:
+    SignalExpr &m_expr;
+    const SignalExpr::Resolver &m_resolve;
+    std::vector<Token> m_tokens;
+    int m_pos = 0;
+    QString m_error;
+
+    bool report(QString *error)
+    {
+        if (error)
+            *error = m_error;
+        return false;
+    }
+
+    int fail(const QString &msg)
+    {
+        if (m_error.isEmpty())
+            m_error = msg;
+        return -1;
+    }
+
+    const Token &peek() const { return m_tokens[m_pos]; }
+    bool acceptOp(const char *op)
+    {
+        if (peek().type == Token::Op && peek().text == QLatin1String(op)) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    int add(const SignalExpr::Node &n)
+    {
+        m_expr.m_nodes.push_back(n);
+        return static_cast<int>(m_expr.m_nodes.size()) - 1;
+    }
+
+    bool tokenize(const QString &s)
+    {
+        static const char *const twoChar[] = {"||", "&&", "==", "!=", "<=", ">="};
+        const QString single = QStringLiteral("|^&<>~!()[],:");
+        int i = 0;
+        const int n = s.size();
+        while (i < n) {
+            const QChar c = s[i];
+            if (c.isSpace()) {
+                ++i;
+                continue;
+            }
+            bool two = false;
+            for (const char *op : twoChar) {
+                if (s.mid(i, 2) == QLatin1String(op)) {
+                    m_tokens.push_back({Token::Op, QString::fromLatin1(op)});
+                    i += 2;
+                    two = true;
+                    break;
+                }
+            }
+            if (two)
+                continue;
+            if (c.isDigit() || c == '\'') {
+                int j = i;
+                while (j < n && (s[j].isLetterOrNumber() || s[j] == '_' || s[j] == '\''))
+                    ++j;
+                m_tokens.push_back({Token::Number, s.mid(i, j - i)});
+                i = j;
+                continue;
+            }
+            if (isIdentStart(c)) {
+                // Bracket groups glued to a name stay in the token: "data[7:0]"
+                // may be a signal name or a slice, decided in primary()
+                int j = i;
+                while (j < n) {
+                    if (isIdentChar(s[j])) {
+                        ++j;
+                    } else if (s[j] == '[') {
+                        const int close = s.indexOf(']', j);
+                        if (close < 0)
+                            break;
+                        j = close + 1;
+                    } else {
+                        break;
+                    }
+                }
+                m_tokens.push_back({Token::Ident, s.mid(i, j - i)});
+                i = j;
+                continue;
+            }
+            if (single.contains(c)) {
+                m_tokens.push_back({Token::Op, QString(c)});
+                ++i;
+                continue;
+            }
+            m_error = QObject::tr("Unexpected character '%1'").arg(c);
+            return false;
+        }
+        m_tokens.push_back({Token::End, QString()});
+        return true;
+    }
+
+    // Precedence climbing over the binary operators, loosest first
+    int parseBinary(int level)
+    {
+        static const struct { const char *ops[6]; int codes[6]; int count; } levels[] = {
+            {{"||"}, {LOr}, 1},
+            {{"&&"}, {LAnd}, 1},
+            {{"|"}, {BOr}, 1},
+            {{"^"}, {BXor}, 1},
+            {{"&"}, {BAnd}, 1},
+            {{"==", "!=", "<", "<=", ">", ">="}, {Eq, Ne, Lt, Le, Gt, Ge}, 6},
+        };
+        constexpr int kLevels = sizeof(levels) / sizeof(levels[0]);
+        if (level == kLevels)
+            return parseUnary();
+
+        int lhs = parseBinary(level + 1);
+        while (lhs >= 0) {
+            int code = -1;
+            for (int k = 0; k < levels[level].count && code < 0; ++k)
+                if (acceptOp(levels[level].ops[k]))
+                    code = levels[level].codes[k];
+            if (code < 0)
+                break;
+            const int rhs = parseBinary(level + 1);
+            if (rhs < 0)
+                return -1;
+            SignalExpr::Node n;
+            n.kind = SignalExpr::Node::Binary;
+            n.value = code;
+            n.lhs = lhs;
+            n.rhs = rhs;
+            lhs = add(n);
+            if (level == kLevels - 1)
+                break;   // comparisons do not chain
+        }
+        return lhs;
+    }
+
+    int parseUnary()
+    {
+        int op = -1;
+        if (acceptOp("~"))
+            op = BitNot;
+        else if (acceptOp("!"))
+            op = LogNot;
+        if (op < 0)
+            return parsePostfix();
+
+        const int inner = parseUnary();
+        if (inner < 0)
+            return -1;
+        SignalExpr::Node n;
+        n.kind = SignalExpr::Node::Unary;
+        n.value = op;
+        n.lhs = inner;
+        return add(n);
+    }
+
+    int parsePostfix()
+    {
+        int node = parsePrimary();
+        while (node >= 0 && acceptOp("[")) {
+            QString range;
+            while (peek().type != Token::End && !(peek().type == Token::Op && peek().text == "]"))
+                range += m_tokens[m_pos++].text;
+            if (!acceptOp("]"))
+                return fail(QObject::tr("Missing ']'"));
+            node = addSlice(node, range);
+        }
+        return node;
+    }
+
+    int addSlice(int child, const QString &range)
+    {
+        const QStringList parts = range.split(':');
+        bool ok1 = false, ok2 = true;
+        int msb = parts.value(0).trimmed().toInt(&ok1);
+        int lsb = parts.size() > 1 ? parts.value(1).trimmed().toInt(&ok2) : msb;
+        if (!ok1 || !ok2 || parts.size() > 2 || msb < 0 || lsb < 0 || msb > 30 || lsb > 30)
+            return fail(QObject::tr("Invalid slice [%1] (bits 0..30)").arg(range));
+        if (msb < lsb)
+            std::swap(msb, lsb);
+        SignalExpr::Node n;
+        n.kind = SignalExpr::Node::Slice;
+        n.msb = msb;
+        n.lsb = lsb;
+        n.lhs = child;
+        return add(n);
+    }
+
+    int parsePrimary()
+    {
+        const Token tok = peek();
+        if (tok.type == Token::End)
+            return fail(QObject::tr("Unexpected end of expression"));
+
+        if (tok.type == Token::Number) {
+            ++m_pos;
+            SignalExpr::Node n;
+            n.kind = SignalExpr::Node::Const;
+            if (!parseValueLiteral(tok.text, n.value))
+                return fail(QObject::tr("Invalid number '%1'").arg(tok.text));
+            return add(n);
+        }
+
+        if (tok.type == Token::Op) {
+            if (!acceptOp("("))
+                return fail(QObject::tr("Unexpected '%1'").arg(tok.text));
+            const int inner = parseBinary(0);
+            if (inner >= 0 && !acceptOp(")"))
+                return fail(QObject::tr("Missing ')'"));
+            return inner;
+        }
+
+        ++m_pos;
+        if (tok.text == "delayed" && acceptOp("("))
+            return parseDelayed();
+        if (tok.text == "clock" && acceptOp("("))
+            return parseClock();
+
+        // Longest prefix that names a signal; the rest are slices
+        QString name = tok.text;
+        QStringList slices;
+        while (!m_resolve(name) && name.endsWith(']')) {
+            const int open = name.lastIndexOf('[');
+            if (open <= 0)
+                break;
+            slices.prepend(name.mid(open + 1, name.size() - open - 2));
+            name.truncate(open);
+        }
+        if (!m_resolve(name))
+            return fail(QObject::tr("Unknown signal '%1'").arg(tok.text));
+
+        SignalExpr::Node n;
+        n.kind = SignalExpr::Node::Sig;
+        n.name = name;
+        int node = add(n);
+        for (const QString &r : slices) {
+            node = addSlice(node, r);
+            if (node < 0)
+                return -1;
+        }
+        return node;
+    }
+
+    int parseDelayed()
+    {
+        const int inner = parseBinary(0);
+        if (inner < 0)
+            return -1;
+        if (!acceptOp(","))
+            return fail(QObject::tr("delayed(expr, samples): missing ','"));
+        int amount = 0;
+        if (peek().type != Token::Number || !parseValueLiteral(peek().text, amount) || amount < 0)
+            return fail(QObject::tr("delayed(expr, samples): samples must be a number >= 0"));
+        ++m_pos;
+        if (!acceptOp(")"))
+            return fail(QObject::tr("Missing ')'"));
+
+        SignalExpr::Node n;
+        n.kind = SignalExpr::Node::Delay;
+        n.value = amount;
+        n.lhs = inner;
+        return add(n);
+    }
+
+    int parseClock()
+    {
+        // clock(period, phase, high[, begin, end]); without a range it never ends
+        int args[5] = {0, 0, 0, 0, INT_MAX};
+        int count = 0;
+        do {
+            if (count == 5 || peek().type != Token::Number || !parseValueLiteral(peek().text, args[count]))
+                return fail(QObject::tr("clock(period, phase, high[, begin, end]): numbers expected"));
+            ++m_pos;
+            ++count;
+        } while (acceptOp(","));
+        if (!acceptOp(")"))
+            return fail(QObject::tr("Missing ')'"));
+
+        SignalExpr::Node n;
+        n.kind = SignalExpr::Node::Clock;
+        n.clock = ClockShape{args[0], args[1], args[2], args[3], args[4]};
+        if ((count != 3 && count != 5) || !n.clock.isValid())
+            return fail(QObject::tr("clock(period, phase, high[, begin, end]): needs 0 < high < period"));
+        return add(n);
+    }
+};
+
+std::shared_ptr<const SignalExpr> SignalExpr::compile(const QString &text, const Resolver &resolve,
+                                                      QString *error)
+{
+    auto expr = std::make_shared<SignalExpr>();
+    expr->m_text = text.trimmed();
+    SignalExprParser parser(*expr, resolve);
+    if (!parser.parse(expr->m_text, error))
+        return nullptr;
+    return expr;
+}
+
+std::shared_ptr<const SignalExpr> SignalExpr::clockExpr(const ClockShape &shape)
+{
+    const QString text = QString("clock(%1, %2, %3, %4, %5)")
+                             .arg(shape.period).arg(shape.phase).arg(shape.high)
+                             .arg(shape.begin).arg(shape.end);
+    return compile(text, [](const QString &) -> const Signal * { return nullptr; }, nullptr);
+}
+
+bool SignalExpr::clockShape(ClockShape *shape) const
+{
+    if (m_root < 0 || m_nodes[m_root].kind != Node::Clock)
+        return false;
+    if (shape)
+        *shape = m_nodes[m_root].clock;
+    return true;
+}
+
+QStringList SignalExpr::operandNames() const
+{
+    QStringList names;
+    for (const Node &n : m_nodes)
+        if (n.kind == Node::Sig && !names.contains(n.name))
+            names << n.name;
+    return names;
+}
+
+bool SignalExpr::refersTo(const Signal *sig, const Resolver &resolve) const
+{
+    // Depth-first over the operand names; each derived signal is expanded once
+    std::unordered_set<const SignalExpr *> visited{this};
+    std::vector<const SignalExpr *> pending{this};
+    while (!pending.empty()) {
+        const SignalExpr *e = pending.back();
+        pending.pop_back();
+        for (const QString &op : e->operandNames()) {
+            const Signal *s = resolve ? resolve(op) : nullptr;
+            if (s == sig)
+                return true;
+            if (s && s->expr && visited.insert(s->expr.get()).second)
+                pending.push_back(s->expr.get());
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation
+// ---------------------------------------------------------------------------
+
+// An operand referenced several times (directly or through other derived
+// signals) is expanded once per window; a derived signal met again while it
+// is being expanded is a reference cycle and evaluates as undefined.
+struct SignalExpr::EvalContext
+{
+    const Resolver &resolve;
+    std::map<std::tuple<const Signal *, int, int>, std::vector<ValueRun>> runs;
+    std::unordered_map<const Signal *, bool> bits;
+    std::unordered_set<const Signal *> active;
+};
+
+namespace {
+
+std::vector<ValueRun> storedRuns(const Signal &sig, int t0, int t1)
+{
+    std::vector<ValueRun> out;
+    const int n = sig.sampleCount();
+    int t = t0;
+    if (t < 0) {
+        pushRun(out, t, UNDEFINED_VALUE);
+        t = 0;
+    }
+    if (t < std::min(t1, n)) {
+        pushRun(out, t, sig.valueAt(t));
+        const auto idx = transitionIndex(sig);
+        const std::vector<int> &e = idx->samples;
+        const int stop = std::min(t1, n);
+        for (auto it = std::upper_bound(e.begin(), e.end(), t); it != e.end() && *it < stop; ++it)
+            pushRun(out, *it, sig.valueAt(*it));
+    }
+    if (n < t1)
+        pushRun(out, std::max(t, n), UNDEFINED_VALUE);
+    return out;
+}
+
+} // namespace
+
+std::vector<ValueRun> SignalExpr::runsOf(const Signal &sig, int t0, int t1, EvalContext &ctx)
+{
+    if (!sig.expr)
+        return storedRuns(sig, t0, t1);
+    const auto key = std::make_tuple(&sig, t0, t1);
+    const auto hit = ctx.runs.find(key);
+    if (hit != ctx.runs.end())
+        return hit->second;
+    if (!ctx.active.insert(&sig).second)
+        return {{t0, UNDEFINED_VALUE}};
+    std::vector<ValueRun> out = sig.expr->eval(sig.expr->m_root, t0, t1, ctx);
+    ctx.active.erase(&sig);
+    ctx.runs.emplace(key, out);
+    return out;
+}
+
+bool SignalExpr::isBit(const Signal &sig, EvalContext &ctx)
+{
+    if (!sig.expr)
+        return sig.type == SignalType::Bit;
+    const auto hit = ctx.bits.find(&sig);
+    if (hit != ctx.bits.end())
+        return hit->second;
+    if (!ctx.active.insert(&sig).second)
+        return false;
+    const bool bit = sig.expr->nodeIsBit(sig.expr->m_root, ctx);
+    ctx.active.erase(&sig);
+    ctx.bits.emplace(&sig, bit);
+    return bit;
+}
+
+std::vector<ValueRun> signalRuns(const Signal &sig, int t0, int t1, const SignalExpr::Resolver &resolve)
+{
+    if (t1 <= t0)
+        return {};
+    SignalExpr::EvalContext ctx{resolve, {}, {}, {}};
+    return SignalExpr::runsOf(sig, t0, t1, ctx);
+}
+
+std::vector<ValueRun> SignalExpr::evaluate(int t0, int t1, const Resolver &resolve) const
+{
+    WP_TRACE_SCOPE("core", "SignalExpr::evaluate");
+    if (m_root < 0 || t1 <= t0)
+        return {};
+    EvalContext ctx{resolve, {}, {}, {}};
+    return eval(m_root, t0, t1, ctx);
+}
+
+std::vector<ValueRun> SignalExpr::eval(int node, int t0, int t1, EvalContext &ctx) const
+{
+    const Node &n = m_nodes[node];
+    std::vector<ValueRun> out;
+
+    switch (n.kind) {
+    case Node::Const:
+        out.push_back({t0, n.value});
+        return out;
+
+    case Node::Sig: {
+        const Signal *s = ctx.resolve ? ctx.resolve(n.name) : nullptr;
+        if (!s)
+            return {{t0, UNDEFINED_VALUE}};
+        return runsOf(*s, t0, t1, ctx);
+    }
+
+    case Node::Clock: {
+        // Runs straight from the edge arithmetic, O(edges in the window)
+        const ClockShape &c = n.clock;
+        pushRun(out, t0, c.valueAt(t0));
+        if (t0 < c.begin && c.begin < t1)
+            pushRun(out, c.begin, c.valueAt(c.begin));
+        for (int t = c.nextEdge(std::max(t0, c.begin), EdgeKind::Any); t >= 0 && t < t1; t = c.nextEdge(t, EdgeKind::Any))
+            pushRun(out, t, c.valueAt(t));
+        if (c.end > t0 && c.end < t1)
+            pushRun(out, c.end, UNDEFINED_VALUE);
+        return out;
+    }
+
+    case Node::Delay: {
+        out = eval(n.lhs, t0 - n.value, t1 - n.value, ctx);
+        for (ValueRun &r : out)
+            r.start += n.value;
+        return out;
+    }
+
+    case Node::Unary:
+    case Node::Slice: {
+        const std::vector<ValueRun> in = eval(n.lhs, t0, t1, ctx);
+        const bool bit = (n.kind == Node::Unary && n.value == BitNot) && nodeIsBit(n.lhs, ctx);
+        const int width = n.msb - n.lsb + 1;
+        const int mask = width >= 31 ? INT_MAX : ((1 << width) - 1);
+        out.reserve(in.size());
+        for (const ValueRun &r : in) {
+            int v = r.value;
+            if (v >= 0) {
+                if (n.kind == Node::Slice)
+                    v = (v >> n.lsb) & mask;
+                else if (n.value == LogNot)
+                    v = (v == 0) ? 1 : 0;
+                else
+                    v = bit ? (v ^ 1) : (v ^ INT_MAX);
+            }
+            pushRun(out, r.start, v);
+        }
+        return out;
+    }
+
+    case Node::Binary: {
+        // Merge walk: a new run starts wherever either operand changes
+        const std::vector<ValueRun> a = eval(n.lhs, t0, t1, ctx);
+        const std::vector<ValueRun> b = eval(n.rhs, t0, t1, ctx);
+        out.reserve(std::max(a.size(), b.size()));
+        size_t i = 0, j = 0;
+        int t = t0;
+        while (true) {
+            pushRun(out, t, applyBinary(n.value, a[i].value, b[j].value));
+            const int na = (i + 1 < a.size()) ? a[i + 1].start : t1;
+            const int nb = (j + 1 < b.size()) ? b[j + 1].start : t1;
+            const int next = std::min(na, nb);
+            if (next >= t1)
+                break;
+            if (na == next)
+                ++i;
+            if (nb == next)
+                ++j;
+            t = next;
+        }
+        return out;
+    }
+    }
+    return out;
+}
+
+bool SignalExpr::nodeIsBit(int node, EvalContext &ctx) const
+{
+    const Node &n = m_nodes[node];
+    switch (n.kind) {
+    case Node::Const:
+        return n.value == 0 || n.value == 1;
+    case Node::Sig: {
+        const Signal *s = ctx.resolve ? ctx.resolve(n.name) : nullptr;
+        return s && isBit(*s, ctx);
+    }
+    case Node::Unary:
+        return n.value == LogNot || nodeIsBit(n.lhs, ctx);
+    case Node::Slice:
+        return n.msb == n.lsb;
+    case Node::Delay:
+        return nodeIsBit(n.lhs, ctx);
+    case Node::Clock:
+        return true;
+    case Node::Binary:
+        if (n.value == BOr || n.value == BXor || n.value == BAnd)
+            return nodeIsBit(n.lhs, ctx) && nodeIsBit(n.rhs, ctx);
+        return true;
+    }
+    return false;
+}
+
+SignalType SignalExpr::resultType(const Resolver &resolve) const
+{
+    if (m_root < 0)
+        return SignalType::Vector;
+    EvalContext ctx{resolve, {}, {}, {}};
+    return nodeIsBit(m_root, ctx) ? SignalType::Bit : SignalType::Vector;
+}
+
+std::vector<int> SignalExpr::sampleValues(const Signal &sig, int t0, int t1, const Resolver &resolve)
+{
+    std::vector<int> vals;
+    if (t1 <= t0)
+        return vals;
+    vals.reserve(t1 - t0);
+    const std::vector<ValueRun> runs = signalRuns(sig, t0, t1, resolve);
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const int end = (r + 1 < runs.size()) ? runs[r + 1].start : t1;
+        vals.insert(vals.end(), end - runs[r].start, runs[r].value);
+    }
+    return vals;
+}
+
+SignalExpr::Resolver resolverFor(const std::vector<Signal> &sigs)
+{
+    // Name -> row, snapshot of the current list; the first row wins on duplicates
+    auto rows = std::make_shared<QHash<QString, int>>();
+    rows->reserve(static_cast<int>(sigs.size()));
+    for (int i = static_cast<int>(sigs.size()) - 1; i >= 0; --i)
+        rows->insert(sigs[i].name, i);
+
+    const std::vector<Signal> *list = &sigs;
+    return [rows, list](const QString &name) -> const Signal * {
+        const int i = rows->value(name, -1);
+        return (i >= 0 && i < static_cast<int>(list->size())) ? &(*list)[i] : nullptr;
+    };
+}
+
+// ---------------------------------------------------------------------------
+// WaveDocument
+// ---------------------------------------------------------------------------
+
+SignalExpr::Resolver WaveDocument::signalResolver() const
+{
+    return resolverFor(m_signals);
+}
+
+void WaveDocument::materializeClock(Signal &sig) const
+{
+    materializeClock(sig, m_sampleCount);
+}
+
+void WaveDocument::materializeClock(Signal &sig, int sampleCount)
+{
+    ClockShape clock;
+    if (!sig.expr || !sig.expr->clockShape(&clock))
+        return;
+    BitPlane bits(sampleCount);
+    const std::vector<ValueRun> runs = signalRuns(sig, 0, sampleCount, SignalExpr::Resolver());
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const int end = (r + 1 < runs.size()) ? runs[r + 1].start : sampleCount;
+        bits.fill(runs[r].start, end, runs[r].value);
+    }
+    sig.bits = std::move(bits);
+    sig.expr.reset();
+}
+
+bool WaveDocument::closesReferenceCycle(int signalIndex, const QString &name) const
+{
+    // Expressions can only name signals that exist, so a cycle can only
+    // appear when a rename redirects an operand; check the renamed list
+    std::vector<Signal> renamed = m_signals;
+    renamed[signalIndex].name = name;
+    const SignalExpr::Resolver resolve = resolverFor(renamed);
+    for (const Signal &s : renamed)
+        if (s.expr && s.expr->refersTo(&s, resolve))
+            return true;
+    return false;
+}
+
+int WaveDocument::addDerivedSignal(const QString &name, const QString &expression, QString *error)
+{
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addDerivedSignal", &m_lastMutationNs);
+    const SignalExpr::Resolver resolve = signalResolver();
+    std::shared_ptr<const SignalExpr> expr = SignalExpr::compile(expression, resolve, error);
+    if (!expr)
+        return -1;
+
+    pushUndoSnapshot();
+    Signal s(name.isEmpty() ? expr->text() : name, expr->resultType(resolve), 0);
+    s.color = QColor(150, 60, 170);
+    s.expr = std::move(expr);
+    m_signals.push_back(s);
+    emit dataChanged();
+    return static_cast<int>(m_signals.size()) - 1;
+}
@@ -0,0 +1,122 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          DerivedSignal.h
+// Description:   Expression-defined signals evaluated lazily over run lists.
+//======================================================================
+
+#ifndef DERIVEDSIGNAL_H
+#define DERIVEDSIGNAL_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "core/core.h"
+#include "core/Clock.h"
+
+// A value that holds from `start` up to the start of the next run
+struct ValueRun
+{
+    int start;
+    int value;
+};
+
+// Expression behind a derived (virtual) signal, e.g.
+//
+//     a & b      ~rst_n      bus[7:4]      bus == 3      a ^ delayed(a, 1)
+//
+// Operators, by increasing precedence: ||  &&  |  ^  &  == != < <= > >=
+// and the unary ~ ! plus [msb:lsb] / [bit] slices and delayed(expr, n);
+// clock(period, phase, high[, begin, end]) is a procedural clock.
+// Literals as in ConditionSearch (42, 0x2A, 0b1, 8'h2A). Undefined operands
+// give an undefined result. ~ inverts a Bit; on a Vector it inverts the 31
+// value bits (widths are not stored).
+//
+// Nothing is stored per sample: evaluate() merges the run lists of the
+// operands (from their transition indices) over the requested window, so
+// the cost is proportional to the number of changes in it.
+class SignalExpr
+{
+public:
+    // Resolves an operand name to a signal of the document (nullptr = unknown)
+    using Resolver = std::function<const Signal *(const QString &name)>;
+
+    // Parses text. Names are resolved now only to tell a slice ("bus[3]")
+    // from a signal whose name contains brackets; evaluation resolves again.
+    static std::shared_ptr<const SignalExpr> compile(const QString &text, const Resolver &resolve,
+                                                     QString *error);
+
+    QString text() const { return m_text; }
+    QStringList operandNames() const;
+
+    // True when `sig` is an operand, directly or through derived operands
+    bool refersTo(const Signal *sig, const Resolver &resolve) const;
+
+    // Bit when the result can only be 0/1 (comparisons, logic, Bit operands)
+    SignalType resultType(const Resolver &resolve) const;
+
+    // Runs covering [t0, t1): the first starts at t0, starts ascend and two
+    // neighbours never hold the same value
+    std::vector<ValueRun> evaluate(int t0, int t1, const Resolver &resolve) const;
+
+    // clock(period, phase, high, begin, end): a procedural clock (Clock.h).
+    // clockShape() tells whether the whole expression is one.
+    static std::shared_ptr<const SignalExpr> clockExpr(const ClockShape &shape);
+    bool clockShape(ClockShape *shape) const;
+
+    // Expands [t0, t1) of a signal (derived or not) into one value per sample
+    static std::vector<int> sampleValues(const Signal &sig, int t0, int t1, const Resolver &resolve);
+
+private:
+    struct Node
+    {
+        enum Kind { Sig, Const, Unary, Binary, Slice, Delay, Clock } kind;
+        QString name;     // Sig
+        int value = 0;    // Const; Unary/Binary operator; Delay amount
+        int msb = 0;      // Slice
+        int lsb = 0;
+        int lhs = -1;
+        int rhs = -1;
+        ClockShape clock; // Clock
+    };
+
+    QString m_text;
+    std::vector<Node> m_nodes;
+    int m_root = -1;
+
+    friend class SignalExprParser;
+    friend std::vector<ValueRun> signalRuns(const Signal &, int, int, const Resolver &);
+
+    // State of one evaluation: operand runs already computed and the derived
+    // signals being expanded (DerivedSignal.cpp)
+    struct EvalContext;
+
+    std::vector<ValueRun> eval(int node, int t0, int t1, EvalContext &ctx) const;
+    bool nodeIsBit(int node, EvalContext &ctx) const;
+    static std::vector<ValueRun> runsOf(const Signal &sig, int t0, int t1, EvalContext &ctx);
+    static bool isBit(const Signal &sig, EvalContext &ctx);
+};
+
+// Runs of a stored or derived signal over [t0, t1); samples outside the
+// signal are undefined
+std::vector<ValueRun> signalRuns(const Signal &sig, int t0, int t1,
+                                 const SignalExpr::Resolver &resolve);
+
+// Resolves operand names against `sigs` (first row wins on duplicates).
+// The list must outlive the resolver.
+SignalExpr::Resolver resolverFor(const std::vector<Signal> &sigs);
+
+#endif // DERIVEDSIGNAL_H
@@ -0,0 +1,95 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Edges.cpp
+// Description:   Per-signal transition index and edge navigation.
+//======================================================================
+
+#include "core/Edges.h"
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+
+namespace {
+
+std::shared_ptr<const TransitionIndex> buildIndex(const std::vector<int> &v)
+{
+    WP_TRACE_SCOPE("core", "transitionIndex::build");
+    auto idx = std::make_shared<TransitionIndex>();
+    const int n = static_cast<int>(v.size());
+    for (int t = 1; t < n; ++t)
+        if (v[t] != v[t - 1])
+            idx->samples.push_back(t);
+    idx->samples.shrink_to_fit();
+    return idx;
+}
+
+std::shared_ptr<const TransitionIndex> buildPackedIndex(const BitPlane &bits)
+{
+    WP_TRACE_SCOPE("core", "transitionIndex::buildPacked");
+    auto idx = std::make_shared<TransitionIndex>();
+    idx->samples.reserve(bits.transitionCount());   // popcount per word
+    bits.forEachTransition([&idx](int t) { idx->samples.push_back(t); });
+    return idx;
+}
+
+bool matchesKind(const Signal &sig, int t, EdgeKind kind)
+{
+    if (kind == EdgeKind::Any || sig.type != SignalType::Bit)
+        return true;
+    const int before = sig.valueAt(t - 1);
+    const int after = sig.valueAt(t);
+    if (kind == EdgeKind::Rising)
+        return before == 0 && after == 1;
+    return before == 1 && after == 0;
+}
+
+} // namespace
+
+std::shared_ptr<const TransitionIndex> transitionIndex(const Signal &sig)
+{
+    if (sig.isPacked())
+        return sig.bits.derived<TransitionIndex>(buildPackedIndex);
+    return sig.values.derived<TransitionIndex>(buildIndex);
+}
+
+int nextEdge(const Signal &sig, int fromSample, EdgeKind kind)
+{
+    ClockShape clock;
+    if (sig.expr && sig.expr->clockShape(&clock))
+        return clock.nextEdge(fromSample, kind);   // procedural clock: arithmetic
+    const auto idx = transitionIndex(sig);
+    const std::vector<int> &e = idx->samples;
+    for (auto it = std::upper_bound(e.begin(), e.end(), fromSample); it != e.end(); ++it)
+        if (matchesKind(sig, *it, kind))
+            return *it;
+    return -1;
+}
+
+int prevEdge(const Signal &sig, int fromSample, EdgeKind kind)
+{
+    ClockShape clock;
+    if (sig.expr && sig.expr->clockShape(&clock))
+        return clock.prevEdge(fromSample, kind);
+    const auto idx = transitionIndex(sig);
+    const std::vector<int> &e = idx->samples;
+    auto it = std::lower_bound(e.begin(), e.end(), fromSample);
+    while (it != e.begin()) {
+        --it;
+        if (matchesKind(sig, *it, kind))
+            return *it;
+    }
+    return -1;
+}
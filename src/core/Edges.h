@@ -0,0 +1,48 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Edges.h
+// Description:   Per-signal transition index and edge navigation.
+//======================================================================
+
+#ifndef EDGES_H
+#define EDGES_H
+
+#include <memory>
+#include <vector>
+#include "core/core.h"
+
+enum class EdgeKind {
+    Any,       // any value change
+    Rising,    // Bit 0 -> 1 (Vector: same as Any)
+    Falling    // Bit 1 -> 0 (Vector: same as Any)
+};
+
+// Samples t (t >= 1) where values[t] != values[t-1], ascending. Built once
+// per value buffer and cached on it (CowVector::derived), so copies of a
+// signal and its VCD library entry share one index until they diverge.
+struct TransitionIndex
+{
+    std::vector<int> samples;
+};
+
+std::shared_ptr<const TransitionIndex> transitionIndex(const Signal &sig);
+
+// First edge strictly after / last edge strictly before fromSample, or -1.
+// A binary search in the transition index; Rising/Falling skip the edges of
+// the other polarity (and those to or from undefined).
+int nextEdge(const Signal &sig, int fromSample, EdgeKind kind);
+int prevEdge(const Signal &sig, int fromSample, EdgeKind kind);
+
+#endif // EDGES_H
@@ -0,0 +1,117 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          GlitchFinder.cpp
+// Description:   Parallel scan for short pulses and zero-width glitches.
+//======================================================================
+
+#include "core/GlitchFinder.h"
+#include "core/VcdLibrary.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+
+namespace {
+
+// Violations of one signal, in sample order
+void scanSignal(const Signal &sig, int index, int t0, int t1,
+                const SignalExpr::Resolver &resolve, const GlitchScanOptions &options,
+                std::vector<PulseViolation> &out, qint64 &pulses)
+{
+    // One sample before t0 tells whether the first run starts with a change
+    const int from = std::max(0, t0 - 1);
+    std::vector<ValueRun> runs = signalRuns(sig, from, t1, resolve);
+
+    // Derived signals may split a run where an operand changed
+    runs.erase(std::unique(runs.begin(), runs.end(),
+                           [](const ValueRun &a, const ValueRun &b) { return a.value == b.value; }),
+               runs.end());
+
+    const std::vector<qint64> *times = options.sampleTimes;
+    auto widthOf = [&](int start, int end) -> qint64 {
+        if (times && end < static_cast<int>(times->size()))
+            return (*times)[end] - (*times)[start];
+        return end - start;
+    };
+
+    // Run 0 either holds sample t0 - 1 or starts at sample 0: never complete
+    for (size_t i = 1; i + 1 < runs.size(); ++i) {
+        const int start = runs[i].start;
+        const int end = runs[i + 1].start;
+        if (start < t0)
+            continue;
+        ++pulses;
+        const qint64 width = widthOf(start, end);
+        if (width < options.minWidth)
+            out.push_back({index, start, end, runs[i].value, width});
+    }
+
+    const int libIndex = index < static_cast<int>(options.libraryIndex.size())
+                             ? options.libraryIndex[index] : -1;
+    if (options.library && libIndex >= 0) {
+        const size_t pulseCount = out.size();
+        for (const VcdGlitch &g : options.library->zeroWidthGlitches(libIndex)) {
+            if (g.sample >= t0 && g.sample < t1)
+                out.push_back({index, g.sample, g.sample, g.value, 0});
+        }
+        std::inplace_merge(out.begin(), out.begin() + pulseCount, out.end(),
+                           [](const PulseViolation &a, const PulseViolation &b) { return a.start < b.start; });
+    }
+}
+
+} // namespace
+
+GlitchScanResult findGlitches(const std::vector<Signal> &sigs, int t0, int t1,
+                              const SignalExpr::Resolver &resolve,
+                              const GlitchScanOptions &options)
+{
+    WP_TRACE_SCOPE("core", "findGlitches");
+    const qint64 startNs = Tracer::nowNs();
+
+    GlitchScanResult result;
+    const int n = static_cast<int>(sigs.size());
+    if (t1 <= t0 || n == 0)
+        return result;
+
+    std::vector<std::vector<PulseViolation>> perSignal(n);
+    std::vector<qint64> pulses(n, 0);
+    std::vector<char> scanned(n, 0);
+    std::atomic<qint64> found{0};
+
+    parallelFor(n, [&](int i) {
+        if ((options.cancel && options.cancel->load(std::memory_order_relaxed))
+            || found.load(std::memory_order_relaxed) >= options.maxViolations)
+            return;
+        scanSignal(sigs[i], i, t0, t1, resolve, options, perSignal[i], pulses[i]);
+        scanned[i] = 1;
+        found.fetch_add(static_cast<qint64>(perSignal[i].size()), std::memory_order_relaxed);
+    });
+
+    result.canceled = options.cancel && options.cancel->load();
+    for (int i = 0; i < n; ++i) {
+        result.pulses += pulses[i];
+        // Signals skipped once the limit was reached also make the result partial
+        if (!scanned[i] && !result.canceled)
+            result.truncated = true;
+        const size_t room = static_cast<size_t>(options.maxViolations) - result.violations.size();
+        if (perSignal[i].size() > room) {
+            result.truncated = true;
+            perSignal[i].resize(room);
+        }
+        result.violations.insert(result.violations.end(), perSignal[i].begin(), perSignal[i].end());
+    }
+    result.elapsedNs = Tracer::nowNs() - startNs;
+    return result;
+}
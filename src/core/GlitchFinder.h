@@ -0,0 +1,72 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          GlitchFinder.h
+// Description:   Minimum pulse-width violations and zero-width glitches.
+//======================================================================
+
+#ifndef GLITCHFINDER_H
+#define GLITCHFINDER_H
+
+#include <atomic>
+#include <vector>
+#include "core/core.h"
+#include "core/DerivedSignal.h"
+
+// A pulse narrower than the threshold, or a zero-width glitch (a signal that
+// changed more than once at one VCD timestamp, see VcdGlitch)
+struct PulseViolation
+{
+    int signal = 0;                 // index into the scanned signals
+    int start = 0;                  // first sample of the pulse
+    int end = 0;                    // one past its last sample; == start for a zero-width glitch
+    int value = UNDEFINED_VALUE;    // value held during the pulse
+    qint64 width = 0;               // in samples or VCD time units
+
+    bool zeroWidth() const { return end == start; }
+};
+
+struct GlitchScanOptions
+{
+    qint64 minWidth = 2;            // complete pulses narrower than this are reported
+    // Measure widths in VCD time (sampleTimes[t] = time of sample t) instead of samples
+    const std::vector<qint64> *sampleTimes = nullptr;
+
+    // Zero-width glitches recorded at import: library index of every
+    // scanned signal (-1 = none)
+    const VcdLibrary *library = nullptr;
+    std::vector<int> libraryIndex;
+
+    int maxViolations = 1 << 20;    // the scan stops adding past this
+    const std::atomic<bool> *cancel = nullptr;
+};
+
+struct GlitchScanResult
+{
+    std::vector<PulseViolation> violations;   // by signal, then sample
+    qint64 pulses = 0;                        // complete pulses examined
+    bool   truncated = false;                 // maxViolations reached
+    bool   canceled = false;
+    qint64 elapsedNs = 0;
+};
+
+// Scans every signal of `sigs` over [t0, t1) for complete pulses (runs of
+// one value, X included, with a change on both sides) narrower than
+// options.minWidth, plus the zero-width glitches of the library. Signals
+// run in parallel; each one only walks its value changes.
+GlitchScanResult findGlitches(const std::vector<Signal> &sigs, int t0, int t1,
+                              const SignalExpr::Resolver &resolve,
+                              const GlitchScanOptions &options);
+
+#endif // GLITCHFINDER_H
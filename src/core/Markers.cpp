@@ -44,11 +44,13 @@
 //======================================================================
 
 #include "core/core.h"
+#include "utils/Trace.h"
 
 
 
 int WaveDocument::addMarker(int sampleIndex)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addMarker", &m_lastMutationNs);
     pushUndoSnapshot();
     if (sampleIndex < 0 || sampleIndex >= m_sampleCount)
         return -1;
@@ -75,8 +77,52 @@ int WaveDocument::addMarker(int sampleIndex)
     return m.id;
 }
 
+std::vector<int> WaveDocument::addMarkers(const std::vector<int> &sampleIndices)
+{
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addMarkers", &m_lastMutationNs);
+    std::vector<int> ids;
+    ids.reserve(sampleIndices.size());
+
+    // Una sola entrada de undo para todo el lote
+    pushUndoSnapshot();
+    std::vector<int> existing;
+    existing.reserve(m_markers.size());
+    for (const Marker &m : m_markers)
+        existing.push_back(m.sample);
+    std::sort(existing.begin(), existing.end());
+
+    std::vector<int> fresh;
+    fresh.reserve(sampleIndices.size());
+    for (int sample : sampleIndices) {
+        if (sample >= 0 && sample < m_sampleCount)
+            fresh.push_back(sample);
+    }
+    std::sort(fresh.begin(), fresh.end());
+    fresh.erase(std::unique(fresh.begin(), fresh.end()), fresh.end());
+
+    for (int sample : fresh) {
+        if (std::binary_search(existing.begin(), existing.end(), sample))
+            continue;
+
+        Marker m;
+        m.id     = m_nextMarkerId++;
+        m.sample = sample;
+        m_markers.push_back(m);
+        ids.push_back(m.id);
+    }
+
+    std::sort(m_markers.begin(), m_markers.end(),
+              [](const Marker &a, const Marker &b) {
+                  return a.sample < b.sample;
+              });
+
+    emit dataChanged();
+    return ids;
+}
+
 void WaveDocument::subMarkerById(int markerId)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::subMarkerById", &m_lastMutationNs);
     pushUndoSnapshot();
     auto it = std::find_if(m_markers.begin(), m_markers.end(),
                            [markerId](const Marker &m) { return m.id == markerId; });
@@ -105,6 +151,7 @@ void WaveDocument::subMarkerById(int markerId)
 
 void WaveDocument::clearMarkers()
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clearMarkers", &m_lastMutationNs);
     pushUndoSnapshot();
     m_markers.clear();
     m_nextMarkerId = 1;
@@ -0,0 +1,145 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Memory.cpp
+// Description:   Memory accounting of a WaveDocument per subsystem and per signal,
+//                and the budget warning.
+//======================================================================
+
+#include "core/core.h"
+#include "core/VcdLibrary.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+// Visible signals, counting each buffer once. Buffers still shared with the
+// VCD library (frozen) are already counted there, or in the undo history for
+// a library that a later import replaced.
+qint64 signalsBytes(const std::vector<Signal> &sigs, bool haveLibrary)
+{
+    std::unordered_set<const void *> seen;
+    qint64 bytes = static_cast<qint64>(sigs.capacity()) * sizeof(Signal);
+    for (const Signal &s : sigs) {
+        if (!(haveLibrary && s.values.isFrozen()) && seen.insert(s.values.bufferId()).second)
+            bytes += s.values.bufferBytes();
+        if (!(haveLibrary && s.labels.isFrozen()) && seen.insert(s.labels.bufferId()).second)
+            bytes += s.labels.bufferBytes();
+        if (!(haveLibrary && s.bits.isFrozen()) && seen.insert(s.bits.bufferId()).second)
+            bytes += s.bits.bufferBytes();
+        if (seen.insert(s.starts.bufferId()).second)
+            bytes += s.starts.bufferBytes();
+    }
+    return bytes;
+}
+
+} // namespace
+
+qint64 WaveDocument::signalBytes(const Signal &sig)
+{
+    return static_cast<qint64>(sizeof(Signal)) +
+           static_cast<qint64>(sig.values.capacity()) * sizeof(int) +
+           static_cast<qint64>(sig.labels.capacity()) * sizeof(QString) +
+           sig.bits.bufferBytes() + sig.starts.bufferBytes();
+}
+
+MemoryStats WaveDocument::memoryStats() const
+{
+    MemoryStats st;
+    st.visibleSignals = signalsBytes(m_signals, m_vcdLibrary != nullptr);
+    st.vcdLibrary     = m_vcdLibrary ? m_vcdLibrary->bytes() : 0;
+
+    st.undoHistory = m_undoBytes;
+    st.redoHistory = m_redoBytes;
+
+    if (m_hasClipboardSignal)
+        st.signalClipboard = signalBytes(m_clipboardSignal);   // may share with a visible signal
+
+    if (m_hasBlockClipboard) {
+        qint64 b = 0;
+        for (const auto &row : m_blockClipboardValues)
+            b += sizeof(row) + static_cast<qint64>(row.capacity()) * sizeof(int);
+        for (const auto &row : m_blockClipboardLabels)
+            b += sizeof(row) + static_cast<qint64>(row.capacity()) * sizeof(QString);
+        for (const BitPlane &row : m_blockClipboardBits)
+            b += row.bufferBytes();
+        for (const BitPlane &row : m_blockClipboardStarts)
+            b += row.bufferBytes();
+        b += static_cast<qint64>(m_blockClipboardBits.capacity() + m_blockClipboardStarts.capacity()) *
+             sizeof(BitPlane);
+        b += static_cast<qint64>(m_blockClipboardTypes.capacity()) * sizeof(SignalType);
+        b += static_cast<qint64>(m_blockClipboardColors.capacity()) * sizeof(QColor);
+        st.blockClipboard = b;
+    }
+
+    st.annotations = static_cast<qint64>(m_markers.capacity()) * sizeof(Marker) +
+                     static_cast<qint64>(m_arrows.capacity()) * sizeof(Arrow);
+    return st;
+}
+
+std::vector<SignalMemoryUsage> WaveDocument::signalMemoryUsage() const
+{
+    std::vector<SignalMemoryUsage> out;
+    const std::vector<Signal> &lib = vcdSignalList();
+    out.reserve(m_signals.size() + lib.size());
+    for (const Signal &s : m_signals)
+        out.push_back({s.name, false, signalBytes(s)});
+    for (const Signal &s : lib)
+        out.push_back({s.name, true, signalBytes(s)});
+
+    std::stable_sort(out.begin(), out.end(),
+                     [](const SignalMemoryUsage &a, const SignalMemoryUsage &b) {
+                         return a.bytes > b.bytes;
+                     });
+    return out;
+}
+
+void WaveDocument::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = std::max<qint64>(0, bytes);
+    m_memoryBudgetWarned = false;
+    checkMemoryBudget();
+}
+
+void WaveDocument::onDocumentMutated()
+{
+    // The cost of the last undo step is only known once the edit has
+    // detached the buffers it touched
+    chargeReleasedBuffers();
+    trimHistory();
+    checkMemoryBudget();
+}
+
+void WaveDocument::checkMemoryBudget()
+{
+    if (m_memoryBudget <= 0)
+        return;
+
+    // O(signals + snapshots): snapshot sizes are cached when they are stored
+    qint64 used = memoryStats().total();
+    if (used > m_memoryBudget && !m_memoryBudgetWarned) {
+        // The newest undo step may be overestimated: warn on its exact charge
+        settleNewestUndoStep();
+        used = memoryStats().total();
+    }
+    if (used > m_memoryBudget) {
+        if (!m_memoryBudgetWarned) {
+            m_memoryBudgetWarned = true;
+            emit memoryBudgetExceeded(used, m_memoryBudget);
+        }
+    } else {
+        m_memoryBudgetWarned = false;
+    }
+}
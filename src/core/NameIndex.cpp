@@ -0,0 +1,199 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          NameIndex.cpp
+// Description:   Trigram index for incremental search over signal names.
+//======================================================================
+
+#include "core/NameIndex.h"
+#include "utils/Trace.h"
+
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+// 6-bit case-folded alphabet; everything unusual shares code 63 (the
+// candidates are verified against the real name anyway)
+inline quint32 foldChar(QChar ch)
+{
+    ushort u = ch.unicode();
+    if (u >= 'A' && u <= 'Z')
+        u = static_cast<ushort>(u + ('a' - 'A'));
+    if (u >= 'a' && u <= 'z')
+        return u - 'a';
+    if (u >= '0' && u <= '9')
+        return 26 + (u - '0');
+    switch (u) {
+    case '_': return 36;
+    case '.': return 37;
+    case '[': return 38;
+    case ']': return 39;
+    case '$': return 40;
+    case '\\': return 41;
+    default:  return 63;
+    }
+}
+
+// Distinct trigram keys of s, sorted
+void trigramKeys(const QString &s, std::vector<quint32> &keys)
+{
+    keys.clear();
+    const int len = s.size();
+    if (len < 3)
+        return;
+    const QChar *d = s.constData();
+    quint32 a = foldChar(d[0]);
+    quint32 b = foldChar(d[1]);
+    for (int i = 2; i < len; ++i) {
+        const quint32 c = foldChar(d[i]);
+        keys.push_back((a << 12) | (b << 6) | c);
+        a = b;
+        b = c;
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+QStringList splitQuery(const QString &query)
+{
+    QStringList frags;
+    QString cur;
+    for (QChar ch : query) {
+        if (ch == '*' || ch == '?' || ch.isSpace()) {
+            if (!cur.isEmpty())
+                frags << cur;
+            cur.clear();
+        } else {
+            cur += ch;
+        }
+    }
+    if (!cur.isEmpty())
+        frags << cur;
+    return frags;
+}
+
+} // namespace
+
+SignalNameIndex::SignalNameIndex(const std::vector<Signal> &sigs)
+    : m_signals(sigs)
+{
+    WP_TRACE_SCOPE("search", "SignalNameIndex::build");
+
+    // Two passes (count, then fill) so the postings are one exact allocation
+    std::vector<quint32> keys;
+    m_offsets.assign(kKeys + 1, 0);
+    for (const Signal &s : m_signals) {
+        trigramKeys(s.name, keys);
+        for (quint32 k : keys)
+            ++m_offsets[k + 1];
+    }
+    for (int k = 0; k < kKeys; ++k)
+        m_offsets[k + 1] += m_offsets[k];
+
+    m_ids.resize(m_offsets[kKeys]);
+    std::vector<quint32> cursor(m_offsets.begin(), m_offsets.end() - 1);
+    for (int i = 0; i < static_cast<int>(m_signals.size()); ++i) {
+        trigramKeys(m_signals[i].name, keys);
+        for (quint32 k : keys)
+            m_ids[cursor[k]++] = static_cast<quint32>(i);
+    }
+}
+
+qint64 SignalNameIndex::bytes() const
+{
+    return static_cast<qint64>(m_offsets.capacity() + m_ids.capacity()) * sizeof(quint32);
+}
+
+NameSearchResult SignalNameIndex::search(const QString &query, int maxResults,
+                                         const std::atomic<bool> *cancel) const
+{
+    WP_TRACE_SCOPE("search", "SignalNameIndex::search");
+    NameSearchResult res;
+    const qint64 t0 = Tracer::nowNs();
+
+    const QStringList frags = splitQuery(query);
+    if (frags.isEmpty())
+        return res;
+
+    // Rarest trigram of any fragment drives the candidate list
+    const quint32 *candBegin = nullptr;
+    const quint32 *candEnd = nullptr;
+    std::vector<quint32> keys;
+    for (const QString &f : frags) {
+        trigramKeys(f, keys);
+        for (quint32 k : keys) {
+            const quint32 *b = m_ids.data() + m_offsets[k];
+            const quint32 *e = m_ids.data() + m_offsets[k + 1];
+            if (!candBegin || (e - b) < (candEnd - candBegin)) {
+                candBegin = b;
+                candEnd = e;
+            }
+        }
+    }
+
+    // Score: lower is better. Matches that end inside the leaf name, exact
+    // leaf names, compact matches and short names rank first.
+    std::vector<std::pair<int, int>> scored;   // (score, id)
+    auto consider = [&](int id) {
+        const QString &name = m_signals[id].name;
+        int pos = 0;
+        int first = -1;
+        for (const QString &f : frags) {
+            const int at = name.indexOf(f, pos, Qt::CaseInsensitive);
+            if (at < 0)
+                return;
+            if (first < 0)
+                first = at;
+            pos = at + f.size();
+        }
+        const int leafStart = name.lastIndexOf('.') + 1;
+        int score = 2 * (pos - first) + name.size();
+        if (pos <= leafStart)
+            score += 1000;                       // match lies only in the scope path
+        if (frags.size() == 1 && first == leafStart && pos == name.size())
+            score -= 2000;                       // exact leaf name
+        scored.emplace_back(score, id);
+    };
+
+    const int n = static_cast<int>(m_signals.size());
+    int checked = 0;
+    if (candBegin) {
+        for (const quint32 *p = candBegin; p != candEnd; ++p) {
+            if (cancel && (++checked & 4095) == 0 && cancel->load(std::memory_order_relaxed)) {
+                res.cancelled = true;
+                return res;
+            }
+            consider(static_cast<int>(*p));
+        }
+    } else {
+        for (int id = 0; id < n; ++id) {
+            if (cancel && (++checked & 4095) == 0 && cancel->load(std::memory_order_relaxed)) {
+                res.cancelled = true;
+                return res;
+            }
+            consider(id);
+        }
+    }
+
+    res.totalMatches = static_cast<int>(scored.size());
+    const int keep = std::min(res.totalMatches, std::max(0, maxResults));
+    std::partial_sort(scored.begin(), scored.begin() + keep, scored.end());
+    res.ids.reserve(keep);
+    for (int i = 0; i < keep; ++i)
+        res.ids.push_back(scored[i].second);
+
+    res.elapsedNs = Tracer::nowNs() - t0;
+    return res;
+}
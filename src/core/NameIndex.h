@@ -0,0 +1,65 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          NameIndex.h
+// Description:   Trigram index for incremental search over signal names.
+//======================================================================
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <QString>
+#include <atomic>
+#include <vector>
+#include "core/core.h"
+
+struct NameSearchResult
+{
+    std::vector<int> ids;     // best matches first (indices into the signal list)
+    int totalMatches = 0;     // before truncation to maxResults
+    qint64 elapsedNs = 0;
+    bool cancelled = false;
+};
+
+// Trigram index over the full hierarchical names of a signal list.
+//
+// Characters are case-folded into a 6-bit alphabet, so a trigram is an
+// 18-bit key and the postings are a flat CSR array (offsets + ids, ids
+// ascending). A query is split into fragments on '*', '?' and spaces
+// ("*axi*wvalid*", "axi wvalid"); a name matches when it contains every
+// fragment, in order, case-insensitively. Only the ids of the rarest query
+// trigram are verified, so typical queries touch a few thousand names even
+// at 1M signals. Queries without any 3-character fragment scan every name.
+//
+// search() is const and may run on worker threads.
+class SignalNameIndex
+{
+public:
+    explicit SignalNameIndex(const std::vector<Signal> &sigs);
+
+    NameSearchResult search(const QString &query, int maxResults,
+                            const std::atomic<bool> *cancel = nullptr) const;
+
+    qint64 bytes() const;
+
+private:
+    static constexpr int kKeyBits = 18;
+    static constexpr int kKeys = 1 << kKeyBits;
+
+    const std::vector<Signal> &m_signals;
+    std::vector<quint32> m_offsets;   // kKeys + 1
+    std::vector<quint32> m_ids;
+};
+
+#endif // NAMEINDEX_H
@@ -0,0 +1,208 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ProtocolDecoder.cpp
+// Description:   Streaming protocol decoder interface, registry and driver.
+//======================================================================
+
+#include "core/ProtocolDecoder.h"
+#include "core/BuiltinDecoders.h"
+#include "utils/Trace.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// Samples per window of value runs pulled from the channels
+constexpr int kWindowSamples = 1 << 18;
+
+struct RegistryEntry
+{
+    QString id;
+    ProtocolDecoderFactory factory;
+};
+
+QMutex g_registryMutex;
+
+std::vector<RegistryEntry> &registry()
+{
+    static std::vector<RegistryEntry> entries = {
+        { QStringLiteral("uart"), makeUartDecoder },
+        { QStringLiteral("spi"),  makeSpiDecoder },
+        { QStringLiteral("i2c"),  makeI2cDecoder },
+    };
+    return entries;
+}
+
+} // namespace
+
+int ProtocolDecoder::option(const QString &key) const
+{
+    if (m_options.contains(key))
+        return m_options.value(key);
+    for (const DecoderOption &o : options())
+        if (o.key == key)
+            return o.defaultValue;
+    return 0;
+}
+
+void ProtocolDecoder::annotate(int row, int start, int end, int value, const QString &label)
+{
+    if (m_out && row >= 0 && row < static_cast<int>(m_out->size()) && end > start)
+        (*m_out)[row].annotations.push_back({start, end, value, label});
+}
+
+void registerProtocolDecoder(const QString &id, ProtocolDecoderFactory factory)
+{
+    QMutexLocker lock(&g_registryMutex);
+    std::vector<RegistryEntry> &entries = registry();
+    for (RegistryEntry &e : entries) {
+        if (e.id == id) {
+            e.factory = std::move(factory);
+            return;
+        }
+    }
+    entries.push_back({id, std::move(factory)});
+}
+
+QStringList protocolDecoderIds()
+{
+    QMutexLocker lock(&g_registryMutex);
+    QStringList ids;
+    for (const RegistryEntry &e : registry())
+        ids << e.id;
+    return ids;
+}
+
+std::unique_ptr<ProtocolDecoder> createProtocolDecoder(const QString &id)
+{
+    QMutexLocker lock(&g_registryMutex);
+    for (const RegistryEntry &e : registry())
+        if (e.id == id)
+            return e.factory();
+    return nullptr;
+}
+
+DecodeSummary decodeProtocol(ProtocolDecoder &decoder, const std::vector<const Signal *> &channels,
+                             int t0, int t1, const SignalExpr::Resolver &resolve,
+                             const AnnotationSink &sink)
+{
+    WP_TRACE_SCOPE("core", "decodeProtocol");
+    DecodeSummary sum;
+    const qint64 startNs = Tracer::nowNs();
+    const int k = static_cast<int>(channels.size());
+
+    std::vector<AnnotationRow> out;
+    for (const QString &name : decoder.outputs())
+        out.push_back({name, {}});
+    decoder.m_out = &out;
+
+    auto flush = [&](int done) {
+        for (const AnnotationRow &row : out)
+            sum.annotations += static_cast<qint64>(row.annotations.size());
+        const bool go = !sink || sink(out, done);
+        for (AnnotationRow &row : out)
+            row.annotations.clear();
+        return go;
+    };
+
+    std::vector<int> prev(k, UNDEFINED_VALUE);
+    std::vector<int> cur(k, UNDEFINED_VALUE);
+    std::vector<std::vector<ValueRun>> runs(k);
+    std::vector<size_t> pos(k);
+
+    t0 = std::max(0, t0);
+    bool started = false;
+    for (int w0 = t0; w0 < t1 && !sum.canceled; w0 += kWindowSamples) {
+        const int w1 = std::min(t1, w0 + kWindowSamples);
+        for (int c = 0; c < k; ++c) {
+            if (channels[c])
+                runs[c] = signalRuns(*channels[c], w0, w1, resolve);
+            else
+                runs[c].assign(1, ValueRun{w0, UNDEFINED_VALUE});
+            pos[c] = 0;
+        }
+
+        // k-way merge of the run starts; a window border is only a change
+        // if some level really differs
+        int s = w0;
+        while (s < w1) {
+            for (int c = 0; c < k; ++c) {
+                if (pos[c] < runs[c].size() && runs[c][pos[c]].start == s)
+                    cur[c] = runs[c][pos[c]++].value;
+            }
+            if (!started) {
+                decoder.begin(s, cur.data());
+                started = true;
+            } else if (cur != prev) {
+                decoder.step(s, prev.data(), cur.data());
+                ++sum.events;
+            }
+            prev = cur;
+
+            int next = w1;
+            for (int c = 0; c < k; ++c)
+                if (pos[c] < runs[c].size())
+                    next = std::min(next, runs[c][pos[c]].start);
+            s = next;
+        }
+        if (w1 < t1 && !flush(w1))
+            sum.canceled = true;
+    }
+
+    if (started && !sum.canceled)
+        decoder.end(t1);
+    flush(sum.canceled ? t0 : t1);
+    decoder.m_out = nullptr;
+    sum.elapsedNs = Tracer::nowNs() - startNs;
+    return sum;
+}
+
+// ---------------------------------------------------------------------------
+// WaveDocument
+// ---------------------------------------------------------------------------
+
+int WaveDocument::addAnnotationSignals(const std::vector<AnnotationRow> &rows)
+{
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addAnnotationSignals", &m_lastMutationNs);
+    if (rows.empty())
+        return -1;
+
+    pushUndoSnapshot();
+    const int first = static_cast<int>(m_signals.size());
+    for (const AnnotationRow &row : rows) {
+        Signal s(row.name, SignalType::Vector, m_sampleCount);
+        s.color = QColor(190, 110, 0);
+        s.starts = BitPlane(m_sampleCount, 0);
+        std::vector<int> &vals = s.values.mut();
+        std::vector<QString> &labs = s.labels.mut();
+        for (const Annotation &a : row.annotations) {
+            const int a0 = std::max(0, a.start);
+            const int a1 = std::min(m_sampleCount, a.end);
+            if (a0 >= a1)
+                continue;
+            std::fill(vals.begin() + a0, vals.begin() + a1, a.value);
+            std::fill(labs.begin() + a0, labs.begin() + a1, a.label);
+            // The painter starts a new bar here even when the previous
+            // annotation has the same value
+            s.starts.set(a0, 1);
+        }
+        m_signals.push_back(std::move(s));
+    }
+    emit dataChanged();
+    return first;
+}
@@ -0,0 +1,128 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ProtocolDecoder.h
+// Description:   Streaming protocol decoder interface, registry and driver.
+//======================================================================
+
+#ifndef PROTOCOLDECODER_H
+#define PROTOCOLDECODER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "core/core.h"
+#include "core/DerivedSignal.h"
+
+// One decoded item (a byte, a start condition, ...) over [start, end)
+struct Annotation
+{
+    int     start;
+    int     end;
+    int     value;
+    QString label;
+};
+
+// Annotations of one decoder output, turned into a Vector signal
+struct AnnotationRow
+{
+    QString name;
+    std::vector<Annotation> annotations;
+};
+
+struct DecoderChannel
+{
+    QString name;          // role: "rx", "sclk", "sda", ...
+    bool    optional;      // may be left unconnected
+};
+
+struct DecoderOption
+{
+    QString key;
+    QString label;
+    int defaultValue;
+    int minValue;
+    int maxValue;
+};
+
+struct DecodeSummary
+{
+    qint64 events = 0;          // samples with a channel change
+    qint64 annotations = 0;
+    bool   canceled = false;
+    qint64 elapsedNs = 0;
+};
+
+// Receives the annotations produced so far (rows in decoder output order,
+// moved out) and the sample reached; returning false stops the decode
+using AnnotationSink = std::function<bool(std::vector<AnnotationRow> &rows, int doneSample)>;
+
+// Runs `decoder` over [t0, t1) of `channels` (one per decoder channel,
+// nullptr = unconnected). The value runs are pulled window by window, so
+// memory is bounded by the window and the pending annotations, not by the
+// range. `sink` is called after every window.
+class ProtocolDecoder;
+DecodeSummary decodeProtocol(ProtocolDecoder &decoder, const std::vector<const Signal *> &channels,
+                             int t0, int t1, const SignalExpr::Resolver &resolve,
+                             const AnnotationSink &sink);
+
+// A protocol decoder consumes the value changes of its channels as a stream,
+// in time order, and produces annotations on one or more output rows. It
+// never sees individual samples: anything timed (e.g. UART bit centres) is
+// scheduled by the decoder between two changes.
+//
+// New decoders derive from this class and are made available with
+// registerProtocolDecoder().
+class ProtocolDecoder
+{
+public:
+    virtual ~ProtocolDecoder() = default;
+
+    virtual QString id() const = 0;                          // "uart"
+    virtual QString description() const = 0;
+    virtual std::vector<DecoderChannel> channels() const = 0;
+    virtual QStringList outputs() const = 0;                 // annotation rows
+    virtual std::vector<DecoderOption> options() const { return {}; }
+
+    void setOption(const QString &key, int value) { m_options.insert(key, value); }
+    int  option(const QString &key) const;
+
+    // Stream: begin() with the levels at the first sample, step() at every
+    // sample where some channel changes (levels before and after; index =
+    // channel), end() at the end of the range. Unconnected channels read
+    // UNDEFINED_VALUE.
+    virtual void begin(int sample, const int *levels) = 0;
+    virtual void step(int sample, const int *prev, const int *cur) = 0;
+    virtual void end(int sample) = 0;
+
+protected:
+    void annotate(int row, int start, int end, int value, const QString &label);
+
+private:
+    friend DecodeSummary decodeProtocol(ProtocolDecoder &, const std::vector<const Signal *> &,
+                                        int, int, const SignalExpr::Resolver &, const AnnotationSink &);
+    QHash<QString, int> m_options;
+    std::vector<AnnotationRow> *m_out = nullptr;
+};
+
+// Decoder registry. The built-in UART, SPI and I2C decoders are always present.
+using ProtocolDecoderFactory = std::function<std::unique_ptr<ProtocolDecoder>()>;
+void registerProtocolDecoder(const QString &id, ProtocolDecoderFactory factory);
+QStringList protocolDecoderIds();
+std::unique_ptr<ProtocolDecoder> createProtocolDecoder(const QString &id);
+
+#endif // PROTOCOLDECODER_H
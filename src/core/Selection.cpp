@@ -44,11 +44,14 @@
 //======================================================================
 
 #include "core/core.h"
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
 
 
 void WaveDocument::copyBlock(int topSignal, int bottomSignal,
                              int startSample, int endSample)
 {
+    WP_TRACE_SCOPE("core", "WaveDocument::copyBlock");
   
     int sigCount    = static_cast<int>(m_signals.size());
     int sampleCount = m_sampleCount;
@@ -78,17 +81,38 @@ void WaveDocument::copyBlock(int topSignal, int bottomSignal,
     m_blockClipboardSignalCount = rows;
     m_blockClipboardSampleCount = cols;
 
-    m_blockClipboardValues.assign(rows, std::vector<int>(cols, UNDEFINED_VALUE));
-    m_blockClipboardLabels.assign(rows, std::vector<QString>(cols));
+    m_blockClipboardValues.assign(rows, std::vector<int>());
+    m_blockClipboardLabels.assign(rows, std::vector<QString>());
+    m_blockClipboardBits.assign(rows, BitPlane());
+    m_blockClipboardStarts.assign(rows, BitPlane());
     m_blockClipboardTypes.resize(rows);
     m_blockClipboardColors.resize(rows);
 
+    SignalExpr::Resolver resolve;
     for (int r = 0; r < rows; ++r) {
         const Signal &s = m_signals[topSignal + r];
 
         m_blockClipboardTypes[r]  = s.type;
         m_blockClipboardColors[r] = s.color;
 
+        if (s.isDerived()) {
+            // Se copian los valores evaluados, pegan como muestras normales
+            if (!resolve)
+                resolve = signalResolver();
+            m_blockClipboardValues[r] = SignalExpr::sampleValues(s, startSample, startSample + cols, resolve);
+            m_blockClipboardLabels[r].resize(cols);
+            continue;
+        }
+
+        if (s.isPacked()) {
+            // Bits: copia desplazada palabra a palabra (64 muestras)
+            m_blockClipboardBits[r] = s.bits.slice(startSample, cols);
+            continue;
+        }
+
+        m_blockClipboardValues[r].assign(cols, UNDEFINED_VALUE);
+        m_blockClipboardLabels[r].resize(cols);
+
         for (int c = 0; c < cols; ++c) {
             int src = startSample + c;
             if (src >= 0 && src < static_cast<int>(s.values.size())) {
@@ -98,6 +122,8 @@ void WaveDocument::copyBlock(int topSignal, int bottomSignal,
                 m_blockClipboardLabels[r][c] = s.labels[src];
             }
         }
+        if (!s.starts.empty())
+            m_blockClipboardStarts[r] = s.starts.slice(startSample, cols);
     }
 
     m_hasBlockClipboard = true;
@@ -107,6 +133,7 @@ void WaveDocument::copyBlock(int topSignal, int bottomSignal,
 
 void WaveDocument::pasteBlock(int destTopSignal, int destStartSample)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::pasteBlock", &m_lastMutationNs);
     pushUndoSnapshot();
     if (!m_hasBlockClipboard)
         return;
@@ -129,19 +156,57 @@ void WaveDocument::pasteBlock(int destTopSignal, int destStartSample)
 
     for (int r = 0; r < maxRows; ++r) {
         Signal &s = m_signals[destTopSignal + r];
+        materializeClock(s);
+        if (s.isDerived())
+            continue;
+
+        const bool packedRow = m_blockClipboardValues[r].empty();
+        if (s.isPacked()) {
+            if (static_cast<int>(s.bits.size()) < sampleCount)
+                s.bits.resize(sampleCount);
+            if (packedRow) {
+                s.bits.paste(destStartSample, m_blockClipboardBits[r], 0, maxCols);
+            } else {
+                for (int c = 0; c < maxCols; ++c)
+                    s.bits.set(destStartSample + c, m_blockClipboardValues[r][c]);
+            }
+            continue;
+        }
 
         if (static_cast<int>(s.values.size()) < sampleCount)
             s.values.resize(sampleCount, UNDEFINED_VALUE);
         if (static_cast<int>(s.labels.size()) < sampleCount)
             s.labels.resize(sampleCount);
 
+        std::vector<int> &vals = s.values.mut();
+        std::vector<QString> &labs = s.labels.mut();
         for (int c = 0; c < maxCols; ++c) {
             int dst = destStartSample + c;
             if (dst < 0 || dst >= sampleCount)
                 continue;
 
-            s.values[dst] = m_blockClipboardValues[r][c];
-            s.labels[dst] = m_blockClipboardLabels[r][c];
+            if (packedRow) {
+                vals[dst] = m_blockClipboardBits[r].value(c);
+                labs[dst].clear();
+            } else {
+                vals[dst] = m_blockClipboardValues[r][c];
+                labs[dst] = m_blockClipboardLabels[r][c];
+            }
+        }
+
+        // Filas de anotación: el bloque pegado empieza un elemento nuevo y
+        // el resto del elemento que corta, otro
+        const BitPlane &srcStarts = m_blockClipboardStarts[r];
+        if (!s.starts.empty() || !srcStarts.empty()) {
+            if (s.starts.size() < sampleCount)
+                s.starts.resize(sampleCount);
+            if (srcStarts.empty())
+                s.starts.fill(destStartSample, destStartSample + maxCols, 0);
+            else
+                s.starts.paste(destStartSample, srcStarts, 0, maxCols);
+            s.starts.set(destStartSample, 1);
+            if (destStartSample + maxCols < sampleCount)
+                s.starts.set(destStartSample + maxCols, 1);
         }
     }
 
@@ -151,6 +216,7 @@ void WaveDocument::pasteBlock(int destTopSignal, int destStartSample)
 void WaveDocument::clearBlock(int topSignal, int bottomSignal,
                               int startSample, int endSample)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clearBlock", &m_lastMutationNs);
     pushUndoSnapshot();
     int sigCount    = static_cast<int>(m_signals.size());
     int sampleCount = m_sampleCount;
@@ -171,6 +237,13 @@ void WaveDocument::clearBlock(int topSignal, int bottomSignal,
 
     for (int sIdx = topSignal; sIdx <= bottomSignal; ++sIdx) {
         Signal &s = m_signals[sIdx];
+        materializeClock(s);
+        if (s.isDerived())
+            continue;
+        if (s.isPacked()) {
+            s.bits.fill(startSample, endSample + 1, UNDEFINED_VALUE);
+            continue;
+        }
 
         pushUndoSnapshot();
         if (static_cast<int>(s.values.size()) < sampleCount)
@@ -178,11 +251,23 @@ void WaveDocument::clearBlock(int topSignal, int bottomSignal,
         if (static_cast<int>(s.labels.size()) < sampleCount)
             s.labels.resize(sampleCount);
 
+        std::vector<int> &vals = s.values.mut();
+        std::vector<QString> &labs = s.labels.mut();
         for (int t = startSample; t <= endSample; ++t) {
-            s.values[t] = UNDEFINED_VALUE;
-            s.labels[t].clear();
+            vals[t] = UNDEFINED_VALUE;
+            labs[t].clear();
         }
     }
 
     emit dataChanged();
 }
+
+int WaveDocument::blockClipboardValue(int row, int col) const
+{
+    if (row < 0 || row >= static_cast<int>(m_blockClipboardValues.size()))
+        return UNDEFINED_VALUE;
+    const std::vector<int> &vals = m_blockClipboardValues[row];
+    if (vals.empty())
+        return m_blockClipboardBits[row].value(col);
+    return (col >= 0 && col < static_cast<int>(vals.size())) ? vals[col] : UNDEFINED_VALUE;
+}
@@ -0,0 +1,203 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          SignalStats.cpp
+// Description:   Per-signal activity statistics (toggles, duty cycle, pulses, histogram).
+//======================================================================
+
+#include "core/SignalStats.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
+
+namespace {
+
+// Below this a chunk costs more to schedule than to scan
+constexpr int kMinChunkSamples = 1 << 16;
+
+struct RunStats
+{
+    qint64 count = 0;
+    qint64 sum = 0;
+    int    min = INT_MAX;
+    int    max = 0;
+
+    void add(int len)
+    {
+        ++count;
+        sum += len;
+        min = std::min(min, len);
+        max = std::max(max, len);
+    }
+    void add(const RunStats &o)
+    {
+        count += o.count;
+        sum += o.sum;
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+    }
+};
+
+// One (signal, chunk) work item. The runs touching the chunk borders are
+// kept apart: only the merge knows whether they continue in the neighbours.
+struct Partial
+{
+    int  first = UNDEFINED_VALUE;   // value of the run at the chunk start
+    int  last = UNDEFINED_VALUE;    // value of the run at the chunk end
+    int  headLen = 0;
+    int  tailLen = 0;
+    bool single = true;             // one run covers the whole chunk
+
+    qint64 toggles = 0;
+    qint64 xSamples = 0;
+    qint64 highSamples = 0;
+    RunStats inner;                 // complete pulses strictly inside
+    std::unordered_map<int, qint64> histogram;
+};
+
+inline bool isPulse(SignalType type, int value)
+{
+    return type == SignalType::Bit ? value == 1 : value != UNDEFINED_VALUE;
+}
+
+Partial scanChunk(const Signal &sig, int c0, int c1, const SignalExpr::Resolver &resolve)
+{
+    Partial p;
+    const std::vector<ValueRun> runs = signalRuns(sig, c0, c1, resolve);
+    const int n = static_cast<int>(runs.size());
+    p.first = runs.front().value;
+    p.last = runs.back().value;
+    p.headLen = (n > 1 ? runs[1].start : c1) - c0;
+    p.tailLen = c1 - runs.back().start;
+    p.single = (n == 1);
+    p.toggles = n - 1;
+
+    for (int r = 0; r < n; ++r) {
+        const int v = runs[r].value;
+        const int len = (r + 1 < n ? runs[r + 1].start : c1) - runs[r].start;
+        if (v == UNDEFINED_VALUE)
+            p.xSamples += len;
+        else if (sig.type == SignalType::Vector)
+            p.histogram[v] += len;
+        else if (v == 1)
+            p.highSamples += len;
+        if (r > 0 && r + 1 < n && isPulse(sig.type, v))
+            p.inner.add(len);
+    }
+    return p;
+}
+
+SignalStats mergeChunks(const Signal &sig, int t0, int t1, const std::vector<Partial> &parts)
+{
+    SignalStats st;
+    st.name = sig.name;
+    st.type = sig.type;
+    st.t0 = t0;
+    st.t1 = t1;
+
+    RunStats pulses;
+    std::unordered_map<int, qint64> hist;
+
+    // Run carried over from the previous chunks; "open" while it touches t0
+    int  curValue = UNDEFINED_VALUE;
+    int  curLen = 0;
+    bool curOpen = true;
+    bool haveCur = false;
+
+    for (const Partial &p : parts) {
+        st.toggles += p.toggles;
+        st.xSamples += p.xSamples;
+        st.highSamples += p.highSamples;
+        pulses.add(p.inner);
+        for (const auto &kv : p.histogram)
+            hist[kv.first] += kv.second;
+
+        if (haveCur && curValue == p.first) {
+            curLen += p.headLen;
+        } else {
+            if (haveCur) {
+                ++st.toggles;   // change exactly at the chunk border
+                if (!curOpen && isPulse(sig.type, curValue))
+                    pulses.add(curLen);
+            }
+            curOpen = !haveCur;
+            curValue = p.first;
+            curLen = p.headLen;
+            haveCur = true;
+        }
+
+        if (!p.single) {
+            // The carried run ends inside this chunk; its tail run starts here
+            if (!curOpen && isPulse(sig.type, curValue))
+                pulses.add(curLen);
+            curValue = p.last;
+            curLen = p.tailLen;
+            curOpen = false;
+        }
+    }
+    // The run still open at t1 is cut by the range: not a complete pulse
+
+    st.pulses = pulses.count;
+    if (pulses.count > 0) {
+        st.minPulse = pulses.min;
+        st.maxPulse = pulses.max;
+        st.meanPulse = double(pulses.sum) / double(pulses.count);
+    }
+
+    st.histogram.assign(hist.begin(), hist.end());
+    std::sort(st.histogram.begin(), st.histogram.end(),
+              [](const std::pair<int, qint64> &a, const std::pair<int, qint64> &b) {
+                  return a.second != b.second ? a.second > b.second : a.first < b.first;
+              });
+    return st;
+}
+
+} // namespace
+
+SignalStatsResult computeSignalStats(const std::vector<Signal> &sigs, int t0, int t1,
+                                     const SignalExpr::Resolver &resolve)
+{
+    WP_TRACE_SCOPE("core", "computeSignalStats");
+    SignalStatsResult res;
+    const qint64 startNs = Tracer::nowNs();
+    const int k = static_cast<int>(sigs.size());
+    t0 = std::max(0, t0);
+    if (k == 0 || t1 <= t0)
+        return res;
+
+    // Enough chunks to keep every worker busy even with a single signal
+    const int len = t1 - t0;
+    const int wanted = std::max(1, parallelWorkers() * 4 / k);
+    const int chunkLen = std::max(kMinChunkSamples, (len + wanted - 1) / wanted);
+    const int chunks = (len + chunkLen - 1) / chunkLen;
+
+    std::vector<std::vector<Partial>> parts(k, std::vector<Partial>(chunks));
+    parallelFor(k * chunks, [&](int item) {
+        const int s = item / chunks;
+        const int c = item % chunks;
+        const int c0 = t0 + c * chunkLen;
+        const int c1 = std::min(t1, c0 + chunkLen);
+        parts[s][c] = scanChunk(sigs[s], c0, c1, resolve);
+    });
+
+    res.stats.reserve(k);
+    for (int s = 0; s < k; ++s)
+        res.stats.push_back(mergeChunks(sigs[s], t0, t1, parts[s]));
+    res.chunks = k * chunks;
+    res.elapsedNs = Tracer::nowNs() - startNs;
+    return res;
+}
@@ -0,0 +1,72 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          SignalStats.h
+// Description:   Per-signal activity statistics (toggles, duty cycle, pulses, histogram).
+//======================================================================
+
+#ifndef SIGNALSTATS_H
+#define SIGNALSTATS_H
+
+#include <vector>
+#include <utility>
+#include "core/core.h"
+#include "core/DerivedSignal.h"
+
+// Activity statistics of one signal over a sample range
+struct SignalStats
+{
+    QString    name;
+    SignalType type = SignalType::Bit;
+    int t0 = 0;                  // range analysed: [t0, t1)
+    int t1 = 0;
+
+    qint64 toggles = 0;          // value changes inside the range
+    qint64 xSamples = 0;         // samples at X
+    qint64 highSamples = 0;      // Bit: samples at 1
+
+    // Complete pulses, i.e. starting and ending inside the range
+    // (Bit: high pulses; Vector: runs of one defined value)
+    qint64 pulses = 0;
+    int    minPulse = 0;
+    int    maxPulse = 0;
+    double meanPulse = 0.0;
+
+    // Vector: samples per defined value, most frequent first
+    std::vector<std::pair<int, qint64>> histogram;
+
+    int samples() const { return t1 - t0; }
+    // High time over defined time, -1 without defined samples or for vectors
+    double dutyCycle() const
+    {
+        const qint64 defined = samples() - xSamples;
+        return (type == SignalType::Bit && defined > 0) ? double(highSamples) / double(defined) : -1.0;
+    }
+};
+
+struct SignalStatsResult
+{
+    std::vector<SignalStats> stats;   // same order as the input signals
+    int    chunks = 0;                // work items (signals x time chunks)
+    qint64 elapsedNs = 0;
+};
+
+// Statistics of every signal in `sigs` over [t0, t1). The range is split in
+// time chunks and (signal, chunk) pairs run in parallel; the partial results
+// are stitched in order, so pulses crossing chunk borders are measured whole.
+// Derived signals are evaluated through `resolve`.
+SignalStatsResult computeSignalStats(const std::vector<Signal> &sigs, int t0, int t1,
+                                     const SignalExpr::Resolver &resolve);
+
+#endif // SIGNALSTATS_H
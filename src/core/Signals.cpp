@@ -43,6 +43,9 @@
 //======================================================================
 
 #include "core/core.h"
+#include "core/VcdLibrary.h"
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
 #include "io/VcdImporter.h"
 #include "io/JsonIO.h"
 
@@ -56,15 +59,27 @@ WaveDocument::WaveDocument(QObject *parent)
       m_hasClipboardSignal(false)
 {
     // Initial document: no signals, but with a default sample count
+
+    // Every mutation ends in dataChanged(): history accounting and budget
+    connect(this, &WaveDocument::dataChanged, this, [this]() { onDocumentMutated(); });
 }
 
 void WaveDocument::resizeSignals(int newSampleCount)
 {
     for (auto &sig : m_signals)
     {
+        if (sig.isDerived())
+            continue; // no storage; evaluated over whatever its operands hold
+        if (sig.isPacked())
+        {
+            sig.bits.resize(newSampleCount); // new samples are X
+            continue;
+        }
         int oldSize = static_cast<int>(sig.values.size());
         sig.values.resize(newSampleCount, UNDEFINED_VALUE);
         sig.labels.resize(newSampleCount); // QString() by default
+        if (!sig.starts.empty())
+            sig.starts.resize(newSampleCount);
         if (newSampleCount > oldSize)
         {
             // The new samples remain at UNDEFINED_VALUE and have empty labels
@@ -74,6 +89,7 @@ void WaveDocument::resizeSignals(int newSampleCount)
 
 void WaveDocument::setSampleCount(int count)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::setSampleCount", &m_lastMutationNs);
     if (count <= 0)
         return;
     if (count == m_sampleCount)
@@ -86,11 +102,11 @@ void WaveDocument::setSampleCount(int count)
 
 int WaveDocument::addBitSignal(const QString &name)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addBitSignal", &m_lastMutationNs);
     pushUndoSnapshot();
     Signal s(name, SignalType::Bit, m_sampleCount);
     s.color = QColor(0, 160, 0);
-    std::fill(s.values.begin(), s.values.end(), 0); // default 0
-    std::fill(s.labels.begin(), s.labels.end(), QString());
+    s.bits.fill(0, m_sampleCount, 0); // default 0
     m_signals.push_back(s);
     emit dataChanged();
     return static_cast<int>(m_signals.size()) - 1;
@@ -98,12 +114,11 @@ int WaveDocument::addBitSignal(const QString &name)
 
 int WaveDocument::addVectorSignal(const QString &name)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addVectorSignal", &m_lastMutationNs);
 
     pushUndoSnapshot();
     Signal s(name, SignalType::Vector, m_sampleCount);
     s.color = QColor(0, 160, 0);
-    std::fill(s.values.begin(), s.values.end(), UNDEFINED_VALUE);
-    std::fill(s.labels.begin(), s.labels.end(), QString());
     m_signals.push_back(s);
     emit dataChanged();
     return static_cast<int>(m_signals.size()) - 1;
@@ -111,6 +126,7 @@ int WaveDocument::addVectorSignal(const QString &name)
 
 int WaveDocument::addClockSignal(const QString &name, int pulses, int highSamples, int lowSamples)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addClockSignal", &m_lastMutationNs);
     pushUndoSnapshot();
     if (pulses <= 0 || highSamples < 0 || lowSamples < 0)
     {
@@ -130,18 +146,15 @@ int WaveDocument::addClockSignal(const QString &name, int pulses, int highSample
     }
 
     Signal s(name, SignalType::Bit, m_sampleCount);
-    std::fill(s.values.begin(), s.values.end(), 0);
-    std::fill(s.labels.begin(), s.labels.end(), QString());
+    s.bits.fill(0, m_sampleCount, 0);
 
+    // Word-parallel fills: a pulse costs one masked store per 64 samples
     for (int p = 0; p < pulses; ++p)
     {
         int base = p * period;
         int highStart = base + lowSamples;
         int highEnd = std::min(base + period, m_sampleCount);
-        for (int i = highStart; i < highEnd; ++i)
-        {
-            s.values[i] = 1;
-        }
+        s.bits.fill(highStart, highEnd, 1);
     }
 
     m_signals.push_back(s);
@@ -151,26 +164,25 @@ int WaveDocument::addClockSignal(const QString &name, int pulses, int highSample
 
 void WaveDocument::toggleBitValue(int signalIndex, int sampleIndex)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::toggleBitValue", &m_lastMutationNs);
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
     if (sampleIndex < 0 || sampleIndex >= m_sampleCount)
         return;
 
     Signal &s = m_signals[signalIndex];
-    if (s.type != SignalType::Bit)
+    materializeClock(s);
+    if (!s.isPacked())
         return;
 
-    int &v = s.values[sampleIndex];
-    if (v == 1)
-        v = 0;
-    else
-        v = 1;
+    s.bits.set(sampleIndex, s.bits.value(sampleIndex) == 1 ? 0 : 1);
 
     emit dataChanged();
 }
 
 void WaveDocument::setBitValue(int signalIndex, int sampleIndex, int value)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::setBitValue", &m_lastMutationNs);
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
     if (sampleIndex < 0 || sampleIndex >= m_sampleCount)
@@ -179,20 +191,21 @@ void WaveDocument::setBitValue(int signalIndex, int sampleIndex, int value)
     pushUndoSnapshot();
 
     Signal &s = m_signals[signalIndex];
-    if (s.type != SignalType::Bit)
+    materializeClock(s);
+    if (!s.isPacked())
         return;
 
     int v = (value != 0) ? 1 : 0;
-    if (s.values[sampleIndex] == v)
+    if (s.bits.value(sampleIndex) == v)
         return;
 
-    s.values[sampleIndex] = v;
-    s.labels[sampleIndex].clear(); // no labels for bits
+    s.bits.set(sampleIndex, v);
     emit dataChanged();
 }
 
 void WaveDocument::setVectorRange(int signalIndex, int startSample, int endSample, int value, const QString &label)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::setVectorRange", &m_lastMutationNs);
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
     if (startSample < 0 && endSample < 0)
@@ -201,24 +214,36 @@ void WaveDocument::setVectorRange(int signalIndex, int startSample, int endSampl
     pushUndoSnapshot();
 
     Signal &s = m_signals[signalIndex];
-    if (s.type != SignalType::Vector)
+    if (s.type != SignalType::Vector || s.isDerived())
         return;
 
     int s0 = std::max(0, std::min(startSample, endSample));
     int s1 = std::min(m_sampleCount - 1, std::max(startSample, endSample));
 
+    std::vector<int> &vals = s.values.mut();
+    std::vector<QString> &labs = s.labels.mut();
     for (int i = s0; i <= s1; ++i)
     {
-            s.values[i] = value;
-            s.labels[i] = label;
+            vals[i] = value;
+            labs[i] = label;
       
     }
+    if (!s.starts.empty())
+    {
+        // On an annotation row the range is an item of its own, and so is
+        // what is left of the item it overwrote
+        s.starts.fill(s0, s1 + 1, 0);
+        s.starts.set(s0, 1);
+        if (s1 + 1 < s.starts.size())
+            s.starts.set(s1 + 1, 1);
+    }
 
     emit dataChanged();
 }
 
 void WaveDocument::clearSample(int signalIndex, int sampleIndex)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clearSample", &m_lastMutationNs);
     
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
@@ -228,6 +253,15 @@ void WaveDocument::clearSample(int signalIndex, int sampleIndex)
     pushUndoSnapshot();
 
     Signal &s = m_signals[signalIndex];
+    materializeClock(s);
+    if (s.isDerived())
+        return;
+    if (s.isPacked())
+    {
+        s.bits.set(sampleIndex, UNDEFINED_VALUE);
+        emit dataChanged();
+        return;
+    }
     s.values[sampleIndex] = UNDEFINED_VALUE;
     if (sampleIndex < static_cast<int>(s.labels.size()))
         s.labels[sampleIndex].clear();
@@ -236,6 +270,7 @@ void WaveDocument::clearSample(int signalIndex, int sampleIndex)
 
 void WaveDocument::setSignalColor(int signalIndex, const QColor &c)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::setSignalColor", &m_lastMutationNs);
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
     pushUndoSnapshot();
@@ -243,20 +278,83 @@ void WaveDocument::setSignalColor(int signalIndex, const QColor &c)
     emit dataChanged();
 }
 
-void WaveDocument::renameSignal(int signalIndex, const QString &name)
+void WaveDocument::moveSignal(int fromIndex, int toIndex)
 {
-    if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::moveSignal", &m_lastMutationNs);
+    int n = static_cast<int>(m_signals.size());
+    if (fromIndex < 0 || fromIndex >= n ||
+        toIndex < 0 || toIndex >= n ||
+        fromIndex == toIndex)
+    {
         return;
+    }
+
+    // 1) Mover la señal en el vector m_signals
+    Signal sig = std::move(m_signals[fromIndex]);
+    m_signals.erase(m_signals.begin() + fromIndex);
+    m_signals.insert(m_signals.begin() + toIndex, sig);
+
+    // 2) Actualizar los índices de las flechas
+    if (!m_arrows.empty())
+    {
+        for (Arrow &a : m_arrows)
+        {
+
+            auto updateIndex = [&](int idx) -> int
+            {
+                if (fromIndex < toIndex)
+                {
+                    // Ej: [0 1 2 3 4], move 1 -> 3
+                    // index 1 pasa a 3
+                    // 2 y 3 bajan a 1 y 2
+                    if (idx == fromIndex)
+                        return toIndex;
+                    if (idx > fromIndex && idx <= toIndex)
+                        return idx - 1;
+                    return idx;
+                }
+                else
+                {
+                    // fromIndex > toIndex
+                    // Ej: [0 1 2 3 4], move 3 -> 1
+                    // index 3 pasa a 1
+                    // 1 y 2 suben a 2 y 3
+                    if (idx == fromIndex)
+                        return toIndex;
+                    if (idx >= toIndex && idx < fromIndex)
+                        return idx + 1;
+                    return idx;
+                }
+            };
+
+            a.startSignal = updateIndex(a.startSignal);
+            a.endSignal = updateIndex(a.endSignal);
+        }
+    }
+
+    emit dataChanged();
+}
+
+bool WaveDocument::renameSignal(int signalIndex, const QString &name)
+{
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::renameSignal", &m_lastMutationNs);
+    if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
+        return false;
+    if (closesReferenceCycle(signalIndex, name))
+        return false;
     pushUndoSnapshot();
     m_signals[signalIndex].name = name;
     emit dataChanged();
+    return true;
 }
 
 void WaveDocument::clear()
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clear", &m_lastMutationNs);
     m_sampleCount = 0;
     m_signals.clear();
-    m_vcdSignals.clear();
+    m_vcdLibrary.reset();
+    m_vcdTail.reset();
     m_markers.clear();
     m_arrows.clear();
     m_nextMarkerId = 1;
@@ -269,38 +367,64 @@ void WaveDocument::clear()
 
 void WaveDocument::clearSignals()
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::clearSignals", &m_lastMutationNs);
     pushUndoSnapshot();
     m_signals.clear();
     emit dataChanged();
 }
 
 
+const std::vector<Signal> &WaveDocument::vcdSignalList() const
+{
+    static const std::vector<Signal> empty;
+    return m_vcdLibrary ? m_vcdLibrary->signalList() : empty;
+}
+
 bool WaveDocument::loadFromVcd(const QString &fileName)
 {
     return WaveVcdImporter::loadFromVcd(*this, fileName);
 }
 
+bool WaveDocument::loadFromVcd(const QString &fileName, const VcdImportOptions &options)
+{
+    return WaveVcdImporter::loadFromVcd(*this, fileName, options);
+}
+
+bool WaveDocument::loadFromFst(const QString &fileName, const VcdImportOptions &options)
+{
+    return WaveVcdImporter::loadFromFst(*this, fileName, options);
+}
+
 int WaveDocument::addSignalFromVcd(const QString &fullName)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::addSignalFromVcd", &m_lastMutationNs);
     // Search for the signal in the VCD library and copy it to the visible list
-    int idx = -1;
-    for (int i = 0; i < static_cast<int>(m_vcdSignals.size()); ++i)
-    {
-        if (m_vcdSignals[i].name == fullName)
-        {
-            idx = i;
-            break;
-        }
-    }
+    int idx = m_vcdLibrary ? m_vcdLibrary->indexOf(fullName) : -1;
     if (idx < 0)
         return -1;
 
-    const Signal &src = m_vcdSignals[idx];
+    const Signal &src = m_vcdLibrary->at(idx);   // shares its buffers: O(1) copy below
+
+    // Samples appended in follow mode: the row gets them as well. A procedural
+    // clock ends at the imported sample count, so it is stored up to there first
+    const VcdTail *tail = vcdTail();
+    ClockShape clock;
+    const bool procedural = src.isDerived() && src.expr->clockShape(&clock);
+    const int srcCount = procedural ? clock.end : src.sampleCount();
+    if (tail && (procedural || !src.isDerived()) && srcCount < m_sampleCount && m_sampleCount <= tail->sampleCount)
+    {
+        m_signals.push_back(src);
+        materializeClock(m_signals.back(), srcCount);
+        const std::vector<VcdTailChange> &changes = tail->changes[idx];
+        extendWithTail(m_signals.back(), m_sampleCount, changes.data(), changes.data() + changes.size());
+        emit dataChanged();
+        return static_cast<int>(m_signals.size()) - 1;
+    }
 
-    // Ensure sampleCount is consistent
-    if (static_cast<int>(src.values.size()) != m_sampleCount)
+    // Ensure sampleCount is consistent (procedural clocks have no samples of their own)
+    if (!src.isDerived() && src.sampleCount() != m_sampleCount)
     {
-        m_sampleCount = static_cast<int>(src.values.size());
+        m_sampleCount = src.sampleCount();
         resizeSignals(m_sampleCount);
     }
 
@@ -321,6 +445,7 @@ bool WaveDocument::loadFromFile(const QString &fileName)
 
 void WaveDocument::copySignal(int signalIndex)
 {
+    WP_TRACE_SCOPE("core", "WaveDocument::copySignal");
     if (signalIndex < 0 || signalIndex >= static_cast<int>(m_signals.size()))
         return;
 
@@ -330,6 +455,7 @@ void WaveDocument::copySignal(int signalIndex)
 
 int WaveDocument::pasteSignal(int destIndex)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::pasteSignal", &m_lastMutationNs);
     pushUndoSnapshot();
     if (!m_hasClipboardSignal)
         return -1;
@@ -358,6 +484,7 @@ int WaveDocument::pasteSignal(int destIndex)
 }
 void WaveDocument::removeSignal(int signalIndex)
 {
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::removeSignal", &m_lastMutationNs);
     int n = static_cast<int>(m_signals.size());
     if (signalIndex < 0 || signalIndex >= n)
         return;
@@ -44,25 +44,102 @@
 //======================================================================
 
 #include "core/core.h"
+#include "core/VcdLibrary.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+using BufferSet = std::unordered_set<const void *>;
+
+void markBuffers(BufferSet &seen, const Signal &s)
+{
+    seen.insert(s.values.bufferId());
+    seen.insert(s.labels.bufferId());
+    seen.insert(s.bits.bufferId());
+    seen.insert(s.starts.bufferId());
+}
+
+// Bytes of the buffers not in `seen` (held by a newer state), which are
+// added to it
+qint64 unseenBufferBytes(const std::vector<Signal> &sigs, BufferSet &seen)
+{
+    qint64 bytes = 0;
+    for (const Signal &s : sigs) {
+        // Frozen buffers belong to a VCD library, charged as a whole
+        if (!s.values.isFrozen() && seen.insert(s.values.bufferId()).second)
+            bytes += s.values.bufferBytes();
+        if (!s.labels.isFrozen() && seen.insert(s.labels.bufferId()).second)
+            bytes += s.labels.bufferBytes();
+        if (!s.bits.isFrozen() && seen.insert(s.bits.bufferId()).second)
+            bytes += s.bits.bufferBytes();
+        if (seen.insert(s.starts.bufferId()).second)
+            bytes += s.starts.bufferBytes();
+    }
+    return bytes;
+}
+
+} // namespace
+
+qint64 WaveDocument::Snapshot::overhead() const
+{
+    return sizeof(Snapshot) +
+           static_cast<qint64>(m_signals.capacity()) * sizeof(Signal) +
+           static_cast<qint64>(m_markers.capacity()) * sizeof(Marker) +
+           static_cast<qint64>(m_arrows.capacity()) * sizeof(Arrow);
+}
+
+qint64 WaveDocument::Snapshot::charge(std::unordered_set<const void *> &seen)
+{
+    bytes = overhead() + unseenBufferBytes(m_signals, seen);
+    // A library replaced by a later import lives on in the snapshots only
+    if (m_vcdLibrary && seen.insert(m_vcdLibrary.get()).second)
+        bytes += m_vcdLibrary->bytes();
+    return bytes;
+}
+
+void WaveDocument::markLiveBuffers(std::unordered_set<const void *> &seen) const
+{
+    for (const Signal &s : m_signals)
+        markBuffers(seen, s);
+    if (m_hasClipboardSignal)
+        markBuffers(seen, m_clipboardSignal);
+    if (m_vcdLibrary)
+        seen.insert(m_vcdLibrary.get());   // counted in MemoryStats::vcdLibrary
+}
 
 void WaveDocument::pushUndoSnapshot()
 {
+    WP_TRACE_SCOPE("undo", "WaveDocument::pushUndoSnapshot");
+
+    // The previous step's charge is final from here on: later edits only
+    // detach buffers the new snapshot also holds
+    settleNewestUndoStep();
+
     Snapshot snap;
     snap.sampleCount   = m_sampleCount;
     snap.m_signals     = m_signals;
-    snap.m_vcdSignals  = m_vcdSignals;
+    snap.m_vcdLibrary  = m_vcdLibrary;
+    snap.m_vcdTail     = m_vcdTail;
     snap.m_markers     = m_markers;
     snap.m_nextMarkerId= m_nextMarkerId;
     snap.m_arrows      = m_arrows;
     snap.m_nextArrowId = m_nextArrowId;
 
+    // Comparte los buffers con el documento: de momento solo cuesta su
+    // estructura; lo que la edición siguiente desacopla se le suma después
+    // (chargeReleasedBuffers)
+    snap.bytes = snap.overhead();
+    m_undoBytes += snap.bytes;
     m_undoStack.push_back(std::move(snap));
-    if ((int)m_undoStack.size() > m_maxUndoSteps) {
-        m_undoStack.erase(m_undoStack.begin());
-    }
+    m_releasedMark = CowStats::releasedBytes();
+    m_chargedLibrary = m_vcdLibrary.get();
 
     // Cada vez que hay un punto de undo nuevo, el redo se limpia
     m_redoStack.clear();
+    m_redoBytes = 0;
 
     emit undoRedoStateChanged();
 }
@@ -71,9 +148,97 @@ void WaveDocument::clearHistory()
 {
     m_undoStack.clear();
     m_redoStack.clear();
+    m_undoBytes = 0;
+    m_redoBytes = 0;
+    m_releasedMark = CowStats::releasedBytes();
+    m_chargedLibrary = m_vcdLibrary.get();
     emit undoRedoStateChanged();
 }
 
+void WaveDocument::setUndoBudget(qint64 bytes)
+{
+    m_undoBudget = std::max<qint64>(0, bytes);
+    updateHistoryBytes();
+    trimHistory();
+    emit undoRedoStateChanged();
+}
+
+void WaveDocument::updateHistoryBytes()
+{
+    WP_TRACE_SCOPE("undo", "WaveDocument::updateHistoryBytes");
+
+    // Each shared buffer is charged once, to the newest state holding it:
+    // first the live document, then undo (newest first), then redo (nearest
+    // first). Evicting the oldest entry therefore frees exactly its charge.
+    // O(history x signals): only on undo, redo and budget changes.
+    BufferSet seen;
+    markLiveBuffers(seen);
+
+    m_undoBytes = 0;
+    for (auto it = m_undoStack.rbegin(); it != m_undoStack.rend(); ++it)
+        m_undoBytes += it->charge(seen);
+    m_redoBytes = 0;
+    for (auto it = m_redoStack.rbegin(); it != m_redoStack.rend(); ++it)
+        m_redoBytes += it->charge(seen);
+    m_releasedMark = CowStats::releasedBytes();
+    m_chargedLibrary = m_vcdLibrary.get();
+}
+
+void WaveDocument::settleNewestUndoStep()
+{
+    // Exact charge of the newest step: the buffers the live document (or the
+    // clipboard) no longer holds. Older steps keep theirs; anything they
+    // share with the live document, the newest step holds too.
+    if (m_undoStack.empty())
+        return;
+    WP_TRACE_SCOPE("undo", "WaveDocument::settleNewestUndoStep");
+    BufferSet seen;
+    markLiveBuffers(seen);
+    Snapshot &top = m_undoStack.back();
+    m_undoBytes -= top.bytes;
+    m_undoBytes += top.charge(seen);
+    m_chargedLibrary = m_vcdLibrary.get();
+}
+
+void WaveDocument::chargeReleasedBuffers()
+{
+    // O(1) per edit: what the edit detached from the shared buffers goes to
+    // the newest step, until pushUndoSnapshot() settles it. An upper bound:
+    // the counter also sees copies that are not document rows
+    // An import replaced the library: the newest step may now be the only
+    // holder of the previous one
+    if (m_vcdLibrary.get() != m_chargedLibrary)
+        settleNewestUndoStep();
+    m_chargedLibrary = m_vcdLibrary.get();
+
+    const qint64 released = CowStats::releasedBytes() - m_releasedMark;
+    m_releasedMark = CowStats::releasedBytes();
+    if (released <= 0 || m_undoStack.empty())
+        return;
+    m_undoStack.back().bytes += released;
+    m_undoBytes += released;
+}
+
+void WaveDocument::trimHistory()
+{
+    // Primero los pasos de undo más antiguos, luego los redo más lejanos.
+    // Siempre se conserva el último paso de undo para que Ctrl+Z funcione
+    // aunque un único snapshot supere el presupuesto.
+    // The released-bytes estimate of the newest step also counts detaches of
+    // temporaries on this thread: nothing is evicted on it, only on its exact
+    // charge.
+    if (m_undoBytes + m_redoBytes > m_undoBudget)
+        settleNewestUndoStep();
+    while (m_undoBytes + m_redoBytes > m_undoBudget && m_undoStack.size() > 1) {
+        m_undoBytes -= m_undoStack.front().bytes;
+        m_undoStack.pop_front();
+    }
+    while (m_undoBytes + m_redoBytes > m_undoBudget && !m_redoStack.empty()) {
+        m_redoBytes -= m_redoStack.front().bytes;
+        m_redoStack.pop_front();
+    }
+}
+
 bool WaveDocument::canUndo() const
 {
     return !m_undoStack.empty();
@@ -86,6 +251,7 @@ bool WaveDocument::canRedo() const
 
 void WaveDocument::undo()
 {
+    WP_TRACE_SCOPE_TIMED("undo", "WaveDocument::undo", &m_lastMutationNs);
     if (m_undoStack.empty())
         return;
 
@@ -93,7 +259,8 @@ void WaveDocument::undo()
     Snapshot cur;
     cur.sampleCount   = m_sampleCount;
     cur.m_signals     = m_signals;
-    cur.m_vcdSignals  = m_vcdSignals;
+    cur.m_vcdLibrary  = m_vcdLibrary;
+    cur.m_vcdTail     = m_vcdTail;
     cur.m_markers     = m_markers;
     cur.m_nextMarkerId= m_nextMarkerId;
     cur.m_arrows      = m_arrows;
@@ -106,18 +273,23 @@ void WaveDocument::undo()
 
     m_sampleCount   = snap.sampleCount;
     m_signals       = std::move(snap.m_signals);
-    m_vcdSignals    = std::move(snap.m_vcdSignals);
+    m_vcdLibrary    = std::move(snap.m_vcdLibrary);
+    m_vcdTail       = std::move(snap.m_vcdTail);
     m_markers       = std::move(snap.m_markers);
     m_nextMarkerId  = snap.m_nextMarkerId;
     m_arrows        = std::move(snap.m_arrows);
     m_nextArrowId   = snap.m_nextArrowId;
 
+    // Buffers move between the live state and the stacks: recount
+    updateHistoryBytes();
+
     emit dataChanged();
     emit undoRedoStateChanged();
 }
 
 void WaveDocument::redo()
 {
+    WP_TRACE_SCOPE_TIMED("undo", "WaveDocument::redo", &m_lastMutationNs);
     if (m_redoStack.empty())
         return;
 
@@ -125,7 +297,8 @@ void WaveDocument::redo()
     Snapshot cur;
     cur.sampleCount   = m_sampleCount;
     cur.m_signals     = m_signals;
-    cur.m_vcdSignals  = m_vcdSignals;
+    cur.m_vcdLibrary  = m_vcdLibrary;
+    cur.m_vcdTail     = m_vcdTail;
     cur.m_markers     = m_markers;
     cur.m_nextMarkerId= m_nextMarkerId;
     cur.m_arrows      = m_arrows;
@@ -138,12 +311,16 @@ void WaveDocument::redo()
 
     m_sampleCount   = snap.sampleCount;
     m_signals       = std::move(snap.m_signals);
-    m_vcdSignals    = std::move(snap.m_vcdSignals);
+    m_vcdLibrary    = std::move(snap.m_vcdLibrary);
+    m_vcdTail       = std::move(snap.m_vcdTail);
     m_markers       = std::move(snap.m_markers);
     m_nextMarkerId  = snap.m_nextMarkerId;
     m_arrows        = std::move(snap.m_arrows);
     m_nextArrowId   = snap.m_nextArrowId;
 
+    // Buffers move between the live state and the stacks: recount
+    updateHistoryBytes();
+
     emit dataChanged();
     emit undoRedoStateChanged();
 }
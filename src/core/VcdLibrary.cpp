@@ -0,0 +1,214 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdLibrary.cpp
+// Description:   Immutable, shared library of signals imported from a VCD file.
+//======================================================================
+
+#include "core/VcdLibrary.h"
+#include "core/NameIndex.h"
+
+#include <QPair>
+#include <QStringList>
+#include <algorithm>
+
+VcdLibrary::VcdLibrary(std::vector<Signal> sigs, VcdTiming timing, std::unique_ptr<VcdSignalSource> source)
+    : m_signals(std::move(sigs)),
+      m_timing(std::move(timing)),
+      m_source(std::move(source))
+{
+    m_signals.shrink_to_fit();
+    qint64 bytes = sizeof(VcdLibrary)
+                 + static_cast<qint64>(m_timing.sampleTimes.capacity() * sizeof(qint64))
+                 + static_cast<qint64>(m_timing.clocks.capacity() * sizeof(ClockInfo))
+                 + static_cast<qint64>(m_timing.glitches.capacity() * sizeof(VcdGlitch));
+    for (Signal &s : m_signals) {
+        // Views share these buffers; they detach on their first edit
+        s.values.freeze();
+        s.labels.freeze();
+        s.bits.freeze();
+        bytes += WaveDocument::signalBytes(s);
+    }
+    m_bytes = bytes;
+
+    if (m_source) {
+        m_loaded.reset(new std::atomic<bool>[m_signals.size()]);
+        for (size_t i = 0; i < m_signals.size(); ++i)
+            m_loaded[i].store(false, std::memory_order_relaxed);
+    }
+
+    buildIndex();
+}
+
+VcdLibrary::~VcdLibrary() = default;
+
+const SignalNameIndex &VcdLibrary::nameIndex() const
+{
+    std::call_once(m_nameIndexOnce, [this]() {
+        m_nameIndex = std::make_unique<SignalNameIndex>(m_signals);
+    });
+    return *m_nameIndex;
+}
+
+void VcdLibrary::buildIndex()
+{
+    m_nameToIndex.reserve(static_cast<int>(m_signals.size()));
+    m_scopes.clear();
+    m_scopes.emplace_back();   // root
+
+    // (parent scope, name) -> scope id, only needed while building
+    QHash<QPair<int, QString>, int> childByName;
+
+    for (int i = 0; i < static_cast<int>(m_signals.size()); ++i) {
+        const QString &fullName = m_signals[i].name;
+        if (!m_nameToIndex.contains(fullName))   // first declaration wins
+            m_nameToIndex.insert(fullName, i);
+
+        const QStringList parts = fullName.split('.');
+        int scopeId = kRootScope;
+        for (int p = 0; p + 1 < parts.size(); ++p) {
+            const QPair<int, QString> key(scopeId, parts[p]);
+            int childId = childByName.value(key, -1);
+            if (childId < 0) {
+                Scope sc;
+                sc.name = parts[p];
+                sc.parent = scopeId;
+                sc.row = static_cast<int>(m_scopes[scopeId].children.size());
+                childId = static_cast<int>(m_scopes.size());
+                m_scopes.push_back(std::move(sc));
+                m_scopes[scopeId].children.push_back(childId);
+                childByName.insert(key, childId);
+            }
+            scopeId = childId;
+        }
+        m_scopes[scopeId].signalIds.push_back(i);
+    }
+}
+
+const ClockInfo &VcdLibrary::clockInfo(int signalIndex) const
+{
+    static const ClockInfo none;
+    if (signalIndex < 0 || signalIndex >= static_cast<int>(m_timing.clocks.size()))
+        return none;
+    return m_timing.clocks[signalIndex];
+}
+
+QString VcdLibrary::clockLabel(int signalIndex) const
+{
+    const ClockInfo &c = clockInfo(signalIndex);
+    if (!c.isClock || c.period <= 0)
+        return QString();
+    if (m_timing.timescale > 0.0)
+        return formatFrequency(1.0 / (double(c.period) * m_timing.timescale));
+    return QString("period %1").arg(c.period);
+}
+
+std::vector<VcdGlitch> VcdLibrary::zeroWidthGlitches(int signalIndex) const
+{
+    const auto range = std::equal_range(
+        m_timing.glitches.begin(), m_timing.glitches.end(), VcdGlitch{signalIndex, 0, 0},
+        [](const VcdGlitch &a, const VcdGlitch &b) { return a.signal < b.signal; });
+    return std::vector<VcdGlitch>(range.first, range.second);
+}
+
+int VcdLibrary::findScope(const QString &path) const
+{
+    int scopeId = kRootScope;
+    for (const QString &part : path.split('.', Qt::SkipEmptyParts)) {
+        int found = -1;
+        for (int child : m_scopes[scopeId].children) {
+            if (m_scopes[child].name == part) {
+                found = child;
+                break;
+            }
+        }
+        if (found < 0)
+            return -1;
+        scopeId = found;
+    }
+    return scopeId;
+}
+
+std::vector<int> VcdLibrary::signalsUnder(int scopeId) const
+{
+    std::vector<int> ids;
+    std::vector<int> pending{scopeId};
+    while (!pending.empty()) {
+        const Scope &sc = m_scopes[pending.back()];
+        pending.pop_back();
+        ids.insert(ids.end(), sc.signalIds.begin(), sc.signalIds.end());
+        pending.insert(pending.end(), sc.children.rbegin(), sc.children.rend());
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+QString VcdLibrary::scopePath(int scopeId) const
+{
+    QStringList chain;
+    for (int id = scopeId; id > kRootScope; id = m_scopes[id].parent)
+        chain.prepend(m_scopes[id].name);
+    return chain.join('.');
+}
+
+void VcdLibrary::preload(const std::vector<int> &indices) const
+{
+    if (m_source)
+        loadSignals(indices);
+}
+
+void VcdLibrary::preloadAll() const
+{
+    if (!m_source)
+        return;
+    std::vector<int> all(m_signals.size());
+    for (int i = 0; i < static_cast<int>(all.size()); ++i)
+        all[i] = i;
+    loadSignals(all);
+}
+
+void VcdLibrary::loadSignals(const std::vector<int> &indices) const
+{
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+    std::vector<int> missing;
+    for (int i : indices) {
+        if (!m_loaded[i].load(std::memory_order_relaxed))
+            missing.push_back(i);
+    }
+    if (missing.empty())
+        return;
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+    std::vector<Signal *> targets;
+    targets.reserve(missing.size());
+    for (int i : missing)
+        targets.push_back(&m_signals[i]);
+
+    m_source->load(missing, targets);
+    for (Signal *s : targets) {
+        s->values.freeze();
+        s->labels.freeze();
+        s->bits.freeze();
+        m_bytes += WaveDocument::signalBytes(*s);
+    }
+    // Published after the samples: at() on another thread sees them complete
+    for (int i : missing)
+        m_loaded[i].store(true, std::memory_order_release);
+}
+
+QString VcdLibrary::leafName(int signalIndex) const
+{
+    const QString &fullName = m_signals[signalIndex].name;
+    return fullName.mid(fullName.lastIndexOf('.') + 1);
+}
@@ -0,0 +1,178 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdLibrary.h
+// Description:   Immutable, shared library of signals imported from a VCD file.
+//======================================================================
+
+#ifndef VCDLIBRARY_H
+#define VCDLIBRARY_H
+
+#include "core/core.h"
+#include "core/Clock.h"
+
+#include <QHash>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class SignalNameIndex;
+
+// A signal that changed more than once at one VCD timestamp. The import
+// keeps the last value per sample; `value` is the one overwritten.
+struct VcdGlitch
+{
+    int signal;
+    int sample;
+    int value;
+};
+
+// Time base of an imported dump. Samples are the distinct VCD timestamps,
+// so the time between two samples varies.
+struct VcdTiming
+{
+    double timescale = 0.0;               // seconds per VCD time unit, 0 = unknown
+    std::vector<qint64> sampleTimes;      // VCD time of every sample
+    std::vector<ClockInfo> clocks;        // per library signal (empty = not analysed)
+    std::vector<VcdGlitch> glitches;      // zero-width glitches, by signal then sample
+};
+
+// A value change of a library signal parsed after the import, while the
+// dump is still being written (follow mode, VcdFollower)
+struct VcdTailChange
+{
+    int signal;        // library index
+    int sample;
+    int value;
+    QString label;     // "[N bits]" for vectors too wide for an int
+};
+
+// Samples appended to an imported dump. The library stays immutable: the
+// document extends its visible rows with these changes, and library rows
+// added later get them too (WaveDocument::appendVcdTail()).
+struct VcdTail
+{
+    const VcdLibrary *library = nullptr;               // the library it extends
+    int sampleCount = 0;                               // library + tail samples
+    std::vector<qint64> sampleTimes;                   // VCD time of the samples after the library's
+    std::vector<std::vector<VcdTailChange>> changes;   // per library signal, by sample
+};
+
+// Decodes the samples of library signals on first use, for formats that can
+// read one signal without the others (FST, see FstReader). The library calls
+// load() with its load lock held, for signals it has not loaded yet.
+class VcdSignalSource
+{
+public:
+    virtual ~VcdSignalSource() = default;
+
+    // Fills the samples (bits, or values and labels) of targets[k], library
+    // signal indices[k]; the name and type are already set
+    virtual void load(const std::vector<int> &indices, const std::vector<Signal *> &targets) = 0;
+};
+
+// Signals imported from a VCD file. Nothing edits them after the import, so
+// the library is immutable and shared (VcdLibraryPtr) between the document,
+// every undo/redo snapshot and any other view of the same file; a snapshot
+// costs one reference count instead of a copy of the whole dump.
+//
+// The constructor also indexes the names once: a hash for full-name lookup
+// and a scope trie ("top.cpu.alu" -> scopes top / cpu / alu) with the child
+// scopes and signals of every scope, so browsing costs O(children).
+//
+// With a VcdSignalSource the signals start with their name and type only;
+// at() decodes one on first access and preload() decodes many in one pass.
+// Code that only needs names uses nameAt(), which never decodes.
+class VcdLibrary
+{
+public:
+    struct Scope
+    {
+        QString name;                 // last path component ("" for the root)
+        int parent = -1;
+        int row = 0;                  // position in the parent's children
+        std::vector<int> children;    // child scope ids, in declaration order
+        std::vector<int> signalIds;   // indices into signalList()
+    };
+
+    static constexpr int kRootScope = 0;
+
+    explicit VcdLibrary(std::vector<Signal> sigs, VcdTiming timing = VcdTiming(),
+                        std::unique_ptr<VcdSignalSource> source = nullptr);
+    ~VcdLibrary();
+
+    // Signals not loaded yet from a source have no samples here
+    const std::vector<Signal> &signalList() const { return m_signals; }
+    int size() const { return static_cast<int>(m_signals.size()); }
+    const Signal &at(int index) const
+    {
+        if (m_source && !m_loaded[index].load(std::memory_order_acquire))
+            loadSignals({index});
+        return m_signals[index];
+    }
+    const QString &nameAt(int index) const { return m_signals[index].name; }
+
+    // Samples decoded lazily (VcdSignalSource); no-ops otherwise
+    bool isLazy() const { return m_source != nullptr; }
+    void preload(const std::vector<int> &indices) const;
+    void preloadAll() const;
+
+    // -1 if there is no signal with that full name
+    int indexOf(const QString &fullName) const { return m_nameToIndex.value(fullName, -1); }
+
+    const Scope &scope(int scopeId) const { return m_scopes[scopeId]; }
+    int scopeCount() const { return static_cast<int>(m_scopes.size()); }
+    QString scopePath(int scopeId) const;      // "top.cpu.alu"
+    QString leafName(int signalIndex) const;   // name without its scope path
+
+    const VcdTiming &timing() const { return m_timing; }
+    // Clock analysis of a signal; isClock is false when not analysed
+    const ClockInfo &clockInfo(int signalIndex) const;
+    // "100 MHz" (or the period in time units without a timescale), "" if not a clock
+    QString clockLabel(int signalIndex) const;
+    // Zero-width glitches of one signal, by sample
+    std::vector<VcdGlitch> zeroWidthGlitches(int signalIndex) const;
+
+    // Scope id of "top.cpu" (-1 if unknown, kRootScope for ""), and every
+    // signal declared in a scope or below it
+    int findScope(const QString &path) const;
+    std::vector<int> signalsUnder(int scopeId) const;
+
+    // Trigram index over the full names, built on first use (thread-safe)
+    const SignalNameIndex &nameIndex() const;
+
+    // Footprint of the library: computed at construction, grows as lazy
+    // signals are loaded
+    qint64 bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+private:
+    mutable std::vector<Signal> m_signals;   // lazy ones are filled in once, under m_loadMutex
+    VcdTiming           m_timing;
+    std::vector<Scope>  m_scopes;
+    QHash<QString, int> m_nameToIndex;
+    mutable std::atomic<qint64> m_bytes{0};
+
+    std::unique_ptr<VcdSignalSource> m_source;
+    std::unique_ptr<std::atomic<bool>[]> m_loaded;
+    mutable std::mutex m_loadMutex;
+
+    mutable std::once_flag m_nameIndexOnce;
+    mutable std::unique_ptr<SignalNameIndex> m_nameIndex;
+
+    void buildIndex();
+    void loadSignals(const std::vector<int> &indices) const;
+};
+
+#endif // VCDLIBRARY_H
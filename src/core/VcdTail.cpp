@@ -0,0 +1,117 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdTail.cpp
+// Description:   Samples appended to an imported VCD while it is followed.
+//======================================================================
+
+#include "core/core.h"
+#include "core/VcdLibrary.h"
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+
+const VcdTail *WaveDocument::vcdTail() const
+{
+    // An undo step may bring back another library; its tail is gone
+    if (!m_vcdTail || !m_vcdLibrary || m_vcdTail->library != m_vcdLibrary.get())
+        return nullptr;
+    return m_vcdTail.get();
+}
+
+void WaveDocument::extendWithTail(Signal &sig, int sampleCount,
+                                  const VcdTailChange *first, const VcdTailChange *last)
+{
+    if (sig.isDerived())
+        return; // no storage (procedural clocks of the dump are stored first by the callers)
+    const int oldCount = sig.sampleCount();
+    const int hold = sig.valueAt(oldCount - 1);
+    last = std::lower_bound(first, last, sampleCount,
+                            [](const VcdTailChange &c, int t) { return c.sample < t; });
+
+    if (sig.isPacked()) {
+        if (sampleCount > oldCount) {
+            sig.bits.resize(sampleCount);
+            sig.bits.fill(oldCount, sampleCount, hold);
+        }
+        for (const VcdTailChange *c = first; c != last; ++c)
+            sig.bits.fill(c->sample, (c + 1 != last) ? c[1].sample : sampleCount, c->value);
+        return;
+    }
+
+    if (sampleCount > oldCount) {
+        sig.values.resize(sampleCount, hold);
+        sig.labels.resize(sampleCount);
+    }
+    if (first == last)
+        return;
+    std::vector<int> &values = sig.values.mut();
+    std::vector<QString> &labels = sig.labels.mut();
+    for (const VcdTailChange *c = first; c != last; ++c) {
+        const int end = (c + 1 != last) ? c[1].sample : sampleCount;
+        std::fill(values.begin() + c->sample, values.begin() + end, c->value);
+        labels[c->sample] = c->label;
+    }
+}
+
+void WaveDocument::appendVcdTail(int sampleCount, const std::vector<qint64> &sampleTimes,
+                                 std::vector<VcdTailChange> changes)
+{
+    WP_TRACE_SCOPE_TIMED("core", "WaveDocument::appendVcdTail", &m_lastMutationNs);
+    if (!m_vcdLibrary || sampleCount < m_sampleCount)
+        return;
+
+    if (!vcdTail()) {
+        m_vcdTail = std::make_shared<VcdTail>();
+        m_vcdTail->library = m_vcdLibrary.get();
+        m_vcdTail->sampleCount = m_sampleCount;
+        m_vcdTail->changes.resize(m_vcdLibrary->size());
+    } else if (m_vcdTail.use_count() > 1) {
+        // An undo step holds the tail as it was when it was taken (its rows
+        // end there): append to a copy
+        m_vcdTail = std::make_shared<VcdTail>(*m_vcdTail);
+    }
+    VcdTail &tail = *m_vcdTail;
+
+    // Grouped per signal, still by sample within each one
+    const auto bySignal = [](const VcdTailChange &a, const VcdTailChange &b) { return a.signal < b.signal; };
+    std::stable_sort(changes.begin(), changes.end(), bySignal);
+
+    // Only the visible rows are touched: O(rows + new samples), not O(library)
+    for (Signal &sig : m_signals) {
+        const int idx = m_vcdLibrary->indexOf(sig.name);
+        if (idx < 0) {
+            // Drawn by hand: the last value holds
+            extendWithTail(sig, sampleCount, nullptr, nullptr);
+            continue;
+        }
+        // A procedural clock is X past the sample count it was imported with;
+        // stored, it continues with the appended changes of its variable
+        materializeClock(sig);
+        const auto range = std::equal_range(changes.begin(), changes.end(), VcdTailChange{idx, 0, 0, QString()}, bySignal);
+        extendWithTail(sig, sampleCount, changes.data() + (range.first - changes.begin()),
+                       changes.data() + (range.second - changes.begin()));
+    }
+
+    for (VcdTailChange &c : changes) {
+        if (c.signal >= 0 && c.signal < static_cast<int>(tail.changes.size()))
+            tail.changes[c.signal].push_back(std::move(c));
+    }
+    tail.sampleTimes.insert(tail.sampleTimes.end(), sampleTimes.begin(), sampleTimes.end());
+    tail.sampleCount = sampleCount;
+    m_sampleCount = sampleCount;
+
+    emit dataChanged();
+}
@@ -0,0 +1,245 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          WaveDiff.cpp
+// Description:   Parallel merge-walk diff of two waveforms.
+//======================================================================
+
+#include "core/WaveDiff.h"
+#include "core/VcdLibrary.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <QHash>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+
+// Runs of one signal with their start moved to the compared axis
+std::vector<ValueRun> runsOf(const Signal &sig, const DiffSide &side, const SignalExpr::Resolver &resolve,
+                             std::vector<qint64> &starts, bool timeAxis, qint64 unit)
+{
+    std::vector<ValueRun> runs = signalRuns(sig, 0, side.sampleCount, resolve);
+    starts.resize(runs.size());
+    for (size_t i = 0; i < runs.size(); ++i)
+        starts[i] = timeAxis ? (*side.times)[runs[i].start] * unit : runs[i].start;
+    return runs;
+}
+
+qint64 axisEnd(const DiffSide &side, bool timeAxis, qint64 unit)
+{
+    if (!timeAxis)
+        return side.sampleCount;
+    // The last sample lasts one unit of the axis
+    return side.sampleCount > 0 ? (*side.times)[side.sampleCount - 1] * unit + 1 : 0;
+}
+
+// Axis units per time unit of each side so that both dumps share the finer
+// timescale; false when that is not possible (unknown timescale on one side,
+// a ratio that is not a whole number, or times that would overflow)
+bool commonUnit(const DiffSide &a, const DiffSide &b, qint64 *unitA, qint64 *unitB)
+{
+    *unitA = 1;
+    *unitB = 1;
+    const double tsA = a.timescale();
+    const double tsB = b.timescale();
+    if (tsA == tsB)
+        return true;   // same unit, or both unknown: times are taken as they are
+    if (tsA <= 0.0 || tsB <= 0.0)
+        return false;
+
+    const bool aCoarser = tsA > tsB;
+    const double ratio = aCoarser ? tsA / tsB : tsB / tsA;
+    const double whole = std::round(ratio);
+    if (std::fabs(ratio - whole) > 1e-6 * whole)
+        return false;
+    if (std::fabs(ratio - 1.0) < 1e-9)
+        return true;   // the same timescale written differently
+
+    const qint64 unit = static_cast<qint64>(whole);
+    const DiffSide &coarse = aCoarser ? a : b;
+    const qint64 last = coarse.sampleCount > 0 ? (*coarse.times)[coarse.sampleCount - 1] + 1 : 0;
+    if (last > LLONG_MAX / unit)
+        return false;
+    *(aCoarser ? unitA : unitB) = unit;
+    return true;
+}
+
+void diffPair(const Signal &sa, const Signal &sb, const DiffSide &a, const DiffSide &b,
+              const SignalExpr::Resolver &resolveA, const SignalExpr::Resolver &resolveB,
+              const WaveDiffResult &res, qint64 end, SignalDiff &out)
+{
+    std::vector<qint64> startsA, startsB;
+    const std::vector<ValueRun> runsA = runsOf(sa, a, resolveA, startsA, res.timeAxis, res.unitA);
+    const std::vector<ValueRun> runsB = runsOf(sb, b, resolveB, startsB, res.timeAxis, res.unitB);
+
+    // Both lists start at 0; walk the union of their change positions
+    size_t i = 0, j = 0;
+    qint64 pos = 0;
+    while (pos < end && i < runsA.size() && j < runsB.size()) {
+        const qint64 nextA = i + 1 < runsA.size() ? startsA[i + 1] : end;
+        const qint64 nextB = j + 1 < runsB.size() ? startsB[j + 1] : end;
+        const qint64 next = std::min({nextA, nextB, end});
+        if (runsA[i].value != runsB[j].value && next > pos) {
+            if (!out.mismatches.empty() && out.mismatches.back().end == pos)
+                out.mismatches.back().end = next;
+            else
+                out.mismatches.push_back({pos, next});
+            out.mismatchLength += next - pos;
+        }
+        pos = next;
+        if (nextA == next)
+            ++i;
+        if (nextB == next)
+            ++j;
+    }
+}
+
+} // namespace
+
+DiffSide DiffSide::fromDocument(const WaveDocument &doc)
+{
+    return fromSnapshot(doc.signalList(), doc.sampleCount(), doc.vcdLibrary());
+}
+
+DiffSide DiffSide::fromSnapshot(std::vector<Signal> visible, int sampleCount, VcdLibraryPtr library)
+{
+    DiffSide side;
+    side.visible = std::move(visible);
+    side.sampleCount = sampleCount;
+    side.library = std::move(library);
+
+    if (side.library) {
+        side.library->preloadAll();   // every signal is compared
+        side.sigs = side.library->signalList();
+        side.sampleCount = static_cast<int>(side.library->timing().sampleTimes.size());
+        if (side.sampleCount > 0)
+            side.times = &side.library->timing().sampleTimes;
+        // Visible rows carry the edits made since import. After a cut they
+        // no longer start at the first VCD sample, so the library rows stay.
+        const bool aligned = (sampleCount == side.sampleCount);
+        for (const Signal &s : side.visible) {
+            const int index = side.library->indexOf(s.name);
+            if (index < 0)
+                side.sigs.push_back(s);
+            else if (aligned)
+                side.sigs[index] = s;
+        }
+    } else {
+        side.sigs = side.visible;
+    }
+    return side;
+}
+
+double DiffSide::timescale() const
+{
+    return (library && times) ? library->timing().timescale : 0.0;
+}
+
+int DiffSide::sampleAt(qint64 pos, bool timeAxis, qint64 unit) const
+{
+    if (!timeAxis)
+        return static_cast<int>(std::min<qint64>(pos, sampleCount));
+    const auto it = std::upper_bound(times->begin(), times->begin() + sampleCount, pos / unit);
+    return std::max(0, static_cast<int>(it - times->begin()) - 1);
+}
+
+WaveDiffResult diffWaveforms(const DiffSide &a, const DiffSide &b)
+{
+    WP_TRACE_SCOPE("core", "diffWaveforms");
+    const qint64 startNs = Tracer::nowNs();
+
+    WaveDiffResult result;
+    if (a.times && b.times) {
+        result.timeAxis = commonUnit(a, b, &result.unitA, &result.unitB);
+        result.timescaleMismatch = !result.timeAxis;
+        if (result.timeAxis)
+            result.timescale = std::min(a.timescale(), b.timescale());
+    }
+    result.endA = axisEnd(a, result.timeAxis, result.unitA);
+    result.endB = axisEnd(b, result.timeAxis, result.unitB);
+    const qint64 end = std::min(result.endA, result.endB);
+
+    // Match by name; the first declaration wins, as in the VCD library
+    QHash<QString, int> byNameB;
+    byNameB.reserve(static_cast<int>(b.sigs.size()));
+    for (int i = 0; i < static_cast<int>(b.sigs.size()); ++i) {
+        if (!byNameB.contains(b.sigs[i].name))
+            byNameB.insert(b.sigs[i].name, i);
+    }
+
+    std::vector<SignalDiff> pairs;
+    std::vector<char> usedB(b.sigs.size(), 0);
+    QHash<QString, int> seenA;
+    for (int i = 0; i < static_cast<int>(a.sigs.size()); ++i) {
+        const QString &name = a.sigs[i].name;
+        if (seenA.contains(name))
+            continue;
+        seenA.insert(name, i);
+        const int j = byNameB.value(name, -1);
+        if (j < 0) {
+            result.onlyInA.append(name);
+            continue;
+        }
+        usedB[j] = 1;
+        SignalDiff d;
+        d.name = name;
+        d.indexA = i;
+        d.indexB = j;
+        d.typeMismatch = a.sigs[i].type != b.sigs[j].type;
+        pairs.push_back(std::move(d));
+    }
+    for (int j = 0; j < static_cast<int>(b.sigs.size()); ++j) {
+        if (!usedB[j] && byNameB.value(b.sigs[j].name) == j)
+            result.onlyInB.append(b.sigs[j].name);
+    }
+    result.matched = static_cast<int>(pairs.size());
+
+    const SignalExpr::Resolver resolveA = resolverFor(a.visible);
+    const SignalExpr::Resolver resolveB = resolverFor(b.visible);
+    parallelFor(static_cast<int>(pairs.size()), [&](int k) {
+        SignalDiff &d = pairs[k];
+        diffPair(a.sigs[d.indexA], b.sigs[d.indexB], a, b, resolveA, resolveB, result, end, d);
+    });
+
+    for (SignalDiff &d : pairs) {
+        if (!d.mismatches.empty())
+            result.differing.push_back(std::move(d));
+    }
+    std::stable_sort(result.differing.begin(), result.differing.end(),
+                     [](const SignalDiff &x, const SignalDiff &y) { return x.firstMismatch() < y.firstMismatch(); });
+
+    result.elapsedNs = Tracer::nowNs() - startNs;
+    return result;
+}
+
+std::vector<std::pair<int, int>> mismatchSamples(const SignalDiff &diff, const DiffSide &a,
+                                                 const WaveDiffResult &result)
+{
+    std::vector<std::pair<int, int>> ranges;
+    ranges.reserve(diff.mismatches.size());
+    for (const DiffInterval &iv : diff.mismatches) {
+        const int s = a.sampleAt(iv.start, result.timeAxis, result.unitA);
+        // First sample at or after the end, and at least the sample holding the start
+        int e = a.sampleAt(iv.end - 1, result.timeAxis, result.unitA) + 1;
+        e = std::max(e, s + 1);
+        if (!ranges.empty() && ranges.back().second >= s)
+            ranges.back().second = std::max(ranges.back().second, e);
+        else
+            ranges.emplace_back(s, e);
+    }
+    return ranges;
+}
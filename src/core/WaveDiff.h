@@ -0,0 +1,110 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          WaveDiff.h
+// Description:   Comparison of two waveforms matched by signal name.
+//======================================================================
+
+#ifndef WAVEDIFF_H
+#define WAVEDIFF_H
+
+#include <QStringList>
+#include <utility>
+#include <vector>
+#include "core/core.h"
+#include "core/DerivedSignal.h"
+
+// One side of a comparison: the signals of a document and, for VCD dumps,
+// the time of every sample. Signal buffers are shared copy-on-write, so a
+// side is a cheap snapshot that stays valid after the document changes.
+struct DiffSide
+{
+    std::vector<Signal> sigs;
+    int sampleCount = 0;
+    VcdLibraryPtr library;                       // keeps `times` alive
+    const std::vector<qint64> *times = nullptr;  // sample -> VCD time (nullptr = samples only)
+    std::vector<Signal> visible;                 // operands of derived signals
+
+    // Every signal of the VCD library, plus the visible signals that are
+    // not in it (derived rows, native documents). A visible row replaces the
+    // library row of the same name, so edits are compared, unless the
+    // document was cut and its samples no longer line up with the VCD times.
+    static DiffSide fromDocument(const WaveDocument &doc);
+
+    // The same from what fromDocument() reads of the document: cheap to take
+    // on the GUI thread, while this (which loads every lazy signal of the
+    // library) runs on a worker
+    static DiffSide fromSnapshot(std::vector<Signal> visible, int sampleCount, VcdLibraryPtr library);
+
+    // Seconds per VCD time unit (0 = unknown or not a dump)
+    double timescale() const;
+
+    // Sample of this side that holds position `pos` of the compared axis;
+    // `unit` is the number of axis units per VCD time unit of this side
+    int sampleAt(qint64 pos, bool timeAxis, qint64 unit = 1) const;
+};
+
+// [start, end) on the compared axis: VCD time when both sides have it (in
+// the finer of the two timescales), samples otherwise
+struct DiffInterval
+{
+    qint64 start;
+    qint64 end;
+};
+
+struct SignalDiff
+{
+    QString name;
+    int  indexA = -1;                   // in DiffSide::sigs
+    int  indexB = -1;
+    bool typeMismatch = false;          // Bit on one side, Vector on the other
+    std::vector<DiffInterval> mismatches;
+    qint64 mismatchLength = 0;          // sum of the interval lengths
+
+    qint64 firstMismatch() const { return mismatches.empty() ? -1 : mismatches.front().start; }
+};
+
+struct WaveDiffResult
+{
+    bool   timeAxis = false;
+    double timescale = 0.0;             // seconds per axis unit (time axis; 0 = unknown)
+    qint64 unitA = 1;                   // axis units per VCD time unit of each side
+    qint64 unitB = 1;
+    bool   timescaleMismatch = false;   // both dumps, but their times could not be
+                                        // brought to one unit: compared by sample
+    qint64 endA = 0;                    // length of each side on the axis;
+    qint64 endB = 0;                    // only [0, min(endA, endB)) is compared
+    int    matched = 0;                 // signals present on both sides
+    std::vector<SignalDiff> differing;  // matched signals with mismatches, earliest first
+    QStringList onlyInA;
+    QStringList onlyInB;
+    qint64 elapsedNs = 0;
+
+    qint64 firstMismatch() const { return differing.empty() ? -1 : differing.front().firstMismatch(); }
+};
+
+// Matches the signals of `a` and `b` by hierarchical name and merge-walks
+// the value runs of every pair (pairs run in parallel), collecting the
+// intervals where the values differ. X only matches X. Dumps with different
+// timescales are compared in the finer unit; when one is unknown the sides
+// are aligned by sample and timescaleMismatch is set.
+WaveDiffResult diffWaveforms(const DiffSide &a, const DiffSide &b);
+
+// The mismatches of one signal as sample ranges of side `a` of `result`,
+// e.g. to highlight them in a view of that document. An interval shorter
+// than a sample of `a` still covers the sample that holds it.
+std::vector<std::pair<int, int>> mismatchSamples(const SignalDiff &diff, const DiffSide &a,
+                                                 const WaveDiffResult &result);
+
+#endif // WAVEDIFF_H
@@ -49,31 +49,72 @@
 #include <QString> 
 #include <QColor>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include "core/CowVector.h"
+#include "core/BitPlane.h"
 
 class JsonIO;
 class VcdImporter;
+class VcdLibrary;
+class SignalExpr;
+struct VcdTail;
+struct VcdTailChange;
+struct AnnotationRow;
+struct VcdImportOptions;
+using VcdLibraryPtr = std::shared_ptr<const VcdLibrary>;
 
 enum class SignalType {
     Bit,
     Vector
 };
 static constexpr int UNDEFINED_VALUE = -1;
+// values/labels/bits are implicitly shared: copying a Signal (library -> view,
+// copy/paste, undo snapshots) is O(1) until one of the copies is modified.
+//
+// Bit signals keep their samples packed in `bits` and leave values/labels
+// empty; read samples of any signal with valueAt()/sampleCount().
 struct Signal
 {
     QString name;
     SignalType type;
-    std::vector<int> values;      // -1 = undefined, >=0 valid value
-    std::vector<QString> labels;  // optional labels per sample (for vectors)
+    CowVector<int> values;        // -1 = undefined, >=0 valid value (vectors)
+    CowVector<QString> labels;    // optional labels per sample (for vectors)
+    BitPlane bits;                // samples of a Bit signal (2 bits each)
+    BitPlane starts;              // annotation rows: 1 on the first sample of each item, else empty
     QColor color;                 // drawing color of the signal
 
+    // Derived signal: computed from other signals on demand (DerivedSignal.h);
+    // values/labels stay empty and editing operations leave it alone
+    std::shared_ptr<const SignalExpr> expr;
+    bool isDerived() const { return expr != nullptr; }
+
+    bool isPacked() const { return type == SignalType::Bit && !isDerived(); }
+    int sampleCount() const
+    {
+        return isPacked() ? bits.size() : static_cast<int>(values.size());
+    }
+    // UNDEFINED_VALUE outside [0, sampleCount())
+    int valueAt(int t) const
+    {
+        if (isPacked())
+            return bits.value(t);
+        return (t >= 0 && t < static_cast<int>(values.size())) ? values[t] : UNDEFINED_VALUE;
+    }
+    // Sample t begins a new item even if it repeats the previous value
+    bool startsItem(int t) const { return starts.value(t) == 1; }
+
     Signal(const QString &n = QString(),
            SignalType t = SignalType::Bit,
 
            int samples = 0)
         : name(n),
           type(t),
-          values(samples, -1),
-          labels(samples),
+          values(t == SignalType::Bit ? 0 : samples, -1),
+          labels(t == SignalType::Bit ? 0 : samples),
+          bits(t == SignalType::Bit ? samples : 0),
           color(Qt::black)
     {
         if (t == SignalType::Bit)
@@ -94,6 +135,33 @@ struct Arrow {
     int endSample;    // timestamp destino
 };
 
+// Approximate heap footprint of a document, per subsystem (bytes).
+// Containers are counted by capacity; label text is not, because QString is
+// implicitly shared between the document, its snapshots and the clipboards.
+// A signal buffer shared by several owners is counted once: in the VCD
+// library if it came from there, else in the newest state that holds it.
+struct MemoryStats {
+    qint64 visibleSignals  = 0;
+    qint64 vcdLibrary      = 0;
+    qint64 undoHistory     = 0;
+    qint64 redoHistory     = 0;
+    qint64 signalClipboard = 0;
+    qint64 blockClipboard  = 0;
+    qint64 annotations     = 0;   // markers + arrows
+
+    qint64 total() const
+    {
+        return visibleSignals + vcdLibrary + undoHistory + redoHistory +
+               signalClipboard + blockClipboard + annotations;
+    }
+};
+
+struct SignalMemoryUsage {
+    QString name;
+    bool    inLibrary;   // true: VCD library entry, false: visible signal
+    qint64  bytes;
+};
+
 class WaveDocument : public QObject
 {
     Q_OBJECT
@@ -108,7 +176,8 @@ public:
     std::vector<Signal> &signalList() { return m_signals; }
 
     // Signals coming from a VCD library (not all are necessarily shown)
-    const std::vector<Signal> &vcdSignalList() const { return m_vcdSignals; }
+    const std::vector<Signal> &vcdSignalList() const;
+    VcdLibraryPtr vcdLibrary() const { return m_vcdLibrary; }
 
 
     // High-level API
@@ -121,7 +190,7 @@ public:
     void setVectorRange(int signalIndex, int startSample, int endSample, int value, const QString &label = QString());
     void clearSample(int signalIndex, int sampleIndex);
     void setSignalColor(int signalIndex, const QColor &c);
-    void renameSignal(int signalIndex, const QString &name);
+    bool renameSignal(int signalIndex, const QString &name);        // false: would make a derived signal its own operand
     void cutRange(int startSample, int endSample);
     void removeSignal(int signalIndex);
     void moveSignal(int fromIndex, int toIndex);
@@ -129,6 +198,8 @@ public:
     bool hasBlockClipboard() const { return m_hasBlockClipboard; }
     int  blockClipboardSignalCount() const { return m_blockClipboardSignalCount; }
     int  blockClipboardSampleCount() const { return m_blockClipboardSampleCount; }
+    // Sample (row, col) of the block clipboard, whether the row is packed or not
+    int  blockClipboardValue(int row, int col) const;
 
     void copyBlock(int topSignal, int bottomSignal,
                    int startSample, int endSample);
@@ -140,6 +211,8 @@ public:
 
 
     int  addMarker(int sampleIndex);          
+    // Adds a marker per sample as a single undo step; returns the new ids
+    std::vector<int> addMarkers(const std::vector<int> &sampleIndices);
     void subMarkerById(int markerId);      
 
     void clearMarkers();
@@ -162,15 +235,64 @@ public:
     void redo();
     bool canUndo() const;
     bool canRedo() const;
-    
+    int  undoDepth() const { return static_cast<int>(m_undoStack.size()); }
+    int  redoDepth() const { return static_cast<int>(m_redoStack.size()); }
+    qint64 undoHistoryBytes() const { return m_undoBytes + m_redoBytes; }
+
+    // History is bounded by memory, not by steps: the oldest snapshots are
+    // evicted while undo + redo exceed the budget (the latest step is kept).
+    void   setUndoBudget(qint64 bytes);
+    qint64 undoBudget() const { return m_undoBudget; }
+    static constexpr qint64 kDefaultUndoBudget = 256LL * 1024 * 1024;
+
+    // Duration of the last document mutation (edit, undo/redo), for the HUD
+    qint64 lastMutationNs() const { return m_lastMutationNs; }
+
+    // Memory accounting
+    static qint64 signalBytes(const Signal &sig);   // full payload, shared or not
+    MemoryStats memoryStats() const;
+    std::vector<SignalMemoryUsage> signalMemoryUsage() const;   // largest first
+
+    // memoryBudgetExceeded() is emitted when the total crosses the budget
+    // (0 = no budget). It is re-armed once usage drops below it again.
+    void   setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const { return m_memoryBudget; }
+
 
     // Add a visible signal from the VCD library
     int addSignalFromVcd(const QString &fullName);
 
+    // Follow mode (VcdFollower): grows the document to `sampleCount` samples
+    // with value changes of library signals parsed after the import. Visible
+    // rows from the library hold their last value and take the changes; rows
+    // added from the library later get them too. Not an undo step.
+    void appendVcdTail(int sampleCount, const std::vector<qint64> &sampleTimes,
+                       std::vector<VcdTailChange> changes);
+    // Samples appended to the current library (nullptr if none)
+    const VcdTail *vcdTail() const;
+
+    // Add a derived signal defined by an expression over the visible signals
+    // (see SignalExpr). Returns -1 and sets *error if it does not compile.
+    int addDerivedSignal(const QString &name, const QString &expression, QString *error = nullptr);
+
+    // Looks visible signals up by name (for SignalExpr). Valid until the
+    // signal list changes.
+    std::function<const Signal *(const QString &)> signalResolver() const;
+
+    // Adds one Vector signal per decoder output row (ProtocolDecoder.h) as a
+    // single undo step. Returns the index of the first new row, -1 if none.
+    int addAnnotationSignals(const std::vector<AnnotationRow> &rows);
+
+    // Procedural clock rows (SignalExpr clock(...), e.g. from a VCD import)
+    // turn into stored bits before they are edited; no-op for other rows
+    void materializeClock(Signal &sig) const;
+
     // Persistence to disk
     bool saveToFile(const QString &fileName) const;
     bool loadFromFile(const QString &fileName);
     bool loadFromVcd(const QString &fileName);
+    bool loadFromVcd(const QString &fileName, const VcdImportOptions &options);
+    bool loadFromFst(const QString &fileName, const VcdImportOptions &options);
 
 
 
@@ -186,11 +308,13 @@ public slots:
 signals:
     void dataChanged();
     void undoRedoStateChanged(); 
+    void memoryBudgetExceeded(qint64 usedBytes, qint64 budgetBytes);
 
 private:
     int m_sampleCount;
     std::vector<Signal> m_signals;      // visible signals in the waveform
-    std::vector<Signal> m_vcdSignals;   // library of signals loaded from VCD
+    VcdLibraryPtr m_vcdLibrary;         // library of signals loaded from VCD (shared, immutable)
+    std::shared_ptr<VcdTail> m_vcdTail; // samples appended to it in follow mode
 
     std::vector<Marker> m_markers;
     int m_nextMarkerId = 1;
@@ -207,29 +331,64 @@ private:
     int  m_blockClipboardSampleCount = 0;
     std::vector<std::vector<int>>       m_blockClipboardValues;
     std::vector<std::vector<QString>>   m_blockClipboardLabels;
+    std::vector<BitPlane>               m_blockClipboardBits;    // rows copied from Bit signals (values/labels rows stay empty)
+    std::vector<BitPlane>               m_blockClipboardStarts;  // item starts of annotation rows (empty elsewhere)
 
     std::vector<SignalType>             m_blockClipboardTypes;   
     std::vector<QColor>                 m_blockClipboardColors;
 
+    qint64 m_lastMutationNs = 0;
+
+    qint64 m_memoryBudget = 0;
+    bool   m_memoryBudgetWarned = false;
+    void   checkMemoryBudget();
+    void   onDocumentMutated();
+
     void resizeSignals(int newSampleCount);
+    // Grows a stored row to `sampleCount` samples: its last value holds and
+    // the tail changes [first, last) (by sample) below sampleCount go on top
+    static void extendWithTail(Signal &sig, int sampleCount,
+                               const VcdTailChange *first, const VcdTailChange *last);
+    // materializeClock() over [0, sampleCount)
+    static void materializeClock(Signal &sig, int sampleCount);
 
     // Undo/Redo system
     struct Snapshot {
         int sampleCount;
         std::vector<Signal> m_signals;
-        std::vector<Signal> m_vcdSignals;
+        VcdLibraryPtr m_vcdLibrary;   // shared, not copied
+        std::shared_ptr<VcdTail> m_vcdTail;   // shared; appendVcdTail() copies one a snapshot holds
         std::vector<Marker> m_markers;
         int m_nextMarkerId;
         std::vector<Arrow> m_arrows;
         int m_nextArrowId;
+        qint64 bytes = 0;   // estimated footprint, settled when the next one is stored
+
+        // Structure only, without the signal buffers
+        qint64 overhead() const;
+        // Sets bytes: overhead plus the buffers not in `seen` (held by a
+        // newer state), which are added to it
+        qint64 charge(std::unordered_set<const void *> &seen);
     };
 
-    std::vector<Snapshot> m_undoStack;
-    std::vector<Snapshot> m_redoStack;
-    int m_maxUndoSteps = 50;  
+    // deque: evicting the oldest snapshot does not shift the others
+    std::deque<Snapshot> m_undoStack;
+    std::deque<Snapshot> m_redoStack;
+    qint64 m_undoBytes  = 0;   // sum of Snapshot::bytes per stack
+    qint64 m_redoBytes  = 0;
+    qint64 m_undoBudget = kDefaultUndoBudget;
+    qint64 m_releasedMark = 0;  // CowStats::releasedBytes() already charged
+    const VcdLibrary *m_chargedLibrary = nullptr;  // live library when the newest step was charged
 
     void pushUndoSnapshot();  
     void clearHistory();     
+    void trimHistory();
+    void updateHistoryBytes();
+    void settleNewestUndoStep();
+    void chargeReleasedBuffers();
+    void markLiveBuffers(std::unordered_set<const void *> &seen) const;
+
+    bool closesReferenceCycle(int signalIndex, const QString &name) const;
 
 
 };
@@ -0,0 +1,902 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          FstReader.cpp
+// Description:   Native reader of GTKWave's FST waveform format.
+//======================================================================
+
+#include "io/FstReader.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <QHash>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#ifdef WAVEPAINT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// Block types (fstapi.h)
+enum : int {
+    kBlockHeader = 0,
+    kBlockValues = 1,
+    kBlockGeometry = 3,
+    kBlockHierarchy = 4,           // gzip
+    kBlockValuesAlias = 5,
+    kBlockHierarchyLz4 = 6,
+    kBlockHierarchyLz4Duo = 7,     // LZ4 applied twice
+    kBlockValuesAlias2 = 8,
+    kBlockWrapper = 254,           // the whole file, gzipped
+};
+
+// Hierarchy entries; tags up to kVarTypeMax are variables
+enum : int { kVarTypeMax = 29, kAttrBegin = 252, kAttrEnd = 253, kScope = 254, kUpscope = 255 };
+
+constexpr qint64 kHeaderLength = 329;   // section length of the header block
+
+// Deflate expands at most about 1032:1, LZ4 and FastLZ less. The sizes an
+// FST file claims for unpacked data are checked against their packed bytes
+// (which lie within the file) before anything is allocated for them.
+constexpr quint64 kMaxExpansion = 1032;
+
+bool plausibleUnpacked(qint64 packed, quint64 unpacked)
+{
+    return packed >= 0 && unpacked / kMaxExpansion <= quint64(packed);
+}
+
+quint64 readBe64(const uchar *p)
+{
+    quint64 v = 0;
+    for (int i = 0; i < 8; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+// Little-endian base-128 varint; false if it runs past `end`
+bool readVarint(const uchar *&p, const uchar *end, quint64 *value)
+{
+    quint64 v = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        const uchar b = *p++;
+        v |= quint64(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Signed varint: the sign is bit 6 of the last byte
+bool readSignedVarint(const uchar *&p, const uchar *end, qint64 *value)
+{
+    quint64 v = 0;
+    int shift = 0;
+    uchar b = 0;
+    do {
+        if (p == end || shift >= 64)
+            return false;
+        b = *p++;
+        v |= quint64(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    if (shift < 64 && (b & 0x40))
+        v |= ~quint64(0) << shift;
+    *value = static_cast<qint64>(v);
+    return true;
+}
+
+bool zlibUncompress(const uchar *src, qint64 srcLen, uchar *dst, qint64 dstLen)
+{
+#ifdef WAVEPAINT_HAVE_ZLIB
+    uLongf outLen = static_cast<uLongf>(dstLen);
+    return uncompress(dst, &outLen, src, static_cast<uLong>(srcLen)) == Z_OK
+           && static_cast<qint64>(outLen) == dstLen;
+#else
+    Q_UNUSED(src); Q_UNUSED(srcLen); Q_UNUSED(dst); Q_UNUSED(dstLen);
+    return false;
+#endif
+}
+
+// gzip stream (hierarchy, whole-file wrapper), fed in pieces zlib's
+// 32-bit lengths can hold
+bool gzipUncompress(const uchar *src, qint64 srcLen, uchar *dst, qint64 dstLen)
+{
+#ifdef WAVEPAINT_HAVE_ZLIB
+    constexpr qint64 kChunk = qint64(1) << 30;
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 32) != Z_OK)
+        return false;
+    qint64 inLeft = srcLen, outLeft = dstLen;
+    zs.next_in = const_cast<uchar *>(src);
+    zs.next_out = dst;
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        if (zs.avail_in == 0 && inLeft > 0) {
+            zs.avail_in = static_cast<uInt>(std::min(inLeft, kChunk));
+            inLeft -= zs.avail_in;
+        }
+        if (zs.avail_out == 0 && outLeft > 0) {
+            zs.avail_out = static_cast<uInt>(std::min(outLeft, kChunk));
+            outLeft -= zs.avail_out;
+        }
+        rc = inflate(&zs, Z_NO_FLUSH);
+        if (rc == Z_BUF_ERROR && ((zs.avail_in == 0 && inLeft == 0) || (zs.avail_out == 0 && outLeft == 0)))
+            break;
+        if (rc == Z_BUF_ERROR)
+            rc = Z_OK;
+    }
+    const bool ok = rc == Z_STREAM_END && zs.avail_out == 0 && outLeft == 0;
+    inflateEnd(&zs);
+    return ok;
+#else
+    Q_UNUSED(src); Q_UNUSED(srcLen); Q_UNUSED(dst); Q_UNUSED(dstLen);
+    return false;
+#endif
+}
+
+// LZ4 block format: a token of literal length (high nibble) and match length
+// (low nibble, + 4), both extended by bytes while they are 255; a match
+// copies from 1..65535 bytes back and may overlap its output
+bool lz4Uncompress(const uchar *src, qint64 srcLen, uchar *dst, qint64 dstLen)
+{
+    const uchar *ip = src;
+    const uchar *const ipEnd = src + srcLen;
+    uchar *op = dst;
+    uchar *const opEnd = dst + dstLen;
+    auto extend = [&ip, ipEnd](qint64 *length) {
+        uchar b;
+        do {
+            if (ip == ipEnd)
+                return false;
+            b = *ip++;
+            *length += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < ipEnd) {
+        const uchar token = *ip++;
+        qint64 literals = token >> 4;
+        if (literals == 15 && !extend(&literals))
+            return false;
+        if (literals > ipEnd - ip || literals > opEnd - op)
+            return false;
+        std::memcpy(op, ip, static_cast<size_t>(literals));
+        ip += literals;
+        op += literals;
+        if (ip == ipEnd)
+            break;                  // the last sequence has no match
+        if (ipEnd - ip < 2)
+            return false;
+        const qint64 distance = ip[0] | (ip[1] << 8);
+        ip += 2;
+        qint64 match = token & 15;
+        if (match == 15 && !extend(&match))
+            return false;
+        match += 4;
+        if (distance == 0 || distance > op - dst || match > opEnd - op)
+            return false;
+        const uchar *from = op - distance;
+        for (qint64 i = 0; i < match; ++i)
+            op[i] = from[i];
+        op += match;
+    }
+    return op == opEnd;
+}
+
+// FastLZ, level 1 or 2 (top bits of the first byte). Instructions are
+// literal runs (ctrl < 32: ctrl + 1 bytes) or matches (length from ctrl's
+// top 3 bits, distance from its low 5 bits and the next byte; level 2 adds
+// longer lengths and a 16-bit far distance).
+bool fastLzUncompress(const uchar *src, qint64 srcLen, uchar *dst, qint64 dstLen)
+{
+    if (srcLen <= 0)
+        return dstLen == 0;
+    const int level = (src[0] >> 5) + 1;
+    if (level > 2)
+        return false;
+    const uchar *ip = src;
+    const uchar *const ipEnd = src + srcLen;
+    uchar *op = dst;
+    uchar *const opEnd = dst + dstLen;
+
+    uint ctrl = *ip++ & 31;
+    for (;;) {
+        if (ctrl >= 32) {
+            qint64 length = (ctrl >> 5) - 1;
+            qint64 distance = qint64(ctrl & 31) << 8;
+            if (length == 6) {
+                if (level == 1) {
+                    if (ip == ipEnd)
+                        return false;
+                    length += *ip++;
+                } else {
+                    uchar b;
+                    do {
+                        if (ip == ipEnd)
+                            return false;
+                        b = *ip++;
+                        length += b;
+                    } while (b == 255);
+                }
+            }
+            if (ip == ipEnd)
+                return false;
+            const uchar code = *ip++;
+            distance += code + 1;
+            if (level == 2 && code == 255 && (ctrl & 31) == 31) {
+                if (ipEnd - ip < 2)
+                    return false;
+                distance = ((qint64(ip[0]) << 8) | ip[1]) + 8192;
+                ip += 2;
+            }
+            length += 3;
+            if (distance > op - dst || length > opEnd - op)
+                return false;
+            const uchar *from = op - distance;
+            for (qint64 i = 0; i < length; ++i)
+                op[i] = from[i];
+            op += length;
+        } else {
+            const qint64 literals = ctrl + 1;
+            if (literals > ipEnd - ip || literals > opEnd - op)
+                return false;
+            std::memcpy(op, ip, static_cast<size_t>(literals));
+            ip += literals;
+            op += literals;
+        }
+        if (ip == ipEnd)
+            break;
+        ctrl = *ip++;
+    }
+    return op == opEnd;
+}
+
+// Value-change data of one handle in a block, by the block's pack type
+bool unpackValues(char packType, const uchar *src, qint64 srcLen, uchar *dst, qint64 dstLen)
+{
+    switch (packType) {
+    case '4':
+        return lz4Uncompress(src, srcLen, dst, dstLen);
+    case 'F':
+        return fastLzUncompress(src, srcLen, dst, dstLen);
+    default:
+        return zlibUncompress(src, srcLen, dst, dstLen);   // 'Z'
+    }
+}
+
+// Bits packed MSB first, as the fstapi writer stores 0/1-only vectors
+int packedValue(const uchar *p, int width)
+{
+    if (width > 32)
+        return VcdParser::kWideValue;
+    quint64 v = 0;
+    for (int j = 0; j < width; ++j)
+        v = (v << 1) | ((p[j >> 3] >> (7 - (j & 7))) & 1);
+    return v > quint64(INT_MAX) ? UNDEFINED_VALUE : static_cast<int>(v);
+}
+
+} // namespace
+
+FstReader::~FstReader()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+bool FstReader::open(const QString &fileName, const VcdSignalFilter &filter, int maxSamples, QString *error)
+{
+    WP_TRACE_SCOPE("io", "FstReader::open");
+    auto fail = [error](const QString &why) {
+        if (error)
+            *error = why;
+        return false;
+    };
+#ifndef WAVEPAINT_HAVE_ZLIB
+    Q_UNUSED(fileName); Q_UNUSED(filter); Q_UNUSED(maxSamples);
+    return fail(QStringLiteral("FST support needs zlib, which was not found at build time"));
+#else
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+        return fail(m_file.errorString());
+    m_size = m_file.size();
+    if (m_size < 1 + kHeaderLength)
+        return fail(QStringLiteral("not an FST file"));
+    m_map = m_file.map(0, m_size);
+    if (!m_map)
+        return fail(QStringLiteral("cannot map the file"));
+    m_data = m_map;
+
+    if (m_data[0] == kBlockWrapper) {
+        // Repacked on close: the real file is one gzip stream
+        const qint64 length = static_cast<qint64>(readBe64(m_data + 1));
+        const qint64 unpacked = static_cast<qint64>(readBe64(m_data + 9));
+        if (length < 16 || length > m_size - 1 || unpacked < 1 + kHeaderLength)
+            return fail(QStringLiteral("truncated FST wrapper"));
+        if (!plausibleUnpacked(length - 16, quint64(unpacked)))
+            return fail(QStringLiteral("corrupt FST wrapper"));
+        m_unwrapped = QByteArray(unpacked, Qt::Uninitialized);
+        if (!gzipUncompress(m_data + 17, length - 16, reinterpret_cast<uchar *>(m_unwrapped.data()), unpacked))
+            return fail(QStringLiteral("corrupt FST wrapper"));
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_file.close();
+        m_data = reinterpret_cast<const uchar *>(m_unwrapped.constData());
+        m_size = unpacked;
+    }
+    if (m_data[0] != kBlockHeader || static_cast<qint64>(readBe64(m_data + 1)) != kHeaderLength)
+        return fail(QStringLiteral("not an FST file"));
+
+    // Blocks: a type byte and a big-endian length counting itself. A block
+    // the writer did not finish (simulation still running or killed) ends
+    // the scan.
+    qint64 geometry = -1, geometryLength = 0;
+    qint64 hierarchy = -1, hierarchyLength = 0;
+    int hierarchyType = 0;
+    for (qint64 pos = 0; m_size - pos >= 9;) {
+        const int type = m_data[pos];
+        const qint64 begin = pos + 1;
+        const quint64 length = readBe64(m_data + begin);
+        if (length < 8 || length > quint64(m_size - begin))
+            break;
+        switch (type) {
+        case kBlockValues:
+        case kBlockValuesAlias:
+        case kBlockValuesAlias2: {
+            Block block;
+            block.begin = begin;
+            block.length = static_cast<qint64>(length);
+            block.type = type;
+            m_blocks.push_back(std::move(block));
+            break;
+        }
+        case kBlockGeometry:
+            geometry = begin;
+            geometryLength = static_cast<qint64>(length);
+            break;
+        case kBlockHierarchy:
+        case kBlockHierarchyLz4:
+        case kBlockHierarchyLz4Duo:
+            hierarchy = begin;
+            hierarchyLength = static_cast<qint64>(length);
+            hierarchyType = type;
+            break;
+        default:
+            break;   // header, blackouts, skipped sections
+        }
+        pos = begin + static_cast<qint64>(length);
+    }
+
+    // Header: start/end time, endian test, memory, scope/var counts, handle
+    // count, block count, timescale exponent
+    m_timescale = std::pow(10.0, static_cast<qint8>(m_data[1 + 72]));
+    if (geometry < 0 || hierarchy < 0)
+        return fail(QStringLiteral("FST file without hierarchy or geometry (still being written?)"));
+    if (!readGeometry(geometry, geometryLength))
+        return fail(QStringLiteral("corrupt FST geometry"));
+    if (!readHierarchy(hierarchy, hierarchyLength, hierarchyType, filter))
+        return fail(QStringLiteral("corrupt FST hierarchy"));
+
+    // Time tables (and the first block's frame), one block per worker
+    std::vector<char> ok(m_blocks.size(), 0);
+    parallelFor(static_cast<int>(m_blocks.size()), [this, &ok](int i) {
+        ok[i] = readBlock(m_blocks[i], i == 0);
+    });
+    for (size_t i = 0; i < ok.size(); ++i) {
+        if (!ok[i]) {
+            m_blocks.resize(i);   // keep what precedes a damaged block
+            break;
+        }
+    }
+    if (m_blocks.empty())
+        return fail(QStringLiteral("FST file without value changes"));
+    numberSamples(maxSamples);
+    return true;
+#endif
+}
+
+bool FstReader::readGeometry(qint64 begin, qint64 length)
+{
+    // length, uncompressed length, handle count, zlib data (unless stored)
+    if (length < 24)
+        return false;
+    const uchar *base = m_data + begin;
+    const qint64 unpacked = static_cast<qint64>(readBe64(base + 8));
+    const quint64 count = readBe64(base + 16);
+    const qint64 packed = length - 24;
+    if (unpacked < 0 || count > quint64(INT_MAX) || unpacked > (qint64(1) << 32))
+        return false;
+    // Every handle takes at least one byte of the table
+    if ((packed != unpacked && !plausibleUnpacked(packed, quint64(unpacked))) || count > quint64(unpacked))
+        return false;
+
+    std::vector<uchar> buffer;
+    const uchar *p = base + 24;
+    const uchar *end = p + packed;
+    if (packed != unpacked) {
+        buffer.resize(static_cast<size_t>(unpacked));
+        if (!zlibUncompress(p, packed, buffer.data(), unpacked))
+            return false;
+        p = buffer.data();
+        end = p + unpacked;
+    }
+
+    // Per handle: 0 = real (8 bytes in the frame), 0xFFFFFFFF = variable
+    // length string, otherwise bits
+    m_handles = static_cast<int>(count);
+    m_lengths.assign(m_handles, 0);
+    m_real.assign(m_handles, 0);
+    for (int h = 0; h < m_handles; ++h) {
+        quint64 len;
+        if (!readVarint(p, end, &len))
+            return false;
+        if (len == 0)
+            m_real[h] = 1;
+        else if (len != 0xFFFFFFFFu)
+            m_lengths[h] = static_cast<int>(std::min<quint64>(len, INT_MAX));
+    }
+    return true;
+}
+
+bool FstReader::readHierarchy(qint64 begin, qint64 length, int type, const VcdSignalFilter &filter)
+{
+    WP_TRACE_SCOPE("io", "FstReader::readHierarchy");
+    if (length < 16)
+        return false;
+    const uchar *base = m_data + begin;
+    const qint64 unpacked = static_cast<qint64>(readBe64(base + 8));
+    if (unpacked < 0 || unpacked > (qint64(1) << 40))
+        return false;
+    const uchar *src = base + 16;
+    const uchar *srcEnd = base + length;
+    if (type != kBlockHierarchyLz4Duo && !plausibleUnpacked(srcEnd - src, quint64(unpacked)))
+        return false;
+
+    QByteArray text(unpacked, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(text.data());
+    if (type == kBlockHierarchy) {
+        if (!gzipUncompress(src, srcEnd - src, out, unpacked))
+            return false;
+    } else if (type == kBlockHierarchyLz4) {
+        if (!lz4Uncompress(src, srcEnd - src, out, unpacked))
+            return false;
+    } else {
+        quint64 middle;
+        if (!readVarint(src, srcEnd, &middle) || middle > quint64(1) << 40
+            || !plausibleUnpacked(srcEnd - src, middle)
+            || !plausibleUnpacked(static_cast<qint64>(middle), quint64(unpacked)))
+            return false;
+        std::vector<uchar> once(static_cast<size_t>(middle));
+        if (!lz4Uncompress(src, srcEnd - src, once.data(), static_cast<qint64>(middle))
+            || !lz4Uncompress(once.data(), static_cast<qint64>(middle), out, unpacked))
+            return false;
+    }
+
+    const uchar *p = out;
+    const uchar *end = out + unpacked;
+    auto cstring = [&p, end](QString *s) {
+        const void *zero = std::memchr(p, 0, static_cast<size_t>(end - p));
+        if (!zero)
+            return false;
+        const uchar *z = static_cast<const uchar *>(zero);
+        if (s)
+            *s = QString::fromUtf8(reinterpret_cast<const char *>(p), static_cast<int>(z - p));
+        p = z + 1;
+        return true;
+    };
+
+    // Vars without an alias take the next handle, in order; the filter's
+    // rejects still use theirs up
+    QStringList scopes;
+    int nextHandle = 0;
+    while (p != end) {
+        const int tag = *p++;
+        if (tag == kScope) {
+            QString name;
+            if (p == end)
+                return false;
+            ++p;   // scope type
+            if (!cstring(&name) || !cstring(nullptr))   // name, component
+                return false;
+            scopes.append(name);
+        } else if (tag == kUpscope) {
+            if (!scopes.isEmpty())
+                scopes.removeLast();
+        } else if (tag == kAttrBegin) {
+            quint64 argument;
+            if (end - p < 2)
+                return false;
+            p += 2;
+            if (!cstring(nullptr) || !readVarint(p, end, &argument))
+                return false;
+        } else if (tag == kAttrEnd) {
+        } else if (tag <= kVarTypeMax) {
+            QString name;
+            quint64 len, alias;
+            if (p == end)
+                return false;
+            ++p;   // direction
+            if (!cstring(&name) || !readVarint(p, end, &len) || !readVarint(p, end, &alias))
+                return false;
+            const qint64 handle = alias ? qint64(alias) - 1 : nextHandle++;
+            if (handle < 0 || handle >= m_handles)
+                return false;
+            VcdParser::Var var;
+            var.name = scopes.isEmpty() ? name : scopes.join('.') + '.' + name;
+            if (!filter.accepts(var.name, scopes.size()))
+                continue;
+            const int bits = m_lengths[handle];
+            var.width = bits > 0 ? bits : 64;   // reals and strings stay X
+            var.code = static_cast<int>(handle);
+            m_vars.push_back(std::move(var));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FstReader::readBlock(Block &block, bool withFrame)
+{
+    // length, begin/end time, memory, frame, value changes, offset table,
+    // time table; the sizes of the last two are at the end
+    const uchar *base = m_data + block.begin;
+    const uchar *end = base + block.length;
+    if (block.length < 32 + 3 + 8 + 24)
+        return false;
+    block.startTime = static_cast<qint64>(readBe64(base + 8));
+
+    const qint64 timeUnpacked = static_cast<qint64>(readBe64(end - 24));
+    const qint64 timePacked = static_cast<qint64>(readBe64(end - 16));
+    const quint64 items = readBe64(end - 8);
+    if (timePacked < 0 || timePacked > block.length - 32 - 8 - 24 || timeUnpacked < 0
+        || timeUnpacked > (qint64(1) << 36) || items > quint64(timeUnpacked)
+        || (timePacked != timeUnpacked && !plausibleUnpacked(timePacked, quint64(timeUnpacked))))
+        return false;
+    const uchar *timeData = end - 24 - timePacked;
+    const uchar *t = timeData;
+    const uchar *timeEnd = timeData + timePacked;
+    std::vector<uchar> buffer;
+    if (timePacked != timeUnpacked) {
+        buffer.resize(static_cast<size_t>(timeUnpacked));
+        if (!zlibUncompress(timeData, timePacked, buffer.data(), timeUnpacked))
+            return false;
+        t = buffer.data();
+        timeEnd = t + timeUnpacked;
+    }
+    block.times.resize(static_cast<size_t>(items));
+    quint64 time = 0;
+    for (quint64 i = 0; i < items; ++i) {
+        quint64 delta;
+        if (!readVarint(t, timeEnd, &delta))
+            return false;
+        time += delta;
+        block.times[i] = static_cast<qint64>(time);
+    }
+
+    const uchar *chainLength = timeData - 8;
+    const quint64 chainBytes = readBe64(chainLength);
+    if (chainBytes > quint64(chainLength - (base + 32)))
+        return false;
+    block.chainEnd = chainLength - m_data;
+    block.chainStart = block.chainEnd - static_cast<qint64>(chainBytes);
+
+    const uchar *p = base + 32;
+    const uchar *limit = m_data + block.chainStart;
+    quint64 frameUnpacked, framePacked, frameHandles, maxHandle;
+    if (!readVarint(p, limit, &frameUnpacked) || !readVarint(p, limit, &framePacked)
+        || !readVarint(p, limit, &frameHandles) || framePacked > quint64(limit - p))
+        return false;
+    const uchar *frameData = p;
+    p += framePacked;
+    if (!readVarint(p, limit, &maxHandle) || p == limit || maxHandle > quint64(m_handles))
+        return false;
+    block.maxHandle = static_cast<int>(maxHandle);
+    block.vcStart = p - m_data;
+    block.packType = static_cast<char>(*p);
+
+    if (withFrame) {
+        // One char per bit ('0', '1', 'x', ...) of every handle, in order
+        if (frameHandles > quint64(m_handles) || frameUnpacked > (quint64(1) << 36)
+            || (framePacked != frameUnpacked && !plausibleUnpacked(static_cast<qint64>(framePacked), frameUnpacked)))
+            return false;
+        m_frame = QByteArray(static_cast<qint64>(frameUnpacked), Qt::Uninitialized);
+        uchar *out = reinterpret_cast<uchar *>(m_frame.data());
+        if (framePacked == frameUnpacked)
+            std::memcpy(out, frameData, static_cast<size_t>(framePacked));
+        else if (!zlibUncompress(frameData, static_cast<qint64>(framePacked), out, static_cast<qint64>(frameUnpacked)))
+            return false;
+        m_frameHandles = static_cast<int>(frameHandles);
+        m_frameOffset.assign(m_frameHandles, 0);
+        qint64 offset = 0;
+        for (int h = 0; h < m_frameHandles; ++h) {
+            m_frameOffset[h] = offset;
+            offset += m_real[h] ? 8 : m_lengths[h];
+        }
+        if (offset > m_frame.size())
+            m_frameHandles = 0;
+    }
+    return true;
+}
+
+void FstReader::numberSamples(int maxSamples)
+{
+    // Sample 0 is the start of the first block (the frame); then every new
+    // time of the time tables. Changes past the limit are dropped.
+    m_sampleTimes.clear();
+    m_sampleTimes.push_back(m_blocks.front().startTime);
+    bool full = false;
+    for (Block &block : m_blocks) {
+        block.sampleOf.assign(block.times.size(), -1);
+        for (size_t i = 0; i < block.times.size() && !full; ++i) {
+            if (block.times[i] > m_sampleTimes.back()) {
+                if (static_cast<int>(m_sampleTimes.size()) >= maxSamples) {
+                    full = true;
+                    break;
+                }
+                m_sampleTimes.push_back(block.times[i]);
+            }
+            block.sampleOf[i] = static_cast<int>(m_sampleTimes.size()) - 1;
+        }
+        std::vector<qint64>().swap(block.times);
+    }
+}
+
+void FstReader::locateEntries(const Block &block, const std::vector<int> &handles, Entry *entries) const
+{
+    // The offset table lists every handle of the block in order: offset
+    // deltas, runs of handles without changes, and aliases of an earlier
+    // handle's data (the encoding depends on the block type)
+    const uchar *p = m_data + block.chainStart;
+    const uchar *end = m_data + block.chainEnd;
+    const int count = block.maxHandle;
+    std::vector<qint64> offsets(count, 0);
+    std::vector<int> aliasOf(count, -1);
+    int idx = 0;
+    qint64 offset = 0;
+    auto skip = [&idx, count](quint64 run) { idx = static_cast<int>(std::min<quint64>(quint64(idx) + run, quint64(count))); };
+
+    if (block.type == kBlockValuesAlias2) {
+        qint64 lastAlias = 0;
+        while (p < end && idx < count) {
+            if (*p & 1) {
+                qint64 v;
+                if (!readSignedVarint(p, end, &v))
+                    break;
+                const qint64 shifted = v >> 1;
+                if (shifted > 0) {
+                    offset += shifted;
+                    offsets[idx] = offset;
+                } else {
+                    if (shifted < 0)
+                        lastAlias = shifted;
+                    if (lastAlias < 0)
+                        aliasOf[idx] = static_cast<int>(-lastAlias - 1);
+                }
+                ++idx;
+            } else {
+                quint64 v;
+                if (!readVarint(p, end, &v))
+                    break;
+                skip(v >> 1);
+            }
+        }
+    } else {
+        while (p < end && idx < count) {
+            quint64 v;
+            if (!readVarint(p, end, &v))
+                break;
+            if (v & 1) {
+                offset += static_cast<qint64>(v >> 1);
+                offsets[idx++] = offset;
+            } else if (v == 0 && block.type == kBlockValuesAlias) {
+                quint64 target;
+                if (!readVarint(p, end, &target))
+                    break;
+                if (target > 0 && target <= quint64(count))
+                    aliasOf[idx] = static_cast<int>(target - 1);
+                ++idx;
+            } else {
+                skip(v >> 1);
+            }
+        }
+    }
+
+    // An entry ends where the next one with data starts, the last one at the
+    // offset table
+    std::vector<qint64> lengths(count, 0);
+    qint64 next = block.chainStart - block.vcStart;
+    for (int h = count - 1; h >= 0; --h) {
+        if (offsets[h] > 0) {
+            lengths[h] = std::max<qint64>(0, next - offsets[h]);
+            next = offsets[h];
+        }
+    }
+
+    for (size_t k = 0; k < handles.size(); ++k) {
+        int h = handles[k];
+        for (int hops = 0; h >= 0 && h < count && aliasOf[h] >= 0 && hops < 8; ++hops)
+            h = aliasOf[h];
+        if (h < 0 || h >= count || offsets[h] <= 0)
+            continue;
+        entries[k].offset = offsets[h];
+        entries[k].length = lengths[h];
+    }
+}
+
+void FstReader::decodeEntry(const Block &block, int handle, const Entry &entry,
+                            std::vector<VcdParser::Change> *changes) const
+{
+    const int width = m_lengths[handle];
+    if (entry.length <= 0 || width <= 0 || m_real[handle])
+        return;
+    const uchar *p = m_data + block.vcStart + entry.offset;
+    const uchar *end = p + entry.length;
+    if (end > m_data + block.chainStart)
+        return;
+
+    // Uncompressed length, 0 when stored as is
+    quint64 unpacked;
+    if (!readVarint(p, end, &unpacked) || unpacked > (quint64(1) << 36)
+        || (unpacked && !plausibleUnpacked(end - p, unpacked)))
+        return;
+    std::vector<uchar> buffer;
+    if (unpacked) {
+        buffer.resize(static_cast<size_t>(unpacked));
+        if (!unpackValues(block.packType, p, end - p, buffer.data(), static_cast<qint64>(unpacked)))
+            return;
+        p = buffer.data();
+        end = p + unpacked;
+    }
+
+    // Each change: time-table index delta and value. Scalars fold both in
+    // one varint (0/1, or one of "xzhuwl-?" read as X); vectors are either
+    // packed bits or one char per bit.
+    quint64 index = 0;
+    while (p < end) {
+        quint64 vli;
+        if (!readVarint(p, end, &vli))
+            break;
+        int value;
+        if (width == 1) {
+            if (!(vli & 1)) {
+                value = static_cast<int>((vli >> 1) & 1);
+                index += vli >> 2;
+            } else {
+                value = UNDEFINED_VALUE;
+                index += vli >> 4;
+            }
+        } else {
+            index += vli >> 1;
+            if (vli & 1) {
+                if (end - p < width)
+                    break;
+                const char *chars = reinterpret_cast<const char *>(p);
+                value = VcdParser::vectorValue(chars, chars + width, width);
+                p += width;
+            } else {
+                const int bytes = (width + 7) / 8;
+                if (end - p < bytes)
+                    break;
+                value = packedValue(p, width);
+                p += bytes;
+            }
+        }
+        if (index >= block.sampleOf.size())
+            break;
+        const int sample = block.sampleOf[static_cast<size_t>(index)];
+        if (sample < 0)
+            break;   // past the sample limit
+        if (!changes->empty() && changes->back().sample == sample)
+            changes->back().value = value;
+        else
+            changes->push_back({sample, value});
+    }
+}
+
+bool FstReader::frameValue(int handle, int *value) const
+{
+    if (handle >= m_frameHandles || m_real[handle] || m_lengths[handle] <= 0)
+        return false;
+    const int width = m_lengths[handle];
+    const char *chars = m_frame.constData() + m_frameOffset[handle];
+    if (width == 1)
+        *value = chars[0] == '0' ? 0 : chars[0] == '1' ? 1 : UNDEFINED_VALUE;
+    else
+        *value = VcdParser::vectorValue(chars, chars + width, width);
+    return true;
+}
+
+std::vector<std::vector<VcdParser::Change>> FstReader::loadChanges(const std::vector<int> &handles) const
+{
+    WP_TRACE_SCOPE("io", "FstReader::loadChanges");
+    const int blockCount = static_cast<int>(m_blocks.size());
+    const int handleCount = static_cast<int>(handles.size());
+    const size_t pieceCount = size_t(blockCount) * size_t(handleCount);
+    std::vector<Entry> entries(pieceCount);
+    parallelFor(blockCount, [&](int b) {
+        locateEntries(m_blocks[b], handles, &entries[size_t(b) * handleCount]);
+    });
+
+    // Every (block, handle) entry is compressed on its own
+    std::vector<std::vector<VcdParser::Change>> pieces(pieceCount);
+    parallelFor(static_cast<int>(std::min<size_t>(pieceCount, INT_MAX)), [&](int k) {
+        const int b = k / handleCount;
+        const int i = k % handleCount;
+        decodeEntry(m_blocks[b], handles[i], entries[k], &pieces[k]);
+    });
+
+    // Frame value at sample 0, then the blocks in order; a block may start
+    // on the last sample of the previous one
+    std::vector<std::vector<VcdParser::Change>> changes(handleCount);
+    parallelFor(handleCount, [&](int i) {
+        std::vector<VcdParser::Change> &list = changes[i];
+        auto add = [&list](const VcdParser::Change &c) {
+            if (!list.empty() && list.back().sample == c.sample)
+                list.back().value = c.value;
+            else
+                list.push_back(c);
+        };
+        int initial;
+        if (frameValue(handles[i], &initial))
+            add({0, initial});
+        for (int b = 0; b < blockCount; ++b) {
+            for (const VcdParser::Change &c : pieces[size_t(b) * handleCount + i])
+                add(c);
+            std::vector<VcdParser::Change>().swap(pieces[size_t(b) * handleCount + i]);
+        }
+    });
+    return changes;
+}
+
+FstSignalSource::FstSignalSource(std::unique_ptr<FstReader> reader)
+    : m_reader(std::move(reader))
+{
+}
+
+void FstSignalSource::load(const std::vector<int> &indices, const std::vector<Signal *> &targets)
+{
+    // Aliased vars share a handle: decode it once
+    const std::vector<VcdParser::Var> &vars = m_reader->vars();
+    std::vector<int> handles;
+    std::vector<int> slot(indices.size());
+    QHash<int, int> slotOfHandle;
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const int handle = vars[indices[k]].code;
+        int found = slotOfHandle.value(handle, -1);
+        if (found < 0) {
+            found = static_cast<int>(handles.size());
+            slotOfHandle.insert(handle, found);
+            handles.push_back(handle);
+        }
+        slot[k] = found;
+    }
+
+    const std::vector<std::vector<VcdParser::Change>> changes = m_reader->loadChanges(handles);
+    const int sampleCount = m_reader->sampleCount();
+    parallelFor(static_cast<int>(indices.size()), [&](int k) {
+        const std::vector<VcdParser::Change> &list = changes[slot[k]];
+        Signal s = VcdParser::signalFromChanges(vars[indices[k]], list.data(), list.data() + list.size(),
+                                                sampleCount);
+        targets[k]->bits = std::move(s.bits);
+        targets[k]->values = std::move(s.values);
+        targets[k]->labels = std::move(s.labels);
+    });
+}
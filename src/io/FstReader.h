@@ -0,0 +1,129 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          FstReader.h
+// Description:   Native reader of GTKWave's FST waveform format.
+//======================================================================
+
+#ifndef FSTREADER_H
+#define FSTREADER_H
+
+#include "io/VcdFilter.h"
+#include "io/VcdParser.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+// Native reader of GTKWave's FST format, as written by Verilator, vcd2fst
+// and the fstapi writers of most simulators; no fstapi library is needed.
+// zlib (WAVEPAINT_HAVE_ZLIB) decodes the frames, time tables, geometry and
+// gzip hierarchies; the LZ4 and FastLZ value-change packings have small
+// built-in decoders.
+//
+// open() reads what browsing needs right away: the header, the geometry, the
+// hierarchy and the time table of every value-change block (decompressed in
+// parallel). The changes of a signal are only decoded by loadChanges(), from
+// all blocks in parallel, when the signal is first used (FstSignalSource).
+//
+// Samples are the distinct timestamps of the time tables, as with a VCD.
+// Scalars and 0/1/X vectors are decoded; reals and strings stay X.
+class FstReader
+{
+public:
+    FstReader() = default;
+    ~FstReader();
+    FstReader(const FstReader &) = delete;
+    FstReader &operator=(const FstReader &) = delete;
+
+    // False (and *error) if the file is not a readable FST. The vars the
+    // filter rejects are left out; samples past maxSamples are dropped.
+    bool open(const QString &fileName, const VcdSignalFilter &filter, int maxSamples,
+              QString *error = nullptr);
+
+    double timescale() const { return m_timescale; }
+    // Var::code is the FST value-change handle; aliases share one
+    const std::vector<VcdParser::Var> &vars() const { return m_vars; }
+    const std::vector<qint64> &sampleTimes() const { return m_sampleTimes; }
+    int sampleCount() const { return static_cast<int>(m_sampleTimes.size()); }
+
+    // Changes of each handle, by sample, encoded as VcdParser::Change.
+    // Thread-safe: only reads the mapped file.
+    std::vector<std::vector<VcdParser::Change>> loadChanges(const std::vector<int> &handles) const;
+
+private:
+    struct Block
+    {
+        qint64 begin = 0;          // offset of the section length
+        qint64 length = 0;
+        int type = 0;
+        qint64 startTime = 0;
+        qint64 vcStart = 0;        // pack type byte; value-change offsets count from here
+        qint64 chainStart = 0;     // offset table of the handles [chainStart, chainEnd)
+        qint64 chainEnd = 0;
+        int maxHandle = 0;         // handles listed in the offset table
+        char packType = 'Z';
+        std::vector<qint64> times; // time table, until the samples are numbered
+        std::vector<int> sampleOf; // time index -> sample, -1 past the limit
+    };
+
+    struct Entry
+    {
+        qint64 offset = 0;         // from vcStart, 0 = no change in the block
+        qint64 length = 0;
+    };
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    QByteArray m_unwrapped;        // a gzip-wrapped file, decompressed
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+
+    double m_timescale = 0.0;
+    int m_handles = 0;
+    std::vector<int> m_lengths;    // bits per handle, 0 = variable length
+    std::vector<char> m_real;
+    std::vector<Block> m_blocks;
+    QByteArray m_frame;            // every handle's value at the start of the first block
+    std::vector<qint64> m_frameOffset;
+    int m_frameHandles = 0;
+    std::vector<VcdParser::Var> m_vars;
+    std::vector<qint64> m_sampleTimes;
+
+    bool readGeometry(qint64 begin, qint64 length);
+    bool readHierarchy(qint64 begin, qint64 length, int type, const VcdSignalFilter &filter);
+    bool readBlock(Block &block, bool withFrame);
+    void numberSamples(int maxSamples);
+    void locateEntries(const Block &block, const std::vector<int> &handles, Entry *entries) const;
+    void decodeEntry(const Block &block, int handle, const Entry &entry,
+                     std::vector<VcdParser::Change> *changes) const;
+    bool frameValue(int handle, int *value) const;
+};
+
+// Library source of an FST import (VcdLibrary): decodes the signals as they
+// are first used, several at a time when preloaded
+class FstSignalSource : public VcdSignalSource
+{
+public:
+    explicit FstSignalSource(std::unique_ptr<FstReader> reader);
+
+    void load(const std::vector<int> &indices, const std::vector<Signal *> &targets) override;
+
+private:
+    std::unique_ptr<FstReader> m_reader;
+};
+
+#endif // FSTREADER_H
@@ -19,6 +19,8 @@
 
 #include "io/JsonIO.h"
 #include "core.h"
+#include "core/DerivedSignal.h"
+#include "utils/Trace.h"
 
 #include <QFile>
 #include <QJsonDocument>
@@ -29,6 +31,7 @@
 
 bool JsonIO::saveToFile(const WaveDocument &doc, const QString &fileName)
 {
+    WP_TRACE_SCOPE("io", "JsonIO::saveToFile");
     QFile f(fileName);
     if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
         return false;
@@ -46,7 +49,22 @@ bool JsonIO::saveToFile(const WaveDocument &doc, const QString &fileName)
         so["type"]  = (s.type == SignalType::Bit ? "bit" : "vector");
         so["color"] = s.color.name(QColor::HexArgb);
 
+        if (s.isDerived()) {
+            // Sólo la expresión: los valores se recalculan al cargar
+            so["expression"] = s.expr->text();
+            sigArray.append(so);
+            continue;
+        }
+
         QJsonArray vals;
+        if (s.isPacked()) {
+            // Mismo formato que antes; las señales bit no llevan labels
+            for (int t = 0; t < s.bits.size(); ++t)
+                vals.append(s.bits.value(t));
+            so["values"] = vals;
+            sigArray.append(so);
+            continue;
+        }
         for (int v : s.values)
             vals.append(v);
         so["values"] = vals;
@@ -56,6 +74,15 @@ bool JsonIO::saveToFile(const WaveDocument &doc, const QString &fileName)
             labs.append(lab);
         so["labels"] = labs;
 
+        if (!s.starts.empty()) {
+            // Filas de anotación: muestras donde empieza cada elemento
+            QJsonArray starts;
+            for (int t = 0; t < s.starts.size(); ++t)
+                if (s.startsItem(t))
+                    starts.append(t);
+            so["starts"] = starts;
+        }
+
         sigArray.append(so);
     }
     root["signals"] = sigArray;
@@ -92,6 +119,7 @@ bool JsonIO::saveToFile(const WaveDocument &doc, const QString &fileName)
 
 bool JsonIO::loadFromFile(WaveDocument &doc, const QString &fileName)
 {
+    WP_TRACE_SCOPE("io", "JsonIO::loadFromFile");
     QFile f(fileName);
     if (!f.open(QIODevice::ReadOnly))
         return false;
@@ -111,13 +139,16 @@ bool JsonIO::loadFromFile(WaveDocument &doc, const QString &fileName)
     // --- Reset básico del documento ---
     doc.m_sampleCount = samples;
     doc.m_signals.clear();
-    doc.m_vcdSignals.clear();
+    doc.m_vcdLibrary.reset();
+    doc.m_vcdTail.reset();
     doc.m_markers.clear();
     doc.m_arrows.clear();
     doc.m_nextMarkerId = 1;
     doc.m_nextArrowId  = 1;
 
     // --- Cargar señales ---
+    // Las derivadas se compilan al final: pueden referirse a señales posteriores
+    std::vector<std::pair<int, QString>> expressions;
     QJsonArray sigArray = root.value("signals").toArray();
     for (const QJsonValue &v : sigArray) {
         if (!v.isObject())
@@ -131,21 +162,58 @@ bool JsonIO::loadFromFile(WaveDocument &doc, const QString &fileName)
         s.type  = (typeStr == "vector") ? SignalType::Vector : SignalType::Bit;
         s.color = QColor(so.value("color").toString("#009600"));
 
+        if (so.contains("expression")) {
+            expressions.emplace_back(static_cast<int>(doc.m_signals.size()),
+                                     so.value("expression").toString());
+            doc.m_signals.push_back(std::move(s));
+            continue;
+        }
+
         QJsonArray vals = so.value("values").toArray();
-        s.values.resize(doc.m_sampleCount, UNDEFINED_VALUE);
+        std::vector<int> values(doc.m_sampleCount, UNDEFINED_VALUE);
         for (int i = 0; i < vals.size() && i < doc.m_sampleCount; ++i) {
-            s.values[i] = vals[i].toInt(UNDEFINED_VALUE);
+            values[i] = vals[i].toInt(UNDEFINED_VALUE);
+        }
+        if (s.type == SignalType::Bit) {
+            s.bits = BitPlane::fromValues(values.data(), doc.m_sampleCount);
+            doc.m_signals.push_back(std::move(s));
+            continue;
         }
+        s.values = std::move(values);
 
         QJsonArray labs = so.value("labels").toArray();
-        s.labels.resize(doc.m_sampleCount);
+        std::vector<QString> labels(doc.m_sampleCount);
         for (int i = 0; i < labs.size() && i < doc.m_sampleCount; ++i) {
-            s.labels[i] = labs[i].toString();
+            labels[i] = labs[i].toString();
+        }
+        s.labels = std::move(labels);
+
+        if (so.contains("starts")) {
+            s.starts = BitPlane(doc.m_sampleCount, 0);
+            for (const QJsonValue &v : so.value("starts").toArray())
+                s.starts.set(v.toInt(-1), 1);
         }
 
         doc.m_signals.push_back(std::move(s));
     }
 
+    if (!expressions.empty()) {
+        const SignalExpr::Resolver resolve = doc.signalResolver();
+        for (const auto &e : expressions) {
+            Signal &s = doc.m_signals[e.first];
+            s.expr = SignalExpr::compile(e.second, resolve, nullptr);
+            if (!s.expr) {
+                // Expresión que ya no compila: queda como señal vacía (X)
+                if (s.type == SignalType::Bit) {
+                    s.bits = BitPlane(doc.m_sampleCount);
+                } else {
+                    s.values = std::vector<int>(doc.m_sampleCount, UNDEFINED_VALUE);
+                    s.labels = std::vector<QString>(doc.m_sampleCount);
+                }
+            }
+        }
+    }
+
     // --- Cargar marcadores (si existen en el fichero) ---
     {
         QJsonArray markerArray = root.value("markers").toArray();
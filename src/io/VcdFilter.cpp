@@ -0,0 +1,81 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFilter.cpp
+// Description:   Include / exclude / scope depth selection of VCD signals at import.
+//======================================================================
+
+#include "io/VcdFilter.h"
+
+bool VcdSignalFilter::compile(const VcdImportOptions &options, VcdSignalFilter *filter, QString *error)
+{
+    VcdSignalFilter f;
+    f.m_maxDepth = options.maxScopeDepth;
+    for (int pass = 0; pass < 2; ++pass) {
+        const QStringList &texts = pass == 0 ? options.include : options.exclude;
+        std::vector<Pattern> &patterns = pass == 0 ? f.m_include : f.m_exclude;
+        for (QString text : texts) {
+            text = text.trimmed();
+            if (text.isEmpty())
+                continue;
+            Pattern p;
+            if (text.size() >= 2 && text.startsWith('/') && text.endsWith('/')) {
+                p.regex = QRegularExpression(text.mid(1, text.size() - 2));
+            } else if (text.contains('*') || text.contains('?')) {
+                // '/' is the only separator the conversion knows: '*' crosses dots.
+                // Brackets are bus ranges ("data[7:0]"), not character sets
+                QString glob;
+                for (const QChar c : text)
+                    glob += c == '[' ? QString("[[]") : c == ']' ? QString("[]]") : QString(c);
+                p.regex = QRegularExpression(QRegularExpression::wildcardToRegularExpression(glob));
+            } else {
+                p.prefix = text;
+            }
+            if (p.prefix.isEmpty() && !p.regex.isValid()) {
+                if (error)
+                    *error = QString("bad pattern %1: %2").arg(text, p.regex.errorString());
+                return false;
+            }
+            patterns.push_back(std::move(p));
+        }
+    }
+    if (filter)
+        *filter = std::move(f);
+    return true;
+}
+
+bool VcdSignalFilter::matches(const std::vector<Pattern> &patterns, const QString &fullName)
+{
+    for (const Pattern &p : patterns) {
+        if (!p.prefix.isEmpty()) {
+            // Below a scope, or the range of a bus ("data[7:0]", "data [7:0]")
+            if (fullName.startsWith(p.prefix)
+                && (fullName.size() == p.prefix.size() || fullName[p.prefix.size()] == '.'
+                    || fullName[p.prefix.size()] == '[' || fullName[p.prefix.size()] == ' '))
+                return true;
+        } else if (p.regex.match(fullName).hasMatch()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VcdSignalFilter::accepts(const QString &fullName, int depth) const
+{
+    if (m_maxDepth > 0 && depth > m_maxDepth)
+        return false;
+    if (!m_include.empty() && !matches(m_include, fullName))
+        return false;
+    return m_exclude.empty() || !matches(m_exclude, fullName);
+}
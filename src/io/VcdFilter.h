@@ -0,0 +1,68 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFilter.h
+// Description:   Include / exclude / scope depth selection of VCD signals at import.
+//======================================================================
+
+#ifndef VCDFILTER_H
+#define VCDFILTER_H
+
+#include "io/VcdImporter.h"
+
+#include <QRegularExpression>
+#include <QString>
+#include <vector>
+
+// Selection of the $vars a VCD import keeps (VcdImportOptions::include /
+// exclude / maxScopeDepth). The parser drops the rest in the header, so
+// their value changes are skipped by identifier code without being
+// decoded or stored.
+//
+// A pattern is one of
+//   top.cpu          a scope or signal name: it and everything below it
+//                    (top.data also takes the bus top.data[7:0])
+//   top.*.irq?       a glob over the full name (* and ? also match '.';
+//                    [ and ] are literal, as in bus ranges)
+//   /^top\.(a|b)\./  a regular expression between slashes (unanchored)
+class VcdSignalFilter
+{
+public:
+    VcdSignalFilter() = default;   // accepts everything
+
+    // False (and *error) if a regular expression does not compile; filter may
+    // be null to only validate the options
+    static bool compile(const VcdImportOptions &options, VcdSignalFilter *filter,
+                        QString *error = nullptr);
+
+    bool acceptsAll() const { return m_include.empty() && m_exclude.empty() && m_maxDepth <= 0; }
+
+    // `depth` is the number of enclosing scopes (top.cpu.clk -> 2)
+    bool accepts(const QString &fullName, int depth) const;
+
+private:
+    struct Pattern
+    {
+        QString prefix;            // plain name: matches itself and prefix + '.'
+        QRegularExpression regex;  // glob or regular expression otherwise
+    };
+
+    std::vector<Pattern> m_include;
+    std::vector<Pattern> m_exclude;
+    int m_maxDepth = 0;
+
+    static bool matches(const std::vector<Pattern> &patterns, const QString &fullName);
+};
+
+#endif // VCDFILTER_H
@@ -0,0 +1,127 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFollower.cpp
+// Description:   Incremental import of a VCD that is still being written (follow mode).
+//======================================================================
+
+#include "io/VcdFollower.h"
+#include "io/VcdParser.h"
+#include "io/VcdInput.h"
+#include "core.h"
+#include "core/VcdLibrary.h"
+#include "utils/Trace.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+VcdFollower::VcdFollower() = default;
+VcdFollower::~VcdFollower() = default;
+
+bool VcdFollower::start(WaveDocument &doc, const QString &fileName, const VcdImportOptions &options)
+{
+    WP_TRACE_SCOPE("io", "VcdFollower::start");
+    stop();
+    // Only plain dumps grow by appending bytes that parse on their own
+    if (VcdInput::detect(fileName) != VcdInput::Compression::None)
+        return false;
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    // Same import as WaveVcdImporter::loadFromVcd() minus finish(): the
+    // last line may still be half written
+    VcdSignalFilter filter;
+    if (!VcdSignalFilter::compile(options, &filter))
+        return false;
+    auto parser = std::make_unique<VcdParser>(WaveVcdImporter::kMaxSamples);
+    parser->setFilter(filter);
+    const qint64 bytes = WaveVcdImporter::feedParser(*parser, f);
+    if (!WaveVcdImporter::buildDocument(doc, *parser, options))
+        return false;
+
+    m_varsOfCode.assign(parser->codeCount(), {});
+    for (int i = 0; i < static_cast<int>(parser->vars().size()); ++i)
+        m_varsOfCode[parser->vars()[i].code].push_back(i);   // library signal i is $var i
+
+    m_parser = std::move(parser);
+    m_fileName = fileName;
+    m_offset = bytes;
+    m_sampleCount = doc.sampleCount();
+    return true;
+}
+
+void VcdFollower::stop()
+{
+    m_parser.reset();
+    m_fileName.clear();
+    m_offset = 0;
+    m_sampleCount = 0;
+    m_varsOfCode.clear();
+}
+
+int VcdFollower::stopWith(const QString &why, QString *reason)
+{
+    if (reason)
+        *reason = why;
+    stop();
+    return -1;
+}
+
+int VcdFollower::poll(WaveDocument &doc, qint64 maxBytes, QString *reason)
+{
+    if (!m_parser)
+        return -1;
+    if (m_parser->limitReached())
+        return stopWith(QString("sample limit (%1) reached").arg(WaveVcdImporter::kMaxSamples), reason);
+    if (doc.sampleCount() != m_sampleCount || !doc.vcdLibrary())
+        return stopWith("the document no longer matches the file", reason);
+
+    // Only the size is looked at when nothing was appended
+    const qint64 size = QFileInfo(m_fileName).size();
+    if (size < m_offset)
+        return stopWith("the file was truncated", reason);
+    if (size == m_offset)
+        return 0;
+
+    WP_TRACE_SCOPE("io", "VcdFollower::poll");
+    QFile f(m_fileName);
+    if (!f.open(QIODevice::ReadOnly) || !f.seek(m_offset))
+        return stopWith("the file cannot be read", reason);
+    m_offset += WaveVcdImporter::feedParser(*m_parser, f, maxBytes);
+
+    // Zero-width glitches stay with the import (VcdTiming)
+    const std::vector<VcdParser::CodeChanges> changed = m_parser->takeChanges();
+    const std::vector<qint64> times = m_parser->takeSampleTimes();
+
+    std::vector<VcdTailChange> changes;
+    const std::vector<VcdParser::Var> &vars = m_parser->vars();
+    for (const VcdParser::CodeChanges &cc : changed) {
+        for (int i : m_varsOfCode[cc.code]) {
+            for (const VcdParser::Change &c : cc.changes) {
+                if (c.value != VcdParser::kWideValue)
+                    changes.push_back({i, c.sample, c.value, QString()});
+                else   // same as the import: 0 plus a marker label on vectors
+                    changes.push_back({i, c.sample, 0, vars[i].width > 1 ? QString("[%1 bits]").arg(vars[i].width) : QString()});
+            }
+        }
+    }
+
+    const int added = m_parser->sampleCount() - m_sampleCount;
+    if (added > 0 || !changes.empty()) {
+        doc.appendVcdTail(m_parser->sampleCount(), times, std::move(changes));
+        m_sampleCount = doc.sampleCount();
+    }
+    return std::max(added, 0);
+}
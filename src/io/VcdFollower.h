@@ -0,0 +1,65 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFollower.h
+// Description:   Incremental import of a VCD that is still being written (follow mode).
+//======================================================================
+
+#ifndef VCDFOLLOWER_H
+#define VCDFOLLOWER_H
+
+#include "io/VcdImporter.h"
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+class WaveDocument;
+class VcdParser;
+
+// Follow mode: imports a VCD that a simulator is still writing and keeps
+// the parser, so every poll() parses only the bytes appended since the
+// previous one (O(new bytes), no re-import) and appends the new samples to
+// the document (WaveDocument::appendVcdTail()). A partial last line waits
+// in the parser until the rest of it arrives.
+class VcdFollower
+{
+public:
+    VcdFollower();
+    ~VcdFollower();
+
+    // Imports `fileName` into `doc` and starts following it (plain VCD only)
+    bool start(WaveDocument &doc, const QString &fileName,
+               const VcdImportOptions &options = VcdImportOptions());
+    void stop();
+    bool isActive() const { return m_parser != nullptr; }
+    const QString &fileName() const { return m_fileName; }
+
+    // Parses at most `maxBytes` of what was appended (the rest waits for the
+    // next call) and extends `doc`. Returns the number of new samples, or -1
+    // when following stopped: `reason` then says why (file truncated, the
+    // document was cut or undone past the followed length, sample limit).
+    int poll(WaveDocument &doc, qint64 maxBytes = 16 << 20, QString *reason = nullptr);
+
+private:
+    std::unique_ptr<VcdParser> m_parser;
+    QString m_fileName;
+    qint64 m_offset = 0;          // bytes parsed so far
+    int m_sampleCount = 0;        // samples the document has from this file
+    std::vector<std::vector<int>> m_varsOfCode;   // library indices per identifier code
+
+    int stopWith(const QString &why, QString *reason);
+};
+
+#endif // VCDFOLLOWER_H
@@ -42,224 +42,203 @@
 // SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //======================================================================
 #include "io/VcdImporter.h"
+#include "io/VcdParser.h"
+#include "io/VcdInput.h"
+#include "io/VcdIndexCache.h"
+#include "io/FstReader.h"
 #include "core.h"
+#include "core/VcdLibrary.h"
+#include "core/DerivedSignal.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
 
-#include <QFile>
-#include <QTextStream>
-#include <QHash>
-#include <QVector>
-#include <QStringList>
+#include <QFileInfo>
+#include <QIODevice>
 #include <algorithm>
 
-
-bool WaveVcdImporter::loadFromVcd(WaveDocument &doc, const QString &fileName)
+bool WaveVcdImporter::loadFromVcd(WaveDocument &doc, const QString &fileName,
+                                  const VcdImportOptions &options)
 {
-    QFile f(fileName);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    WP_TRACE_SCOPE("io", "WaveVcdImporter::loadFromVcd");
+    VcdSignalFilter filter;
+    if (!VcdSignalFilter::compile(options, &filter))
+        return false;
+    VcdInput in(fileName);
+    if (!in.open())
         return false;
 
-    QTextStream ts(&f);
-
-    const int MAX_SAMPLES = 200000; // sample limit for large VCDs
-
-    struct TmpSignal {
-        QString name;
-        QString id;
-        int width = 1;
-        SignalType type = SignalType::Bit;
-        std::vector<int> values;
-        std::vector<QString> labels;
-    };
+    // A large dump opened before with the same filter maps its index instead
+    const bool indexed = options.useIndexCache
+                         && QFileInfo(fileName).size() >= VcdIndexCache::kMinSourceBytes;
+    if (indexed) {
+        auto index = std::make_unique<VcdIndexCache>();
+        auto dump = std::make_shared<VcdParsedDump>();
+        if (index->load(fileName, options, dump.get())) {
+            // Signals are built from the mapped change lists on first use,
+            // unless the index lacks the clock analysis, which needs them all
+            if (options.detectClocks && dump->clocks.size() != dump->vars.size())
+                return buildDocument(doc, *dump, options);
+            const VcdParsedDump &mapped = *dump;
+            return buildDocument(doc, mapped, options,
+                                 std::make_unique<VcdIndexSignalSource>(std::move(index), std::move(dump)));
+        }
+    }
 
-    QVector<TmpSignal> tmpSignals;
-    QHash<QString, int> idToIndex;
-    QStringList scopeStack;
+    // Reading (and decompressing .gz / .zst) runs one block ahead of the
+    // parser; the body of each block is parsed on every core
+    VcdParser parser(kMaxSamples);
+    parser.setFilter(filter);
+    {
+        WP_TRACE_SCOPE("io", "WaveVcdImporter::parse");
+        const bool read = in.pump([&parser](const char *data, qint64 size) {
+            parser.feedParallel(data, size);
+            return !parser.limitReached();
+        }, VcdParser::parallelBlockSize());
+        if (!read)
+            return false;
+        parser.finish();
+    }
 
-    bool inHeader = true;
-    int sampleIdx = -1;
-    int maxSampleIdx = -1;
+    const VcdParsedDump dump = VcdParsedDump::take(parser);
+    if (!buildDocument(doc, dump, options))
+        return false;
+    if (indexed)
+        VcdIndexCache::save(fileName, options, dump, doc.m_vcdLibrary->timing().clocks);
+    return true;
+}
 
-    while (!ts.atEnd()) {
-        QString line = ts.readLine();
-        if (line.isEmpty())
-            continue;
-        line = line.trimmed();
-        if (line.isEmpty())
-            continue;
+bool WaveVcdImporter::isVcdFile(const QString &fileName)
+{
+    return fileName.endsWith(".vcd", Qt::CaseInsensitive)
+        || fileName.endsWith(".vcd.gz", Qt::CaseInsensitive)
+        || fileName.endsWith(".vcd.zst", Qt::CaseInsensitive);
+}
 
-        if (inHeader) {
-            if (line.startsWith("$scope")) {
-                // $scope module top $end
-                QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-                if (parts.size() >= 3) {
-                    QString scopeName = parts[2];
-                    if (scopeName != "$end")
-                        scopeStack.append(scopeName);
-                }
-            } else if (line.startsWith("$upscope")) {
-                if (!scopeStack.isEmpty())
-                    scopeStack.removeLast();
-            } else if (line.startsWith("$var")) {
-                // $var wire 1 ! clk $end
-                QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-                if (parts.size() >= 5) {
-                    QString typeStr = parts[1];
-                    bool okWidth = false;
-                    int width = parts[2].toInt(&okWidth);
-                    if (!okWidth || width <= 0)
-                        width = 1;
-                    QString id = parts[3];
+bool WaveVcdImporter::loadFromFst(WaveDocument &doc, const QString &fileName,
+                                  const VcdImportOptions &options)
+{
+    WP_TRACE_SCOPE("io", "WaveVcdImporter::loadFromFst");
+    VcdSignalFilter filter;
+    if (!VcdSignalFilter::compile(options, &filter))
+        return false;
+    auto reader = std::make_unique<FstReader>();
+    QString error;
+    if (!reader->open(fileName, filter, kMaxSamples, &error)) {
+        qWarning("WavePaint: %s: %s", qPrintable(fileName), qPrintable(error));
+        return false;
+    }
+    const int sampleCount = reader->sampleCount();
+    if (sampleCount == 0)
+        return false;
 
-                    QString name;
-                    for (int i = 4; i < parts.size(); ++i) {
-                        if (parts[i] == "$end")
-                            break;
-                        if (!name.isEmpty())
-                            name += " ";
-                        name += parts[i];
-                    }
-                    if (name.isEmpty())
-                        name = id;
+    // Name and type only: FstSignalSource decodes the samples on first use
+    std::vector<Signal> lib;
+    lib.reserve(reader->vars().size());
+    for (const VcdParser::Var &var : reader->vars())
+        lib.emplace_back(var.name, var.width == 1 ? SignalType::Bit : SignalType::Vector, 0);
 
-                    QString fullName;
-                    if (!scopeStack.isEmpty())
-                        fullName = scopeStack.join(".") + "." + name;
-                    else
-                        fullName = name;
+    VcdTiming timing;
+    timing.timescale = reader->timescale();
+    timing.sampleTimes = reader->sampleTimes();
 
-                    TmpSignal tmp;
-                    tmp.name = fullName;
-                    tmp.id = id;
-                    tmp.width = width;
-                    tmp.type = (width == 1 ? SignalType::Bit : SignalType::Vector);
-                    tmpSignals.append(tmp);
-                    idToIndex.insert(id, tmpSignals.size() - 1);
-                }
-            } else if (line.startsWith("$enddefinitions")) {
-                inHeader = false;
-            }
-            continue;
-        }
+    doc.m_signals.clear();
+    doc.m_sampleCount = sampleCount;
+    doc.m_vcdLibrary = std::make_shared<const VcdLibrary>(std::move(lib), std::move(timing),
+                                                          std::make_unique<FstSignalSource>(std::move(reader)));
+    doc.m_vcdTail.reset();
 
-        // Data body
-        if (line[0] == '#') {
-            // new logical time -> new compressed sample index
-            sampleIdx++;
-            if (sampleIdx > maxSampleIdx)
-                maxSampleIdx = sampleIdx;
+    emit doc.dataChanged();
+    return true;
+}
 
-            if (sampleIdx >= MAX_SAMPLES) {
-                // Avoid continuing to read a huge VCD: keep only the first MAX_SAMPLES samples.
-                break;
-            }
-            continue;
-        }
+bool WaveVcdImporter::isFstFile(const QString &fileName)
+{
+    return fileName.endsWith(".fst", Qt::CaseInsensitive);
+}
 
-        if (line.startsWith("$")) {
-            // Ignore directives like $dumpvars, $end, etc.
-            continue;
-        }
+qint64 WaveVcdImporter::feedParser(VcdParser &parser, QIODevice &in, qint64 maxBytes)
+{
+    constexpr qint64 kBlock = 4 << 20;
+    QByteArray block(int(kBlock), Qt::Uninitialized);
+    qint64 total = 0;
+    while (!parser.limitReached() && (maxBytes < 0 || total < maxBytes)) {
+        const qint64 want = maxBytes < 0 ? kBlock : std::min(kBlock, maxBytes - total);
+        const qint64 got = in.read(block.data(), want);
+        if (got <= 0)
+            break;
+        parser.feed(block.constData(), got);
+        total += got;
+    }
+    return total;
+}
 
-        if (sampleIdx < 0) {
-            // If changes appear before any '#', associate them with sample 0
-            sampleIdx = 0;
-            maxSampleIdx = std::max(maxSampleIdx, sampleIdx);
-        }
+bool WaveVcdImporter::buildDocument(WaveDocument &doc, VcdParser &parser, const VcdImportOptions &options)
+{
+    return buildDocument(doc, VcdParsedDump::take(parser), options);
+}
 
-        QChar c = line[0];
-        if (c == 'b' || c == 'B') {
-            // Format: b<bits> <id>
-            QStringList parts = line.split(' ', Qt::SkipEmptyParts);
-            if (parts.size() < 2)
-                continue;
-            QString bits = parts[0].mid(1);
-            QString id = parts[1];
-            if (!idToIndex.contains(id))
-                continue;
-            TmpSignal &tmp = tmpSignals[idToIndex.value(id)];
-            if (sampleIdx >= static_cast<int>(tmp.values.size())) {
-                tmp.values.resize(sampleIdx + 1, UNDEFINED_VALUE);
-                tmp.labels.resize(sampleIdx + 1);
-            }
+bool WaveVcdImporter::buildDocument(WaveDocument &doc, const VcdParsedDump &dump, const VcdImportOptions &options,
+                                    std::unique_ptr<VcdSignalSource> source)
+{
+    if (dump.sampleCount == 0)
+        return false;
 
-            if (bits.contains('x', Qt::CaseInsensitive) ||
-                bits.contains('z', Qt::CaseInsensitive)) {
-                tmp.values[sampleIdx] = UNDEFINED_VALUE;
-            } else {
-                // For very wide buses we don't try to convert to int,
-                // we just store a marker in the label.
-                if (tmp.width > 32 || bits.size() > 32) {
-                    tmp.values[sampleIdx] = 0;
-                    tmp.labels[sampleIdx] = QString("[%1 bits]").arg(tmp.width);
-                } else {
-                    bool okVal = false;
-                    int val = bits.toInt(&okVal, 2);
-                    tmp.values[sampleIdx] = okVal ? val : UNDEFINED_VALUE;
-                }
-            }
-        } else if (c == '0' || c == '1' || c == 'x' || c == 'X' || c == 'z' || c == 'Z') {
-            // Scalars: 0id / 1id / xid / zid
-            QString id = line.mid(1).trimmed();
-            if (!idToIndex.contains(id))
-                continue;
-            TmpSignal &tmp = tmpSignals[idToIndex.value(id)];
-            if (sampleIdx >= static_cast<int>(tmp.values.size())) {
-                tmp.values.resize(sampleIdx + 1, UNDEFINED_VALUE);
-                tmp.labels.resize(sampleIdx + 1);
-            }
-            if (c == 'x' || c == 'X' || c == 'z' || c == 'Z') {
-                tmp.values[sampleIdx] = UNDEFINED_VALUE;
-            } else {
-                int val = (c == '1') ? 1 : 0;
-                tmp.values[sampleIdx] = val;
-            }
-        } else {
-            // Other lines (not interpreted)
-            continue;
-        }
+    WP_TRACE_SCOPE("io", "WaveVcdImporter::buildLibrary");
+
+    const int sampleCount = dump.sampleCount;
+    const std::vector<VcdParser::Var> &vars = dump.vars;
+
+    VcdTiming timing;
+    timing.timescale = dump.timescale;
+    timing.sampleTimes = dump.sampleTimes;
+
+    // Move into the shared VCD library (without adding to visible waveform yet)
+    std::vector<Signal> lib(vars.size());
+    if (source) {
+        // Name and type only: the source builds the samples on first use
+        for (size_t i = 0; i < vars.size(); ++i)
+            lib[i] = Signal(vars[i].name, vars[i].width == 1 ? SignalType::Bit : SignalType::Vector, 0);
+    } else {
+        parallelFor(static_cast<int>(vars.size()), [&](int i) {
+            const VcdParsedDump::Range &range = dump.changes[vars[i].code];
+            lib[i] = VcdParser::signalFromChanges(vars[i], range.first, range.last, sampleCount);
+        });
     }
 
-    if (maxSampleIdx < 0)
-        return false;
-
-    int sampleCount = maxSampleIdx + 1;
+    // Glitches were recorded per identifier code; aliases get their own copy
+    for (int i = 0; i < static_cast<int>(vars.size()); ++i) {
+        auto range = std::equal_range(dump.glitches.begin(), dump.glitches.end(), VcdGlitch{vars[i].code, 0, 0},
+                                      [](const VcdGlitch &a, const VcdGlitch &b) { return a.signal < b.signal; });
+        for (auto it = range.first; it != range.second; ++it)
+            timing.glitches.push_back({i, it->sample, it->value});
+    }
 
-    // Normalize length and fill with last known value
-    for (TmpSignal &tmp : tmpSignals) {
-        if (static_cast<int>(tmp.values.size()) < sampleCount) {
-            tmp.values.resize(sampleCount, UNDEFINED_VALUE);
-            tmp.labels.resize(sampleCount);
-        }
+    if (options.detectClocks && dump.clocks.size() == lib.size()) {
+        // Analysed when the index was written
+        timing.clocks = dump.clocks;
+    } else if (options.detectClocks && !source) {
+        WP_TRACE_SCOPE("io", "WaveVcdImporter::detectClocks");
+        // Independent per signal; most are rejected by their transition count
+        timing.clocks.resize(lib.size());
+        parallelFor(static_cast<int>(lib.size()), [&](int i) {
+            if (lib[i].isPacked())
+                timing.clocks[i] = detectClock(lib[i].bits, timing.sampleTimes);
+        });
+    }
 
-        int last = UNDEFINED_VALUE;
-        for (int i = 0; i < sampleCount; ++i) {
-            int v = tmp.values[i];
-            if (v != UNDEFINED_VALUE) {
-                last = v;
-            } else {
-                tmp.values[i] = last;
-            }
+    if (options.detectClocks && options.proceduralClocks) {
+        for (size_t i = 0; i < lib.size(); ++i) {
+            if (!timing.clocks[i].uniform)
+                continue;
+            lib[i].expr = SignalExpr::clockExpr(timing.clocks[i].shape);
+            lib[i].bits = BitPlane();
         }
     }
 
-    // Copy to internal VCD library (without adding to visible waveform yet)
-    doc.m_vcdSignals.clear();
     doc.m_signals.clear(); // don't show any signals by default
     doc.m_sampleCount = sampleCount;
-    doc.m_vcdSignals.reserve(tmpSignals.size());
-
-    for (const TmpSignal &tmp : tmpSignals) {
-        Signal s;
-        s.name = tmp.name;
-        s.type = tmp.type;
-        s.values = tmp.values;
-        s.labels = tmp.labels;
-        if (s.type == SignalType::Bit)
-            s.color = QColor(0, 150, 0);
-        else
-            s.color = QColor(0, 0, 180);
-        doc.m_vcdSignals.push_back(std::move(s));
-    }
+    doc.m_vcdLibrary = std::make_shared<const VcdLibrary>(std::move(lib), std::move(timing), std::move(source));
+    doc.m_vcdTail.reset();
 
     emit doc.dataChanged();
     return true;
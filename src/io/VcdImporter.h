@@ -45,15 +45,71 @@
 #define WAVEVCDIMPORTER_H
 
 #include <QString>
+#include <QStringList>
+#include <memory>
 
 class WaveDocument;
+class VcdParser;
+class VcdSignalSource;
+struct VcdParsedDump;
+class QIODevice;
+
+struct VcdImportOptions
+{
+    // Look for periodic Bit signals and label them with their frequency
+    bool detectClocks = true;
+    // Keep exactly periodic clocks as clock(period, phase, high, ...)
+    // expressions instead of their samples
+    bool proceduralClocks = false;
+
+    // Selective import (VcdSignalFilter): keep the $vars matching `include`
+    // (everything if empty) and not `exclude`, at most `maxScopeDepth`
+    // scopes deep (0 = any). The others are skipped while parsing.
+    QStringList include;
+    QStringList exclude;
+    int maxScopeDepth = 0;
+
+    // Reopen large dumps from their index (VcdIndexCache) and write it
+    // after parsing them
+    bool useIndexCache = true;
+};
 
 // Specialized VCD file importer for WaveDocument.
 // All VCD parsing logic is encapsulated here.
 class WaveVcdImporter
 {
 public:
-    static bool loadFromVcd(WaveDocument &doc, const QString &fileName);
+    static constexpr int kMaxSamples = 200000; // sample limit for large VCDs
+
+    // Plain, gzip or zstd compressed dump (see VcdInput)
+    static bool loadFromVcd(WaveDocument &doc, const QString &fileName,
+                            const VcdImportOptions &options = VcdImportOptions());
+
+    // "*.vcd", "*.vcd.gz", "*.vcd.zst"
+    static bool isVcdFile(const QString &fileName);
+
+    // GTKWave FST dump (FstReader): the hierarchy is read now, the samples
+    // of a signal when it is first used. The filter options apply; clocks
+    // are not analysed, since that would decode every signal.
+    static bool loadFromFst(WaveDocument &doc, const QString &fileName,
+                            const VcdImportOptions &options = VcdImportOptions());
+
+    // "*.fst"
+    static bool isFstFile(const QString &fileName);
+
+    // Feeds `in` from its current position to the end (or `maxBytes`) to
+    // `parser` in large blocks; returns the number of bytes read
+    static qint64 feedParser(VcdParser &parser, QIODevice &in, qint64 maxBytes = -1);
+
+    // Replaces the document with a library built from what `parser` has read
+    // (its changes are moved out; the parser can keep going, see
+    // VcdFollower). False if the dump has no sample.
+    static bool buildDocument(WaveDocument &doc, VcdParser &parser, const VcdImportOptions &options);
+    // Same from a dump taken from a parser or mapped from an index. With a
+    // `source` the rows get their name and type only and it decodes their
+    // samples on first use; the clock analysis must then come with `dump`.
+    static bool buildDocument(WaveDocument &doc, const VcdParsedDump &dump, const VcdImportOptions &options,
+                              std::unique_ptr<VcdSignalSource> source = nullptr);
 };
 
 #endif // WAVEVCDIMPORTER_H
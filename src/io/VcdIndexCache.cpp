@@ -0,0 +1,353 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdIndexCache.cpp
+// Description:   Sidecar index of parsed VCD dumps for fast reopen.
+//======================================================================
+
+#include "io/VcdIndexCache.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[8] = {'W', 'P', 'V', 'C', 'D', 'I', 'X', '\0'};
+constexpr quint32 kVersion = 1;
+constexpr quint32 kHasClocks = 1;
+
+struct IndexHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 flags;
+    qint64 sourceSize;
+    qint64 sourceMtime;     // ms since the epoch
+    double timescale;
+    qint32 maxSamples;      // WaveVcdImporter::kMaxSamples it was parsed with
+    qint32 sampleCount;
+    qint32 varCount;
+    qint32 codeCount;
+    qint64 changeCount;
+    qint64 glitchCount;
+    qint64 nameBytes;
+};
+static_assert(sizeof(IndexHeader) == 80, "index header layout");
+static_assert(sizeof(VcdParser::Change) == 8, "change layout");
+
+struct VarRecord
+{
+    qint32 width;
+    qint32 code;
+    qint32 nameOffset;
+    qint32 nameBytes;
+};
+
+struct GlitchRecord
+{
+    qint32 code;
+    qint32 sample;
+    qint32 value;
+    qint32 reserved;
+};
+
+struct ClockRecord
+{
+    qint64 period;
+    qint64 cycles;
+    double duty;
+    qint32 isClock;
+    qint32 uniform;
+    qint32 shape[5];    // period, phase, high, begin, end
+    qint32 reserved;
+};
+
+// Offsets of the sections after the header, from the counts
+struct Layout
+{
+    qint64 sampleTimes, codeOffsets, changes, vars, glitches, clocks, names, total;
+
+    explicit Layout(const IndexHeader &h)
+    {
+        sampleTimes = sizeof(IndexHeader);
+        codeOffsets = sampleTimes + qint64(h.sampleCount) * 8;
+        changes = codeOffsets + (qint64(h.codeCount) + 1) * 8;
+        vars = changes + h.changeCount * qint64(sizeof(VcdParser::Change));
+        glitches = vars + qint64(h.varCount) * qint64(sizeof(VarRecord));
+        clocks = glitches + h.glitchCount * qint64(sizeof(GlitchRecord));
+        names = clocks + ((h.flags & kHasClocks) ? qint64(h.varCount) * qint64(sizeof(ClockRecord)) : 0);
+        total = names + h.nameBytes;
+    }
+};
+
+qint64 sourceMtime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+} // namespace
+
+VcdIndexCache::~VcdIndexCache()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+QString VcdIndexCache::indexPath(const QString &fileName, const VcdImportOptions &options)
+{
+    // Each filter keeps its own index of the same dump
+    QString key = QFileInfo(fileName).absoluteFilePath();
+    key += '\n' + options.include.join('\n');
+    key += '\n' + options.exclude.join('\n');
+    key += '\n' + QString::number(options.maxScopeDepth);
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + "/WavePaint/vcd-index/" + QString::fromLatin1(hash) + ".wpidx";
+}
+
+bool VcdIndexCache::load(const QString &fileName, const VcdImportOptions &options, VcdParsedDump *dump)
+{
+    WP_TRACE_SCOPE("io", "VcdIndexCache::load");
+    if (map(fileName, options, dump)) {
+        // Recently used: the last to go when the directory is trimmed
+        m_file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+        return true;
+    }
+
+    // Stale (the dump changed), from another version or damaged: it would
+    // only take space until the next save replaces it, if there is one
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.close();
+    if (m_file.exists())
+        m_file.remove();
+    return false;
+}
+
+bool VcdIndexCache::map(const QString &fileName, const VcdImportOptions &options, VcdParsedDump *dump)
+{
+    const QFileInfo source(fileName);
+    m_file.setFileName(indexPath(fileName, options));
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(IndexHeader)))
+        return false;
+
+    IndexHeader h;
+    if (m_file.read(reinterpret_cast<char *>(&h), sizeof(h)) != qint64(sizeof(h)))
+        return false;
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion
+        || h.sourceSize != source.size() || h.sourceMtime != sourceMtime(source)
+        || h.maxSamples != WaveVcdImporter::kMaxSamples)
+        return false;
+    if (h.sampleCount <= 0 || h.varCount < 0 || h.codeCount < 0 || h.changeCount < 0
+        || h.glitchCount < 0 || h.nameBytes < 0)
+        return false;
+    const Layout layout(h);
+    if (layout.total != m_file.size())
+        return false;
+
+    m_map = m_file.map(0, layout.total);
+    if (!m_map)
+        return false;
+    const uchar *base = m_map;
+
+    VcdParsedDump d;
+    d.timescale = h.timescale;
+    d.sampleCount = h.sampleCount;
+    d.sampleTimes.resize(h.sampleCount);
+    std::memcpy(d.sampleTimes.data(), base + layout.sampleTimes, size_t(h.sampleCount) * 8);
+
+    // Change lists in place; a damaged index must not reach signalFromChanges()
+    std::vector<qint64> offsets(size_t(h.codeCount) + 1);
+    std::memcpy(offsets.data(), base + layout.codeOffsets, offsets.size() * 8);
+    const auto *changes = reinterpret_cast<const VcdParser::Change *>(base + layout.changes);
+    d.changes.resize(h.codeCount);
+    for (int c = 0; c < h.codeCount; ++c) {
+        if (offsets[c] < 0 || offsets[c] > offsets[c + 1] || offsets[c + 1] > h.changeCount)
+            return false;
+        d.changes[c] = {changes + offsets[c], changes + offsets[c + 1]};
+    }
+    std::atomic<bool> sorted{true};
+    parallelFor(h.codeCount, [&](int c) {
+        int prev = -1;
+        for (const VcdParser::Change *ch = d.changes[c].first; ch != d.changes[c].last; ++ch) {
+            if (ch->sample <= prev || ch->sample >= h.sampleCount) {
+                sorted = false;
+                return;
+            }
+            prev = ch->sample;
+        }
+    });
+    if (!sorted)
+        return false;
+
+    const char *names = reinterpret_cast<const char *>(base + layout.names);
+    d.vars.resize(h.varCount);
+    for (int i = 0; i < h.varCount; ++i) {
+        VarRecord r;
+        std::memcpy(&r, base + layout.vars + qint64(i) * qint64(sizeof(r)), sizeof(r));
+        if (r.code < 0 || r.code >= h.codeCount || r.nameOffset < 0 || r.nameBytes < 0
+            || qint64(r.nameOffset) + r.nameBytes > h.nameBytes)
+            return false;
+        d.vars[i].name = QString::fromUtf8(names + r.nameOffset, r.nameBytes);
+        d.vars[i].width = r.width;
+        d.vars[i].code = r.code;
+    }
+
+    d.glitches.resize(size_t(h.glitchCount));
+    for (qint64 i = 0; i < h.glitchCount; ++i) {
+        GlitchRecord r;
+        std::memcpy(&r, base + layout.glitches + i * qint64(sizeof(r)), sizeof(r));
+        if (r.code < 0 || r.code >= h.codeCount || r.sample < 0 || r.sample >= h.sampleCount)
+            return false;
+        d.glitches[i] = {r.code, r.sample, r.value};
+    }
+
+    if (h.flags & kHasClocks) {
+        d.clocks.resize(h.varCount);
+        for (int i = 0; i < h.varCount; ++i) {
+            ClockRecord r;
+            std::memcpy(&r, base + layout.clocks + qint64(i) * qint64(sizeof(r)), sizeof(r));
+            ClockInfo &info = d.clocks[i];
+            info.isClock = r.isClock != 0;
+            info.uniform = r.uniform != 0;
+            info.period = r.period;
+            info.duty = r.duty;
+            info.cycles = r.cycles;
+            info.shape = {r.shape[0], r.shape[1], r.shape[2], r.shape[3], r.shape[4]};
+        }
+    }
+
+    *dump = std::move(d);
+    return true;
+}
+
+bool VcdIndexCache::save(const QString &fileName, const VcdImportOptions &options,
+                         const VcdParsedDump &dump, const std::vector<ClockInfo> &clocks)
+{
+    WP_TRACE_SCOPE("io", "VcdIndexCache::save");
+    const QString path = indexPath(fileName, options);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return false;
+
+    const QFileInfo source(fileName);
+    IndexHeader h;
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.flags = clocks.size() == dump.vars.size() ? kHasClocks : 0;
+    h.sourceSize = source.size();
+    h.sourceMtime = sourceMtime(source);
+    h.timescale = dump.timescale;
+    h.maxSamples = WaveVcdImporter::kMaxSamples;
+    h.sampleCount = dump.sampleCount;
+    h.varCount = static_cast<qint32>(dump.vars.size());
+    h.codeCount = static_cast<qint32>(dump.changes.size());
+    h.glitchCount = static_cast<qint64>(dump.glitches.size());
+
+    std::vector<qint64> offsets(dump.changes.size() + 1, 0);
+    for (size_t c = 0; c < dump.changes.size(); ++c)
+        offsets[c + 1] = offsets[c] + (dump.changes[c].last - dump.changes[c].first);
+    h.changeCount = offsets.back();
+
+    QByteArray names;
+    std::vector<VarRecord> vars(dump.vars.size());
+    for (size_t i = 0; i < dump.vars.size(); ++i) {
+        const QByteArray utf8 = dump.vars[i].name.toUtf8();
+        vars[i] = {dump.vars[i].width, dump.vars[i].code, static_cast<qint32>(names.size()),
+                   static_cast<qint32>(utf8.size())};
+        names.append(utf8);
+    }
+    h.nameBytes = names.size();
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly))
+        return false;
+    auto put = [&out](const void *data, qint64 size) {
+        if (size > 0)
+            out.write(static_cast<const char *>(data), size);
+    };
+    put(&h, sizeof(h));
+    put(dump.sampleTimes.data(), qint64(dump.sampleTimes.size()) * 8);
+    put(offsets.data(), qint64(offsets.size()) * 8);
+    for (const VcdParsedDump::Range &r : dump.changes)
+        put(r.first, (r.last - r.first) * qint64(sizeof(VcdParser::Change)));
+    put(vars.data(), qint64(vars.size()) * qint64(sizeof(VarRecord)));
+    for (const VcdGlitch &g : dump.glitches) {
+        const GlitchRecord r{g.signal, g.sample, g.value, 0};
+        put(&r, sizeof(r));
+    }
+    if (h.flags & kHasClocks) {
+        for (const ClockInfo &info : clocks) {
+            const ClockRecord r{info.period, info.cycles, info.duty, info.isClock, info.uniform,
+                                {info.shape.period, info.shape.phase, info.shape.high,
+                                 info.shape.begin, info.shape.end}, 0};
+            put(&r, sizeof(r));
+        }
+    }
+    put(names.constData(), names.size());
+    if (!out.commit())
+        return false;
+
+    trimCache(QFileInfo(path).absolutePath(), kMaxCacheBytes, path);
+    return true;
+}
+
+void VcdIndexCache::trimCache(const QString &dir, qint64 maxBytes, const QString &keep)
+{
+    WP_TRACE_SCOPE("io", "VcdIndexCache::trimCache");
+    // Newest first: what is past the budget is the least recently used
+    const QFileInfoList entries = QDir(dir).entryInfoList(QStringList() << "*.wpidx", QDir::Files, QDir::Time);
+    const QFileInfo kept(keep);
+    qint64 total = kept.size();
+    for (const QFileInfo &entry : entries) {
+        if (entry.absoluteFilePath() == kept.absoluteFilePath())
+            continue;
+        if (total + entry.size() > maxBytes)
+            QFile::remove(entry.absoluteFilePath());
+        else
+            total += entry.size();
+    }
+}
+
+VcdIndexSignalSource::VcdIndexSignalSource(std::unique_ptr<VcdIndexCache> index,
+                                           std::shared_ptr<const VcdParsedDump> dump)
+    : m_index(std::move(index)),
+      m_dump(std::move(dump))
+{
+}
+
+void VcdIndexSignalSource::load(const std::vector<int> &indices, const std::vector<Signal *> &targets)
+{
+    WP_TRACE_SCOPE("io", "VcdIndexSignalSource::load");
+    const VcdParsedDump &dump = *m_dump;
+    parallelFor(static_cast<int>(indices.size()), [&](int k) {
+        if (targets[k]->isDerived())
+            return;
+        const VcdParser::Var &var = dump.vars[indices[k]];
+        const VcdParsedDump::Range &range = dump.changes[var.code];
+        Signal s = VcdParser::signalFromChanges(var, range.first, range.last, dump.sampleCount);
+        targets[k]->bits = std::move(s.bits);
+        targets[k]->values = std::move(s.values);
+        targets[k]->labels = std::move(s.labels);
+    });
+}
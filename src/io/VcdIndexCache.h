@@ -0,0 +1,95 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdIndexCache.h
+// Description:   Sidecar index of parsed VCD dumps for fast reopen.
+//======================================================================
+
+#ifndef VCDINDEXCACHE_H
+#define VCDINDEXCACHE_H
+
+#include "io/VcdImporter.h"
+#include "io/VcdParser.h"
+#include "core/VcdLibrary.h"
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+
+// Sidecar index of a parsed dump: one file per dump path and import filter
+// in the user cache directory (<cache>/WavePaint/vcd-index). Reopening a large VCD maps the index
+// instead of reading, decompressing and parsing the dump again, and skips
+// the clock analysis.
+//
+// The index is valid while the dump keeps the size and modification time
+// it was written for; a stale or damaged index is deleted when found. The
+// directory is kept under kMaxCacheBytes, dropping the indexes used least
+// recently (by file modification time, renewed on every load). Layout (native byte order, 8-byte aligned sections):
+//   header | sample times | change offsets per code | changes (sample, value)
+//   | vars (width, code, name) | glitches | clock analysis per var | names
+// The change lists are used in place from the mapping.
+class VcdIndexCache
+{
+public:
+    // Smaller dumps are parsed every time
+    static constexpr qint64 kMinSourceBytes = 32 << 20;
+    // Total size of the index directory kept after a save
+    static constexpr qint64 kMaxCacheBytes = qint64(4) << 30;
+
+    VcdIndexCache() = default;
+    ~VcdIndexCache();
+    VcdIndexCache(const VcdIndexCache &) = delete;
+    VcdIndexCache &operator=(const VcdIndexCache &) = delete;
+
+    // Maps the index of `fileName` if it is current; the change lists of
+    // `dump` then point into the mapping, which lives as long as this object.
+    // False if there is none, it is stale or it does not check out (then it
+    // is deleted).
+    bool load(const QString &fileName, const VcdImportOptions &options, VcdParsedDump *dump);
+
+    // Writes (replaces) the index of `fileName`; `clocks` per var, may be
+    // empty. Then trims the directory to kMaxCacheBytes.
+    static bool save(const QString &fileName, const VcdImportOptions &options,
+                     const VcdParsedDump &dump, const std::vector<ClockInfo> &clocks);
+
+    static QString indexPath(const QString &fileName, const VcdImportOptions &options);
+
+    // Deletes the least recently used indexes in `dir` until the rest fit in
+    // `maxBytes`; `keep` (the index just written) is never deleted
+    static void trimCache(const QString &dir, qint64 maxBytes, const QString &keep);
+
+private:
+    QFile m_file;
+    uchar *m_map = nullptr;
+
+    bool map(const QString &fileName, const VcdImportOptions &options, VcdParsedDump *dump);
+};
+
+// Library source over a mapped index: a signal is built from its change
+// list on first use, so reopening costs O(vars) instead of O(vars x samples).
+// Procedural clock rows have no samples to load.
+class VcdIndexSignalSource : public VcdSignalSource
+{
+public:
+    VcdIndexSignalSource(std::unique_ptr<VcdIndexCache> index, std::shared_ptr<const VcdParsedDump> dump);
+
+    void load(const std::vector<int> &indices, const std::vector<Signal *> &targets) override;
+
+private:
+    std::unique_ptr<VcdIndexCache> m_index;        // the mapping the change lists point into
+    std::shared_ptr<const VcdParsedDump> m_dump;   // released before the mapping
+};
+
+#endif // VCDINDEXCACHE_H
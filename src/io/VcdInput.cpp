@@ -0,0 +1,303 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdInput.cpp
+// Description:   Plain / gzip / zstd byte source for the VCD importer.
+//======================================================================
+
+#include "io/VcdInput.h"
+#include "utils/Trace.h"
+
+#include <QByteArray>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef WAVEPAINT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef WAVEPAINT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr qint64 kInputBlock = 1 << 20;   // compressed bytes per file read
+constexpr qint64 kPumpBlock  = 4 << 20;   // decompressed bytes per parser block
+constexpr qint64 kPumpAhead  = 12 << 20;  // decompressed bytes waiting for the parser
+
+} // namespace
+
+struct VcdInput::Decoder
+{
+    std::vector<char> in = std::vector<char>(kInputBlock);   // compressed input
+    size_t inPos = 0;
+    size_t inSize = 0;
+    bool inputEnd = false;
+    bool finished = false;
+    bool failed = false;
+    bool midStream = false;   // inside a gzip stream / zstd frame
+#ifdef WAVEPAINT_HAVE_ZLIB
+    z_stream zs{};
+    bool zlibReady = false;
+#endif
+#ifdef WAVEPAINT_HAVE_ZSTD
+    ZSTD_DStream *zstd = nullptr;
+#endif
+
+    ~Decoder()
+    {
+#ifdef WAVEPAINT_HAVE_ZLIB
+        if (zlibReady)
+            inflateEnd(&zs);
+#endif
+#ifdef WAVEPAINT_HAVE_ZSTD
+        if (zstd)
+            ZSTD_freeDStream(zstd);
+#endif
+    }
+
+    // Next compressed block once the current one is used up
+    bool refill(QFile &file)
+    {
+        if (inPos < inSize || inputEnd)
+            return true;
+        const qint64 n = file.read(in.data(), kInputBlock);
+        if (n < 0)
+            return false;
+        inPos = 0;
+        inSize = size_t(n);
+        inputEnd = (n == 0);
+        return true;
+    }
+};
+
+VcdInput::VcdInput(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+VcdInput::~VcdInput() = default;
+
+VcdInput::Compression VcdInput::detect(const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return Compression::None;
+    const QByteArray magic = f.read(4);
+    if (magic.size() >= 2 && uchar(magic[0]) == 0x1f && uchar(magic[1]) == 0x8b)
+        return Compression::Gzip;
+    if (magic.size() == 4 && uchar(magic[0]) == 0x28 && uchar(magic[1]) == 0xb5
+        && uchar(magic[2]) == 0x2f && uchar(magic[3]) == 0xfd)
+        return Compression::Zstd;
+    return Compression::None;
+}
+
+bool VcdInput::isSupported(Compression compression)
+{
+    switch (compression) {
+    case Compression::None:
+        return true;
+    case Compression::Gzip:
+#ifdef WAVEPAINT_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Compression::Zstd:
+#ifdef WAVEPAINT_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool VcdInput::open(QString *error)
+{
+    m_compression = detect(m_file.fileName());
+    if (!isSupported(m_compression)) {
+        if (error)
+            *error = m_compression == Compression::Gzip
+                         ? QString("this build has no gzip support (zlib)")
+                         : QString("this build has no zstd support (libzstd)");
+        return false;
+    }
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error)
+            *error = m_file.errorString();
+        return false;
+    }
+
+    m_decoder.reset();
+    if (m_compression == Compression::None)
+        return true;
+    m_decoder = std::make_unique<Decoder>();
+#ifdef WAVEPAINT_HAVE_ZLIB
+    if (m_compression == Compression::Gzip) {
+        // 15 + 16: gzip wrapper, largest window
+        if (inflateInit2(&m_decoder->zs, 15 + 16) != Z_OK) {
+            if (error)
+                *error = QString("zlib initialisation failed");
+            return false;
+        }
+        m_decoder->zlibReady = true;
+    }
+#endif
+#ifdef WAVEPAINT_HAVE_ZSTD
+    if (m_compression == Compression::Zstd) {
+        m_decoder->zstd = ZSTD_createDStream();
+        if (!m_decoder->zstd || ZSTD_isError(ZSTD_initDStream(m_decoder->zstd))) {
+            if (error)
+                *error = QString("zstd initialisation failed");
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+qint64 VcdInput::read(char *data, qint64 max)
+{
+    if (m_compression == Compression::None)
+        return m_file.read(data, max);
+
+    Decoder &d = *m_decoder;
+    if (d.failed)
+        return -1;
+    max = std::min<qint64>(max, 1 << 30);
+    qint64 produced = 0;
+    while (produced == 0 && !d.finished) {
+        if (!d.refill(m_file))
+            return -1;
+        if (d.inPos == d.inSize && d.inputEnd) {
+            // End of the file: fine between streams / frames, not inside one
+            d.finished = true;
+            d.failed = d.midStream;   // truncated
+            break;
+        }
+#ifdef WAVEPAINT_HAVE_ZLIB
+        if (m_compression == Compression::Gzip) {
+            z_stream &zs = d.zs;
+            zs.next_in = reinterpret_cast<Bytef *>(d.in.data() + d.inPos);
+            zs.avail_in = uInt(d.inSize - d.inPos);
+            zs.next_out = reinterpret_cast<Bytef *>(data);
+            zs.avail_out = uInt(max);
+            const int rc = inflate(&zs, Z_NO_FLUSH);
+            d.inPos = d.inSize - zs.avail_in;
+            produced = max - zs.avail_out;
+            d.midStream = (rc != Z_STREAM_END);
+            if (rc == Z_STREAM_END) {
+                // Concatenated .gz files hold one stream per member
+                if (!d.refill(m_file))
+                    return -1;
+                if (d.inPos == d.inSize && d.inputEnd)
+                    d.finished = true;
+                else
+                    inflateReset(&zs);
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                d.failed = true;
+            }
+        }
+#endif
+#ifdef WAVEPAINT_HAVE_ZSTD
+        if (m_compression == Compression::Zstd) {
+            // Concatenated frames are handled by the stream itself
+            ZSTD_inBuffer in = {d.in.data(), d.inSize, d.inPos};
+            ZSTD_outBuffer out = {data, size_t(max), 0};
+            const size_t rc = ZSTD_decompressStream(d.zstd, &out, &in);
+            if (ZSTD_isError(rc)) {
+                d.failed = true;
+            } else {
+                d.inPos = in.pos;
+                d.midStream = (rc != 0);   // 0: a frame just ended
+                produced = qint64(out.pos);
+            }
+        }
+#endif
+        if (d.failed)
+            return produced > 0 ? produced : -1;
+    }
+    return d.failed ? -1 : produced;
+}
+
+bool VcdInput::pump(const std::function<bool(const char *, qint64)> &consume, qint64 blockSize)
+{
+    if (blockSize <= 0)
+        blockSize = kPumpBlock;
+    const size_t depth = size_t(std::max<qint64>(1, kPumpAhead / blockSize));
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<QByteArray> blocks;
+    bool done = false;
+    bool failed = false;
+    bool stop = false;
+
+    // Producer: reads / decompresses full blocks ahead of the parser
+    std::thread reader([&]() {
+        Tracer::setThreadName("VCD reader");
+        for (;;) {
+            QByteArray block(int(blockSize), Qt::Uninitialized);
+            qint64 filled = 0;
+            qint64 n = 0;
+            {
+                WP_TRACE_SCOPE("io", "VcdInput::read");
+                while (filled < blockSize && (n = read(block.data() + filled, blockSize - filled)) > 0)
+                    filled += n;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return blocks.size() < depth || stop; });
+            if (stop)
+                return;
+            if (filled > 0) {
+                block.resize(int(filled));
+                blocks.push_back(std::move(block));
+            }
+            if (n <= 0) {
+                done = true;
+                failed = (n < 0);
+                cv.notify_all();
+                return;
+            }
+            cv.notify_all();
+        }
+    });
+
+    // Consumer: the caller's thread
+    for (;;) {
+        QByteArray block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return !blocks.empty() || done; });
+            if (blocks.empty())
+                break;
+            block = std::move(blocks.front());
+            blocks.pop_front();
+            cv.notify_all();
+        }
+        if (!consume(block.constData(), block.size())) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+            cv.notify_all();
+            break;
+        }
+    }
+    reader.join();
+    return !failed;
+}
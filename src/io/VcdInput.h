@@ -0,0 +1,66 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdInput.h
+// Description:   Plain / gzip / zstd byte source for the VCD importer.
+//======================================================================
+
+#ifndef VCDINPUT_H
+#define VCDINPUT_H
+
+#include <QFile>
+#include <QString>
+#include <functional>
+#include <memory>
+
+// Byte source of the VCD importer: a plain dump or a gzip / zstd compressed
+// one (.vcd.gz, .vcd.zst; detected from the first bytes, not the name),
+// decompressed while it is read, never to a temporary file.
+//
+// Decompression needs zlib / libzstd at build time (WAVEPAINT_HAVE_ZLIB,
+// WAVEPAINT_HAVE_ZSTD, set by CMake when they are found); without them
+// open() rejects those files.
+class VcdInput
+{
+public:
+    enum class Compression { None, Gzip, Zstd };
+
+    explicit VcdInput(const QString &fileName);
+    ~VcdInput();
+
+    // False if the file cannot be read or its compression is not built in
+    bool open(QString *error = nullptr);
+    Compression compression() const { return m_compression; }
+
+    // Up to `max` decompressed bytes: 0 at the end, -1 on error
+    qint64 read(char *data, qint64 max);
+
+    // Reads everything, handing blocks to `consume` on the calling thread
+    // while the next ones are read and decompressed on another thread, so
+    // decompression overlaps parsing. `consume` returns false to stop early.
+    // blockSize 0 uses 4 MB blocks. False on a read or decompression error.
+    bool pump(const std::function<bool(const char *, qint64)> &consume, qint64 blockSize = 0);
+
+    static Compression detect(const QString &fileName);
+    static bool isSupported(Compression compression);
+
+private:
+    struct Decoder;
+
+    QFile m_file;
+    Compression m_compression = Compression::None;
+    std::unique_ptr<Decoder> m_decoder;
+};
+
+#endif // VCDINPUT_H
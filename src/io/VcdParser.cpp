@@ -0,0 +1,516 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdParser.cpp
+// Description:   Resumable, block-fed VCD tokenizer (header + per-code value changes).
+//======================================================================
+
+#include "io/VcdParser.h"
+#include "utils/Parallel.h"
+#include "utils/Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Bytes of the body parsed by one worker of feedParallel()
+constexpr qint64 kPieceBytes = 4 << 20;
+
+bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// First line in [from, end) that starts with '#' and follows a '\n' at or
+// after `from`: where a piece may begin. `end` if there is none.
+const char *nextTimestampLine(const char *from, const char *end)
+{
+    while (from != end) {
+        const char *nl = static_cast<const char *>(std::memchr(from, '\n', size_t(end - from)));
+        if (!nl || nl + 1 == end)
+            return end;
+        if (nl[1] == '#')
+            return nl + 1;
+        from = nl + 1;
+    }
+    return end;
+}
+
+// "1ns", "10 ps", "1 s" -> seconds per time unit (0 if not understood)
+double parseTimescale(QString text)
+{
+    text.remove("$end");
+    text.remove(' ');
+    text.remove('\t');
+    int digits = 0;
+    while (digits < text.size() && text[digits].isDigit())
+        ++digits;
+    bool ok = false;
+    const double mult = text.left(digits).toDouble(&ok);
+    if (!ok)
+        return 0.0;
+    const QString unit = text.mid(digits).toLower();
+    static const struct { const char *unit; double seconds; } units[] = {
+        {"s", 1.0}, {"ms", 1e-3}, {"us", 1e-6}, {"ns", 1e-9}, {"ps", 1e-12}, {"fs", 1e-15},
+    };
+    for (const auto &u : units)
+        if (unit == QLatin1String(u.unit))
+            return mult * u.seconds;
+    return 0.0;
+}
+
+} // namespace
+
+int VcdParser::vectorValue(const char *bits, const char *end, int width)
+{
+    for (const char *p = bits; p != end; ++p)
+        if (*p == 'x' || *p == 'X' || *p == 'z' || *p == 'Z')
+            return UNDEFINED_VALUE;
+    // For very wide buses we don't try to convert to int,
+    // we just store a marker in the label.
+    if (width > 32 || end - bits > 32)
+        return kWideValue;
+    if (bits == end)
+        return UNDEFINED_VALUE;
+    quint64 v = 0;
+    for (const char *p = bits; p != end; ++p) {
+        if (*p != '0' && *p != '1')
+            return UNDEFINED_VALUE;
+        v = (v << 1) | quint64(*p == '1');
+    }
+    if (v > quint64(std::numeric_limits<int>::max()))
+        return UNDEFINED_VALUE;
+    return static_cast<int>(v);
+}
+
+Signal VcdParser::signalFromChanges(const Var &var, const Change *first, const Change *last, int sampleCount)
+{
+    Signal s(var.name, var.width == 1 ? SignalType::Bit : SignalType::Vector, 0);
+    const Change *changes = first;
+    const int n = static_cast<int>(last - first);
+    if (s.type == SignalType::Bit) {
+        // 2 bits per sample instead of an int and a QString
+        BitPlane bits(sampleCount);   // X until the first change
+        for (int k = 0; k < n; ++k) {
+            const int end = (k + 1 < n) ? changes[k + 1].sample : sampleCount;
+            const int v = changes[k].value == kWideValue ? 0 : changes[k].value;
+            bits.fill(changes[k].sample, end, v);
+        }
+        s.bits = std::move(bits);
+        return s;
+    }
+
+    std::vector<int> values(sampleCount, UNDEFINED_VALUE);
+    std::vector<QString> labels(sampleCount);
+    const QString wide = QString("[%1 bits]").arg(var.width);
+    for (int k = 0; k < n; ++k) {
+        const int start = changes[k].sample;
+        const int end = (k + 1 < n) ? changes[k + 1].sample : sampleCount;
+        int v = changes[k].value;
+        if (v == kWideValue) {
+            v = 0;
+            labels[start] = wide;
+        }
+        std::fill(values.begin() + start, values.begin() + end, v);
+    }
+    s.values = std::move(values);
+    s.labels = std::move(labels);
+    return s;
+}
+
+VcdParser::VcdParser(int maxSamples)
+    : m_maxSamples(maxSamples)
+{
+}
+
+void VcdParser::feed(const char *data, qint64 size)
+{
+    const char *p = data;
+    const char *end = data + size;
+    while (p != end && !m_limitReached) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+        if (!nl) {
+            m_pending.append(p, int(end - p));
+            return;
+        }
+        if (!m_pending.isEmpty()) {
+            // Finish the line started by the previous block
+            m_pending.append(p, int(nl - p));
+            const QByteArray line = std::move(m_pending);
+            m_pending = QByteArray();
+            parseLine(line.constData(), line.constData() + line.size());
+        } else {
+            parseLine(p, nl);
+        }
+        p = nl + 1;
+    }
+}
+
+qint64 VcdParser::parallelBlockSize()
+{
+    return std::min<qint64>(parallelWorkers(), 16) * kPieceBytes;
+}
+
+void VcdParser::feedParallel(const char *data, qint64 size)
+{
+    const int workers = int(std::min<qint64>(parallelWorkers(), size / kPieceBytes));
+    if (!m_headerDone || m_limitReached || workers < 2) {
+        feed(data, size);
+        return;
+    }
+    WP_TRACE_SCOPE("io", "VcdParser::feedParallel");
+
+    // The end of a line of the previous block and whatever comes before the
+    // first timestamp are parsed here; the rest is cut into whole samples
+    const char *end = data + size;
+    const char *first = nextTimestampLine(data, end);
+    feed(data, first - data);
+    const char *last = end;
+    while (last != first && last[-1] != '\n')
+        --last;
+    if (m_limitReached || last == first) {
+        feed(first, end - first);
+        return;
+    }
+
+    std::vector<const char *> cuts{first};
+    for (int i = 1; i < workers; ++i) {
+        const char *cut = nextTimestampLine(first + (last - first) * i / workers - 1, last);
+        if (cut > cuts.back() && cut != last)
+            cuts.push_back(cut);
+    }
+    cuts.push_back(last);
+    const int count = static_cast<int>(cuts.size()) - 1;
+
+    while (static_cast<int>(m_pieces.size()) < count)
+        m_pieces.push_back(forkBody());
+    // No piece can keep more samples than the whole parse has room for
+    const int room = m_maxSamples - m_sampleCount;
+    parallelFor(count, [&](int i) {
+        WP_TRACE_SCOPE("io", "VcdParser::parsePiece");
+        VcdParser &piece = *m_pieces[i];
+        piece.m_maxSamples = room;
+        piece.feed(cuts[i], cuts[i + 1] - cuts[i]);
+    });
+    stitchPieces(count);
+
+    // A partial last line waits for the next block as with feed()
+    if (!m_limitReached)
+        m_pending.append(last, int(end - last));
+}
+
+std::unique_ptr<VcdParser> VcdParser::forkBody() const
+{
+    // The identifier table is shared (implicitly, read-only), the body state is the piece's own
+    std::unique_ptr<VcdParser> piece(new VcdParser(0));
+    piece->m_headerDone = true;
+    piece->m_codeById = m_codeById;
+    piece->m_codes.resize(m_codes.size());
+    for (size_t c = 0; c < m_codes.size(); ++c)
+        piece->m_codes[c].width = m_codes[c].width;
+    return piece;
+}
+
+void VcdParser::stitchPieces(int count)
+{
+    WP_TRACE_SCOPE("io", "VcdParser::stitchPieces");
+
+    // Sample numbers of each piece start after those of the previous ones;
+    // the first piece that passes the limit is cut there and ends the parse
+    std::vector<int> offset(count), keep(count);
+    int used = count;
+    for (int i = 0; i < count; ++i) {
+        const VcdParser &piece = *m_pieces[i];
+        const int room = m_maxSamples - m_sampleCount;
+        offset[i] = m_sampleCount;
+        keep[i] = std::min(piece.m_sampleCount, room);
+        m_sampleTimes.insert(m_sampleTimes.end(), piece.m_sampleTimes.begin(),
+                             piece.m_sampleTimes.begin() + keep[i]);
+        m_sampleCount += keep[i];
+        if (piece.m_limitReached || piece.m_sampleCount > room) {
+            m_limitReached = true;
+            used = i + 1;
+            break;
+        }
+    }
+
+    // Codes in order of their first change, as feed() lists them
+    if (m_stitched.size() != m_codes.size())
+        m_stitched.assign(m_codes.size(), 0);
+    std::vector<int> codes;
+    for (int i = 0; i < used; ++i) {
+        const VcdParser &piece = *m_pieces[i];
+        for (int code : piece.m_changedCodes) {
+            if (m_stitched[code] || piece.m_codes[code].changes.front().sample >= keep[i])
+                continue;
+            m_stitched[code] = 1;
+            codes.push_back(code);
+            if (m_codes[code].changes.empty())
+                m_changedCodes.push_back(code);
+        }
+        for (const VcdGlitch &g : piece.m_glitches)
+            if (g.sample < keep[i])
+                m_glitches.push_back({g.signal, g.sample + offset[i], g.value});
+    }
+
+    // Every code is appended to independently; the last value and sample
+    // carry over so a later feed() continues from the stitched state
+    constexpr int kCodesPerTask = 256;
+    const int tasks = (static_cast<int>(codes.size()) + kCodesPerTask - 1) / kCodesPerTask;
+    parallelFor(tasks, [&](int t) {
+        const int begin = t * kCodesPerTask;
+        const int endCode = std::min(begin + kCodesPerTask, static_cast<int>(codes.size()));
+        for (int k = begin; k < endCode; ++k) {
+            const int code = codes[k];
+            Code &cd = m_codes[code];
+            m_stitched[code] = 0;
+            for (int i = 0; i < used; ++i) {
+                const Code &src = m_pieces[i]->m_codes[code];
+                for (const Change &ch : src.changes) {
+                    if (ch.sample >= keep[i])
+                        break;
+                    cd.changes.push_back({ch.sample + offset[i], ch.value});
+                    cd.lastSample = ch.sample + offset[i];
+                    cd.lastValue = ch.value;
+                }
+                if (src.lastGlitch >= 0 && src.lastGlitch < keep[i])
+                    cd.lastGlitch = src.lastGlitch + offset[i];
+            }
+        }
+    });
+
+    // Reset the pieces for the next block (only the codes they touched)
+    parallelFor(count, [&](int i) {
+        VcdParser &piece = *m_pieces[i];
+        for (int code : piece.m_changedCodes) {
+            Code &cd = piece.m_codes[code];
+            cd.changes.clear();
+            cd.lastSample = -1;
+            cd.lastValue = UNDEFINED_VALUE;
+            cd.lastGlitch = -1;
+        }
+        piece.m_changedCodes.clear();
+        piece.m_glitches.clear();
+        piece.m_sampleTimes.clear();
+        piece.m_sampleCount = 0;
+        piece.m_limitReached = false;
+    });
+}
+
+void VcdParser::finish()
+{
+    if (m_pending.isEmpty())
+        return;
+    const QByteArray line = std::move(m_pending);
+    m_pending = QByteArray();
+    if (!m_limitReached)
+        parseLine(line.constData(), line.constData() + line.size());
+}
+
+void VcdParser::parseLine(const char *begin, const char *end)
+{
+    while (begin != end && isBlank(*begin))
+        ++begin;
+    while (end != begin && isBlank(end[-1]))
+        --end;
+    if (begin == end)
+        return;
+
+    if (m_headerDone)
+        parseBodyLine(begin, end);
+    else
+        parseHeaderLine(QString::fromUtf8(begin, int(end - begin)));
+}
+
+void VcdParser::parseHeaderLine(const QString &line)
+{
+    if (m_inTimescale || line.startsWith("$timescale")) {
+        // "$timescale 1ns $end", possibly over several lines
+        m_timescaleText += ' ' + (m_inTimescale ? line : line.mid(10));
+        m_inTimescale = !line.contains("$end");
+        if (!m_inTimescale)
+            m_timescale = parseTimescale(m_timescaleText);
+    } else if (line.startsWith("$scope")) {
+        // $scope module top $end
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() >= 3 && parts[2] != "$end")
+            m_scopeStack.append(parts[2]);
+    } else if (line.startsWith("$upscope")) {
+        if (!m_scopeStack.isEmpty())
+            m_scopeStack.removeLast();
+    } else if (line.startsWith("$var")) {
+        // $var wire 1 ! clk $end
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.size() < 5)
+            return;
+        bool okWidth = false;
+        int width = parts[2].toInt(&okWidth);
+        if (!okWidth || width <= 0)
+            width = 1;
+        const QString &id = parts[3];
+
+        QString name;
+        for (int i = 4; i < parts.size(); ++i) {
+            if (parts[i] == "$end")
+                break;
+            if (!name.isEmpty())
+                name += " ";
+            name += parts[i];
+        }
+        if (name.isEmpty())
+            name = id;
+
+        Var var;
+        var.name = m_scopeStack.isEmpty() ? name : m_scopeStack.join(".") + "." + name;
+        var.width = width;
+        if (!m_filter.accepts(var.name, m_scopeStack.size()))
+            return;
+        // Aliases ($var lines sharing an id) read the same changes
+        const QByteArray key = id.toUtf8();
+        var.code = m_codeById.value(key, -1);
+        if (var.code < 0) {
+            var.code = static_cast<int>(m_codes.size());
+            m_codeById.insert(key, var.code);
+            m_codes.emplace_back();
+            m_codes.back().width = width;
+        }
+        m_vars.push_back(std::move(var));
+    } else if (line.startsWith("$enddefinitions")) {
+        m_headerDone = true;
+    }
+}
+
+void VcdParser::parseBodyLine(const char *begin, const char *end)
+{
+    const char c = *begin;
+    if (c == '#') {
+        // new logical time -> new compressed sample index
+        if (m_sampleCount >= m_maxSamples) {
+            // Avoid continuing to read a huge VCD: keep only the first maxSamples samples.
+            m_limitReached = true;
+            return;
+        }
+        qint64 t = 0;
+        for (const char *p = begin + 1; p != end && *p >= '0' && *p <= '9'; ++p)
+            t = t * 10 + (*p - '0');
+        m_sampleTimes.push_back(t);
+        ++m_sampleCount;
+        return;
+    }
+
+    if (c == '$') {
+        // Ignore directives like $dumpvars, $end, etc.
+        return;
+    }
+
+    if (c == 'b' || c == 'B') {
+        // Format: b<bits> <id>
+        const char *bitsEnd = begin + 1;
+        while (bitsEnd != end && !isBlank(*bitsEnd))
+            ++bitsEnd;
+        const char *id = bitsEnd;
+        while (id != end && isBlank(*id))
+            ++id;
+        const int code = codeOf(id, end);
+        if (code >= 0)
+            recordChange(code, vectorValue(begin + 1, bitsEnd, m_codes[code].width));
+    } else if (c == '0' || c == '1' || c == 'x' || c == 'X' || c == 'z' || c == 'Z') {
+        // Scalars: 0id / 1id / xid / zid
+        const char *id = begin + 1;
+        while (id != end && isBlank(*id))
+            ++id;
+        const int code = codeOf(id, end);
+        if (code >= 0)
+            recordChange(code, (c == '0' || c == '1') ? c - '0' : UNDEFINED_VALUE);
+    }
+    // Other lines (real values, strings) are not interpreted
+}
+
+int VcdParser::codeOf(const char *begin, const char *end) const
+{
+    if (begin == end)
+        return -1;
+    return m_codeById.value(QByteArray::fromRawData(begin, int(end - begin)), -1);
+}
+
+void VcdParser::recordChange(int code, int value)
+{
+    if (m_sampleCount == 0) {
+        // If changes appear before any '#', associate them with sample 0
+        m_sampleTimes.push_back(0);
+        m_sampleCount = 1;
+    }
+    const int sample = m_sampleCount - 1;
+    Code &cd = m_codes[code];
+    if (cd.lastSample == sample) {
+        // A second change within one timestamp overwrites the first: the
+        // sample keeps the last value and the overwritten one is recorded
+        // as a zero-width glitch (once per code and sample)
+        if (cd.lastValue != value && cd.lastGlitch != sample) {
+            m_glitches.push_back({code, sample, cd.lastValue});
+            cd.lastGlitch = sample;
+        }
+        if (!cd.changes.empty() && cd.changes.back().sample == sample) {
+            cd.changes.back().value = value;
+            cd.lastValue = value;
+            return;
+        }
+        // The first one was taken already: this one goes on top of it
+    }
+    if (cd.changes.empty())
+        m_changedCodes.push_back(code);
+    cd.changes.push_back({sample, value});
+    cd.lastSample = sample;
+    cd.lastValue = value;
+}
+
+std::vector<VcdParser::CodeChanges> VcdParser::takeChanges(std::vector<VcdGlitch> *glitches)
+{
+    std::vector<CodeChanges> out;
+    out.reserve(m_changedCodes.size());
+    for (int code : m_changedCodes) {
+        out.push_back({code, std::move(m_codes[code].changes)});
+        m_codes[code].changes = std::vector<Change>();
+    }
+    m_changedCodes.clear();
+    if (glitches)
+        *glitches = std::move(m_glitches);
+    m_glitches = std::vector<VcdGlitch>();
+    return out;
+}
+
+std::vector<qint64> VcdParser::takeSampleTimes()
+{
+    std::vector<qint64> times = std::move(m_sampleTimes);
+    m_sampleTimes = std::vector<qint64>();
+    return times;
+}
+
+VcdParsedDump VcdParsedDump::take(VcdParser &parser)
+{
+    VcdParsedDump dump;
+    dump.timescale = parser.timescale();
+    dump.sampleCount = parser.sampleCount();
+    dump.vars = parser.vars();
+    dump.storage = parser.takeChanges(&dump.glitches);
+    dump.changes.resize(parser.codeCount());
+    for (const VcdParser::CodeChanges &cc : dump.storage)
+        dump.changes[cc.code] = {cc.changes.data(), cc.changes.data() + cc.changes.size()};
+    std::stable_sort(dump.glitches.begin(), dump.glitches.end(),
+                     [](const VcdGlitch &a, const VcdGlitch &b) { return a.signal < b.signal; });
+    dump.sampleTimes = parser.takeSampleTimes();
+    return dump;
+}
@@ -0,0 +1,188 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdParser.h
+// Description:   Resumable, block-fed VCD tokenizer (header + per-code value changes).
+//======================================================================
+
+#ifndef VCDPARSER_H
+#define VCDPARSER_H
+
+#include "core/VcdLibrary.h"
+#include "io/VcdFilter.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+// Resumable VCD tokenizer. feed() takes the file in blocks of any size and
+// keeps a partial last line for the next call, so the importer reads a file
+// once in large blocks and follow mode (VcdFollower) parses only the bytes
+// appended since the last poll.
+//
+// Nothing is stored per sample: every identifier code gets the list of its
+// value changes (at most one per sample; a second change at the same
+// timestamp overwrites the first, which is recorded as a zero-width glitch).
+// Samples are the distinct '#' timestamps; changes before the first one go
+// to sample 0 at time 0.
+//
+// feedParallel() parses large blocks of the body on every core: the block is
+// cut at '#' lines, each piece is parsed with sample numbers starting at 0,
+// and the pieces are stitched in order. A sample never spans two pieces, so
+// the result is the same as feed().
+class VcdParser
+{
+public:
+    struct Var
+    {
+        QString name;     // full name, "top.cpu.clk"
+        int width = 1;
+        int code = 0;     // identifier code index; aliases share one
+    };
+
+    struct Change
+    {
+        int sample;
+        int value;        // 0/1, vector value, UNDEFINED_VALUE or kWideValue
+    };
+
+    // Known value of a vector too wide for an int (stored as 0 + "[N bits]")
+    static constexpr int kWideValue = -2;
+
+    // "0101" digits of a vector change -> value (UNDEFINED_VALUE with x/z,
+    // kWideValue above 32 bits)
+    static int vectorValue(const char *bits, const char *end, int width);
+    // Library signal of one var from its changes (by sample): every change
+    // holds until the next one, X before the first
+    static Signal signalFromChanges(const Var &var, const Change *first, const Change *last, int sampleCount);
+
+    explicit VcdParser(int maxSamples);
+
+    // $vars the filter rejects are left out (set before the header is fed):
+    // their changes are skipped by identifier code, never decoded
+    void setFilter(const VcdSignalFilter &filter) { m_filter = filter; }
+
+    // Parses every complete line of `data`
+    void feed(const char *data, qint64 size);
+    // Same result as feed(); once the header is done, blocks of at least
+    // parallelBlockSize() are parsed on parallelWorkers() threads
+    void feedParallel(const char *data, qint64 size);
+    // Parses what is left of a last line without a newline (end of file)
+    void finish();
+
+    // Block size that gives every worker of feedParallel() a piece
+    static qint64 parallelBlockSize();
+
+    bool headerDone() const { return m_headerDone; }
+    // The sample limit stopped the parse; later input is ignored
+    bool limitReached() const { return m_limitReached; }
+    double timescale() const { return m_timescale; }
+
+    const std::vector<Var> &vars() const { return m_vars; }
+    int codeCount() const { return static_cast<int>(m_codes.size()); }
+    int sampleCount() const { return m_sampleCount; }
+
+    struct CodeChanges
+    {
+        int code;
+        std::vector<Change> changes;   // by sample
+    };
+
+    // Moves out what was parsed since the last call: the changes of every
+    // code that changed (in order of their first change) and the zero-width
+    // glitches (VcdGlitch::signal = code). Costs O(changes), not O(codes).
+    // The last sample stays open, a later feed() may still change it.
+    std::vector<CodeChanges> takeChanges(std::vector<VcdGlitch> *glitches = nullptr);
+    // Times of the samples started since the last call
+    std::vector<qint64> takeSampleTimes();
+
+private:
+    struct Code
+    {
+        int width = 1;
+        std::vector<Change> changes;
+        int lastSample = -1;     // sample and value of the last change, kept across takeChanges()
+        int lastValue = UNDEFINED_VALUE;
+        int lastGlitch = -1;
+    };
+
+    int m_maxSamples;
+    VcdSignalFilter m_filter;
+    QByteArray m_pending;              // partial line of the previous feed()
+    bool m_headerDone = false;
+    bool m_limitReached = false;
+
+    // Header
+    QStringList m_scopeStack;
+    QString m_timescaleText;
+    bool m_inTimescale = false;
+    double m_timescale = 0.0;
+    std::vector<Var> m_vars;
+    QHash<QByteArray, int> m_codeById;
+
+    // Body
+    std::vector<Code> m_codes;
+    std::vector<int> m_changedCodes;   // codes with changes not taken yet
+    std::vector<VcdGlitch> m_glitches;
+    std::vector<qint64> m_sampleTimes;
+    int m_sampleCount = 0;
+
+    // feedParallel(): one body-only parser per piece, kept between blocks
+    std::vector<std::unique_ptr<VcdParser>> m_pieces;
+    std::vector<char> m_stitched;      // per code, scratch of stitchPieces()
+
+    void parseLine(const char *begin, const char *end);
+    void parseHeaderLine(const QString &line);
+    void parseBodyLine(const char *begin, const char *end);
+    int codeOf(const char *begin, const char *end) const;
+    void recordChange(int code, int value);
+    std::unique_ptr<VcdParser> forkBody() const;
+    void stitchPieces(int count);
+};
+
+// What WaveVcdImporter::buildDocument() needs of a parsed dump. The change
+// lists live in `storage` when the dump was taken from a parser, or in a
+// mapped index file (VcdIndexCache); either way `changes` points at them,
+// so the struct is move-only.
+struct VcdParsedDump
+{
+    struct Range
+    {
+        const VcdParser::Change *first = nullptr;
+        const VcdParser::Change *last = nullptr;
+    };
+
+    double timescale = 0.0;
+    int sampleCount = 0;
+    std::vector<VcdParser::Var> vars;
+    std::vector<Range> changes;          // per identifier code
+    std::vector<VcdGlitch> glitches;     // signal = identifier code, sorted by code
+    std::vector<qint64> sampleTimes;
+    std::vector<ClockInfo> clocks;       // per var, from an index (empty = not analysed)
+    std::vector<VcdParser::CodeChanges> storage;
+
+    VcdParsedDump() = default;
+    VcdParsedDump(VcdParsedDump &&) = default;
+    VcdParsedDump &operator=(VcdParsedDump &&) = default;
+    VcdParsedDump(const VcdParsedDump &) = delete;
+    VcdParsedDump &operator=(const VcdParsedDump &) = delete;
+
+    // Moves out what `parser` has read (takeChanges(), takeSampleTimes())
+    static VcdParsedDump take(VcdParser &parser);
+};
+
+#endif // VCDPARSER_H
@@ -0,0 +1,175 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ConditionSearchDialog.cpp
+// Description:   Dialog for the value/condition search engine.
+//======================================================================
+
+#include "ConditionSearchDialog.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+namespace {
+
+QTableWidgetItem *sampleItem(int sample)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(QString::number(sample));
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return it;
+}
+
+} // namespace
+
+ConditionSearchDialog::ConditionSearchDialog(WaveDocument *doc, QWidget *parent)
+    : QDialog(parent),
+      m_doc(doc),
+      m_exprEdit(new QLineEdit(this)),
+      m_findButton(new QPushButton(tr("Find"), this)),
+      m_statusLabel(new QLabel(this)),
+      m_hitTable(new QTableWidget(this)),
+      m_watcher(new QFutureWatcher<ConditionResult>(this))
+{
+    setWindowTitle(tr("Find by condition"));
+    resize(480, 520);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *exprRow = new QHBoxLayout();
+    m_exprEdit->setPlaceholderText(tr("e.g. bus == 0xDEAD && valid == 1"));
+    m_exprEdit->setToolTip(tr("Operators: == != < <= > >= && || ! ( )\n"
+                              "Values: 42, 0x2A, 0b101010, 8'h2A, X (undefined)\n"
+                              "A bare signal name means \"> 0\""));
+    m_exprEdit->setText(QSettings("WavePaint", "WavePaint").value("search/lastCondition").toString());
+    exprRow->addWidget(m_exprEdit, 1);
+    m_findButton->setDefault(true);
+    exprRow->addWidget(m_findButton);
+    layout->addLayout(exprRow);
+
+    layout->addWidget(m_statusLabel);
+
+    m_hitTable->setColumnCount(3);
+    m_hitTable->setHorizontalHeaderLabels({tr("Start"), tr("End"), tr("Samples")});
+    m_hitTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_hitTable->verticalHeader()->setVisible(false);
+    m_hitTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_hitTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    layout->addWidget(m_hitTable, 1);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *markBtn = buttons->addButton(tr("Add marker"), QDialogButtonBox::ActionRole);
+    QPushButton *markAllBtn = buttons->addButton(tr("Mark all"), QDialogButtonBox::ActionRole);
+    connect(markBtn, &QPushButton::clicked, this, &ConditionSearchDialog::addMarkersForSelection);
+    connect(markAllBtn, &QPushButton::clicked, this, &ConditionSearchDialog::markAll);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(m_findButton, &QPushButton::clicked, this, &ConditionSearchDialog::find);
+    connect(m_exprEdit, &QLineEdit::returnPressed, this, &ConditionSearchDialog::find);
+    connect(m_watcher, &QFutureWatcher<ConditionResult>::finished,
+            this, &ConditionSearchDialog::onFinished);
+    connect(m_hitTable, &QTableWidget::cellDoubleClicked, this, [this](int row, int)
+    {
+        if (row >= 0 && row < static_cast<int>(m_hits.size()))
+            emit hitActivated(m_hits[row].start);
+    });
+}
+
+void ConditionSearchDialog::find()
+{
+    if (m_watcher->isRunning())
+        return;
+
+    // Compile on the GUI thread (cheap, reads the document); scan on a worker
+    ConditionSearch search;
+    if (!search.compile(m_exprEdit->text(), *m_doc))
+    {
+        m_statusLabel->setText(search.errorString());
+        return;
+    }
+    QSettings("WavePaint", "WavePaint").setValue("search/lastCondition", m_exprEdit->text());
+
+    m_findButton->setEnabled(false);
+    m_statusLabel->setText(tr("Searching..."));
+    m_watcher->setFuture(QtConcurrent::run([search]() { return search.run(); }));
+}
+
+void ConditionSearchDialog::onFinished()
+{
+    m_findButton->setEnabled(true);
+    ConditionResult res = m_watcher->result();
+    m_hits = std::move(res.hits);
+
+    const int total = static_cast<int>(m_hits.size());
+    const int rows = std::min(total, kMaxHitRows);
+    m_hitTable->setRowCount(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        const ConditionHit &h = m_hits[r];
+        m_hitTable->setItem(r, 0, sampleItem(h.start));
+        m_hitTable->setItem(r, 1, sampleItem(h.end - 1));
+        m_hitTable->setItem(r, 2, sampleItem(h.end - h.start));
+    }
+
+    QString text = (rows < total) ? tr("%1 hits (first %2 listed)").arg(total).arg(rows)
+                                  : tr("%1 hits").arg(total);
+    text += tr(" in %1 ms, %2 chunks (%3 dense)")
+                .arg(res.elapsedNs / 1.0e6, 0, 'f', 2)
+                .arg(res.chunks)
+                .arg(res.denseChunks);
+    m_statusLabel->setText(text);
+}
+
+void ConditionSearchDialog::addMarkersForSelection()
+{
+    std::vector<int> samples;
+    for (const QModelIndex &idx : m_hitTable->selectionModel()->selectedRows())
+    {
+        if (idx.row() < static_cast<int>(m_hits.size()))
+            samples.push_back(m_hits[idx.row()].start);
+    }
+
+    if (samples.size() == 1)
+        m_doc->addMarker(samples.front());
+    else if (!samples.empty())
+        m_doc->addMarkers(samples);
+}
+
+void ConditionSearchDialog::markAll()
+{
+    if (m_hits.empty())
+        return;
+
+    if (static_cast<int>(m_hits.size()) > kConfirmMarkers &&
+        QMessageBox::question(this, tr("Mark all"),
+                              tr("Add %1 markers?").arg(static_cast<qint64>(m_hits.size()))) != QMessageBox::Yes)
+        return;
+
+    std::vector<int> samples;
+    samples.reserve(m_hits.size());
+    for (const ConditionHit &h : m_hits)
+        samples.push_back(h.start);
+    m_doc->addMarkers(samples);   // one undo step
+}
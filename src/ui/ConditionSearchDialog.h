@@ -0,0 +1,66 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ConditionSearchDialog.h
+// Description:   Dialog for the value/condition search engine.
+//======================================================================
+
+#ifndef CONDITIONSEARCHDIALOG_H
+#define CONDITIONSEARCHDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include "core/core.h"
+#include "core/ConditionSearch.h"
+
+class QLineEdit;
+class QPushButton;
+class QLabel;
+class QTableWidget;
+
+// "Find by condition": compiles an expression such as
+// "bus == 0xDEAD && valid == 1", runs it off the GUI thread and lists the
+// sample ranges where it holds. Hits can be turned into markers.
+class ConditionSearchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ConditionSearchDialog(WaveDocument *doc, QWidget *parent = nullptr);
+
+signals:
+    // A hit was double-clicked: move the cursor there
+    void hitActivated(int sample);
+
+private slots:
+    void find();
+    void onFinished();
+    void addMarkersForSelection();
+    void markAll();
+
+private:
+    WaveDocument *m_doc;
+    QLineEdit    *m_exprEdit;
+    QPushButton  *m_findButton;
+    QLabel       *m_statusLabel;
+    QTableWidget *m_hitTable;
+    QFutureWatcher<ConditionResult> *m_watcher;
+
+    std::vector<ConditionHit> m_hits;
+
+    // The table lists the first hits only; "Mark all" uses every hit
+    static constexpr int kMaxHitRows = 10000;
+    static constexpr int kConfirmMarkers = 1000;
+};
+
+#endif // CONDITIONSEARCHDIALOG_H
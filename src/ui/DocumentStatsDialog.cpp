@@ -0,0 +1,142 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          DocumentStatsDialog.cpp
+// Description:   Document statistics dialog (memory per subsystem and per signal).
+//======================================================================
+
+#include "DocumentStatsDialog.h"
+#include "utils/FormatUtils.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+
+#include <algorithm>
+
+namespace {
+
+QTableWidgetItem *bytesItem(qint64 bytes)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(formatBytes(bytes));
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    it->setData(Qt::UserRole, bytes);
+    return it;
+}
+
+} // namespace
+
+DocumentStatsDialog::DocumentStatsDialog(WaveDocument *doc, QWidget *parent)
+    : QDialog(parent),
+      m_doc(doc),
+      m_totalLabel(new QLabel(this)),
+      m_subsystemTable(new QTableWidget(this)),
+      m_signalTable(new QTableWidget(this)),
+      m_budgetSpin(new QSpinBox(this))
+{
+    setWindowTitle(tr("Document statistics"));
+    resize(560, 600);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QFont bold = m_totalLabel->font();
+    bold.setBold(true);
+    m_totalLabel->setFont(bold);
+    layout->addWidget(m_totalLabel);
+
+    m_subsystemTable->setColumnCount(2);
+    m_subsystemTable->setHorizontalHeaderLabels({tr("Subsystem"), tr("Memory")});
+    m_subsystemTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_subsystemTable->verticalHeader()->setVisible(false);
+    m_subsystemTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_subsystemTable->setSelectionMode(QAbstractItemView::NoSelection);
+    layout->addWidget(m_subsystemTable, 1);
+
+    layout->addWidget(new QLabel(tr("Largest signals:"), this));
+    m_signalTable->setColumnCount(3);
+    m_signalTable->setHorizontalHeaderLabels({tr("Signal"), tr("Source"), tr("Memory")});
+    m_signalTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_signalTable->verticalHeader()->setVisible(false);
+    m_signalTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(m_signalTable, 2);
+
+    // Presupuesto de memoria (0 = sin aviso)
+    QFormLayout *form = new QFormLayout();
+    m_budgetSpin->setRange(0, 1024 * 1024);
+    m_budgetSpin->setSuffix(tr(" MB"));
+    m_budgetSpin->setSpecialValueText(tr("Off"));
+    m_budgetSpin->setValue(static_cast<int>(m_doc->memoryBudget() / (1024 * 1024)));
+    form->addRow(tr("Warn when the document uses more than:"), m_budgetSpin);
+    layout->addLayout(form);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    QPushButton *refreshBtn = buttons->addButton(tr("Refresh"), QDialogButtonBox::ActionRole);
+    connect(refreshBtn, &QPushButton::clicked, this, &DocumentStatsDialog::refresh);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    refresh();
+}
+
+qint64 DocumentStatsDialog::memoryBudget() const
+{
+    return static_cast<qint64>(m_budgetSpin->value()) * 1024 * 1024;
+}
+
+void DocumentStatsDialog::refresh()
+{
+    const MemoryStats st = m_doc->memoryStats();
+
+    m_totalLabel->setText(tr("Total: %1   (%2 visible signals, %3 in VCD library, %4 undo / %5 redo steps)")
+                              .arg(formatBytes(st.total()))
+                              .arg(m_doc->signalList().size())
+                              .arg(m_doc->vcdSignalList().size())
+                              .arg(m_doc->undoDepth())
+                              .arg(m_doc->redoDepth()));
+
+    const QList<QPair<QString, qint64>> rows = {
+        {tr("Visible signals"),  st.visibleSignals},
+        {tr("VCD library"),      st.vcdLibrary},
+        {tr("Undo history"),     st.undoHistory},
+        {tr("Redo history"),     st.redoHistory},
+        {tr("Signal clipboard"), st.signalClipboard},
+        {tr("Block clipboard"),  st.blockClipboard},
+        {tr("Markers & arrows"), st.annotations},
+    };
+    m_subsystemTable->setRowCount(rows.size());
+    for (int r = 0; r < rows.size(); ++r)
+    {
+        m_subsystemTable->setItem(r, 0, new QTableWidgetItem(rows[r].first));
+        m_subsystemTable->setItem(r, 1, bytesItem(rows[r].second));
+    }
+
+    // Solo las mayores: una tabla con cientos de miles de filas no aporta nada
+    const std::vector<SignalMemoryUsage> usage = m_doc->signalMemoryUsage();
+    const int n = std::min(static_cast<int>(usage.size()), kMaxSignalRows);
+    m_signalTable->setRowCount(n);
+    for (int r = 0; r < n; ++r)
+    {
+        const SignalMemoryUsage &u = usage[r];
+        m_signalTable->setItem(r, 0, new QTableWidgetItem(u.name));
+        m_signalTable->setItem(r, 1, new QTableWidgetItem(u.inLibrary ? tr("VCD library") : tr("Visible")));
+        m_signalTable->setItem(r, 2, bytesItem(u.bytes));
+    }
+}
@@ -0,0 +1,53 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          DocumentStatsDialog.h
+// Description:   Document statistics dialog (memory per subsystem and per signal).
+//======================================================================
+
+#ifndef DOCUMENTSTATSDIALOG_H
+#define DOCUMENTSTATSDIALOG_H
+
+#include <QDialog>
+#include "core/core.h"
+
+class QTableWidget;
+class QSpinBox;
+class QLabel;
+
+// "Document statistics": memory used by each subsystem of the document and
+// by each signal, plus the memory budget that triggers the warning.
+class DocumentStatsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit DocumentStatsDialog(WaveDocument *doc, QWidget *parent = nullptr);
+
+    // Budget chosen in the dialog, in bytes (0 = disabled)
+    qint64 memoryBudget() const;
+
+private slots:
+    void refresh();
+
+private:
+    WaveDocument *m_doc;
+    QLabel       *m_totalLabel;
+    QTableWidget *m_subsystemTable;
+    QTableWidget *m_signalTable;
+    QSpinBox     *m_budgetSpin;
+
+    static constexpr int kMaxSignalRows = 500;
+};
+
+#endif // DOCUMENTSTATSDIALOG_H
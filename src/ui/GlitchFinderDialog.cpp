@@ -0,0 +1,363 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          GlitchFinderDialog.cpp
+// Description:   Dialog that lists short pulses and zero-width glitches.
+//======================================================================
+
+#include "GlitchFinderDialog.h"
+#include "WaveView.h"
+#include "core/VcdLibrary.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+enum Target { SelectedSignals, VisibleSignals, VcdScope };
+
+QTableWidgetItem *numberItem(const QString &text)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(text);
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return it;
+}
+
+QString valueText(int value, bool isBit)
+{
+    if (value == UNDEFINED_VALUE)
+        return QStringLiteral("X");
+    return isBit ? QString::number(value) : QStringLiteral("0x") + QString::number(value, 16).toUpper();
+}
+
+} // namespace
+
+GlitchFinderDialog::GlitchFinderDialog(WaveDocument *doc, WaveView *view, QWidget *parent)
+    : QDialog(parent),
+      m_doc(doc),
+      m_view(view),
+      m_targetCombo(new QComboBox(this)),
+      m_scopeEdit(new QLineEdit(this)),
+      m_widthSpin(new QSpinBox(this)),
+      m_unitCombo(new QComboBox(this)),
+      m_zeroWidthCheck(new QCheckBox(tr("Zero-width glitches"), this)),
+      m_findButton(new QPushButton(tr("Find"), this)),
+      m_statusLabel(new QLabel(this)),
+      m_table(new QTableWidget(this)),
+      m_watcher(new QFutureWatcher<GlitchScanResult>(this))
+{
+    setWindowTitle(tr("Find glitches"));
+    resize(560, 540);
+
+    QSettings settings("WavePaint", "WavePaint");
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *targetRow = new QHBoxLayout();
+    m_targetCombo->addItem(tr("Selected signals"), SelectedSignals);
+    m_targetCombo->addItem(tr("Visible signals"), VisibleSignals);
+    m_targetCombo->addItem(tr("VCD scope"), VcdScope);
+    m_targetCombo->setCurrentIndex(settings.value("glitches/target", SelectedSignals).toInt());
+    m_scopeEdit->setPlaceholderText(tr("e.g. top.cpu (empty = whole dump)"));
+    m_scopeEdit->setToolTip(tr("Every signal declared in this scope or below it"));
+    targetRow->addWidget(new QLabel(tr("Scan"), this));
+    targetRow->addWidget(m_targetCombo);
+    targetRow->addWidget(m_scopeEdit, 1);
+    layout->addLayout(targetRow);
+
+    QHBoxLayout *widthRow = new QHBoxLayout();
+    m_widthSpin->setRange(1, INT_MAX);
+    m_widthSpin->setValue(settings.value("glitches/minWidth", 2).toInt());
+    m_widthSpin->setToolTip(tr("Complete pulses narrower than this are reported"));
+    m_unitCombo->addItem(tr("samples"));
+    m_unitCombo->addItem(tr("VCD time units"));
+    m_unitCombo->setCurrentIndex(settings.value("glitches/timeUnits", false).toBool() ? 1 : 0);
+    m_zeroWidthCheck->setChecked(true);
+    m_zeroWidthCheck->setToolTip(tr("Several changes of one signal at the same VCD timestamp"));
+    m_findButton->setDefault(true);
+    widthRow->addWidget(new QLabel(tr("Pulses narrower than"), this));
+    widthRow->addWidget(m_widthSpin);
+    widthRow->addWidget(m_unitCombo);
+    widthRow->addWidget(m_zeroWidthCheck);
+    widthRow->addStretch(1);
+    widthRow->addWidget(m_findButton);
+    layout->addLayout(widthRow);
+
+    m_statusLabel->setWordWrap(true);
+    layout->addWidget(m_statusLabel);
+
+    m_table->setColumnCount(5);
+    m_table->setHorizontalHeaderLabels({tr("Signal"), tr("Start"), tr("Width"), tr("Value"), tr("Kind")});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    layout->addWidget(m_table, 1);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *showBtn = buttons->addButton(tr("Show signal"), QDialogButtonBox::ActionRole);
+    QPushButton *markBtn = buttons->addButton(tr("Add marker"), QDialogButtonBox::ActionRole);
+    QPushButton *markAllBtn = buttons->addButton(tr("Mark all"), QDialogButtonBox::ActionRole);
+    showBtn->setToolTip(tr("Add the signals of the selected rows to the waveform"));
+    connect(showBtn, &QPushButton::clicked, this, &GlitchFinderDialog::showSelectedSignals);
+    connect(markBtn, &QPushButton::clicked, this, &GlitchFinderDialog::addMarkersForSelection);
+    connect(markAllBtn, &QPushButton::clicked, this, &GlitchFinderDialog::markAll);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(m_findButton, &QPushButton::clicked, this, &GlitchFinderDialog::findOrStop);
+    connect(m_targetCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &GlitchFinderDialog::updateControls);
+    connect(m_doc, &WaveDocument::dataChanged, this, &GlitchFinderDialog::updateControls);
+    connect(m_watcher, &QFutureWatcher<GlitchScanResult>::finished,
+            this, &GlitchFinderDialog::onFinished);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int)
+    {
+        if (row >= 0 && row < static_cast<int>(m_result.violations.size()))
+            emit violationActivated(m_result.violations[row].start);
+    });
+
+    updateControls();
+}
+
+void GlitchFinderDialog::setScopePath(const QString &path)
+{
+    m_scopeEdit->setText(path);
+}
+
+bool GlitchFinderDialog::timeUnitsAvailable() const
+{
+    const VcdLibraryPtr lib = m_doc->vcdLibrary();
+    if (!lib)
+        return false;
+    // Scopes are scanned in the library itself; visible signals only while
+    // the document still has the samples of the dump (no cut since import)
+    const int samples = static_cast<int>(lib->timing().sampleTimes.size());
+    return m_targetCombo->currentData().toInt() == VcdScope || samples == m_doc->sampleCount();
+}
+
+void GlitchFinderDialog::updateControls()
+{
+    const bool scope = m_targetCombo->currentData().toInt() == VcdScope;
+    m_scopeEdit->setEnabled(scope);
+    m_unitCombo->setEnabled(timeUnitsAvailable());
+    m_zeroWidthCheck->setEnabled(timeUnitsAvailable());
+}
+
+void GlitchFinderDialog::findOrStop()
+{
+    if (m_watcher->isRunning())
+    {
+        m_cancel->store(true);
+        return;
+    }
+
+    const Target target = static_cast<Target>(m_targetCombo->currentData().toInt());
+    const VcdLibraryPtr lib = m_doc->vcdLibrary();
+    const bool aligned = timeUnitsAvailable();
+
+    // Snapshot of what is scanned: sample buffers are shared copy-on-write,
+    // so the worker never sees later edits
+    auto snapshot = std::make_shared<const std::vector<Signal>>(m_doc->signalList());
+    std::vector<Signal> sigs;
+    GlitchScanOptions options;
+    int sampleCount = m_doc->sampleCount();
+
+    if (target == VcdScope)
+    {
+        if (!lib)
+        {
+            m_statusLabel->setText(tr("No VCD file loaded"));
+            return;
+        }
+        const int scopeId = lib->findScope(m_scopeEdit->text().trimmed());
+        if (scopeId < 0)
+        {
+            m_statusLabel->setText(tr("Unknown scope \"%1\"").arg(m_scopeEdit->text().trimmed()));
+            return;
+        }
+        options.libraryIndex = lib->signalsUnder(scopeId);
+        lib->preload(options.libraryIndex);   // FST: decode the scope in one parallel pass
+        for (int idx : options.libraryIndex)
+            sigs.push_back(lib->at(idx));
+        sampleCount = static_cast<int>(lib->timing().sampleTimes.size());
+    }
+    else
+    {
+        std::vector<int> rows;
+        if (target == SelectedSignals)
+        {
+            rows = m_view->selectedSignals();
+        }
+        else
+        {
+            for (int r = 0; r < static_cast<int>(snapshot->size()); ++r)
+                rows.push_back(r);
+        }
+        for (int r : rows)
+        {
+            if (r < 0 || r >= static_cast<int>(snapshot->size()))
+                continue;
+            sigs.push_back((*snapshot)[r]);
+            options.libraryIndex.push_back(lib ? lib->indexOf(sigs.back().name) : -1);
+        }
+    }
+
+    if (sigs.empty())
+    {
+        m_statusLabel->setText(target == SelectedSignals
+                                   ? tr("Select signals (click a name; Ctrl+click for several)")
+                                   : tr("No signals to scan"));
+        return;
+    }
+
+    m_names.clear();
+    m_isBit.clear();
+    for (const Signal &s : sigs)
+    {
+        m_names.append(s.name);
+        m_isBit.push_back(s.type == SignalType::Bit);
+    }
+    m_timeUnits = aligned && m_unitCombo->currentIndex() == 1;
+
+    options.minWidth = m_widthSpin->value();
+    options.maxViolations = 1000000;
+    if (aligned && m_zeroWidthCheck->isChecked())
+        options.library = lib.get();
+    m_cancel = std::make_shared<std::atomic<bool>>(false);
+    options.cancel = m_cancel.get();
+
+    QSettings settings("WavePaint", "WavePaint");
+    settings.setValue("glitches/target", m_targetCombo->currentIndex());
+    settings.setValue("glitches/minWidth", m_widthSpin->value());
+    settings.setValue("glitches/timeUnits", m_unitCombo->currentIndex() == 1);
+
+    m_findButton->setText(tr("Stop"));
+    m_statusLabel->setText(tr("Scanning %1 signals...").arg(static_cast<qint64>(sigs.size())));
+
+    const bool timeUnits = m_timeUnits;
+    std::shared_ptr<std::atomic<bool>> cancel = m_cancel;
+    m_watcher->setFuture(QtConcurrent::run([snapshot, lib, sigs, options, sampleCount, timeUnits, cancel]() mutable
+    {
+        // The library (timing, glitches) stays alive with the lambda
+        if (timeUnits)
+            options.sampleTimes = &lib->timing().sampleTimes;
+        return findGlitches(sigs, 0, sampleCount, resolverFor(*snapshot), options);
+    }));
+}
+
+void GlitchFinderDialog::onFinished()
+{
+    m_findButton->setText(tr("Find"));
+    m_result = m_watcher->result();
+
+    const QString unit = m_timeUnits ? tr("t") : tr("smp");
+    const int total = static_cast<int>(m_result.violations.size());
+    const int rows = std::min(total, kMaxRows);
+    m_table->setRowCount(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        const PulseViolation &v = m_result.violations[r];
+        m_table->setItem(r, 0, new QTableWidgetItem(m_names[v.signal]));
+        m_table->setItem(r, 1, numberItem(QString::number(v.start)));
+        m_table->setItem(r, 2, numberItem(v.zeroWidth() ? QStringLiteral("0")
+                                                        : QString("%1 %2").arg(v.width).arg(unit)));
+        m_table->setItem(r, 3, numberItem(valueText(v.value, m_isBit[v.signal])));
+        m_table->setItem(r, 4, new QTableWidgetItem(v.zeroWidth() ? tr("zero-width") : tr("short pulse")));
+    }
+
+    QString text = (rows < total) ? tr("%1 violations (first %2 listed)").arg(total).arg(rows)
+                                  : tr("%1 violations").arg(total);
+    text += tr(" in %1 signals, %2 pulses checked in %3 ms")
+                .arg(m_names.size())
+                .arg(m_result.pulses)
+                .arg(m_result.elapsedNs / 1.0e6, 0, 'f', 2);
+    if (m_result.canceled)
+        text += tr(" (stopped)");
+    else if (m_result.truncated)
+        text += tr(" (limit reached)");
+    m_statusLabel->setText(text);
+}
+
+void GlitchFinderDialog::addMarkersForSelection()
+{
+    std::vector<int> samples;
+    for (const QModelIndex &idx : m_table->selectionModel()->selectedRows())
+    {
+        if (idx.row() < static_cast<int>(m_result.violations.size()))
+            samples.push_back(m_result.violations[idx.row()].start);
+    }
+
+    if (samples.size() == 1)
+        m_doc->addMarker(samples.front());
+    else if (!samples.empty())
+        m_doc->addMarkers(samples);
+}
+
+void GlitchFinderDialog::markAll()
+{
+    if (m_result.violations.empty())
+        return;
+
+    if (static_cast<int>(m_result.violations.size()) > kConfirmMarkers &&
+        QMessageBox::question(this, tr("Mark all"),
+                              tr("Add %1 markers?").arg(static_cast<qint64>(m_result.violations.size())))
+            != QMessageBox::Yes)
+        return;
+
+    std::vector<int> samples;
+    samples.reserve(m_result.violations.size());
+    for (const PulseViolation &v : m_result.violations)
+        samples.push_back(v.start);
+    std::sort(samples.begin(), samples.end());
+    samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+    m_doc->addMarkers(samples);   // one undo step
+}
+
+void GlitchFinderDialog::showSelectedSignals()
+{
+    QStringList names;
+    for (const QModelIndex &idx : m_table->selectionModel()->selectedRows())
+    {
+        if (idx.row() >= static_cast<int>(m_result.violations.size()))
+            continue;
+        const QString &name = m_names[m_result.violations[idx.row()].signal];
+        if (!names.contains(name))
+            names.append(name);
+    }
+
+    for (const QString &name : names)
+    {
+        const std::vector<Signal> &visible = m_doc->signalList();
+        const bool shown = std::any_of(visible.begin(), visible.end(),
+                                       [&](const Signal &s) { return s.name == name; });
+        if (!shown)
+            m_doc->addSignalFromVcd(name);
+    }
+}
@@ -0,0 +1,89 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          GlitchFinderDialog.h
+// Description:   Dialog that lists short pulses and zero-width glitches.
+//======================================================================
+
+#ifndef GLITCHFINDERDIALOG_H
+#define GLITCHFINDERDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include "core/core.h"
+#include "core/GlitchFinder.h"
+
+class WaveView;
+class QComboBox;
+class QLineEdit;
+class QSpinBox;
+class QCheckBox;
+class QPushButton;
+class QLabel;
+class QTableWidget;
+
+// "Find glitches": pulses narrower than a threshold and zero-width glitches
+// of the selected signals, of every visible signal or of a whole VCD scope.
+// The scan runs off the GUI thread; violations can be turned into markers.
+class GlitchFinderDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    GlitchFinderDialog(WaveDocument *doc, WaveView *view, QWidget *parent = nullptr);
+
+    // Pre-fills the scope field (e.g. with the scope selected in the hierarchy)
+    void setScopePath(const QString &path);
+
+signals:
+    // A violation was double-clicked: move the cursor there
+    void violationActivated(int sample);
+
+private slots:
+    void findOrStop();
+    void onFinished();
+    void updateControls();
+    void addMarkersForSelection();
+    void markAll();
+    void showSelectedSignals();
+
+private:
+    WaveDocument *m_doc;
+    WaveView     *m_view;
+    QComboBox    *m_targetCombo;
+    QLineEdit    *m_scopeEdit;
+    QSpinBox     *m_widthSpin;
+    QComboBox    *m_unitCombo;
+    QCheckBox    *m_zeroWidthCheck;
+    QPushButton  *m_findButton;
+    QLabel       *m_statusLabel;
+    QTableWidget *m_table;
+    QFutureWatcher<GlitchScanResult> *m_watcher;
+
+    std::shared_ptr<std::atomic<bool>> m_cancel;
+    GlitchScanResult m_result;
+    QStringList      m_names;        // scanned signals, indexed by PulseViolation::signal
+    std::vector<char> m_isBit;       // idem
+    bool             m_timeUnits = false;
+
+    // VCD time of every sample, when it lines up with the document samples
+    bool timeUnitsAvailable() const;
+
+    static constexpr int kMaxRows = 10000;
+    static constexpr int kConfirmMarkers = 1000;
+};
+
+#endif // GLITCHFINDERDIALOG_H
@@ -47,16 +47,32 @@
  
 #include <QMainWindow>
 #include <QAction>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
 #include "core/core.h"
+#include "core/NameIndex.h"
+#include "core/Edges.h"
+#include "io/VcdFollower.h"
 
 class WaveView;
-class QTreeWidget;
-class QListWidget;
+class QTreeView;
+class QListView;
 class QSplitter;
 class QSpinBox;
-class QTreeWidgetItem;
 class QScrollArea;
-class QListWidgetItem;
+class QModelIndex;
+class QLineEdit;
+class ConditionSearchDialog;
+class SignalStatsPanel;
+class ProtocolDecoderDialog;
+class GlitchFinderDialog;
+class WaveDiffDialog;
+class QDockWidget;
+class QTimer;
+class QFileSystemWatcher;
+class VcdScopeModel;
+class VcdSignalListModel;
 
 class MainWindow : public QMainWindow
 { 
@@ -76,9 +92,11 @@ private:
 
     // Main layout: splitter with hierarchy panel on the left and waveform on the right
     QSplitter *m_splitter;
-    QTreeWidget *m_hierarchyTree;
+    QTreeView *m_hierarchyTree;
     QAction *m_viewHierarchyAction;
-    QListWidget *m_signalList;
+    QListView *m_signalList;
+    VcdScopeModel *m_scopeModel = nullptr;
+    VcdSignalListModel *m_signalModel = nullptr;
     QScrollArea *m_waveScroll;
     QAction *m_cutAction;
     QAction *m_arrowAction;
@@ -89,13 +107,47 @@ private:
     QAction *m_eraseAction;
     QAction *m_undoAction = nullptr;
     QAction *m_redoAction = nullptr;
+    QAction *m_traceAction = nullptr;
+    QAction *m_hudAction = nullptr;
+    QAction *m_followAction = nullptr;
     QList<QAction*> m_allActions;
 
+    // Incremental name search (MainWindow_Search.cpp): one query in flight,
+    // the latest keystroke waits in m_pendingSearch
+    QLineEdit *m_searchEdit = nullptr;
+    QFutureWatcher<NameSearchResult> *m_searchWatcher = nullptr;
+    QFuture<void> m_indexWarmup;   // trigram index built after an import
+    VcdLibraryPtr m_searchLibrary;
+    std::shared_ptr<std::atomic<bool>> m_searchCancel;
+    QString m_pendingSearch;
+    bool m_searchPending = false;
+
+    ConditionSearchDialog *m_conditionDialog = nullptr;   // non-modal, created on first use
+    ProtocolDecoderDialog *m_decoderDialog = nullptr;     // idem
+    GlitchFinderDialog *m_glitchDialog = nullptr;         // idem
+    WaveDiffDialog *m_diffDialog = nullptr;               // idem
+    SignalStatsPanel *m_statsPanel = nullptr;
+    QDockWidget *m_statsDock = nullptr;                    // hidden until View -> Signal statistics
+
+    // File -> Follow VCD file: the watcher reports writes, the timer catches
+    // the ones it misses (and bytes left over by a capped poll)
+    VcdFollower m_follower;
+    QFileSystemWatcher *m_followWatcher = nullptr;
+    QTimer *m_followTimer = nullptr;
+
 
     void createUi(); 
     void createMenus();
     void createToolBar();
     void rebuildHierarchy();
+    void clearHierarchy();
+    void launchSignalSearch(const QString &text);
+    void warmSearchIndex();
+    void navigateEdge(bool forward, EdgeKind kind);
+    // Options of the next VCD import (File menu settings)
+    VcdImportOptions importOptions() const;
+    bool startFollowing(const QString &fileName);
+    void stopFollowing(const QString &reason = QString());
 
     int signalCount() const;
     void moveSignal(int from, int to);
@@ -108,8 +160,10 @@ private slots:
     void exportPng();
     void openFile();
     void saveFileAs();
-    void onHierarchySelectionChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
-    void onSignalDoubleClicked(QListWidgetItem *item);
+    void onHierarchySelectionChanged(const QModelIndex &current, const QModelIndex &previous);
+    void onSignalDoubleClicked(const QModelIndex &index);
+    void onSearchTextChanged(const QString &text);
+    void onSearchFinished();
     void onCutToggled(bool enabled);
     void onEraseToggled(bool enabled);
     void onAddMarkerToggled(bool enabled);
@@ -122,6 +176,18 @@ private slots:
     void onUndo();
     void onRedo();
     void updateUndoRedoActions();
+    void onTraceToggled(bool enabled);
+    void onFollowToggled(bool enabled);
+    void setVcdImportFilter();
+    void pollFollowedFile();
+    void showDocumentStats();
+    void setUndoHistoryBudget();
+    void onMemoryBudgetExceeded(qint64 usedBytes, qint64 budgetBytes);
+    void scrollToSample(int sample);
+    void showConditionSearch();
+    void showProtocolDecoder();
+    void showGlitchFinder();
+    void showWaveDiff();
 };
 
 #endif // MAINWINDOW_H
@@ -44,6 +44,9 @@
 #include "core/core.h"
 #include "MainWindow.h"
 #include "WaveView.h"
+#include "core/VcdLibrary.h"
+#include "VcdHierarchyModel.h"
+#include "SignalStatsPanel.h"
 #include <QToolBar>
 #include <QSpinBox>
 #include <QMenuBar>
@@ -55,16 +58,18 @@
 #include <QFileInfo>
 #include <QDesktopServices>
 #include <QUrl>
-#include <QTreeWidgetItem>
 #include <QKeyEvent>
 #include <QScrollArea>
-#include <QListWidgetItem>
 #include <QMap>
 #include <QVBoxLayout>
-#include <QListWidget>
-#include <QTreeWidget>
+#include <QListView>
+#include <QTreeView>
+#include <QItemSelectionModel>
 #include <QSplitter>
+#include <QSettings>
 #include <QLabel>
+#include <QLineEdit>
+#include <QDockWidget>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -104,6 +109,13 @@ MainWindow::MainWindow(QWidget *parent)
     connect(&m_document, &WaveDocument::undoRedoStateChanged,
             this, &MainWindow::updateUndoRedoActions);
 
+    connect(&m_document, &WaveDocument::memoryBudgetExceeded,
+            this, &MainWindow::onMemoryBudgetExceeded);
+    QSettings settings("WavePaint", "WavePaint");
+    m_document.setMemoryBudget(settings.value("memory/budgetBytes", 0).toLongLong());
+    m_document.setUndoBudget(settings.value("undo/budgetBytes",
+                                            WaveDocument::kDefaultUndoBudget).toLongLong());
+
     updateUndoRedoActions(); // estado inicial
 }
 
@@ -119,11 +131,24 @@ void MainWindow::createUi()
     leftLayout->setContentsMargins(2, 2, 2, 2);
     leftLayout->setSpacing(2);
 
-    m_hierarchyTree = new QTreeWidget(leftPanel);
-    m_hierarchyTree->setHeaderLabel(tr("Hierarchy"));
+    // Busqueda incremental por nombre completo (ver MainWindow_Search.cpp)
+    m_searchEdit = new QLineEdit(leftPanel);
+    m_searchEdit->setPlaceholderText(tr("Search signals (e.g. axi*wvalid)"));
+    m_searchEdit->setClearButtonEnabled(true);
+    leftLayout->addWidget(m_searchEdit);
+
+    // Modelos perezosos sobre el trie de scopes (ver VcdHierarchyModel)
+    m_scopeModel = new VcdScopeModel(this);
+    m_hierarchyTree = new QTreeView(leftPanel);
+    m_hierarchyTree->setModel(m_scopeModel);
+    m_hierarchyTree->setUniformRowHeights(true);
     leftLayout->addWidget(m_hierarchyTree, 2);
 
-    m_signalList = new QListWidget(leftPanel);
+    m_signalModel = new VcdSignalListModel(this);
+    m_signalList = new QListView(leftPanel);
+    m_signalList->setModel(m_signalModel);
+    m_signalList->setUniformItemSizes(true);
+    m_signalList->setEditTriggers(QAbstractItemView::NoEditTriggers);
     leftLayout->addWidget(m_signalList, 1);
 
     leftPanel->setLayout(leftLayout);
@@ -149,12 +174,32 @@ void MainWindow::createUi()
     m_splitter->setSizes(sizes);
 
     // Connect hierarchy selection to the signal list
-    connect(m_hierarchyTree, &QTreeWidget::currentItemChanged,
+    connect(m_hierarchyTree->selectionModel(), &QItemSelectionModel::currentChanged,
             this, &MainWindow::onHierarchySelectionChanged);
 
     // Double-click a signal in the list => add it to the waveform
-    connect(m_signalList, &QListWidget::itemDoubleClicked,
+    connect(m_signalList, &QListView::doubleClicked,
             this, &MainWindow::onSignalDoubleClicked);
+
+    // Edge navigation moves the cursor; keep it on screen
+    connect(m_waveView, &WaveView::cursorMoved,
+            this, &MainWindow::scrollToSample);
+
+    // Per-signal statistics, docked at the bottom and hidden by default
+    m_statsPanel = new SignalStatsPanel(&m_document, m_waveView, this);
+    m_statsDock = new QDockWidget(tr("Signal statistics"), this);
+    m_statsDock->setObjectName("signalStatsDock");
+    m_statsDock->setWidget(m_statsPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_statsDock);
+    m_statsDock->hide();
+    connect(m_waveView, &WaveView::selectionChanged,
+            m_statsPanel, &SignalStatsPanel::refreshIfAuto);
+
+    m_searchWatcher = new QFutureWatcher<NameSearchResult>(this);
+    connect(m_searchWatcher, &QFutureWatcher<NameSearchResult>::finished,
+            this, &MainWindow::onSearchFinished);
+    connect(m_searchEdit, &QLineEdit::textChanged,
+            this, &MainWindow::onSearchTextChanged);
 }
 
 void MainWindow::activateXDesactivateAll(const QList<QAction*> &actions, QAction *except)
@@ -347,72 +392,28 @@ void MainWindow::updateUndoRedoActions()
     m_redoAction->setEnabled(m_document.canRedo());
 }
 
-void MainWindow::onHierarchySelectionChanged(QTreeWidgetItem *current, QTreeWidgetItem * /*previous*/)
+void MainWindow::onHierarchySelectionChanged(const QModelIndex &current, const QModelIndex & /*previous*/)
 {
-    if (!m_hierarchyTree || !m_signalList)
+    if (!m_scopeModel || !m_signalModel)
         return;
 
-    m_signalList->clear();
-    if (!current)
+    // While a search is active the list shows its results instead
+    if (m_searchEdit && !m_searchEdit->text().trimmed().isEmpty())
         return;
 
-    // Rebuild the selected module path (concatenate texts up to the root)
-    QStringList chain;
-    QTreeWidgetItem *it = current;
-    while (it)
-    {
-        chain.prepend(it->text(0));
-        it = it->parent();
-    }
-    QString modulePath = chain.join('.');
-
-    const auto &sigs = m_document.vcdSignalList();
-    for (const Signal &s : sigs)
-    {
-        QString fullName = s.name;
-        if (fullName.isEmpty())
-            continue;
-
-        QStringList parts = fullName.split('.');
-        if (parts.size() <= 1)
-            continue;
-
-        QString leaf = parts.last();
-        parts.removeLast();
-        QString sigModulePath = parts.join('.');
-
-        if (sigModulePath == modulePath)
-        {
-            QListWidgetItem *item = new QListWidgetItem(leaf, m_signalList);
-            item->setToolTip(fullName);
-        }
-    }
+    // Only the signals declared directly in this scope, fetched on demand
+    m_signalModel->setScope(m_scopeModel->library(), m_scopeModel->scopeId(current));
 }
 
-void MainWindow::onSignalDoubleClicked(QListWidgetItem *item)
+void MainWindow::onSignalDoubleClicked(const QModelIndex &index)
 {
-    if (!item)
-        return;
-    if (!m_hierarchyTree)
+    if (!m_signalModel)
         return;
 
-    // Get the currently selected module in the hierarchy
-    QTreeWidgetItem *current = m_hierarchyTree->currentItem();
-    if (!current)
+    QString fullName = m_signalModel->fullName(index);
+    if (fullName.isEmpty())
         return;
 
-    QStringList chain;
-    QTreeWidgetItem *it = current;
-    while (it)
-    {
-        chain.prepend(it->text(0));
-        it = it->parent();
-    }
-    QString modulePath = chain.join('.');
-
-    QString leafName = item->text();
-    QString fullName = modulePath.isEmpty() ? leafName : (modulePath + "." + leafName);
-
     // Add signal visible from the VCD library
     int idx = m_document.addSignalFromVcd(fullName);
     if (idx < 0)
@@ -489,59 +490,3 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
 
     QMainWindow::keyPressEvent(event);
 }
-
-void WaveDocument::moveSignal(int fromIndex, int toIndex)
-{
-    int n = static_cast<int>(m_signals.size());
-    if (fromIndex < 0 || fromIndex >= n ||
-        toIndex < 0 || toIndex >= n ||
-        fromIndex == toIndex)
-    {
-        return;
-    }
-
-    // 1) Mover la señal en el vector m_signals
-    Signal sig = m_signals[fromIndex];
-    m_signals.erase(m_signals.begin() + fromIndex);
-    m_signals.insert(m_signals.begin() + toIndex, sig);
-
-    // 2) Actualizar los índices de las flechas
-    if (!m_arrows.empty())
-    {
-        for (Arrow &a : m_arrows)
-        {
-
-            auto updateIndex = [&](int idx) -> int
-            {
-                if (fromIndex < toIndex)
-                {
-                    // Ej: [0 1 2 3 4], move 1 -> 3
-                    // index 1 pasa a 3
-                    // 2 y 3 bajan a 1 y 2
-                    if (idx == fromIndex)
-                        return toIndex;
-                    if (idx > fromIndex && idx <= toIndex)
-                        return idx - 1;
-                    return idx;
-                }
-                else
-                {
-                    // fromIndex > toIndex
-                    // Ej: [0 1 2 3 4], move 3 -> 1
-                    // index 3 pasa a 1
-                    // 1 y 2 suben a 2 y 3
-                    if (idx == fromIndex)
-                        return toIndex;
-                    if (idx >= toIndex && idx < fromIndex)
-                        return idx + 1;
-                    return idx;
-                }
-            };
-
-            a.startSignal = updateIndex(a.startSignal);
-            a.endSignal = updateIndex(a.endSignal);
-        }
-    }
-
-    emit dataChanged();
-}
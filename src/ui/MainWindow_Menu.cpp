@@ -44,6 +44,18 @@
 
 #include "MainWindow.h"
 #include "WaveView.h"
+#include "DocumentStatsDialog.h"
+#include "ConditionSearchDialog.h"
+#include "ProtocolDecoderDialog.h"
+#include "GlitchFinderDialog.h"
+#include "WaveDiffDialog.h"
+#include "VcdFilterDialog.h"
+#include "VcdHierarchyModel.h"
+#include "core/VcdLibrary.h"
+#include "io/VcdImporter.h"
+#include "io/VcdInput.h"
+#include "utils/Trace.h"
+#include "utils/FormatUtils.h"
 #include <QToolBar>
 #include <QSpinBox>
 #include <QMenuBar>
@@ -55,15 +67,18 @@
 #include <QFileInfo>
 #include <QDesktopServices>
 #include <QUrl>
-#include <QTreeWidgetItem>
 #include <QKeyEvent>
 #include <QScrollArea>
-#include <QListWidgetItem>
+#include <QScrollBar>
 #include <QMap>
 #include <QVBoxLayout>
-#include <QListWidget>
-#include <QTreeWidget>
 #include <QSplitter>
+#include <QSettings>
+#include <QDockWidget>
+#include <QTreeView>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QSignalBlocker>
 
 void MainWindow::createMenus()
 {
@@ -80,12 +95,34 @@ void MainWindow::createMenus()
 
     fileMenu->addSeparator();
 
+    // Detected clocks become clock(...) expressions instead of sample arrays
+    QAction *proceduralAct = fileMenu->addAction(tr("Store VCD clocks procedurally"));
+    proceduralAct->setCheckable(true);
+    proceduralAct->setChecked(QSettings("WavePaint", "WavePaint").value("import/proceduralClocks", false).toBool());
+    connect(proceduralAct, &QAction::toggled, this, [](bool on)
+    {
+        QSettings settings("WavePaint", "WavePaint");
+        settings.setValue("import/proceduralClocks", on);
+    });
+
+    fileMenu->addAction(tr("VCD import filter..."), this, &MainWindow::setVcdImportFilter);
+
+    // Tail a VCD that a simulation is still writing
+    m_followAction = fileMenu->addAction(tr("Follow VCD file"));
+    m_followAction->setCheckable(true);
+    m_followAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F));
+    connect(m_followAction, &QAction::toggled, this, &MainWindow::onFollowToggled);
+
+    fileMenu->addSeparator();
+
     QAction *quitAct = fileMenu->addAction(tr("E&xit"), this, &QWidget::close);
     quitAct->setShortcut(QKeySequence::Quit);
 
     QMenu *editMenu = menuBar()->addMenu(tr("&Edit"));
     QAction *clearAct = editMenu->addAction(tr("Clear all signals"), this, &MainWindow::clearAllSignals);
     clearAct->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_L));
+    editMenu->addSeparator();
+    editMenu->addAction(tr("Undo history size..."), this, &MainWindow::setUndoHistoryBudget);
 
     Q_UNUSED(clearAct);
 
@@ -96,6 +133,52 @@ void MainWindow::createMenus()
     m_viewHierarchyAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_H));
     connect(m_viewHierarchyAction, &QAction::toggled, this, &MainWindow::toggleHierarchyPanel);
 
+    viewMenu->addSeparator();
+    m_traceAction = viewMenu->addAction(tr("Record performance trace"));
+    m_traceAction->setCheckable(true);
+    m_traceAction->setChecked(Tracer::isEnabled()); // WAVEPAINT_TRACE may have enabled it
+    connect(m_traceAction, &QAction::toggled, this, &MainWindow::onTraceToggled);
+
+    m_hudAction = viewMenu->addAction(tr("Performance HUD"));
+    m_hudAction->setCheckable(true);
+    m_hudAction->setShortcut(QKeySequence(Qt::Key_F12));
+    connect(m_hudAction, &QAction::toggled, m_waveView, &WaveView::setHudEnabled);
+    viewMenu->addAction(tr("Document statistics..."), this, &MainWindow::showDocumentStats);
+    QAction *statsDockAct = m_statsDock->toggleViewAction();
+    statsDockAct->setText(tr("Signal statistics"));
+    statsDockAct->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_I));
+    viewMenu->addAction(statsDockAct);
+
+    // Edge navigation over the selected signals (click a name; Ctrl+click for several)
+    QMenu *navMenu = menuBar()->addMenu(tr("&Navigate"));
+    struct EdgeNav { const char *text; QKeySequence key; bool forward; EdgeKind kind; };
+    const EdgeNav navs[] = {
+        { QT_TR_NOOP("Next edge"),             QKeySequence(Qt::CTRL | Qt::Key_Right),             true,  EdgeKind::Any },
+        { QT_TR_NOOP("Previous edge"),         QKeySequence(Qt::CTRL | Qt::Key_Left),              false, EdgeKind::Any },
+        { QT_TR_NOOP("Next rising edge"),      QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Right), true,  EdgeKind::Rising },
+        { QT_TR_NOOP("Previous rising edge"),  QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Left),  false, EdgeKind::Rising },
+        { QT_TR_NOOP("Next falling edge"),     QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_Right),   true,  EdgeKind::Falling },
+        { QT_TR_NOOP("Previous falling edge"), QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_Left),    false, EdgeKind::Falling },
+    };
+    for (const EdgeNav &nav : navs)
+    {
+        QAction *act = navMenu->addAction(tr(nav.text));
+        act->setShortcut(nav.key);
+        const bool forward = nav.forward;
+        const EdgeKind kind = nav.kind;
+        connect(act, &QAction::triggered, this, [this, forward, kind]() { navigateEdge(forward, kind); });
+        if (nav.kind == EdgeKind::Any && !nav.forward)
+            navMenu->addSeparator();
+    }
+    navMenu->addSeparator();
+    QAction *findCondAct = navMenu->addAction(tr("Find by condition..."), this, &MainWindow::showConditionSearch);
+    findCondAct->setShortcut(QKeySequence::Find);
+
+    QMenu *analyzeMenu = menuBar()->addMenu(tr("&Analyze"));
+    analyzeMenu->addAction(tr("Decode protocol..."), this, &MainWindow::showProtocolDecoder);
+    analyzeMenu->addAction(tr("Find glitches..."), this, &MainWindow::showGlitchFinder);
+    analyzeMenu->addAction(tr("Compare with..."), this, &MainWindow::showWaveDiff);
+
     QMenu *helpMenu = menuBar()->addMenu(tr("&Help"));
     QAction *helpAct = helpMenu->addAction(tr("Documentation"), this, &MainWindow::linkToDoc);
     newAct->setShortcut(QKeySequence::New);
@@ -161,26 +244,49 @@ void MainWindow::openFile()
         this,
         tr("Open waveform"),
         QString(),
-        tr("WavePaint files (*.wp *.json *.vcd *.fst *.ghw);;All files (*)"));
+        tr("WavePaint files (*.wp *.json *.vcd *.vcd.gz *.vcd.zst *.fst *.ghw);;All files (*)"));
     if (fileName.isEmpty())
         return;
 
     QFileInfo info(fileName);
     const QString ext = info.suffix().toLower();
+    const bool isVcd = WaveVcdImporter::isVcdFile(fileName);
+    const bool isFst = WaveVcdImporter::isFstFile(fileName);
+    // .vcd.gz / .vcd.zst are decompressed while parsing, if built in
+    const VcdInput::Compression compression = isVcd ? VcdInput::detect(fileName) : VcdInput::Compression::None;
 
     bool ok = false;
+    QString failure;
 
-    if (ext == "vcd")
+    stopFollowing();
+    if (isVcd && !VcdInput::isSupported(compression))
+    {
+        VcdInput(fileName).open(&failure);
+        ok = false;
+    }
+    else if (isVcd)
+    {
+        if (m_followAction->isChecked() && compression == VcdInput::Compression::None)
+        {
+            ok = startFollowing(fileName);
+        }
+        else
+        {
+            ok = m_document.loadFromVcd(fileName, importOptions());
+        }
+    }
+    else if (isFst)
     {
-        ok = m_document.loadFromVcd(fileName);
+        // Signals are decoded when added to the view; not followed while written
+        ok = m_document.loadFromFst(fileName, importOptions());
     }
     else if (ext == "wp" || ext == "json" || ext.isEmpty())
     {
         ok = m_document.loadFromFile(fileName);
     }
-    else if (ext == "fst" || ext == "ghw")
+    else if (ext == "ghw")
     {
-        // FST/GHW not implemented yet: could be converted to VCD externally in the future
+        // GHW not implemented yet: could be converted to VCD externally in the future
         ok = false;
     }
     else
@@ -192,31 +298,39 @@ void MainWindow::openFile()
     if (ok)
     {
         m_currentFile = fileName;
+        if (m_diffDialog)
+            m_diffDialog->clearResult();
         if (m_sampleSpin)
         {
             m_sampleSpin->setValue(m_document.sampleCount());
         }
 
-        if (ext == "vcd")
+        if (isVcd || isFst)
         {
             rebuildHierarchy();
         }
         else
         {
             // For other formats, clear the hierarchy but keep the splitter
-            if (m_hierarchyTree)
-                m_hierarchyTree->clear();
-            if (m_signalList)
-                m_signalList->clear();
+            clearHierarchy();
         }
 
-        statusBar()->showMessage(tr("Loaded %1").arg(fileName), 3000);
+        const VcdImportOptions options = importOptions();
+        const bool filtered = !options.include.isEmpty() || !options.exclude.isEmpty() || options.maxScopeDepth > 0;
+        if ((isVcd || isFst) && filtered)
+            statusBar()->showMessage(tr("Loaded %1 (import filter: %2 signals)").arg(fileName).arg(m_document.vcdSignalList().size()), 5000);
+        else
+            statusBar()->showMessage(tr("Loaded %1").arg(fileName), 3000);
     }
     else
     {
-        if (ext == "fst" || ext == "ghw")
+        if (ext == "ghw")
+        {
+            statusBar()->showMessage(tr("GHW import not implemented yet (VCD and FST supported)."), 5000);
+        }
+        else if (!failure.isEmpty())
         {
-            statusBar()->showMessage(tr("FST/GHW import not implemented yet (VCD supported)."), 5000);
+            statusBar()->showMessage(tr("Failed to load %1: %2").arg(fileName, failure), 5000);
         }
         else
         {
@@ -254,28 +368,342 @@ void MainWindow::saveFileAs()
 
 void MainWindow::newDocument()
 {
+    stopFollowing();
     m_document.clear();
     if (m_sampleSpin)
     {
         m_sampleSpin->setValue(m_document.sampleCount());
     }
-    if (m_hierarchyTree)
-        m_hierarchyTree->clear();
-    if (m_signalList)
-        m_signalList->clear();
+    clearHierarchy();
+    if (m_diffDialog)
+        m_diffDialog->clearResult();
     statusBar()->showMessage(tr("New document"), 2000);
 }
 
 void MainWindow::clearAllSignals()
 {
     m_document.clearSignals();
-    if (m_hierarchyTree)
-        m_hierarchyTree->clear();
-    if (m_signalList)
-        m_signalList->clear();
+    clearHierarchy();
     statusBar()->showMessage(tr("All signals cleared"), 2000);
 }
 
+void MainWindow::onFollowToggled(bool enabled)
+{
+    if (!enabled)
+    {
+        stopFollowing();
+        return;
+    }
+    if (m_follower.isActive())
+        return;
+    if (!WaveVcdImporter::isVcdFile(m_currentFile))
+    {
+        // Stays checked: the next VCD opened is followed
+        statusBar()->showMessage(tr("The next VCD file opened will be followed"), 3000);
+        return;
+    }
+
+    if (VcdInput::detect(m_currentFile) != VcdInput::Compression::None)
+    {
+        statusBar()->showMessage(tr("Compressed dumps cannot be followed"), 3000);
+        return;
+    }
+
+    // Following re-imports the file once to keep the parser state; the
+    // signals on screen come back afterwards
+    QStringList shown;
+    if (VcdLibraryPtr lib = m_document.vcdLibrary())
+    {
+        for (const Signal &sig : m_document.signalList())
+        {
+            if (lib->indexOf(sig.name) >= 0)
+                shown << sig.name;
+        }
+    }
+    if (!startFollowing(m_currentFile))
+    {
+        statusBar()->showMessage(tr("Could not follow %1").arg(m_currentFile), 3000);
+        return;
+    }
+    for (const QString &name : shown)
+        m_document.addSignalFromVcd(name);
+    if (m_sampleSpin)
+        m_sampleSpin->setValue(m_document.sampleCount());
+    rebuildHierarchy();
+}
+
+VcdImportOptions MainWindow::importOptions() const
+{
+    QSettings settings("WavePaint", "WavePaint");
+    VcdImportOptions options;
+    options.proceduralClocks = settings.value("import/proceduralClocks", false).toBool();
+    options.include = settings.value("import/include").toStringList();
+    options.exclude = settings.value("import/exclude").toStringList();
+    options.maxScopeDepth = settings.value("import/maxScopeDepth", 0).toInt();
+    return options;
+}
+
+void MainWindow::setVcdImportFilter()
+{
+    VcdFilterDialog dlg(importOptions(), this);
+    if (dlg.exec() != QDialog::Accepted)
+        return;
+
+    const VcdImportOptions options = dlg.options();
+    QSettings settings("WavePaint", "WavePaint");
+    settings.setValue("import/include", options.include);
+    settings.setValue("import/exclude", options.exclude);
+    settings.setValue("import/maxScopeDepth", options.maxScopeDepth);
+}
+
+bool MainWindow::startFollowing(const QString &fileName)
+{
+    if (!m_follower.start(m_document, fileName, importOptions()))
+        return false;
+
+    if (!m_followTimer)
+    {
+        m_followTimer = new QTimer(this);
+        m_followTimer->setInterval(500);
+        connect(m_followTimer, &QTimer::timeout, this, &MainWindow::pollFollowedFile);
+        m_followWatcher = new QFileSystemWatcher(this);
+        connect(m_followWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::pollFollowedFile);
+    }
+    if (!m_followWatcher->files().isEmpty())
+        m_followWatcher->removePaths(m_followWatcher->files());
+    m_followWatcher->addPath(fileName);
+    m_followTimer->start();
+    statusBar()->showMessage(tr("Following %1").arg(fileName), 3000);
+    return true;
+}
+
+void MainWindow::stopFollowing(const QString &reason)
+{
+    // poll() may have stopped the follower already
+    m_follower.stop();
+    if (!m_followTimer)
+        return;
+    m_followTimer->stop();
+    if (!m_followWatcher->files().isEmpty())
+        m_followWatcher->removePaths(m_followWatcher->files());
+    if (!reason.isEmpty())
+    {
+        const QSignalBlocker block(m_followAction);
+        m_followAction->setChecked(false);
+        statusBar()->showMessage(tr("Stopped following: %1").arg(reason), 5000);
+    }
+}
+
+void MainWindow::pollFollowedFile()
+{
+    if (!m_follower.isActive())
+        return;
+
+    // Auto-scroll only while the end of the waveform is in view, so the
+    // user can browse back without being pulled forward on every update
+    QScrollBar *bar = m_waveScroll->horizontalScrollBar();
+    const bool atEnd = bar->value() >= bar->maximum() - bar->pageStep() / 8;
+
+    QString reason;
+    const int added = m_follower.poll(m_document, 16 << 20, &reason);
+    if (added < 0)
+    {
+        stopFollowing(reason);
+        return;
+    }
+    if (added == 0)
+        return;
+
+    if (m_sampleSpin)
+        m_sampleSpin->setValue(m_document.sampleCount());
+    if (atEnd)
+        scrollToSample(m_document.sampleCount() - 1);
+}
+
+void MainWindow::onTraceToggled(bool enabled)
+{
+    if (enabled)
+    {
+        Tracer::clear();
+        Tracer::setEnabled(true);
+        statusBar()->showMessage(tr("Recording performance trace..."), 3000);
+        return;
+    }
+
+    Tracer::setEnabled(false);
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        tr("Save performance trace"),
+        QString(),
+        tr("Chrome trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    if (!fileName.endsWith(".json", Qt::CaseInsensitive))
+    {
+        fileName += ".json";
+    }
+
+    if (Tracer::writeChromeTrace(fileName))
+    {
+        const QString dropped = Tracer::droppedCount() > 0
+            ? tr(", %1 older ones dropped").arg(Tracer::droppedCount())
+            : QString();
+        statusBar()->showMessage(tr("Trace saved to %1 (%2 events%3)")
+                                     .arg(fileName)
+                                     .arg(Tracer::eventCount())
+                                     .arg(dropped), 3000);
+    }
+    else
+    {
+        statusBar()->showMessage(tr("Failed to save trace %1").arg(fileName), 3000);
+    }
+}
+
+void MainWindow::showDocumentStats()
+{
+    DocumentStatsDialog dlg(&m_document, this);
+    if (dlg.exec() != QDialog::Accepted)
+        return;
+
+    m_document.setMemoryBudget(dlg.memoryBudget());
+    QSettings settings("WavePaint", "WavePaint");
+    settings.setValue("memory/budgetBytes", dlg.memoryBudget());
+}
+
+void MainWindow::setUndoHistoryBudget()
+{
+    bool ok = false;
+    int mb = QInputDialog::getInt(this,
+                                  tr("Undo history size"),
+                                  tr("Memory for undo/redo history (MB).\n"
+                                     "Oldest steps are dropped above this size; "
+                                     "currently %1 in %2 steps.")
+                                      .arg(formatBytes(m_document.undoHistoryBytes()))
+                                      .arg(m_document.undoDepth() + m_document.redoDepth()),
+                                  static_cast<int>(m_document.undoBudget() / (1024 * 1024)),
+                                  1, 1024 * 1024, 16, &ok);
+    if (!ok)
+        return;
+
+    const qint64 bytes = static_cast<qint64>(mb) * 1024 * 1024;
+    m_document.setUndoBudget(bytes);
+    QSettings settings("WavePaint", "WavePaint");
+    settings.setValue("undo/budgetBytes", bytes);
+}
+
+void MainWindow::onMemoryBudgetExceeded(qint64 usedBytes, qint64 budgetBytes)
+{
+    statusBar()->showMessage(tr("Warning: document uses %1, above the %2 memory budget "
+                                "(View -> Document statistics)")
+                                 .arg(formatBytes(usedBytes), formatBytes(budgetBytes)),
+                             10000);
+}
+
+void MainWindow::navigateEdge(bool forward, EdgeKind kind)
+{
+    if (!m_waveView)
+        return;
+
+    if (m_waveView->selectedSignals().empty())
+    {
+        statusBar()->showMessage(tr("Select a signal (click its name) to navigate its edges"), 3000);
+        return;
+    }
+
+    // WaveView emits cursorMoved on success, which scrolls it into view
+    const int sample = m_waveView->jumpToEdge(forward, kind);
+    if (sample < 0)
+        statusBar()->showMessage(forward ? tr("No further edge") : tr("No previous edge"), 2000);
+    else
+        statusBar()->showMessage(tr("Edge at sample %1").arg(sample), 2000);
+}
+
+void MainWindow::showConditionSearch()
+{
+    if (!m_conditionDialog)
+    {
+        m_conditionDialog = new ConditionSearchDialog(&m_document, this);
+        connect(m_conditionDialog, &ConditionSearchDialog::hitActivated, this, [this](int sample)
+        {
+            m_waveView->setCursorSample(sample);
+            scrollToSample(sample);
+        });
+    }
+    m_conditionDialog->show();
+    m_conditionDialog->raise();
+    m_conditionDialog->activateWindow();
+}
+
+void MainWindow::showProtocolDecoder()
+{
+    if (!m_decoderDialog)
+    {
+        m_decoderDialog = new ProtocolDecoderDialog(&m_document, this);
+        connect(m_decoderDialog, &ProtocolDecoderDialog::annotationActivated, this, [this](int sample)
+        {
+            m_waveView->setCursorSample(sample);
+            scrollToSample(sample);
+        });
+    }
+    m_decoderDialog->show();
+    m_decoderDialog->raise();
+    m_decoderDialog->activateWindow();
+}
+
+void MainWindow::showGlitchFinder()
+{
+    if (!m_glitchDialog)
+    {
+        m_glitchDialog = new GlitchFinderDialog(&m_document, m_waveView, this);
+        connect(m_glitchDialog, &GlitchFinderDialog::violationActivated, this, [this](int sample)
+        {
+            m_waveView->setCursorSample(sample);
+            scrollToSample(sample);
+        });
+    }
+
+    // Offer the scope selected in the hierarchy panel
+    const VcdLibraryPtr lib = m_document.vcdLibrary();
+    if (lib && m_hierarchyTree && m_scopeModel && m_hierarchyTree->currentIndex().isValid())
+        m_glitchDialog->setScopePath(lib->scopePath(m_scopeModel->scopeId(m_hierarchyTree->currentIndex())));
+
+    m_glitchDialog->show();
+    m_glitchDialog->raise();
+    m_glitchDialog->activateWindow();
+}
+
+void MainWindow::showWaveDiff()
+{
+    if (!m_diffDialog)
+    {
+        m_diffDialog = new WaveDiffDialog(&m_document, m_waveView, this);
+        connect(m_diffDialog, &WaveDiffDialog::mismatchActivated, this, [this](int sample)
+        {
+            m_waveView->setCursorSample(sample);
+            scrollToSample(sample);
+        });
+    }
+    m_diffDialog->show();
+    m_diffDialog->raise();
+    m_diffDialog->activateWindow();
+}
+
+void MainWindow::scrollToSample(int sample)
+{
+    if (!m_waveScroll || !m_waveView)
+        return;
+
+    // Re-centre only when the sample leaves the middle of the viewport
+    QScrollBar *bar = m_waveScroll->horizontalScrollBar();
+    const int viewW = m_waveScroll->viewport()->width();
+    const int margin = viewW / 8;
+    const int x = m_waveView->sampleToX(sample);
+    if (x < bar->value() + margin || x > bar->value() + viewW - margin)
+        bar->setValue(x - viewW / 2);
+}
+
 void MainWindow::linkToDoc()
 {
     const QUrl url("https://github.com/marianoolmos/WavePaint");
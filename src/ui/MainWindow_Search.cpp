@@ -0,0 +1,118 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          MainWindow_Search.cpp
+// Description:   Incremental fuzzy search over the VCD library names.
+//======================================================================
+
+#include "MainWindow.h"
+#include "core/VcdLibrary.h"
+#include "core/NameIndex.h"
+#include "VcdHierarchyModel.h"
+#include <QLineEdit>
+#include <QListView>
+#include <QTreeView>
+#include <QItemSelectionModel>
+#include <QStatusBar>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace
+{
+// Ranked results kept per query; the total count is still reported
+constexpr int kMaxSearchResults = 1000;
+}
+
+void MainWindow::warmSearchIndex()
+{
+    VcdLibraryPtr lib = m_document.vcdLibrary();
+    if (!lib || lib->size() == 0)
+        return;
+
+    // nameIndex() builds once under std::call_once; later queries just wait on it.
+    // The task holds its own reference to the library, so it may outlive the import.
+    m_indexWarmup = QtConcurrent::run([lib]() { lib->nameIndex(); });
+}
+
+void MainWindow::onSearchTextChanged(const QString &text)
+{
+    if (!m_signalModel)
+        return;
+
+    if (text.trimmed().isEmpty())
+    {
+        // Back to browsing: show the signals of the selected scope again
+        if (m_searchCancel)
+            m_searchCancel->store(true);
+        m_searchPending = false;
+        if (m_hierarchyTree && m_scopeModel)
+            m_signalModel->setScope(m_scopeModel->library(),
+                                    m_scopeModel->scopeId(m_hierarchyTree->currentIndex()));
+        return;
+    }
+
+    if (m_searchWatcher->isRunning())
+    {
+        // Abort the stale query; the latest text runs as soon as it returns
+        m_searchCancel->store(true);
+        m_pendingSearch = text;
+        m_searchPending = true;
+        return;
+    }
+    launchSignalSearch(text);
+}
+
+void MainWindow::launchSignalSearch(const QString &text)
+{
+    VcdLibraryPtr lib = m_document.vcdLibrary();
+    if (!lib || lib->size() == 0)
+    {
+        m_signalModel->setResults(nullptr, {});
+        return;
+    }
+
+    m_searchLibrary = lib;
+    m_searchCancel = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<std::atomic<bool>> cancel = m_searchCancel;
+
+    m_searchWatcher->setFuture(QtConcurrent::run([lib, text, cancel]() {
+        return lib->nameIndex().search(text, kMaxSearchResults, cancel.get());
+    }));
+}
+
+void MainWindow::onSearchFinished()
+{
+    NameSearchResult res = m_searchWatcher->result();
+    VcdLibraryPtr lib = m_searchLibrary;
+    m_searchLibrary.reset();
+
+    if (m_searchPending)
+    {
+        m_searchPending = false;
+        launchSignalSearch(m_pendingSearch);
+        return;
+    }
+
+    // Cancelled, or the search box was cleared / the library replaced meanwhile
+    if (res.cancelled || !m_searchEdit || m_searchEdit->text().trimmed().isEmpty()
+        || lib != m_document.vcdLibrary())
+        return;
+
+    const int shown = static_cast<int>(res.ids.size());
+    m_signalModel->setResults(lib, std::move(res.ids));
+
+    QString msg = (shown < res.totalMatches)
+        ? tr("%1 matches (showing %2) in %3 ms").arg(res.totalMatches).arg(shown)
+        : tr("%1 matches in %3 ms").arg(res.totalMatches);
+    statusBar()->showMessage(msg.arg(res.elapsedNs / 1.0e6, 0, 'f', 2), 3000);
+}
@@ -43,6 +43,8 @@
 //======================================================================    
 #include "MainWindow.h"
 #include "WaveView.h"
+#include "core/VcdLibrary.h"
+#include "VcdHierarchyModel.h"
 #include <QToolBar>
 #include <QSpinBox>
 #include <QMenuBar>
@@ -54,64 +56,35 @@
 #include <QFileInfo>
 #include <QDesktopServices>
 #include <QUrl>
-#include <QTreeWidgetItem>
 #include <QKeyEvent>
 #include <QScrollArea>
-#include <QListWidgetItem>
-#include <QMap>
 #include <QVBoxLayout>
-#include <QListWidget>
-#include <QTreeWidget>
+#include <QListView>
+#include <QTreeView>
 #include <QSplitter>
 
 void MainWindow::rebuildHierarchy()
 {
-    if (!m_hierarchyTree || !m_signalList)
+    if (!m_scopeModel || !m_signalModel)
         return;
 
-    m_hierarchyTree->clear();
-    m_signalList->clear();
+    m_signalModel->clear();
 
-    const auto &sigs = m_document.vcdSignalList();
-    if (sigs.empty())
-        return;
-
-    // Build hierarchy tree from names separated by '.'
-    QMap<QString, QTreeWidgetItem *> pathToItem;
-
-    for (const Signal &s : sigs)
+    VcdLibraryPtr lib = m_document.vcdLibrary();
+    if (!lib || lib->size() == 0)
     {
-        QString fullName = s.name;
-        if (fullName.isEmpty())
-            continue;
-
-        QStringList parts = fullName.split('.');
-        if (parts.size() <= 1)
-            continue;
-
-        QStringList moduleParts = parts;
-        moduleParts.removeLast(); // last element = signal name
-
-        QString pathSoFar;
-        QTreeWidgetItem *parentItem = nullptr;
-        for (const QString &part : moduleParts)
-        {
-            pathSoFar = pathSoFar.isEmpty() ? part : pathSoFar + "." + part;
-            if (!pathToItem.contains(pathSoFar))
-            {
-                QTreeWidgetItem *item = new QTreeWidgetItem();
-                item->setText(0, part);
-                if (parentItem)
-                    parentItem->addChild(item);
-                else
-                    m_hierarchyTree->addTopLevelItem(item);
-                pathToItem.insert(pathSoFar, item);
-            }
-            parentItem = pathToItem.value(pathSoFar);
-        }
+        m_scopeModel->setLibrary(nullptr);
+        return;
     }
 
-    m_hierarchyTree->expandAll();
+    // The model exposes scopes as the tree expands: no per-scope work here
+    m_scopeModel->setLibrary(lib);
+
+    // Build the name index in the background so the first keystroke is fast,
+    // and refresh a query typed before the import finished
+    warmSearchIndex();
+    if (m_searchEdit && !m_searchEdit->text().trimmed().isEmpty())
+        onSearchTextChanged(m_searchEdit->text());
 
     // Ensure left panel remains visible
     if (m_splitter)
@@ -128,6 +101,18 @@ void MainWindow::rebuildHierarchy()
         }
     }
 }
+
+void MainWindow::clearHierarchy()
+{
+    if (m_searchCancel)
+        m_searchCancel->store(true);
+    m_searchPending = false;
+    if (m_signalModel)
+        m_signalModel->clear();
+    if (m_scopeModel)
+        m_scopeModel->setLibrary(nullptr);
+}
+
 void MainWindow::toggleHierarchyPanel(bool visible)
 {
     if (!m_splitter)
@@ -0,0 +1,367 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ProtocolDecoderDialog.cpp
+// Description:   Dialog that runs a protocol decoder in the background.
+//======================================================================
+
+#include "ProtocolDecoderDialog.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <atomic>
+
+// State shared with the worker: annotations wait in `pending` until the
+// dialog's poll timer picks them up
+struct DecodeJob
+{
+    QMutex mutex;
+    std::vector<AnnotationRow> pending;
+    int doneSample = 0;
+    std::atomic<bool> cancel{false};
+};
+
+namespace {
+
+QTableWidgetItem *sampleItem(int sample)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(QString::number(sample));
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return it;
+}
+
+// "top.uart_rx" matches the channel "rx"
+bool matchesRole(const QString &signalName, const QString &role)
+{
+    const QString leaf = signalName.mid(signalName.lastIndexOf('.') + 1).toLower();
+    return leaf == role || leaf.endsWith('_' + role);
+}
+
+} // namespace
+
+ProtocolDecoderDialog::ProtocolDecoderDialog(WaveDocument *doc, QWidget *parent)
+    : QDialog(parent),
+      m_doc(doc),
+      m_decoderCombo(new QComboBox(this)),
+      m_channelForm(new QFormLayout()),
+      m_optionForm(new QFormLayout()),
+      m_startButton(new QPushButton(tr("Decode"), this)),
+      m_stopButton(new QPushButton(tr("Stop"), this)),
+      m_progress(new QProgressBar(this)),
+      m_statusLabel(new QLabel(this)),
+      m_table(new QTableWidget(this)),
+      m_pollTimer(new QTimer(this)),
+      m_watcher(new QFutureWatcher<DecodeSummary>(this))
+{
+    setWindowTitle(tr("Decode protocol"));
+    resize(520, 600);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    for (const QString &id : protocolDecoderIds())
+    {
+        std::unique_ptr<ProtocolDecoder> dec = createProtocolDecoder(id);
+        m_decoderCombo->addItem(dec ? dec->description() : id, id);
+    }
+    const QString lastId = QSettings("WavePaint", "WavePaint").value("decode/lastDecoder").toString();
+    m_decoderCombo->setCurrentIndex(std::max(0, m_decoderCombo->findData(lastId)));
+
+    QFormLayout *top = new QFormLayout();
+    top->addRow(tr("Decoder"), m_decoderCombo);
+    layout->addLayout(top);
+    layout->addLayout(m_channelForm);
+    layout->addLayout(m_optionForm);
+
+    QHBoxLayout *runRow = new QHBoxLayout();
+    runRow->addWidget(m_progress, 1);
+    m_startButton->setDefault(true);
+    runRow->addWidget(m_startButton);
+    m_stopButton->setEnabled(false);
+    runRow->addWidget(m_stopButton);
+    layout->addLayout(runRow);
+    layout->addWidget(m_statusLabel);
+
+    m_table->setColumnCount(4);
+    m_table->setHorizontalHeaderLabels({tr("Row"), tr("Start"), tr("End"), tr("Annotation")});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    layout->addWidget(m_table, 1);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    m_pollTimer->setInterval(100);
+    connect(m_pollTimer, &QTimer::timeout, this, &ProtocolDecoderDialog::drain);
+    connect(m_decoderCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ProtocolDecoderDialog::onDecoderChanged);
+    connect(m_startButton, &QPushButton::clicked, this, &ProtocolDecoderDialog::start);
+    connect(m_stopButton, &QPushButton::clicked, this, &ProtocolDecoderDialog::stop);
+    connect(m_watcher, &QFutureWatcher<DecodeSummary>::finished,
+            this, &ProtocolDecoderDialog::onFinished);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int)
+    {
+        if (QTableWidgetItem *it = m_table->item(row, 1))
+            emit annotationActivated(it->text().toInt());
+    });
+    // Signal list changes invalidate the channel choices
+    connect(m_doc, &WaveDocument::dataChanged, this, [this]()
+    {
+        if (!m_watcher->isRunning())
+            onDecoderChanged();
+    });
+
+    onDecoderChanged();
+}
+
+ProtocolDecoderDialog::~ProtocolDecoderDialog()
+{
+    // The worker only touches the job and its own snapshot; just let it stop
+    if (m_job)
+        m_job->cancel = true;
+    m_watcher->waitForFinished();
+}
+
+void ProtocolDecoderDialog::clearForm(QFormLayout *form)
+{
+    while (form->rowCount() > 0)
+        form->removeRow(0);
+}
+
+void ProtocolDecoderDialog::onDecoderChanged()
+{
+    // Same decoder (the signal list changed): keep the channels chosen so far
+    const QString id = m_decoderCombo->currentData().toString();
+    QStringList previous;
+    if (id == m_decoderId)
+    {
+        for (QComboBox *combo : m_channelCombos)
+            previous << combo->currentText();
+    }
+    m_decoderId = id;
+    std::unique_ptr<ProtocolDecoder> dec = createProtocolDecoder(m_decoderId);
+    clearForm(m_channelForm);
+    clearForm(m_optionForm);
+    m_channelCombos.clear();
+    m_optionSpins.clear();
+    if (!dec)
+        return;
+
+    const std::vector<Signal> &sigs = m_doc->signalList();
+    for (const DecoderChannel &ch : dec->channels())
+    {
+        QComboBox *combo = new QComboBox(this);
+        if (ch.optional)
+            combo->addItem(tr("(none)"), -1);
+        int pick = -1;
+        for (int i = 0; i < static_cast<int>(sigs.size()); ++i)
+        {
+            if (sigs[i].type != SignalType::Bit)
+                continue;
+            combo->addItem(sigs[i].name, i);
+            if (pick < 0 && matchesRole(sigs[i].name, ch.name))
+                pick = combo->count() - 1;
+        }
+        const int kept = m_channelCombos.size() < static_cast<size_t>(previous.size())
+                             ? combo->findText(previous[static_cast<int>(m_channelCombos.size())]) : -1;
+        if (kept >= 0)
+            combo->setCurrentIndex(kept);
+        else if (pick >= 0)
+            combo->setCurrentIndex(pick);
+        m_channelForm->addRow(ch.name + (ch.optional ? tr(" (optional)") : QString()), combo);
+        m_channelCombos.push_back(combo);
+    }
+
+    QSettings settings("WavePaint", "WavePaint");
+    for (const DecoderOption &opt : dec->options())
+    {
+        QSpinBox *spin = new QSpinBox(this);
+        spin->setRange(opt.minValue, opt.maxValue);
+        spin->setValue(settings.value(QString("decode/%1/%2").arg(m_decoderId, opt.key), opt.defaultValue).toInt());
+        m_optionForm->addRow(opt.label, spin);
+        m_optionSpins.push_back(spin);
+    }
+}
+
+void ProtocolDecoderDialog::start()
+{
+    if (m_watcher->isRunning())
+        return;
+
+    std::unique_ptr<ProtocolDecoder> dec = createProtocolDecoder(m_decoderId);
+    if (!dec)
+        return;
+
+    // Snapshot of the signals (buffers are shared, so it is cheap); the
+    // worker reads the channels and the operands of derived ones from it
+    auto snapshot = std::make_shared<const std::vector<Signal>>(m_doc->signalList());
+    std::vector<int> channelRows;
+    const std::vector<DecoderChannel> channels = dec->channels();
+    for (size_t c = 0; c < channels.size(); ++c)
+    {
+        const int row = m_channelCombos[c]->currentData().toInt();
+        if (row < 0 && !channels[c].optional)
+        {
+            m_statusLabel->setText(tr("Choose a signal for \"%1\"").arg(channels[c].name));
+            return;
+        }
+        channelRows.push_back(row);
+    }
+
+    QSettings settings("WavePaint", "WavePaint");
+    settings.setValue("decode/lastDecoder", m_decoderId);
+    const std::vector<DecoderOption> options = dec->options();
+    for (size_t i = 0; i < options.size(); ++i)
+    {
+        dec->setOption(options[i].key, m_optionSpins[i]->value());
+        settings.setValue(QString("decode/%1/%2").arg(m_decoderId, options[i].key), m_optionSpins[i]->value());
+    }
+
+    m_rows.clear();
+    m_table->setRowCount(0);
+    m_job = std::make_shared<DecodeJob>();
+    const int total = m_doc->sampleCount();
+    m_progress->setRange(0, 1000);
+    m_progress->setValue(0);
+    m_statusLabel->setText(tr("Decoding..."));
+    m_startButton->setEnabled(false);
+    m_stopButton->setEnabled(true);
+    m_decoderCombo->setEnabled(false);
+
+    std::shared_ptr<ProtocolDecoder> decoder(std::move(dec));
+    std::shared_ptr<DecodeJob> job = m_job;
+    m_watcher->setFuture(QtConcurrent::run([decoder, job, snapshot, channelRows, total]()
+    {
+        std::vector<const Signal *> chans;
+        for (int row : channelRows)
+            chans.push_back(row >= 0 && row < static_cast<int>(snapshot->size()) ? &(*snapshot)[row] : nullptr);
+
+        return decodeProtocol(*decoder, chans, 0, total, resolverFor(*snapshot),
+                              [job](std::vector<AnnotationRow> &rows, int done)
+        {
+            QMutexLocker lock(&job->mutex);
+            if (job->pending.empty())
+                job->pending.resize(rows.size());
+            for (size_t r = 0; r < rows.size(); ++r)
+            {
+                std::vector<Annotation> &dst = job->pending[r].annotations;
+                job->pending[r].name = rows[r].name;
+                dst.insert(dst.end(), std::make_move_iterator(rows[r].annotations.begin()),
+                           std::make_move_iterator(rows[r].annotations.end()));
+            }
+            job->doneSample = done;
+            return !job->cancel.load();
+        });
+    }));
+    m_pollTimer->start();
+}
+
+void ProtocolDecoderDialog::stop()
+{
+    if (m_job)
+        m_job->cancel = true;
+}
+
+void ProtocolDecoderDialog::drain()
+{
+    if (!m_job)
+        return;
+
+    std::vector<AnnotationRow> batch;
+    int done = 0;
+    {
+        QMutexLocker lock(&m_job->mutex);
+        batch.swap(m_job->pending);
+        done = m_job->doneSample;
+    }
+
+    const int total = std::max(1, m_doc->sampleCount());
+    m_progress->setValue(static_cast<int>(1000LL * done / total));
+
+    if (m_rows.size() < batch.size())
+        m_rows.resize(batch.size());
+    for (size_t r = 0; r < batch.size(); ++r)
+    {
+        m_rows[r].name = batch[r].name;
+        for (Annotation &a : batch[r].annotations)
+        {
+            const int tableRow = m_table->rowCount();
+            if (tableRow < kMaxTableRows)
+            {
+                m_table->insertRow(tableRow);
+                m_table->setItem(tableRow, 0, new QTableWidgetItem(batch[r].name));
+                m_table->setItem(tableRow, 1, sampleItem(a.start));
+                m_table->setItem(tableRow, 2, sampleItem(a.end - 1));
+                m_table->setItem(tableRow, 3, new QTableWidgetItem(a.label));
+            }
+            m_rows[r].annotations.push_back(std::move(a));
+        }
+    }
+}
+
+void ProtocolDecoderDialog::onFinished()
+{
+    m_pollTimer->stop();
+    drain();
+    const DecodeSummary sum = m_watcher->result();
+
+    m_startButton->setEnabled(true);
+    m_stopButton->setEnabled(false);
+    m_decoderCombo->setEnabled(true);
+    m_progress->setValue(m_progress->maximum());
+
+    // One Vector row per non-empty output, named "<decoder>.<output>"
+    std::vector<AnnotationRow> rows;
+    for (AnnotationRow &row : m_rows)
+    {
+        if (row.annotations.empty())
+            continue;
+        row.name = m_decoderId + '.' + row.name;
+        rows.push_back(std::move(row));
+    }
+    m_rows.clear();
+    m_job.reset();
+
+    QString text = tr("%1 annotations from %2 events in %3 ms")
+                       .arg(sum.annotations)
+                       .arg(sum.events)
+                       .arg(sum.elapsedNs / 1.0e6, 0, 'f', 2);
+    if (sum.canceled)
+        text += tr(" (stopped)");
+    if (m_table->rowCount() >= kMaxTableRows)
+        text += tr(", first %1 listed").arg(kMaxTableRows);
+    m_statusLabel->setText(text);
+
+    if (!rows.empty())
+        m_doc->addAnnotationSignals(rows);
+}
@@ -0,0 +1,86 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          ProtocolDecoderDialog.h
+// Description:   Dialog that runs a protocol decoder in the background.
+//======================================================================
+
+#ifndef PROTOCOLDECODERDIALOG_H
+#define PROTOCOLDECODERDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <memory>
+#include <vector>
+#include "core/core.h"
+#include "core/ProtocolDecoder.h"
+
+class QComboBox;
+class QFormLayout;
+class QSpinBox;
+class QPushButton;
+class QProgressBar;
+class QLabel;
+class QTableWidget;
+class QTimer;
+struct DecodeJob;
+
+// "Decode protocol": picks a decoder (UART, SPI, I2C, ...), maps its
+// channels to signals of the document and runs it on a worker thread.
+// Annotations are listed as they arrive; when the run ends (or is stopped)
+// they are added to the document as labelled Vector rows.
+class ProtocolDecoderDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit ProtocolDecoderDialog(WaveDocument *doc, QWidget *parent = nullptr);
+    ~ProtocolDecoderDialog() override;
+
+signals:
+    // An annotation was double-clicked: move the cursor there
+    void annotationActivated(int sample);
+
+private slots:
+    void onDecoderChanged();
+    void start();
+    void stop();
+    void drain();
+    void onFinished();
+
+private:
+    WaveDocument *m_doc;
+    QComboBox    *m_decoderCombo;
+    QFormLayout  *m_channelForm;
+    QFormLayout  *m_optionForm;
+    QPushButton  *m_startButton;
+    QPushButton  *m_stopButton;
+    QProgressBar *m_progress;
+    QLabel       *m_statusLabel;
+    QTableWidget *m_table;
+    QTimer       *m_pollTimer;
+    QFutureWatcher<DecodeSummary> *m_watcher;
+
+    std::vector<QComboBox *> m_channelCombos;
+    std::vector<QSpinBox *>  m_optionSpins;
+    std::shared_ptr<DecodeJob> m_job;
+    std::vector<AnnotationRow> m_rows;       // everything received so far
+    QString m_decoderId;
+
+    void clearForm(QFormLayout *form);
+
+    // The table lists the first annotations only; the rows get all of them
+    static constexpr int kMaxTableRows = 10000;
+};
+
+#endif // PROTOCOLDECODERDIALOG_H
@@ -0,0 +1,284 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          SignalStatsPanel.cpp
+// Description:   Dockable per-signal statistics panel.
+//======================================================================
+
+#include "SignalStatsPanel.h"
+#include "WaveView.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+namespace {
+
+QTableWidgetItem *numberItem(const QString &text)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(text);
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return it;
+}
+
+QString percent(qint64 part, qint64 whole)
+{
+    return whole > 0 ? QString::number(100.0 * double(part) / double(whole), 'f', 2) : QStringLiteral("-");
+}
+
+} // namespace
+
+SignalStatsPanel::SignalStatsPanel(WaveDocument *doc, WaveView *view, QWidget *parent)
+    : QWidget(parent),
+      m_doc(doc),
+      m_view(view),
+      m_fromSpin(new QSpinBox(this)),
+      m_toSpin(new QSpinBox(this)),
+      m_markerACombo(new QComboBox(this)),
+      m_markerBCombo(new QComboBox(this)),
+      m_autoCheck(new QCheckBox(tr("Auto"), this)),
+      m_computeButton(new QPushButton(tr("Compute"), this)),
+      m_statusLabel(new QLabel(this)),
+      m_statsTable(new QTableWidget(this)),
+      m_histTable(new QTableWidget(this)),
+      m_watcher(new QFutureWatcher<SignalStatsResult>(this))
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    // Range: explicit samples, or snapped to two markers
+    QHBoxLayout *rangeRow = new QHBoxLayout();
+    m_fromSpin->setRange(0, INT_MAX);
+    m_toSpin->setRange(0, INT_MAX);
+    m_toSpin->setValue(m_doc->sampleCount());
+    m_lastSampleCount = m_doc->sampleCount();
+    m_toSpin->setToolTip(tr("End of the range (exclusive)"));
+    QPushButton *wholeBtn = new QPushButton(tr("Whole"), this);
+    rangeRow->addWidget(new QLabel(tr("From"), this));
+    rangeRow->addWidget(m_fromSpin, 1);
+    rangeRow->addWidget(new QLabel(tr("to"), this));
+    rangeRow->addWidget(m_toSpin, 1);
+    rangeRow->addWidget(wholeBtn);
+    layout->addLayout(rangeRow);
+
+    QHBoxLayout *markerRow = new QHBoxLayout();
+    markerRow->addWidget(new QLabel(tr("Markers"), this));
+    markerRow->addWidget(m_markerACombo, 1);
+    markerRow->addWidget(m_markerBCombo, 1);
+    layout->addLayout(markerRow);
+
+    QHBoxLayout *runRow = new QHBoxLayout();
+    m_autoCheck->setToolTip(tr("Recompute when the selection or the document changes"));
+    runRow->addWidget(m_autoCheck);
+    runRow->addStretch(1);
+    runRow->addWidget(m_computeButton);
+    layout->addLayout(runRow);
+
+    m_statusLabel->setText(tr("Select signals (Ctrl+click for several) and press Compute"));
+    m_statusLabel->setWordWrap(true);
+    layout->addWidget(m_statusLabel);
+
+    m_statsTable->setColumnCount(9);
+    m_statsTable->setHorizontalHeaderLabels({tr("Signal"), tr("Samples"), tr("Toggles"), tr("Duty %"),
+                                             tr("X %"), tr("Pulses"), tr("Min"), tr("Max"), tr("Mean")});
+    m_statsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_statsTable->horizontalHeader()->setStretchLastSection(true);
+    m_statsTable->verticalHeader()->setVisible(false);
+    m_statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_statsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_statsTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_statsTable->setToolTip(tr("Pulses: complete high pulses (vectors: runs of one value) inside the range"));
+    layout->addWidget(m_statsTable, 2);
+
+    m_histTable->setColumnCount(3);
+    m_histTable->setHorizontalHeaderLabels({tr("Value"), tr("Samples"), tr("%")});
+    m_histTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_histTable->verticalHeader()->setVisible(false);
+    m_histTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    layout->addWidget(new QLabel(tr("Value histogram (selected vector)"), this));
+    layout->addWidget(m_histTable, 1);
+
+    rebuildMarkerCombos();
+
+    connect(wholeBtn, &QPushButton::clicked, this, [this]()
+    {
+        m_fromSpin->setValue(0);
+        m_toSpin->setValue(m_doc->sampleCount());
+    });
+    connect(m_markerACombo, QOverload<int>::of(&QComboBox::activated), this, &SignalStatsPanel::onMarkerRange);
+    connect(m_markerBCombo, QOverload<int>::of(&QComboBox::activated), this, &SignalStatsPanel::onMarkerRange);
+    connect(m_computeButton, &QPushButton::clicked, this, &SignalStatsPanel::compute);
+    connect(m_watcher, &QFutureWatcher<SignalStatsResult>::finished, this, &SignalStatsPanel::onFinished);
+    connect(m_statsTable, &QTableWidget::itemSelectionChanged, this, &SignalStatsPanel::showHistogram);
+    connect(m_doc, &WaveDocument::dataChanged, this, [this]()
+    {
+        // A range that covered the whole document keeps covering it
+        if (m_toSpin->value() == m_lastSampleCount)
+            m_toSpin->setValue(m_doc->sampleCount());
+        m_lastSampleCount = m_doc->sampleCount();
+        rebuildMarkerCombos();
+        refreshIfAuto();
+    });
+}
+
+void SignalStatsPanel::rebuildMarkerCombos()
+{
+    const QVariant a = m_markerACombo->currentData();
+    const QVariant b = m_markerBCombo->currentData();
+
+    std::vector<Marker> markers = m_doc->markerList();
+    std::sort(markers.begin(), markers.end(),
+              [](const Marker &x, const Marker &y) { return x.sample < y.sample; });
+
+    for (QComboBox *combo : {m_markerACombo, m_markerBCombo})
+    {
+        combo->clear();
+        combo->addItem(tr("(none)"), -1);
+        for (const Marker &m : markers)
+            combo->addItem(tr("Marker %1 @ %2").arg(m.id).arg(m.sample), m.sample);
+        combo->setEnabled(!markers.empty());
+    }
+    m_markerACombo->setCurrentIndex(std::max(0, m_markerACombo->findData(a)));
+    m_markerBCombo->setCurrentIndex(std::max(0, m_markerBCombo->findData(b)));
+}
+
+void SignalStatsPanel::onMarkerRange()
+{
+    const int a = m_markerACombo->currentData().toInt();
+    const int b = m_markerBCombo->currentData().toInt();
+    if (a < 0 || b < 0 || a == b)
+        return;
+    m_fromSpin->setValue(std::min(a, b));
+    m_toSpin->setValue(std::max(a, b));
+    refreshIfAuto();
+}
+
+void SignalStatsPanel::refreshIfAuto()
+{
+    if (m_autoCheck->isChecked() && isVisible())
+        compute();
+}
+
+void SignalStatsPanel::compute()
+{
+    if (m_watcher->isRunning())
+    {
+        m_rerun = true;
+        return;
+    }
+
+    std::vector<int> rows = m_view->selectedSignals();
+    const std::vector<Signal> &all = m_doc->signalList();
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [&](int r) { return r < 0 || r >= static_cast<int>(all.size()); }),
+               rows.end());
+    if (rows.empty())
+    {
+        m_statusLabel->setText(tr("No signal selected"));
+        return;
+    }
+
+    // Snapshot of the document: the sample buffers are shared copy-on-write,
+    // so this is cheap and the worker never sees later edits
+    auto snapshot = std::make_shared<const std::vector<Signal>>(all);
+    std::vector<Signal> selected;
+    selected.reserve(rows.size());
+    for (int r : rows)
+        selected.push_back(all[r]);
+
+    const int t0 = m_fromSpin->value();
+    const int t1 = std::min(m_toSpin->value(), m_doc->sampleCount());
+    if (t1 <= t0)
+    {
+        m_statusLabel->setText(tr("Empty range"));
+        return;
+    }
+
+    m_computeButton->setEnabled(false);
+    m_statusLabel->setText(tr("Computing..."));
+    m_watcher->setFuture(QtConcurrent::run([snapshot, selected, t0, t1]()
+    {
+        return computeSignalStats(selected, t0, t1, resolverFor(*snapshot));
+    }));
+}
+
+void SignalStatsPanel::onFinished()
+{
+    m_computeButton->setEnabled(true);
+    m_result = m_watcher->result();
+
+    const int rows = static_cast<int>(m_result.stats.size());
+    m_statsTable->setRowCount(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        const SignalStats &st = m_result.stats[r];
+        const bool hasPulses = st.pulses > 0;
+        m_statsTable->setItem(r, 0, new QTableWidgetItem(st.name));
+        m_statsTable->setItem(r, 1, numberItem(QString::number(st.samples())));
+        m_statsTable->setItem(r, 2, numberItem(QString::number(st.toggles)));
+        m_statsTable->setItem(r, 3, numberItem(st.dutyCycle() < 0 ? QStringLiteral("-")
+                                                                  : QString::number(100.0 * st.dutyCycle(), 'f', 2)));
+        m_statsTable->setItem(r, 4, numberItem(percent(st.xSamples, st.samples())));
+        m_statsTable->setItem(r, 5, numberItem(QString::number(st.pulses)));
+        m_statsTable->setItem(r, 6, numberItem(hasPulses ? QString::number(st.minPulse) : QStringLiteral("-")));
+        m_statsTable->setItem(r, 7, numberItem(hasPulses ? QString::number(st.maxPulse) : QStringLiteral("-")));
+        m_statsTable->setItem(r, 8, numberItem(hasPulses ? QString::number(st.meanPulse, 'f', 2) : QStringLiteral("-")));
+    }
+    if (rows > 0)
+        m_statsTable->selectRow(0);
+    showHistogram();
+
+    m_statusLabel->setText(tr("[%1, %2): %3 signals in %4 ms, %5 work items")
+                               .arg(rows > 0 ? m_result.stats.front().t0 : 0)
+                               .arg(rows > 0 ? m_result.stats.front().t1 : 0)
+                               .arg(rows)
+                               .arg(m_result.elapsedNs / 1.0e6, 0, 'f', 2)
+                               .arg(m_result.chunks));
+
+    if (m_rerun)
+    {
+        m_rerun = false;
+        compute();
+    }
+}
+
+void SignalStatsPanel::showHistogram()
+{
+    const int row = m_statsTable->currentRow();
+    m_histTable->setRowCount(0);
+    if (row < 0 || row >= static_cast<int>(m_result.stats.size()))
+        return;
+
+    const SignalStats &st = m_result.stats[row];
+    const int rows = std::min(static_cast<int>(st.histogram.size()), kMaxHistogramRows);
+    m_histTable->setRowCount(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        const auto &bin = st.histogram[r];
+        m_histTable->setItem(r, 0, numberItem("0x" + QString::number(bin.first, 16).toUpper()));
+        m_histTable->setItem(r, 1, numberItem(QString::number(bin.second)));
+        m_histTable->setItem(r, 2, numberItem(percent(bin.second, st.samples())));
+    }
+}
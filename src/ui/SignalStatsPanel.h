@@ -0,0 +1,77 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          SignalStatsPanel.h
+// Description:   Dockable per-signal statistics panel.
+//======================================================================
+
+#ifndef SIGNALSTATSPANEL_H
+#define SIGNALSTATSPANEL_H
+
+#include <QWidget>
+#include <QFutureWatcher>
+#include "core/core.h"
+#include "core/SignalStats.h"
+
+class WaveView;
+class QSpinBox;
+class QComboBox;
+class QPushButton;
+class QCheckBox;
+class QLabel;
+class QTableWidget;
+
+// Dockable panel with the activity statistics (toggles, duty cycle, pulse
+// widths, time in X, value histogram) of the selected signals over a range
+// of samples or between two markers. The work runs on the thread pool.
+class SignalStatsPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    SignalStatsPanel(WaveDocument *doc, WaveView *view, QWidget *parent = nullptr);
+
+public slots:
+    void compute();
+    // Selection or document changed: recompute when "Auto" is on
+    void refreshIfAuto();
+
+private slots:
+    void onFinished();
+    void onMarkerRange();
+    void showHistogram();
+
+private:
+    WaveDocument *m_doc;
+    WaveView     *m_view;
+    QSpinBox     *m_fromSpin;
+    QSpinBox     *m_toSpin;
+    QComboBox    *m_markerACombo;
+    QComboBox    *m_markerBCombo;
+    QCheckBox    *m_autoCheck;
+    QPushButton  *m_computeButton;
+    QLabel       *m_statusLabel;
+    QTableWidget *m_statsTable;
+    QTableWidget *m_histTable;
+    QFutureWatcher<SignalStatsResult> *m_watcher;
+
+    SignalStatsResult m_result;
+    bool m_rerun = false;   // a request arrived while computing
+    int  m_lastSampleCount = 0;
+
+    void rebuildMarkerCombos();
+
+    static constexpr int kMaxHistogramRows = 256;
+};
+
+#endif // SIGNALSTATSPANEL_H
@@ -0,0 +1,101 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFilterDialog.cpp
+// Description:   Dialog for the include / exclude / depth filter of VCD imports.
+//======================================================================
+
+#include "VcdFilterDialog.h"
+#include "io/VcdFilter.h"
+
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QLabel>
+#include <QDialogButtonBox>
+#include <QPushButton>
+
+VcdFilterDialog::VcdFilterDialog(const VcdImportOptions &options, QWidget *parent)
+    : QDialog(parent),
+      m_options(options),
+      m_includeEdit(new QLineEdit(this)),
+      m_excludeEdit(new QLineEdit(this)),
+      m_depthSpin(new QSpinBox(this)),
+      m_errorLabel(new QLabel(this))
+{
+    setWindowTitle(tr("VCD import filter"));
+    resize(520, 0);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QLabel *help = new QLabel(tr("Patterns separated by spaces: a scope or signal name (<tt>top.cpu</tt>, "
+                                 "takes everything below it), a glob (<tt>*.irq*</tt>) or a regular "
+                                 "expression between slashes (<tt>/^top\\.(cpu|dma)\\./</tt>). Signals left "
+                                 "out are skipped while parsing. Applies to the next VCD opened."), this);
+    help->setWordWrap(true);
+    layout->addWidget(help);
+
+    QFormLayout *form = new QFormLayout();
+    m_includeEdit->setText(options.include.join(' '));
+    m_includeEdit->setPlaceholderText(tr("everything"));
+    form->addRow(tr("Include:"), m_includeEdit);
+    m_excludeEdit->setText(options.exclude.join(' '));
+    m_excludeEdit->setPlaceholderText(tr("nothing"));
+    form->addRow(tr("Exclude:"), m_excludeEdit);
+    m_depthSpin->setRange(0, 64);
+    m_depthSpin->setSpecialValueText(tr("Any"));
+    m_depthSpin->setValue(options.maxScopeDepth);
+    m_depthSpin->setToolTip(tr("Number of scopes around a signal: top.cpu.clk is 2 deep"));
+    form->addRow(tr("Maximum scope depth:"), m_depthSpin);
+    layout->addLayout(form);
+
+    m_errorLabel->setStyleSheet("color: #b00020;");
+    m_errorLabel->hide();
+    layout->addWidget(m_errorLabel);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel
+                                                     | QDialogButtonBox::Reset, this);
+    connect(buttons, &QDialogButtonBox::accepted, this, &VcdFilterDialog::validateAndAccept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(buttons->button(QDialogButtonBox::Reset), &QPushButton::clicked, this, [this]()
+    {
+        m_includeEdit->clear();
+        m_excludeEdit->clear();
+        m_depthSpin->setValue(0);
+    });
+    layout->addWidget(buttons);
+}
+
+VcdImportOptions VcdFilterDialog::options() const
+{
+    VcdImportOptions options = m_options;
+    options.include = m_includeEdit->text().split(' ', Qt::SkipEmptyParts);
+    options.exclude = m_excludeEdit->text().split(' ', Qt::SkipEmptyParts);
+    options.maxScopeDepth = m_depthSpin->value();
+    return options;
+}
+
+void VcdFilterDialog::validateAndAccept()
+{
+    VcdSignalFilter filter;
+    QString error;
+    if (!VcdSignalFilter::compile(options(), &filter, &error))
+    {
+        m_errorLabel->setText(error);
+        m_errorLabel->show();
+        return;
+    }
+    accept();
+}
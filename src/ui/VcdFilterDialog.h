@@ -0,0 +1,51 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdFilterDialog.h
+// Description:   Dialog for the include / exclude / depth filter of VCD imports.
+//======================================================================
+
+#ifndef VCDFILTERDIALOG_H
+#define VCDFILTERDIALOG_H
+
+#include <QDialog>
+#include "io/VcdImporter.h"
+
+class QLineEdit;
+class QSpinBox;
+class QLabel;
+
+// File -> VCD import filter...: which signals the next VCD imports keep
+// (VcdImportOptions include / exclude / maxScopeDepth, see VcdSignalFilter)
+class VcdFilterDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit VcdFilterDialog(const VcdImportOptions &options, QWidget *parent = nullptr);
+
+    // The options given to the constructor with the filter chosen here
+    VcdImportOptions options() const;
+
+private slots:
+    void validateAndAccept();
+
+private:
+    VcdImportOptions m_options;
+    QLineEdit *m_includeEdit;
+    QLineEdit *m_excludeEdit;
+    QSpinBox  *m_depthSpin;
+    QLabel    *m_errorLabel;
+};
+
+#endif // VCDFILTERDIALOG_H
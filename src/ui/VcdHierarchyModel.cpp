@@ -0,0 +1,254 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdHierarchyModel.cpp
+// Description:   Lazy item models for the VCD scope hierarchy and its signals.
+//======================================================================
+
+#include "VcdHierarchyModel.h"
+#include "core/VcdLibrary.h"
+
+#include <algorithm>
+
+namespace {
+
+// Rows exposed per fetchMore(): enough to fill a view, cheap to create
+constexpr int kFetchBatch = 256;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// VcdScopeModel
+// ---------------------------------------------------------------------------
+
+VcdScopeModel::VcdScopeModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+void VcdScopeModel::setLibrary(const VcdLibraryPtr &lib)
+{
+    beginResetModel();
+    m_lib = lib;
+    m_fetched.assign(m_lib ? m_lib->scopeCount() : 0, 0);
+    endResetModel();
+}
+
+int VcdScopeModel::scopeOf(const QModelIndex &parent) const
+{
+    return parent.isValid() ? static_cast<int>(parent.internalId()) : VcdLibrary::kRootScope;
+}
+
+int VcdScopeModel::scopeId(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<int>(index.internalId()) : -1;
+}
+
+QModelIndex VcdScopeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (!m_lib || column != 0 || row < 0)
+        return QModelIndex();
+
+    const int parentId = scopeOf(parent);
+    if (row >= m_fetched[parentId])
+        return QModelIndex();
+
+    return createIndex(row, column, static_cast<quintptr>(m_lib->scope(parentId).children[row]));
+}
+
+QModelIndex VcdScopeModel::parent(const QModelIndex &child) const
+{
+    if (!m_lib || !child.isValid())
+        return QModelIndex();
+
+    const int parentId = m_lib->scope(static_cast<int>(child.internalId())).parent;
+    if (parentId <= VcdLibrary::kRootScope)
+        return QModelIndex();
+
+    return createIndex(m_lib->scope(parentId).row, 0, static_cast<quintptr>(parentId));
+}
+
+int VcdScopeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!m_lib || parent.column() > 0)
+        return 0;
+    return m_fetched[scopeOf(parent)];
+}
+
+int VcdScopeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool VcdScopeModel::hasChildren(const QModelIndex &parent) const
+{
+    // Lets the view draw the expand arrow before anything is fetched
+    if (!m_lib)
+        return false;
+    return !m_lib->scope(scopeOf(parent)).children.empty();
+}
+
+QVariant VcdScopeModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_lib || !index.isValid())
+        return QVariant();
+
+    const int id = static_cast<int>(index.internalId());
+    const VcdLibrary::Scope &sc = m_lib->scope(id);
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return sc.name;
+    case Qt::ToolTipRole:
+        return tr("%1\n%2 scopes, %3 signals")
+            .arg(m_lib->scopePath(id))
+            .arg(sc.children.size())
+            .arg(sc.signalIds.size());
+    default:
+        return QVariant();
+    }
+}
+
+QVariant VcdScopeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return tr("Hierarchy");
+    return QVariant();
+}
+
+bool VcdScopeModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!m_lib)
+        return false;
+    const int id = scopeOf(parent);
+    return m_fetched[id] < static_cast<int>(m_lib->scope(id).children.size());
+}
+
+void VcdScopeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!m_lib)
+        return;
+    const int id = scopeOf(parent);
+    const int total = static_cast<int>(m_lib->scope(id).children.size());
+    const int first = m_fetched[id];
+    const int last = std::min(total, first + kFetchBatch) - 1;
+    if (last < first)
+        return;
+
+    beginInsertRows(parent, first, last);
+    m_fetched[id] = last + 1;
+    endInsertRows();
+}
+
+// ---------------------------------------------------------------------------
+// VcdSignalListModel
+// ---------------------------------------------------------------------------
+
+VcdSignalListModel::VcdSignalListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void VcdSignalListModel::setScope(const VcdLibraryPtr &lib, int scopeId)
+{
+    beginResetModel();
+    m_lib = lib;
+    m_scopeId = (lib && scopeId >= 0 && scopeId < lib->scopeCount()) ? scopeId : -1;
+    m_fetched = 0;
+    m_showResults = false;
+    m_results.clear();
+    endResetModel();
+}
+
+void VcdSignalListModel::setResults(const VcdLibraryPtr &lib, std::vector<int> ids)
+{
+    beginResetModel();
+    m_lib = lib;
+    m_scopeId = -1;
+    m_fetched = 0;
+    m_showResults = (lib != nullptr);
+    m_results = lib ? std::move(ids) : std::vector<int>();
+    endResetModel();
+}
+
+const std::vector<int> &VcdSignalListModel::signalIds() const
+{
+    static const std::vector<int> none;
+    if (m_showResults)
+        return m_results;
+    return (m_lib && m_scopeId >= 0) ? m_lib->scope(m_scopeId).signalIds : none;
+}
+
+QString VcdSignalListModel::fullName(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_fetched)
+        return QString();
+    return m_lib->nameAt(signalIds()[index.row()]);
+}
+
+int VcdSignalListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+QVariant VcdSignalListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fetched)
+        return QVariant();
+
+    const int sigIdx = signalIds()[index.row()];
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        const QString name = m_showResults ? m_lib->nameAt(sigIdx) : m_lib->leafName(sigIdx);
+        const QString clock = m_lib->clockLabel(sigIdx);
+        return clock.isEmpty() ? name : tr("%1  [clock %2]").arg(name, clock);
+    }
+    case Qt::ToolTipRole:
+    {
+        const ClockInfo &info = m_lib->clockInfo(sigIdx);
+        if (!info.isClock)
+            return m_lib->nameAt(sigIdx);
+        return tr("%1\nClock %2, duty %3%, %4 cycles%5")
+            .arg(m_lib->nameAt(sigIdx), m_lib->clockLabel(sigIdx))
+            .arg(info.duty * 100.0, 0, 'f', 1)
+            .arg(info.cycles)
+            .arg(info.uniform ? QString() : tr(" (irregular in samples)"));
+    }
+    case Qt::UserRole:
+        return m_lib->nameAt(sigIdx);
+    default:
+        return QVariant();
+    }
+}
+
+bool VcdSignalListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < static_cast<int>(signalIds().size());
+}
+
+void VcdSignalListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    const int total = static_cast<int>(signalIds().size());
+    const int last = std::min(total, m_fetched + kFetchBatch) - 1;
+    if (last < m_fetched)
+        return;
+
+    beginInsertRows(QModelIndex(), m_fetched, last);
+    m_fetched = last + 1;
+    endInsertRows();
+}
@@ -0,0 +1,94 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          VcdHierarchyModel.h
+// Description:   Lazy item models for the VCD scope hierarchy and its signals.
+//======================================================================
+
+#ifndef VCDHIERARCHYMODEL_H
+#define VCDHIERARCHYMODEL_H
+
+#include <QAbstractItemModel>
+#include <QAbstractListModel>
+#include <vector>
+#include "core/core.h"
+
+// Lazy models over the scope trie of a VcdLibrary. Nothing is created per
+// scope or per signal up front: rows are exposed in batches through
+// canFetchMore()/fetchMore() as the views expand or scroll, so opening a
+// design with hundreds of thousands of scopes/nets is immediate.
+
+// Tree of scopes. internalId() of an index is its scope id.
+class VcdScopeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    explicit VcdScopeModel(QObject *parent = nullptr);
+
+    void setLibrary(const VcdLibraryPtr &lib);
+    VcdLibraryPtr library() const { return m_lib; }
+
+    int scopeId(const QModelIndex &index) const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    VcdLibraryPtr m_lib;
+    std::vector<int> m_fetched;   // per scope id: children already exposed
+
+    int scopeOf(const QModelIndex &parent) const;
+};
+
+// Signals declared directly in one scope, or the results of a name search
+class VcdSignalListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit VcdSignalListModel(QObject *parent = nullptr);
+
+    void setScope(const VcdLibraryPtr &lib, int scopeId);
+    void clear() { setScope(nullptr, -1); }
+
+    // Shows an explicit list of signal ids (ranked search results) by full name
+    void setResults(const VcdLibraryPtr &lib, std::vector<int> ids);
+
+    // Full hierarchical name of the signal at row
+    QString fullName(const QModelIndex &index) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+private:
+    VcdLibraryPtr m_lib;
+    int m_scopeId = -1;
+    int m_fetched = 0;
+    bool m_showResults = false;
+    std::vector<int> m_results;
+
+    const std::vector<int> &signalIds() const;
+};
+
+#endif // VCDHIERARCHYMODEL_H
@@ -0,0 +1,253 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          WaveDiffDialog.cpp
+// Description:   Dialog that compares the document with a reference run.
+//======================================================================
+
+#include "WaveDiffDialog.h"
+#include "WaveView.h"
+#include "io/VcdImporter.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QSettings>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+namespace {
+
+QTableWidgetItem *numberItem(const QString &text)
+{
+    QTableWidgetItem *it = new QTableWidgetItem(text);
+    it->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return it;
+}
+
+} // namespace
+
+WaveDiffDialog::WaveDiffDialog(WaveDocument *doc, WaveView *view, QWidget *parent)
+    : QDialog(parent),
+      m_doc(doc),
+      m_view(view),
+      m_fileEdit(new QLineEdit(this)),
+      m_compareButton(new QPushButton(tr("Compare"), this)),
+      m_highlightCheck(new QCheckBox(tr("Highlight in waveform"), this)),
+      m_statusLabel(new QLabel(this)),
+      m_table(new QTableWidget(this)),
+      m_watcher(new QFutureWatcher<Job>(this))
+{
+    setWindowTitle(tr("Compare waveforms"));
+    resize(600, 520);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *fileRow = new QHBoxLayout();
+    QPushButton *browseBtn = new QPushButton(tr("Browse..."), this);
+    m_fileEdit->setPlaceholderText(tr("Reference run (.vcd, .wp, .json)"));
+    m_fileEdit->setText(QSettings("WavePaint", "WavePaint").value("diff/lastFile").toString());
+    m_compareButton->setDefault(true);
+    fileRow->addWidget(new QLabel(tr("Compare with"), this));
+    fileRow->addWidget(m_fileEdit, 1);
+    fileRow->addWidget(browseBtn);
+    fileRow->addWidget(m_compareButton);
+    layout->addLayout(fileRow);
+
+    m_statusLabel->setWordWrap(true);
+    m_statusLabel->setText(tr("Signals are matched by their full name; VCD runs are compared in time"));
+    layout->addWidget(m_statusLabel);
+
+    m_table->setColumnCount(5);
+    m_table->setHorizontalHeaderLabels({tr("Signal"), tr("First mismatch"), tr("Intervals"),
+                                        tr("Length"), tr("Note")});
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    layout->addWidget(m_table, 1);
+
+    m_highlightCheck->setChecked(true);
+    layout->addWidget(m_highlightCheck);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton *showBtn = buttons->addButton(tr("Show signal"), QDialogButtonBox::ActionRole);
+    showBtn->setToolTip(tr("Add the selected signals to the waveform"));
+    connect(showBtn, &QPushButton::clicked, this, &WaveDiffDialog::showSelectedSignals);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    connect(browseBtn, &QPushButton::clicked, this, &WaveDiffDialog::browse);
+    connect(m_compareButton, &QPushButton::clicked, this, &WaveDiffDialog::compare);
+    connect(m_fileEdit, &QLineEdit::returnPressed, this, &WaveDiffDialog::compare);
+    connect(m_highlightCheck, &QCheckBox::toggled, this, &WaveDiffDialog::updateHighlights);
+    connect(m_watcher, &QFutureWatcher<Job>::finished, this, &WaveDiffDialog::onFinished);
+    connect(m_table, &QTableWidget::cellDoubleClicked, this, [this](int row, int)
+    {
+        if (!m_aligned || row < 0 || row >= static_cast<int>(m_job.result.differing.size()))
+            return;
+        const qint64 first = m_job.result.differing[row].firstMismatch();
+        emit mismatchActivated(m_job.a.sampleAt(first, m_job.result.timeAxis, m_job.result.unitA));
+    });
+}
+
+void WaveDiffDialog::browse()
+{
+    const QString fileName = QFileDialog::getOpenFileName(
+        this, tr("Reference waveform"), m_fileEdit->text(),
+        tr("Waveforms (*.vcd *.vcd.gz *.vcd.zst *.wp *.json);;All files (*)"));
+    if (!fileName.isEmpty())
+        m_fileEdit->setText(fileName);
+}
+
+void WaveDiffDialog::compare()
+{
+    if (m_watcher->isRunning())
+        return;
+
+    const QString fileName = m_fileEdit->text().trimmed();
+    if (fileName.isEmpty())
+    {
+        browse();
+        return;
+    }
+    QSettings("WavePaint", "WavePaint").setValue("diff/lastFile", fileName);
+
+    // Cheap snapshot of the current document on the GUI thread (rows share
+    // their buffers); its library is loaded, the reference too and both are
+    // compared on a worker
+    std::vector<Signal> visible = m_doc->signalList();
+    const int sampleCount = m_doc->sampleCount();
+    VcdLibraryPtr library = m_doc->vcdLibrary();
+
+    m_compareButton->setEnabled(false);
+    m_statusLabel->setText(tr("Loading %1...").arg(QFileInfo(fileName).fileName()));
+    m_watcher->setFuture(QtConcurrent::run([visible = std::move(visible), sampleCount, library = std::move(library), fileName]()
+    {
+        Job job;
+        job.documentSamples = sampleCount;
+        job.a = DiffSide::fromSnapshot(visible, sampleCount, library);
+
+        WaveDocument other;
+        VcdImportOptions options;
+        options.detectClocks = false;
+        if (WaveVcdImporter::isVcdFile(fileName))
+            job.loaded = other.loadFromVcd(fileName, options);
+        else if (WaveVcdImporter::isFstFile(fileName))
+            job.loaded = other.loadFromFst(fileName, options);
+        else
+            job.loaded = other.loadFromFile(fileName);
+        if (!job.loaded)
+            return job;
+
+        job.b = DiffSide::fromDocument(other);
+        job.result = diffWaveforms(job.a, job.b);
+        return job;
+    }));
+}
+
+QString WaveDiffDialog::positionText(qint64 pos) const
+{
+    if (!m_job.result.timeAxis)
+        return tr("sample %1").arg(pos);
+    return tr("t=%1 (sample %2)").arg(pos).arg(m_job.a.sampleAt(pos, true, m_job.result.unitA));
+}
+
+void WaveDiffDialog::onFinished()
+{
+    m_compareButton->setEnabled(true);
+    m_job = m_watcher->result();
+    m_aligned = (m_job.a.sampleCount == m_job.documentSamples);
+    if (!m_job.loaded)
+    {
+        m_statusLabel->setText(tr("Could not load %1").arg(m_fileEdit->text()));
+        clearResult();
+        return;
+    }
+
+    const WaveDiffResult &res = m_job.result;
+    const int total = static_cast<int>(res.differing.size());
+    const int rows = std::min(total, kMaxRows);
+    m_table->setRowCount(rows);
+    for (int r = 0; r < rows; ++r)
+    {
+        const SignalDiff &d = res.differing[r];
+        m_table->setItem(r, 0, new QTableWidgetItem(d.name));
+        m_table->setItem(r, 1, numberItem(positionText(d.firstMismatch())));
+        m_table->setItem(r, 2, numberItem(QString::number(static_cast<qint64>(d.mismatches.size()))));
+        m_table->setItem(r, 3, numberItem(QString::number(d.mismatchLength)));
+        m_table->setItem(r, 4, new QTableWidgetItem(d.typeMismatch ? tr("bit vs vector") : QString()));
+    }
+
+    QString text = (total == 0) ? tr("No differences in %1 matched signals").arg(res.matched)
+                                : tr("%1 of %2 matched signals differ, first at %3")
+                                      .arg(total).arg(res.matched).arg(positionText(res.firstMismatch()));
+    if (!res.onlyInA.isEmpty() || !res.onlyInB.isEmpty())
+        text += tr("; %1 only here, %2 only in the reference").arg(res.onlyInA.size()).arg(res.onlyInB.size());
+    if (res.endA != res.endB)
+        text += tr("; lengths differ (%1 vs %2), compared up to the shorter").arg(res.endA).arg(res.endB);
+    text += tr(" (%1 ms)").arg(res.elapsedNs / 1.0e6, 0, 'f', 1);
+    if (res.timescaleMismatch)
+        text += tr("\nThe timescales of the two dumps cannot be matched: compared sample by sample");
+    else if (res.unitA != res.unitB)
+        text += tr("\nTimes are in units of %1 s (the finer timescale)").arg(res.timescale, 0, 'g', 3);
+    if (!m_aligned)
+        text += tr("\nThe document was cut since import: highlights and navigation are off");
+    m_statusLabel->setText(text);
+
+    updateHighlights();
+}
+
+void WaveDiffDialog::clearResult()
+{
+    m_job = Job();
+    m_table->setRowCount(0);
+    m_view->setDiffHighlights({});
+}
+
+void WaveDiffDialog::updateHighlights()
+{
+    QHash<QString, std::vector<std::pair<int, int>>> ranges;
+    if (m_highlightCheck->isChecked() && m_aligned)
+    {
+        for (const SignalDiff &d : m_job.result.differing)
+            ranges.insert(d.name, mismatchSamples(d, m_job.a, m_job.result));
+    }
+    m_view->setDiffHighlights(ranges);
+}
+
+void WaveDiffDialog::showSelectedSignals()
+{
+    for (const QModelIndex &idx : m_table->selectionModel()->selectedRows())
+    {
+        if (idx.row() >= static_cast<int>(m_job.result.differing.size()))
+            continue;
+        const QString &name = m_job.result.differing[idx.row()].name;
+        const std::vector<Signal> &visible = m_doc->signalList();
+        const bool shown = std::any_of(visible.begin(), visible.end(),
+                                       [&](const Signal &s) { return s.name == name; });
+        if (!shown)
+            m_doc->addSignalFromVcd(name);
+    }
+}
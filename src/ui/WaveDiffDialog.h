@@ -0,0 +1,88 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          WaveDiffDialog.h
+// Description:   Dialog that compares the document with a reference run.
+//======================================================================
+
+#ifndef WAVEDIFFDIALOG_H
+#define WAVEDIFFDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QHash>
+#include <utility>
+#include <vector>
+#include "core/core.h"
+#include "core/WaveDiff.h"
+
+class WaveView;
+class QLineEdit;
+class QPushButton;
+class QCheckBox;
+class QLabel;
+class QTableWidget;
+
+// "Compare with...": loads a second document or VCD run off the GUI thread,
+// diffs it against the current one by signal name and lists the signals
+// that differ, earliest mismatch first. Mismatching regions are shaded in
+// the waveform rows with the same name.
+class WaveDiffDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    WaveDiffDialog(WaveDocument *doc, WaveView *view, QWidget *parent = nullptr);
+
+    // Drops the result and its highlights (the current document changed)
+    void clearResult();
+
+signals:
+    // A signal was double-clicked: move the cursor to its first mismatch
+    void mismatchActivated(int sample);
+
+private slots:
+    void browse();
+    void compare();
+    void onFinished();
+    void updateHighlights();
+    void showSelectedSignals();
+
+private:
+    struct Job
+    {
+        DiffSide a;
+        DiffSide b;
+        WaveDiffResult result;
+        bool loaded = false;
+        int documentSamples = 0;   // of the document when the compare started
+    };
+
+    WaveDocument *m_doc;
+    WaveView     *m_view;
+    QLineEdit    *m_fileEdit;
+    QPushButton  *m_compareButton;
+    QCheckBox    *m_highlightCheck;
+    QLabel       *m_statusLabel;
+    QTableWidget *m_table;
+    QFutureWatcher<Job> *m_watcher;
+
+    Job  m_job;
+    bool m_aligned = false;   // side A samples are the document samples
+
+    QString positionText(qint64 pos) const;
+
+    static constexpr int kMaxRows = 10000;
+};
+
+#endif // WAVEDIFFDIALOG_H
@@ -47,7 +47,14 @@
 #include <QWidget> 
 #include <QColor>
 #include <QSize>
+#include <QHash>
 #include "core/core.h"
+#include "core/Edges.h"
+#include "core/DerivedSignal.h"
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 class WaveView : public QWidget
 {
@@ -61,6 +68,25 @@ public:
     // Export the current content to PNG with the specified background
     bool exportToPng(const QString &fileName, const QColor &background);
 
+    // Signals selected in the names column (click, Ctrl+click to toggle)
+    const std::vector<int> &selectedSignals() const { return m_selectedSignals; }
+
+    // Time cursor (click on the time axis); -1 = not placed
+    int  cursorSample() const { return m_cursorSample; }
+    void setCursorSample(int sample);
+    int  sampleToX(int sample) const { return m_leftMargin + sample * m_cellWidth; }
+
+    // Moves the cursor to the closest edge of the selected signals after
+    // (forward) or before it. Starts from the first visible sample when no
+    // cursor is placed. Returns the new cursor sample, or -1 if none.
+    int jumpToEdge(bool forward, EdgeKind kind);
+
+signals:
+    // Emitted when edge navigation moves the cursor (the window scrolls to it)
+    void cursorMoved(int sample);
+    // The set of selected signal rows changed (click / Ctrl+click on a name)
+    void selectionChanged();
+
 public slots:
     // Activate cut mode: the user chooses two points and the range is cut
     void startCutMode();              // shortcut for setCutModeEnabled(true)
@@ -84,6 +110,13 @@ public slots:
     void zoomIn();
     void zoomOut();
 
+    // Performance HUD overlay (paint time, rows/samples, undo footprint)
+    void setHudEnabled(bool en);
+
+    // Waveform diff: sample ranges [start, end) shaded in the rows with
+    // that signal name, sorted and disjoint. An empty hash clears them.
+    void setDiffHighlights(const QHash<QString, std::vector<std::pair<int, int>>> &ranges);
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
@@ -92,6 +125,7 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void moveEvent(QMoveEvent *event) override;
 
 
 private slots:
@@ -166,6 +200,31 @@ private:
     int  m_blockPasteSignal        = -1;  // signal top
     int  m_blockPasteSample        = -1;  // sample de inicio
 
+    // Signal selection and time cursor (edge navigation)
+    std::vector<int> m_selectedSignals;
+    int m_cursorSample = -1;
+
+    QHash<QString, std::vector<std::pair<int, int>>> m_diffRanges;
+    void drawDiffHighlights(QPainter &p, const Signal &sig, int index);
+
+    int  firstVisibleSample() const;
+    bool isSignalSelected(int index) const;
+    void remapSelectionOnMove(int from, int to);
+
+    // Performance HUD
+    static constexpr int kHudPaintHistory = 120;
+    bool m_hudEnabled = false;
+    std::vector<qint64> m_paintTimesNs;   // ring buffer of recent paint times
+    int    m_paintTimesNext = 0;
+    qint64 m_lastPaintNs = 0;
+    int    m_statRowsDrawn = 0;
+    qint64 m_statSamplesDrawn = 0;
+    qint64 m_statCacheLookups = 0;        // filled by render caches, if any
+    qint64 m_statCacheHits = 0;
+
+    void recordPaintTime(qint64 ns);
+    void drawHud(QPainter &p);
+
     // Helpers
     bool normalizedBlockSelection(int &topSignal, int &bottomSignal,
                                   int &startSample, int &endSample) const;
@@ -175,15 +234,30 @@ private:
     bool mapToSignalSample(const QPoint &pos, int &signalIndex, int &sampleIndex) const;
     int mapToSignalIndexFromY(int y) const;
 
+    // Samples [m_paintFirstSample, m_paintEndSample) intersect the area being painted
+    int m_paintFirstSample = 0;
+    int m_paintEndSample = 0;
+
+    // Derived signals: runs evaluated per tile of samples. The tile size
+    // follows the zoom, so the key carries it; cleared on every document change.
+    using DerivedTileKey = std::tuple<const SignalExpr *, int, int>;   // expr, tile, tileSamples
+    static constexpr size_t kMaxDerivedTiles = 4096;
+    std::map<DerivedTileKey, std::vector<ValueRun>> m_derivedTiles;
+    SignalExpr::Resolver m_derivedResolver;
+    const std::vector<ValueRun> &derivedTile(const Signal &sig, int tile, int tileSamples);
+
     void drawSignal(QPainter &p, const Signal &sig, int index);
-    void drawBitSignal(QPainter &p, const Signal &sig, int index);
-    void drawVectorSignal(QPainter &p, const Signal &sig, int index);
+    // [t0, t1) is the sample range to draw; sig.valueAt(t - base) is sample t
+    void drawBitSignal(QPainter &p, const Signal &sig, int index, int t0, int t1, int base = 0);
+    void drawVectorSignal(QPainter &p, const Signal &sig, int index, int t0, int t1, int base = 0);
+    void drawDerivedSignal(QPainter &p, const Signal &sig, int index);
     void drawVectorSelection(QPainter &p);
 
 
     void addBitSignal();
     void addVectorSignal();
     void addClockSignal();
+    void addDerivedSignal();
 };
 
 #endif // WAVEVIEW_H
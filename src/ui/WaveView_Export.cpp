@@ -44,7 +44,9 @@
 //======================================================================
 #include <QPainterPath>
 #include <cmath>
+#include <algorithm>
 #include "WaveView.h"
+#include "utils/Trace.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
@@ -59,6 +61,7 @@
 
 bool WaveView::exportToPng(const QString &fileName, const QColor &background)
 {
+    WP_TRACE_SCOPE("io", "WaveView::exportToPng");
     if (!m_doc)
         return false;
     if (fileName.isEmpty())
@@ -114,6 +117,20 @@ bool WaveView::exportToPng(const QString &fileName, const QColor &background)
 
 void WaveView::onDocumentChanged()
 {
-    updateGeometry();
+    WP_TRACE_SCOPE("ui", "WaveView::onDocumentChanged");
+
+    // Drop selection/cursor that no longer exist (signals removed, cut, ...)
+    const int sigCount = static_cast<int>(m_doc->signalList().size());
+    m_selectedSignals.erase(std::remove_if(m_selectedSignals.begin(), m_selectedSignals.end(),
+                                           [sigCount](int i) { return i >= sigCount; }),
+                            m_selectedSignals.end());
+    if (m_cursorSample >= m_doc->sampleCount())
+        m_cursorSample = -1;
+    m_derivedTiles.clear();
+    m_derivedResolver = nullptr;
+    {
+        WP_TRACE_SCOPE("ui", "WaveView::updateGeometry");
+        updateGeometry();
+    }
     update();
 }
\ No newline at end of file
@@ -44,6 +44,7 @@
 //======================================================================
 #include <QPainterPath>
 #include <cmath>
+#include <algorithm>
 #include "WaveView.h"
 #include <QPainter>
 #include <QMouseEvent>
@@ -105,12 +106,35 @@ void WaveView::mousePressEvent(QMouseEvent *event)
             int idx = mapToSignalIndexFromY(event->pos().y());
             if (idx >= 0)
             {
+                // Seleccion para la navegacion por flancos (Ctrl = añadir/quitar)
+                if (event->modifiers() & Qt::ControlModifier)
+                {
+                    auto it = std::find(m_selectedSignals.begin(), m_selectedSignals.end(), idx);
+                    if (it != m_selectedSignals.end())
+                        m_selectedSignals.erase(it);
+                    else
+                        m_selectedSignals.push_back(idx);
+                }
+                else
+                {
+                    m_selectedSignals.assign(1, idx);
+                }
+                update();
+                emit selectionChanged();
+
                 m_isMovingSignal = true;
                 m_moveSignalIndex = idx;
                 setCursor(Qt::ClosedHandCursor);
                 return; // no seguimos con pintura ni nada más
             }
         }
+
+        // Click sobre el eje de tiempo -> colocar el cursor
+        if (event->pos().y() < m_topMargin && event->pos().x() >= m_leftMargin)
+        {
+            setCursorSample((event->pos().x() - m_leftMargin) / m_cellWidth);
+            return;
+        }
         // 2) Modo borrar flecha (ArrowDelete):
         //    un clic cerca de una flecha borra SOLO esa flecha
         if (m_mode == Mode::ArrowSub)
@@ -430,6 +454,7 @@ void WaveView::mouseMoveEvent(QMouseEvent *event)
         {
 
             m_doc->moveSignal(m_moveSignalIndex, newIdx);
+            remapSelectionOnMove(m_moveSignalIndex, newIdx);
             m_moveSignalIndex = newIdx;
         }
         return;
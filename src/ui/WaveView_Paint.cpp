@@ -45,6 +45,7 @@
 #include <QPainterPath>
 #include <cmath>
 #include "WaveView.h"
+#include "utils/Trace.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
@@ -56,10 +57,22 @@
 #include <QMessageBox>
 #include <QCursor>
 #include <QKeyEvent>
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QStringList>
+#include <algorithm>
+#include "utils/FormatUtils.h"
 
 void WaveView::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    WP_TRACE_SCOPE("paint", "WaveView::paintEvent");
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+    m_statRowsDrawn = 0;
+    m_statSamplesDrawn = 0;
+    m_statCacheLookups = 0;
+    m_statCacheHits = 0;
+
     QPainter p(this);
 
     p.setRenderHint(QPainter::Antialiasing, true);
@@ -78,6 +91,16 @@ void WaveView::paintEvent(QPaintEvent *event)
     const auto &sigs = m_doc->signalList();
     int sampleCount = m_doc->sampleCount();
 
+    // Samples under the exposed area (one extra on each side for transitions)
+    m_paintFirstSample = 0;
+    m_paintEndSample = sampleCount;
+    if (!m_exportSize.isValid() && m_cellWidth > 0)
+    {
+        const QRect r = event->rect();
+        m_paintFirstSample = std::max(0, (r.left() - m_leftMargin) / m_cellWidth - 1);
+        m_paintEndSample = std::min(sampleCount, (r.right() - m_leftMargin) / m_cellWidth + 2);
+    }
+
     // Text color for axes depending on background
     int lumBg = qRound(0.299 * bg.red() + 0.587 * bg.green() + 0.114 * bg.blue());
     QColor axisColor = (lumBg < 128) ? Qt::white : Qt::black;
@@ -100,6 +123,7 @@ void WaveView::paintEvent(QPaintEvent *event)
     if (sampleCount > 20000)
         labelStep = 100;
 
+    const qint64 axisStartNs = Tracer::isEnabled() ? Tracer::nowNs() : -1;
     for (int t = 0; t < sampleCount; t += labelStep)
     {
         int x = m_leftMargin + t * m_cellWidth;
@@ -125,12 +149,17 @@ void WaveView::paintEvent(QPaintEvent *event)
         int x = m_leftMargin + t * m_cellWidth;
         p.drawLine(x, m_topMargin, x, h);
     }
+    if (axisStartNs >= 0)
+        Tracer::record("paint", "WaveView::paintAxisAndGrid", axisStartNs, Tracer::nowNs());
 
     // Draw signals
-    p.setPen(axisColor);
-    for (int i = 0; i < static_cast<int>(sigs.size()); ++i)
     {
-        drawSignal(p, sigs[i], i);
+        WP_TRACE_SCOPE("paint", "WaveView::paintSignals");
+        p.setPen(axisColor);
+        for (int i = 0; i < static_cast<int>(sigs.size()); ++i)
+        {
+            drawSignal(p, sigs[i], i);
+        }
     }
 
     // Draw vector selection (if any)
@@ -170,6 +199,7 @@ void WaveView::paintEvent(QPaintEvent *event)
     const auto &markers = m_doc->markerList();
     if (!markers.empty())
     {
+        WP_TRACE_SCOPE("paint", "WaveView::paintMarkers");
         QPen markerPen(Qt::yellow);
         markerPen.setWidth(2);
         p.setPen(markerPen);
@@ -217,10 +247,20 @@ void WaveView::paintEvent(QPaintEvent *event)
 
         p.setFont(oldFont);
     }
+    // --- Cursor de tiempo (navegacion por flancos) ---
+    if (m_cursorSample >= 0 && m_cursorSample < sampleCount && !m_exportSize.isValid())
+    {
+        QPen cursorPen(QColor(0, 170, 255));
+        cursorPen.setWidth(2);
+        p.setPen(cursorPen);
+        int x = m_leftMargin + m_cursorSample * m_cellWidth;
+        p.drawLine(x, m_topMargin - 4, x, h - 1);
+    }
     // --- Flechas existentes ---
     const auto &arrows = m_doc->arrowList();
     if (!arrows.empty())
     {
+        WP_TRACE_SCOPE("paint", "WaveView::paintArrows");
         QPen arrowPen(Qt::red);
         arrowPen.setWidth(2);
         arrowPen.setCapStyle(Qt::RoundCap);
@@ -341,6 +381,7 @@ void WaveView::paintEvent(QPaintEvent *event)
         m_blockPastePreviewActive &&
         m_doc && m_doc->hasBlockClipboard())
     {
+        WP_TRACE_SCOPE("paint", "WaveView::paintPastePreview");
 
         const auto &sigs = m_doc->signalList();
         int sigCount = static_cast<int>(sigs.size());
@@ -403,7 +444,6 @@ void WaveView::paintEvent(QPaintEvent *event)
                                        ? colors2D[r]
                                        : QColor(Qt::blue);
 
-                const auto &rowVals = vals2D[r];
                 const auto &rowLabs = (r < (int)labs2D.size()) ? labs2D[r]
                                                                : std::vector<QString>();
 
@@ -425,11 +465,11 @@ void WaveView::paintEvent(QPaintEvent *event)
                     bool havePrev = false;
                     int prevY = lowY;
 
-                    int cols = std::min(clipCols, (int)rowVals.size());
+                    int cols = std::min(clipCols, m_doc->blockClipboardSampleCount());
 
                     for (int c = 0; c < cols; ++c)
                     {
-                        int v = rowVals[c];
+                        int v = m_doc->blockClipboardValue(r, c);
                         if (v != 0 && v != 1)
                         {
                             havePrev = false;
@@ -475,11 +515,11 @@ void WaveView::paintEvent(QPaintEvent *event)
                     int barTop = rowTop + (int)(m_rowHeight * 0.25);
                     int barHeight = (int)(m_rowHeight * 0.5);
 
-                    int cols = std::min(clipCols, (int)rowVals.size());
+                    int cols = std::min(clipCols, m_doc->blockClipboardSampleCount());
                     int c = 0;
                     while (c < cols)
                     {
-                        int v = rowVals[c];
+                        int v = m_doc->blockClipboardValue(r, c);
                         if (v == UNDEFINED_VALUE)
                         {
                             ++c;
@@ -490,7 +530,7 @@ void WaveView::paintEvent(QPaintEvent *event)
                         int endC = c;
                         for (int k = c + 1; k < cols; ++k)
                         {
-                            if (rowVals[k] != v)
+                            if (m_doc->blockClipboardValue(r, k) != v)
                                 break;
                             endC = k;
                         }
@@ -537,6 +577,91 @@ void WaveView::paintEvent(QPaintEvent *event)
             }
         }
     }
+
+    // HUD de rendimiento (nunca en la exportación a PNG)
+    if (m_hudEnabled && !m_exportSize.isValid())
+    {
+        recordPaintTime(paintTimer.nsecsElapsed());
+        drawHud(p);
+    }
+}
+
+void WaveView::recordPaintTime(qint64 ns)
+{
+    if (static_cast<int>(m_paintTimesNs.size()) < kHudPaintHistory)
+    {
+        m_paintTimesNs.push_back(ns);
+    }
+    else
+    {
+        m_paintTimesNs[m_paintTimesNext] = ns;
+    }
+    m_paintTimesNext = (m_paintTimesNext + 1) % kHudPaintHistory;
+    m_lastPaintNs = ns;
+}
+
+void WaveView::drawHud(QPainter &p)
+{
+    // p95 over the last kHudPaintHistory frames
+    qint64 p95Ns = 0;
+    if (!m_paintTimesNs.empty())
+    {
+        std::vector<qint64> sorted = m_paintTimesNs;
+        size_t k = (sorted.size() * 95) / 100;
+        if (k >= sorted.size())
+            k = sorted.size() - 1;
+        std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+        p95Ns = sorted[k];
+    }
+
+    auto ms = [](qint64 ns) { return QString::number(ns / 1.0e6, 'f', 2); };
+
+    QStringList lines;
+    lines << QString("paint  %1 ms  (p95 %2 ms)").arg(ms(m_lastPaintNs), ms(p95Ns));
+    lines << QString("rows   %1   samples %2").arg(m_statRowsDrawn).arg(m_statSamplesDrawn);
+    if (m_statCacheLookups > 0)
+        lines << QString("cache  %1 %").arg(100.0 * m_statCacheHits / m_statCacheLookups, 0, 'f', 1);
+    else
+        lines << QString("cache  n/a");
+    if (m_doc)
+    {
+        lines << QString("undo   %1 steps, %2  (redo %3)")
+                     .arg(m_doc->undoDepth())
+                     .arg(formatBytes(m_doc->undoHistoryBytes()))
+                     .arg(m_doc->redoDepth());
+        lines << QString("edit   %1 ms").arg(ms(m_doc->lastMutationNs()));
+    }
+
+    p.save();
+    QFont f = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    p.setFont(f);
+    QFontMetrics fm(f);
+
+    int boxW = 0;
+    for (const QString &l : lines)
+        boxW = std::max(boxW, fm.horizontalAdvance(l));
+    boxW += 16;
+    int boxH = static_cast<int>(lines.size()) * fm.height() + 12;
+
+    // Esquina superior derecha de la parte visible (la vista vive en un QScrollArea)
+    QRect vis = visibleRegion().boundingRect();
+    if (vis.isEmpty())
+        vis = rect();
+    QRect box(vis.right() - boxW - 8, vis.top() + 8, boxW, boxH);
+
+    p.setRenderHint(QPainter::Antialiasing, false);
+    p.setPen(QColor(255, 255, 255, 60));
+    p.setBrush(QColor(0, 0, 0, 180));
+    p.drawRect(box);
+
+    p.setPen(QColor(120, 255, 120));
+    int y = box.top() + 6 + fm.ascent();
+    for (const QString &l : lines)
+    {
+        p.drawText(box.left() + 8, y, l);
+        y += fm.height();
+    }
+    p.restore();
 }
 
 void WaveView::drawSignal(QPainter &p, const Signal &sig, int index)
@@ -546,7 +671,16 @@ void WaveView::drawSignal(QPainter &p, const Signal &sig, int index)
 
     // Signal name on the left
     QRect nameRect(0, top, m_leftMargin - 5, m_rowHeight);
+    ++m_statRowsDrawn;
+    if (!sig.isDerived())
+        m_statSamplesDrawn += m_doc->sampleCount();
     p.save();
+    if (!m_exportSize.isValid() && isSignalSelected(index))
+    {
+        QColor hl = palette().highlight().color();
+        hl.setAlpha(60);
+        p.fillRect(nameRect, hl);
+    }
     // Text color according to background (for export with black background, etc.)
     QColor bg = m_exportBackground.isValid() ? m_exportBackground : palette().base().color();
     int lumBg = qRound(0.299 * bg.red() + 0.587 * bg.green() + 0.114 * bg.blue());
@@ -561,22 +695,148 @@ void WaveView::drawSignal(QPainter &p, const Signal &sig, int index)
     p.setPen(QColor(200, 200, 200));
     p.drawLine(0, bottom, width(), bottom);
 
-    if (sig.values.empty())
+    drawDiffHighlights(p, sig, index);
+
+    if (sig.isDerived())
+    {
+        drawDerivedSignal(p, sig, index);
+        return;
+    }
+
+    if (sig.sampleCount() == 0)
         return;
 
     if (sig.type == SignalType::Bit)
     {
-        drawBitSignal(p, sig, index);
+        drawBitSignal(p, sig, index, 0, m_doc->sampleCount());
     }
     else
     {
-        drawVectorSignal(p, sig, index);
+        drawVectorSignal(p, sig, index, 0, m_doc->sampleCount());
     }
 }
 
-void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index)
+void WaveView::drawDiffHighlights(QPainter &p, const Signal &sig, int index)
+{
+    if (m_diffRanges.isEmpty() || m_exportSize.isValid())
+        return;
+    const auto it = m_diffRanges.constFind(sig.name);
+    if (it == m_diffRanges.constEnd())
+        return;
+
+    // Only the ranges that reach the painted samples
+    const std::vector<std::pair<int, int>> &ranges = it.value();
+    auto r = std::lower_bound(ranges.begin(), ranges.end(), m_paintFirstSample,
+                              [](const std::pair<int, int> &range, int sample) { return range.second <= sample; });
+
+    const int top = m_topMargin + index * m_rowHeight;
+    const QColor shade(220, 40, 40, 70);
+    for (; r != ranges.end() && r->first < m_paintEndSample; ++r)
+    {
+        const int x1 = sampleToX(r->first);
+        const int x2 = sampleToX(r->second);
+        p.fillRect(QRect(x1, top, std::max(x2 - x1, 2), m_rowHeight - 1), shade);
+    }
+}
+
+const std::vector<ValueRun> &WaveView::derivedTile(const Signal &sig, int tile, int tileSamples)
+{
+    ++m_statCacheLookups;
+    const DerivedTileKey key(sig.expr.get(), tile, tileSamples);
+    auto it = m_derivedTiles.find(key);
+    if (it != m_derivedTiles.end())
+    {
+        ++m_statCacheHits;
+        return it->second;
+    }
+
+    if (m_derivedTiles.size() >= kMaxDerivedTiles)
+        m_derivedTiles.clear();
+    if (!m_derivedResolver)
+        m_derivedResolver = m_doc->signalResolver();
+
+    const int t0 = tile * tileSamples;
+    const int t1 = std::min(m_doc->sampleCount(), t0 + tileSamples);
+    return m_derivedTiles.emplace(key, signalRuns(sig, t0, t1, m_derivedResolver)).first->second;
+}
+
+void WaveView::drawDerivedSignal(QPainter &p, const Signal &sig, int index)
+{
+    WP_TRACE_SCOPE("paint", "WaveView::drawDerivedSignal");
+    const int sampleCount = m_doc->sampleCount();
+    if (sampleCount <= 0 || m_paintEndSample <= m_paintFirstSample)
+        return;
+
+    // About 1024 px per tile whatever the zoom
+    const int tileSamples = std::max(64, 1024 / std::max(1, m_cellWidth));
+    const int maxTile = (sampleCount - 1) / tileSamples;
+    int firstTile = m_paintFirstSample / tileSamples;
+    int lastTile = (m_paintEndSample - 1) / tileSamples;
+
+    std::vector<ValueRun> runs;
+    auto append = [&runs](const std::vector<ValueRun> &tileRuns)
+    {
+        for (const ValueRun &r : tileRuns)
+            if (runs.empty() || runs.back().value != r.value)
+                runs.push_back(r);
+    };
+    for (int tile = firstTile; tile <= lastTile; ++tile)
+        append(derivedTile(sig, tile, tileSamples));
+
+    // Grow the edge runs to their real extent (bounded) so a bar and its
+    // label look the same whichever strip of the view gets repainted
+    constexpr int kMaxExtraTiles = 64;
+    for (int k = 0; k < kMaxExtraTiles && firstTile > 0 && runs.front().start == firstTile * tileSamples; ++k)
+    {
+        std::vector<ValueRun> before = derivedTile(sig, --firstTile, tileSamples);
+        const bool continues = before.back().value == runs.front().value;
+        if (continues)
+        {
+            runs.front().start = before.back().start;
+            before.pop_back();
+        }
+        runs.insert(runs.begin(), before.begin(), before.end());
+        if (!continues)
+            break;
+    }
+    for (int k = 0; k < kMaxExtraTiles && lastTile < maxTile; ++k)
+    {
+        const std::vector<ValueRun> &after = derivedTile(sig, ++lastTile, tileSamples);
+        const bool continues = after.front().value == runs.back().value;
+        append(after);
+        if (!continues || after.size() > 1)
+            break;
+    }
+
+    // Expand into a window-sized temporary signal and reuse the normal painters
+    const int t0 = firstTile * tileSamples;
+    const int t1 = std::min(sampleCount, (lastTile + 1) * tileSamples);
+    Signal window(sig.name, sig.type, t1 - t0);
+    window.color = sig.color;
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+        const int start = std::max(t0, runs[r].start);
+        const int end = (r + 1 < runs.size()) ? runs[r + 1].start : t1;
+        if (window.isPacked())
+        {
+            window.bits.fill(start - t0, end - t0, runs[r].value);
+            continue;
+        }
+        std::vector<int> &vals = window.values.mut();
+        std::fill(vals.begin() + (start - t0), vals.begin() + (end - t0), runs[r].value);
+        if (runs[r].value != UNDEFINED_VALUE)
+            window.labels.mut()[start - t0] = "0x" + QString::number(runs[r].value, 16).toUpper();
+    }
+    m_statSamplesDrawn += t1 - t0;
+
+    if (sig.type == SignalType::Bit)
+        drawBitSignal(p, window, index, t0, t1, t0);
+    else
+        drawVectorSignal(p, window, index, t0, t1, t0);
+}
+
+void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index, int t0, int t1, int base)
 {
-    int sampleCount = m_doc->sampleCount();
     int top = m_topMargin + index * m_rowHeight;
 
     // Wave levels
@@ -594,11 +854,11 @@ void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index)
     grad.setColorAt(0.0, cTop);
     grad.setColorAt(1.0, cBottom);
 
-    const auto &vals = sig.values;
+    auto valueAt = [&sig, base](int t) { return sig.valueAt(t - base); };
     int runStart = -1;
-    for (int t = 0; t < sampleCount; ++t)
+    for (int t = t0; t < t1; ++t)
     {
-        int v = (t < static_cast<int>(vals.size())) ? vals[t] : UNDEFINED_VALUE;
+        int v = valueAt(t);
         if (v == 1)
         {
             if (runStart < 0)
@@ -622,7 +882,7 @@ void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index)
     if (runStart >= 0)
     {
         int x1 = m_leftMargin + runStart * m_cellWidth;
-        int x2 = m_leftMargin + sampleCount * m_cellWidth;
+        int x2 = m_leftMargin + t1 * m_cellWidth;
         if (x2 > x1)
         {
             QRect gradRect(x1, highY, x2 - x1, lowY - highY);
@@ -638,9 +898,9 @@ void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index)
     bool havePrev = false;
     int prevY = lowY;
 
-    for (int t = 0; t < sampleCount; ++t)
+    for (int t = t0; t < t1; ++t)
     {
-        int v = (t < static_cast<int>(vals.size())) ? vals[t] : UNDEFINED_VALUE;
+        int v = valueAt(t);
 
         // If the value is undefined, cut the stroke and draw nothing for this sample.
         if (v != 0 && v != 1)
@@ -676,12 +936,11 @@ void WaveView::drawBitSignal(QPainter &p, const Signal &sig, int index)
     p.restore();
 }
 
-void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index)
+void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index, int t0, int t1, int base)
 {
     if (!m_doc)
         return;
 
-    int sampleCount = m_doc->sampleCount();
     int top = m_topMargin + index * m_rowHeight;
 
     int barTop = top + static_cast<int>(m_rowHeight * 0.25);
@@ -696,15 +955,18 @@ void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index)
     pen.setWidth(2);
     p.setPen(pen);
 
-    const auto &vals = sig.values;
     const auto &labs = sig.labels;
+    auto valueAt = [&sig, base](int t) { return sig.valueAt(t - base); };
+    // Annotation rows mark where each item starts, so back-to-back equal
+    // values (two identical decoded bytes) stay apart
+    auto itemStarts = [&sig, base](int t) { return sig.startsItem(t - base); };
 
     int triW = std::min(8, std::max(4, m_cellWidth / 3));
 
-    int t = 0;
-    while (t < sampleCount)
+    int t = t0;
+    while (t < t1)
     {
-        int v = (t < static_cast<int>(vals.size())) ? vals[t] : UNDEFINED_VALUE;
+        int v = valueAt(t);
         if (v == UNDEFINED_VALUE)
         {
             ++t;
@@ -714,10 +976,10 @@ void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index)
         // Group segment of consecutive samples with the same value
         int start = t;
         int end = t;
-        for (int k = t + 1; k < sampleCount; ++k)
+        for (int k = t + 1; k < t1; ++k)
         {
-            int vk = (k < static_cast<int>(vals.size())) ? vals[k] : UNDEFINED_VALUE;
-            if (vk != v)
+            int vk = valueAt(k);
+            if (vk != v || itemStarts(k))
                 break;
             end = k;
         }
@@ -725,18 +987,18 @@ void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index)
         // Check if there will be a peak to the left/right
         int prevIndex = start - 1;
         bool hasLeftPeak = false;
-        if (prevIndex >= 0)
+        if (prevIndex >= t0)
         {
-            int prevV = (prevIndex < static_cast<int>(vals.size())) ? vals[prevIndex] : UNDEFINED_VALUE;
-            hasLeftPeak = (prevV != UNDEFINED_VALUE && prevV != v);
+            int prevV = valueAt(prevIndex);
+            hasLeftPeak = (prevV != UNDEFINED_VALUE && (prevV != v || itemStarts(start)));
         }
 
         int nextIndex = end + 1;
         bool hasRightPeak = false;
-        if (nextIndex < sampleCount)
+        if (nextIndex < t1)
         {
-            int nextV = (nextIndex < static_cast<int>(vals.size())) ? vals[nextIndex] : UNDEFINED_VALUE;
-            hasRightPeak = (nextV != UNDEFINED_VALUE && nextV != v);
+            int nextV = valueAt(nextIndex);
+            hasRightPeak = (nextV != UNDEFINED_VALUE && (nextV != v || itemStarts(nextIndex)));
         }
 
         // Total edges of the segment
@@ -781,8 +1043,8 @@ void WaveView::drawVectorSignal(QPainter &p, const Signal &sig, int index)
 
         // Text: label + value (if label exists)
         QString label;
-        if (start < static_cast<int>(labs.size()))
-            label = labs[start];
+        if (start - base >= 0 && start - base < static_cast<int>(labs.size()))
+            label = labs[start - base];
 
         QString text;
         if (label.isEmpty())
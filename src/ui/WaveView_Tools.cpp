@@ -43,7 +43,9 @@
 //======================================================================
 #include <QPainterPath>
 #include <cmath>
+#include <algorithm>
 #include "WaveView.h"
+#include "utils/Trace.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
@@ -55,6 +57,7 @@
 #include <QMessageBox>
 #include <QCursor>
 #include <QKeyEvent>
+#include <QMoveEvent>
 
 
 
@@ -119,6 +122,106 @@ void WaveView::zoomOut()
     update();
 }
 
+void WaveView::setHudEnabled(bool en)
+{
+    m_hudEnabled = en;
+    m_paintTimesNs.clear();
+    m_paintTimesNext = 0;
+    m_lastPaintNs = 0;
+    update();
+}
+
+void WaveView::setDiffHighlights(const QHash<QString, std::vector<std::pair<int, int>>> &ranges)
+{
+    m_diffRanges = ranges;
+    update();
+}
+
+void WaveView::moveEvent(QMoveEvent *event)
+{
+    QWidget::moveEvent(event);
+    // El scroll copia píxeles ya pintados: sin repintar, el HUD se quedaría
+    // "pegado" en la posición anterior
+    if (m_hudEnabled)
+        update();
+}
+
+void WaveView::setCursorSample(int sample)
+{
+    if (!m_doc)
+        return;
+    if (sample >= m_doc->sampleCount())
+        sample = m_doc->sampleCount() - 1;
+    if (sample < 0)
+        sample = -1;
+    if (sample == m_cursorSample)
+        return;
+
+    m_cursorSample = sample;
+    update();
+}
+
+int WaveView::firstVisibleSample() const
+{
+    QRect vis = visibleRegion().boundingRect();
+    if (vis.isEmpty() || vis.left() <= m_leftMargin)
+        return 0;
+    return (vis.left() - m_leftMargin) / m_cellWidth;
+}
+
+bool WaveView::isSignalSelected(int index) const
+{
+    return std::find(m_selectedSignals.begin(), m_selectedSignals.end(), index)
+           != m_selectedSignals.end();
+}
+
+void WaveView::remapSelectionOnMove(int from, int to)
+{
+    // Mismo desplazamiento que WaveDocument::moveSignal aplica a las filas
+    for (int &idx : m_selectedSignals)
+    {
+        if (idx == from)
+            idx = to;
+        else if (from < to && idx > from && idx <= to)
+            --idx;
+        else if (from > to && idx >= to && idx < from)
+            ++idx;
+    }
+}
+
+int WaveView::jumpToEdge(bool forward, EdgeKind kind)
+{
+    WP_TRACE_SCOPE("ui", "WaveView::jumpToEdge");
+    if (!m_doc || m_selectedSignals.empty())
+        return -1;
+
+    int from = m_cursorSample;
+    if (from < 0)
+        from = forward ? firstVisibleSample() - 1 : firstVisibleSample();
+
+    // Closest edge over all selected signals: one binary search each
+    const auto &sigs = m_doc->signalList();
+    int best = -1;
+    for (int idx : m_selectedSignals)
+    {
+        if (idx < 0 || idx >= static_cast<int>(sigs.size()))
+            continue;
+        int e = forward ? nextEdge(sigs[idx], from, kind)
+                        : prevEdge(sigs[idx], from, kind);
+        if (e < 0)
+            continue;
+        if (best < 0 || (forward ? e < best : e > best))
+            best = e;
+    }
+
+    if (best >= 0)
+    {
+        setCursorSample(best);
+        emit cursorMoved(best);
+    }
+    return best;
+}
+
 
 
 
@@ -311,8 +414,9 @@ void WaveView::contextMenuEvent(QContextMenuEvent *event)
                     QLineEdit::Normal,
                     currentName,
                     &ok);
-                if (ok && !newName.isEmpty())
-                    m_doc->renameSignal(sigIdx, newName);
+                if (ok && !newName.isEmpty() && !m_doc->renameSignal(sigIdx, newName))
+                    QMessageBox::warning(this, tr("Rename signal"),
+                                         tr("A derived signal would refer to itself through '%1'.").arg(newName));
             }
 
             // Change color
@@ -351,6 +455,7 @@ void WaveView::contextMenuEvent(QContextMenuEvent *event)
     QAction *addBitAct = menu.addAction(tr("Add bit signal"));
     QAction *addVectorAct = menu.addAction(tr("Add vector signal"));
     QAction *addClockAct = menu.addAction(tr("Add clock signal"));
+    QAction *addDerivedAct = menu.addAction(tr("Add derived signal..."));
 
     menu.addSeparator();
     QAction *cancelAct = menu.addAction(tr("Cancel"));
@@ -372,6 +477,10 @@ void WaveView::contextMenuEvent(QContextMenuEvent *event)
     {
         addClockSignal();
     }
+    else if (chosen == addDerivedAct)
+    {
+        addDerivedSignal();
+    }
 }
 
 void WaveView::addBitSignal()
@@ -427,6 +536,26 @@ void WaveView::addClockSignal()
 
     m_doc->addClockSignal(name, pulses, highSamples, lowSamples);
 }
+
+void WaveView::addDerivedSignal()
+{
+    QString expression;
+    while (true)
+    {
+        bool ok = false;
+        expression = QInputDialog::getText(this, tr("Add derived signal"),
+                                           tr("Expression over the visible signals\n"
+                                              "(e.g. a & b, ~rst_n, bus[7:4], bus == 3, a ^ delayed(a, 1)):"),
+                                           QLineEdit::Normal, expression, &ok);
+        if (!ok || expression.trimmed().isEmpty())
+            return;
+
+        QString error;
+        if (m_doc->addDerivedSignal(QString(), expression, &error) >= 0)
+            return;
+        QMessageBox::warning(this, tr("Add derived signal"), error);
+    }
+}
 void WaveView::setMarkerAddModeEnabled(bool en)
 {
     if (en)
@@ -43,13 +43,20 @@
 //======================================================================
 #include <QApplication>
 #include "MainWindow.h"
+#include "utils/Trace.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    // WAVEPAINT_TRACE=<file.json> records a Chrome trace of the whole session
+    Tracer::initFromEnvironment();
+    Tracer::setThreadName(QStringLiteral("GUI"));
+
     MainWindow w;
     w.show();
 
-    return app.exec();
+    int rc = app.exec();
+    Tracer::shutdown();
+    return rc;
 }
@@ -0,0 +1,141 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Parallel.cpp
+// Description:   Shared worker pool behind parallelFor.
+//======================================================================
+
+#include "utils/Parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Set while this thread runs items of a parallelFor: nested calls go serial
+thread_local bool t_inParallelFor = false;
+
+class WorkerPool
+{
+public:
+    struct Job
+    {
+        const std::function<void(int)> *fn;
+        int count;
+        std::atomic<int> next{0};
+        int active = 0;   // workers inside the job, guarded by m_mutex
+    };
+
+    WorkerPool()
+    {
+        const int n = parallelWorkers() - 1;
+        m_threads.reserve(n);
+        for (int t = 0; t < n; ++t)
+            m_threads.emplace_back([this]() { work(); });
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread &t : m_threads)
+            t.join();
+    }
+
+    void run(int count, const std::function<void(int)> &fn)
+    {
+        Job job;
+        job.fn = &fn;
+        job.count = count;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(&job);
+        }
+        m_wake.notify_all();
+
+        // The caller works on its own job too, then waits for the workers
+        // still inside it
+        drain(job);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        retire(&job);
+        m_idle.wait(lock, [&job]() { return job.active == 0; });
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<Job *> m_jobs;        // jobs that may still have items, oldest first
+    std::mutex m_mutex;
+    std::condition_variable m_wake;  // a job was queued (or stop)
+    std::condition_variable m_idle;  // a worker left a job
+    bool m_stop = false;
+
+    static void drain(Job &job)
+    {
+        t_inParallelFor = true;
+        for (int i = job.next.fetch_add(1); i < job.count; i = job.next.fetch_add(1))
+            (*job.fn)(i);
+        t_inParallelFor = false;
+    }
+
+    void retire(Job *job)
+    {
+        for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+            if (*it == job) {
+                m_jobs.erase(it);
+                return;
+            }
+        }
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop)
+                return;
+            Job *job = m_jobs.front();
+            if (job->next.load() >= job->count) {
+                // Handed out completely; its caller waits for the active ones
+                m_jobs.pop_front();
+                continue;
+            }
+            ++job->active;
+            lock.unlock();
+            drain(*job);
+            lock.lock();
+            if (--job->active == 0)
+                m_idle.notify_all();
+        }
+    }
+};
+
+} // namespace
+
+void parallelRun(int count, const std::function<void(int)> &fn)
+{
+    if (t_inParallelFor) {
+        for (int i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+    static WorkerPool pool;
+    pool.run(count, fn);
+}
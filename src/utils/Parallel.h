@@ -0,0 +1,54 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Parallel.h
+// Description:   Parallel-for over a shared worker pool for core algorithms.
+//======================================================================
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+#include <thread>
+
+// Number of worker threads used by parallelFor (at least 1)
+inline int parallelWorkers()
+{
+    const unsigned hc = std::thread::hardware_concurrency();
+    return hc == 0 ? 1 : static_cast<int>(hc);
+}
+
+// Runs fn(i) for i in [0, count) on the shared pool (Parallel.cpp)
+void parallelRun(int count, const std::function<void(int)> &fn);
+
+// Calls fn(i) for every i in [0, count), spread over one process-wide pool of
+// parallelWorkers() - 1 threads plus the calling thread. Items are handed out
+// one at a time, so uneven chunks balance themselves. A parallelFor inside
+// another (on the caller or a worker) runs serially, so nesting never
+// oversubscribes the machine; calls from several threads share the pool.
+// fn must be safe to run concurrently for different i; results are usually
+// written to slot i of a pre-sized vector and combined afterwards on the
+// caller.
+template <typename Fn>
+void parallelFor(int count, Fn fn)
+{
+    if (count <= 1 || parallelWorkers() <= 1) {
+        for (int i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+    parallelRun(count, std::function<void(int)>(std::ref(fn)));
+}
+
+#endif // PARALLEL_H
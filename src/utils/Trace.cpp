@@ -0,0 +1,207 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Trace.cpp
+// Description:   Tracer event buffer and Chrome Trace Event JSON writer.
+//======================================================================
+
+#include "utils/Trace.h"
+
+#include <QFile>
+#include <QByteArray>
+#include <QtGlobal>
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    qint64 startNs;
+    qint64 endNs;
+    int tid;
+};
+
+// Ring of the most recent events: a long recording keeps its last
+// kMaxEvents (about 40 MB) instead of growing without limit
+constexpr size_t kMaxEvents = size_t(1) << 20;
+
+std::mutex g_mutex;
+std::vector<TraceEvent> g_events;
+size_t g_oldest = 0;           // index of the oldest event once the ring is full
+qint64 g_dropped = 0;
+std::vector<std::pair<int, QString>> g_threadNames;
+QString g_envFile;
+
+std::atomic<int> g_nextTid{1};
+thread_local int t_tid = 0;
+
+int currentTid()
+{
+    // Small stable ids read better in Perfetto than native thread handles
+    if (t_tid == 0)
+        t_tid = g_nextTid.fetch_add(1, std::memory_order_relaxed);
+    return t_tid;
+}
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+void appendEscaped(QByteArray &out, const QByteArray &s)
+{
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out.append('\\');
+        if (static_cast<unsigned char>(c) < 0x20)
+            continue;
+        out.append(c);
+    }
+}
+
+} // namespace
+
+void Tracer::setEnabled(bool en)
+{
+    s_enabled.store(en, std::memory_order_relaxed);
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_events.clear();
+    g_oldest = 0;
+    g_dropped = 0;
+}
+
+int Tracer::eventCount()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return static_cast<int>(g_events.size());
+}
+
+qint64 Tracer::droppedCount()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_dropped;
+}
+
+qint64 Tracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void Tracer::record(const char *category, const char *name, qint64 startNs, qint64 endNs)
+{
+    const int tid = currentTid();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_events.size() < kMaxEvents) {
+        g_events.push_back({category, name, startNs, endNs, tid});
+        return;
+    }
+    g_events[g_oldest] = {category, name, startNs, endNs, tid};
+    g_oldest = (g_oldest + 1) % kMaxEvents;
+    ++g_dropped;
+}
+
+void Tracer::setThreadName(const QString &name)
+{
+    const int tid = currentTid();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (auto &entry : g_threadNames) {
+        if (entry.first == tid) {
+            entry.second = name;
+            return;
+        }
+    }
+    g_threadNames.emplace_back(tid, name);
+}
+
+bool Tracer::writeChromeTrace(const QString &fileName)
+{
+    std::vector<TraceEvent> events;
+    std::vector<std::pair<int, QString>> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        events.reserve(g_events.size());
+        events.insert(events.end(), g_events.begin() + g_oldest, g_events.end());
+        events.insert(events.end(), g_events.begin(), g_events.begin() + g_oldest);
+        threadNames = g_threadNames;
+    }
+
+    QFile f(fileName);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray out;
+    out.reserve(1 << 20);
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    out.append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"WavePaint\"}}");
+
+    for (const auto &entry : threadNames) {
+        out.append(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        out.append(QByteArray::number(entry.first));
+        out.append(",\"args\":{\"name\":\"");
+        appendEscaped(out, entry.second.toUtf8());
+        out.append("\"}}");
+    }
+
+    // Complete events ("X"); timestamps are microseconds
+    for (const TraceEvent &e : events) {
+        out.append(",\n{\"name\":\"");
+        appendEscaped(out, QByteArray(e.name));
+        out.append("\",\"cat\":\"");
+        appendEscaped(out, QByteArray(e.category));
+        out.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+        out.append(QByteArray::number(e.tid));
+        out.append(",\"ts\":");
+        out.append(QByteArray::number(e.startNs / 1000.0, 'f', 3));
+        out.append(",\"dur\":");
+        out.append(QByteArray::number((e.endNs - e.startNs) / 1000.0, 'f', 3));
+        out.append('}');
+
+        if (out.size() > (1 << 20)) {
+            if (f.write(out) != out.size())
+                return false;
+            out.clear();
+        }
+    }
+    out.append("\n]}\n");
+    return f.write(out) == out.size() && f.flush();
+}
+
+void Tracer::initFromEnvironment()
+{
+    g_envFile = qEnvironmentVariable("WAVEPAINT_TRACE");
+    if (!g_envFile.isEmpty())
+        setEnabled(true);
+}
+
+void Tracer::shutdown()
+{
+    if (g_envFile.isEmpty())
+        return;
+    if (!writeChromeTrace(g_envFile))
+        qWarning("WavePaint: could not write trace to %s", qPrintable(g_envFile));
+    else if (droppedCount() > 0)
+        qWarning("WavePaint: trace kept the last %d events (%lld older ones dropped)",
+                 eventCount(), static_cast<long long>(droppedCount()));
+}
@@ -0,0 +1,116 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          Trace.h
+// Description:   Scoped Chrome-trace instrumentation of the hot paths.
+//======================================================================
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <atomic>
+
+// Lightweight scoped tracing of the hot paths (import, JSON I/O, undo,
+// document mutators, painting). Always compiled in; when it is disabled a
+// scope costs a single relaxed atomic load.
+//
+// Recording is switched on with the WAVEPAINT_TRACE=<file.json> environment
+// variable (written on exit) or from View -> Record performance trace.
+// The output is Chrome Trace Event JSON, readable by Perfetto / chrome://tracing.
+class Tracer
+{
+public:
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool en);
+
+    // Drops every recorded event
+    static void clear();
+    // Events kept; past about a million the oldest are overwritten
+    static int eventCount();
+    static qint64 droppedCount();
+
+    // Monotonic clock shared by every thread, in nanoseconds
+    static qint64 nowNs();
+
+    // Records a complete event [startNs, endNs) on the calling thread
+    static void record(const char *category, const char *name, qint64 startNs, qint64 endNs);
+
+    // Name shown for the calling thread in the trace viewer
+    static void setThreadName(const QString &name);
+
+    // False if the file cannot be opened or a write fails
+    static bool writeChromeTrace(const QString &fileName);
+
+    // WAVEPAINT_TRACE support: enable at startup, write at shutdown
+    static void initFromEnvironment();
+    static void shutdown();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name)
+        : m_category(category),
+          m_name(name),
+          m_startNs(Tracer::isEnabled() ? Tracer::nowNs() : -1)
+    {
+    }
+
+    // Timed variant: always measures and stores the duration in *elapsedNs,
+    // and records a trace event only when tracing is enabled.
+    TraceScope(const char *category, const char *name, qint64 *elapsedNs)
+        : m_category(category),
+          m_name(name),
+          m_startNs(Tracer::nowNs()),
+          m_elapsedNs(elapsedNs)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (m_startNs < 0)
+            return;
+        const qint64 endNs = Tracer::nowNs();
+        if (m_elapsedNs)
+            *m_elapsedNs = endNs - m_startNs;
+        if (Tracer::isEnabled())
+            Tracer::record(m_category, m_name, m_startNs, endNs);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_startNs;
+    qint64 *m_elapsedNs = nullptr;
+};
+
+#define WP_TRACE_CONCAT_INNER(a, b) a##b
+#define WP_TRACE_CONCAT(a, b) WP_TRACE_CONCAT_INNER(a, b)
+
+// Usage: WP_TRACE_SCOPE("io", "JsonIO::saveToFile");  (literals only)
+#define WP_TRACE_SCOPE(category, name) \
+    TraceScope WP_TRACE_CONCAT(wpTraceScope_, __LINE__)(category, name)
+
+// Same, but also stores the scope duration (ns) in *elapsedNsPtr
+#define WP_TRACE_SCOPE_TIMED(category, name, elapsedNsPtr) \
+    TraceScope WP_TRACE_CONCAT(wpTraceScope_, __LINE__)(category, name, elapsedNsPtr)
+
+#endif // TRACE_H
@@ -0,0 +1,577 @@
+// ========================================================================================
+//  /@@      /@@                               /@@@@@@@           /@@             /@@    
+// | @@  /@ | @@                              | @@__  @@         |__/            | @@    
+// | @@ /@@@| @@  /@@@@@@  /@@    /@@ /@@@@@@ | @@  \ @@ /@@@@@@  /@@ /@@@@@@@  /@@@@@@  
+// | @@/@@ @@ @@ |____  @@|  @@  /@@//@@__  @@| @@@@@@@/|____  @@| @@| @@__  @@|_  @@_/  
+// | @@@@_  @@@@  /@@@@@@@ \  @@/@@/| @@@@@@@@| @@____/  /@@@@@@@| @@| @@  \ @@  | @@    
+// | @@@/ \  @@@ /@@__  @@  \  @@@/ | @@_____/| @@      /@@__  @@| @@| @@  | @@  | @@ /@@
+// | @@/   \  @@|  @@@@@@@   \  @/  |  @@@@@@@| @@     |  @@@@@@@| @@| @@  | @@  |  @@@@/
+// |__/     \__/ \_______/    \_/    \_______/|__/      \_______/|__/|__/  |__/   \___/  
+//                                                                                       
+// ___|HHHHHHHHH|______|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ ___|HHHHHHHHH|___ 
+//                                                                                       
+//
+// Project:       WavePaint
+// File:          WaveGen.cpp
+// Description:   Deterministic synthetic workload generator: streams VCD or
+//                .wp files of configurable size for scale testing.
+//======================================================================
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Standalone tool (no Qt): it must build and run on machines where only the
+// dumps are produced. Everything is streamed through a large write buffer, so
+// the memory footprint does not depend on the size of the generated file.
+
+namespace {
+
+struct Options
+{
+    std::string format;            // "vcd" or "wp" (empty = from extension)
+    std::string output;            // empty = stdout
+    uint64_t seed       = 1;
+    int      signalCount = 1000;
+    int      depth       = 3;      // scope levels below the root
+    int      fanout      = 4;      // child scopes per scope
+    int      clocks      = 1;      // signals toggling on every step
+    double   bitRatio    = 0.5;    // fraction of non-clock signals that are 1 bit wide
+    int      widthMin    = 2;
+    int      widthMax    = 32;
+    long long steps      = 10000;  // timestamps / samples
+    long long timestep   = 10;     // time units between timestamps
+    long long jitter     = 0;      // extra random spacing 0..jitter
+    double   toggle      = 0.1;    // probability of a change per signal and step
+    double   xzRate      = 0.01;   // probability that a change goes to x/z
+};
+
+// splitmix64: tiny, fast and identical on every platform, so a seed always
+// produces the same bytes.
+struct Rng
+{
+    uint64_t s;
+    explicit Rng(uint64_t seed = 0) : s(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // Integer threshold so the decision does not depend on floating point
+    static uint64_t threshold(double p)
+    {
+        if (p <= 0.0)
+            return 0;
+        if (p >= 1.0)
+            return UINT64_MAX;
+        return static_cast<uint64_t>(p * 18446744073709551616.0);
+    }
+};
+
+class Writer
+{
+public:
+    explicit Writer(FILE *f) : m_file(f) { m_buf.reserve(kBufSize + 1024); }
+    ~Writer() { flush(); }
+
+    void put(char c)
+    {
+        m_buf.push_back(c);
+        if (m_buf.size() >= kBufSize)
+            flush();
+    }
+    void put(const char *s) { put(s, std::strlen(s)); }
+    void put(const std::string &s) { put(s.data(), s.size()); }
+    void put(const char *s, size_t n)
+    {
+        m_buf.append(s, n);
+        if (m_buf.size() >= kBufSize)
+            flush();
+    }
+    void putNumber(long long v)
+    {
+        char tmp[24];
+        int n = 0;
+        bool neg = v < 0;
+        unsigned long long u = neg ? 0ull - static_cast<unsigned long long>(v)
+                                   : static_cast<unsigned long long>(v);
+        do {
+            tmp[n++] = static_cast<char>('0' + (u % 10));
+            u /= 10;
+        } while (u);
+        if (neg)
+            tmp[n++] = '-';
+        while (n > 0)
+            m_buf.push_back(tmp[--n]);
+        if (m_buf.size() >= kBufSize)
+            flush();
+    }
+    void flush()
+    {
+        if (!m_buf.empty()) {
+            if (std::fwrite(m_buf.data(), 1, m_buf.size(), m_file) != m_buf.size())
+                m_failed = true;
+            m_buf.clear();
+        }
+    }
+    bool failed() const { return m_failed; }
+
+private:
+    static constexpr size_t kBufSize = 1 << 20;
+    FILE *m_file;
+    std::string m_buf;
+    bool m_failed = false;
+};
+
+struct GenSignal
+{
+    std::string scope;   // dotted path without the leaf name
+    std::string name;    // leaf name
+    std::string id;      // VCD identifier code
+    int  width   = 1;
+    bool isClock = false;
+};
+
+// Value of one signal at one step. Vectors keep up to 64 bits in words[0],
+// wider buses use as many words as needed.
+struct GenValue
+{
+    char state = '0';               // '0'/'1' for bits, 'v' valid vector, 'x'/'z'
+    std::vector<uint64_t> words;
+};
+
+// Per-signal random stream. The .wp writer replays every signal from start
+// to end while the VCD writer interleaves them step by step; both consume the
+// stream in the same order, so the two formats describe the same waveform.
+class SignalStream
+{
+public:
+    SignalStream(const Options &opt, const GenSignal &sig, int index)
+        : m_sig(&sig),
+          m_rng(opt.seed * 0x100000001B3ull + static_cast<uint64_t>(index) + 1),
+          m_toggle(Rng::threshold(opt.toggle)),
+          m_xz(Rng::threshold(opt.xzRate))
+    {
+        m_value.words.assign((sig.width + 63) / 64, 0);
+        if (sig.width > 1 && !sig.isClock) {
+            m_value.state = 'v';
+            randomWords();
+        }
+    }
+
+    const GenValue &value() const { return m_value; }
+
+    // Advances one step. Returns true if the value changed.
+    bool step(long long stepIndex)
+    {
+        if (m_sig->isClock) {
+            m_value.state = (stepIndex & 1) ? '1' : '0';
+            return true;
+        }
+        if (m_toggle == 0 || m_rng.next() > m_toggle)
+            return false;
+
+        if (m_xz != 0 && m_rng.next() <= m_xz) {
+            m_value.state = (m_rng.next() & 1) ? 'z' : 'x';
+            return true;
+        }
+        if (m_sig->width == 1) {
+            m_value.state = (m_value.state == '1') ? '0' : '1';
+        } else {
+            m_value.state = 'v';
+            randomWords();
+        }
+        return true;
+    }
+
+private:
+    void randomWords()
+    {
+        for (size_t w = 0; w < m_value.words.size(); ++w)
+            m_value.words[w] = m_rng.next();
+        int topBits = m_sig->width % 64;
+        if (topBits != 0)
+            m_value.words.back() &= (1ull << topBits) - 1;
+    }
+
+    const GenSignal *m_sig;
+    Rng m_rng;
+    uint64_t m_toggle;
+    uint64_t m_xz;
+    GenValue m_value;
+};
+
+std::string vcdIdentifier(int index)
+{
+    // Printable ASCII '!'..'~' in base 94
+    std::string id;
+    int n = index;
+    do {
+        id.push_back(static_cast<char>('!' + (n % 94)));
+        n /= 94;
+    } while (n > 0);
+    return id;
+}
+
+std::vector<GenSignal> buildLayout(const Options &opt)
+{
+    Rng layout(opt.seed ^ 0x5A17C0DEull);
+
+    // Leaf scopes: fanout^depth, but never more than there are signals
+    long long leaves = 1;
+    for (int d = 0; d < opt.depth && leaves < opt.signalCount; ++d)
+        leaves *= opt.fanout;
+    leaves = std::max(1LL, std::min<long long>(leaves, opt.signalCount));
+
+    std::vector<std::string> leafPaths(static_cast<size_t>(leaves));
+    for (long long k = 0; k < leaves; ++k) {
+        std::string path = "top";
+        long long rest = k;
+        for (int d = 0; d < opt.depth; ++d) {
+            path += ".blk" + std::to_string(rest % opt.fanout);
+            rest /= opt.fanout;
+        }
+        leafPaths[static_cast<size_t>(k)] = path;
+    }
+
+    std::vector<GenSignal> sigs(static_cast<size_t>(opt.signalCount));
+    const uint64_t bitThreshold = Rng::threshold(opt.bitRatio);
+    const int span = std::max(1, opt.widthMax - opt.widthMin + 1);
+
+    for (int i = 0; i < opt.signalCount; ++i) {
+        GenSignal &s = sigs[static_cast<size_t>(i)];
+        s.scope = leafPaths[static_cast<size_t>(i % leaves)];
+        s.id = vcdIdentifier(i);
+        if (i < opt.clocks) {
+            s.isClock = true;
+            s.width = 1;
+            s.name = "clk" + std::to_string(i);
+            continue;
+        }
+        bool isBit = layout.next() <= bitThreshold;
+        s.width = isBit ? 1 : opt.widthMin + static_cast<int>(layout.next() % span);
+        s.name = (s.width == 1 ? "sig" : "bus") + std::to_string(i);
+    }
+
+    // Group signals by scope (stable) so the VCD header opens every scope once
+    std::stable_sort(sigs.begin(), sigs.end(),
+                     [](const GenSignal &a, const GenSignal &b) { return a.scope < b.scope; });
+    return sigs;
+}
+
+std::vector<std::string> splitScope(const std::string &path)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t dot = path.find('.', start);
+        if (dot == std::string::npos)
+            dot = path.size();
+        parts.push_back(path.substr(start, dot - start));
+        start = dot + 1;
+    }
+    return parts;
+}
+
+void writeBinary(Writer &out, const GenValue &v, int width)
+{
+    for (int bit = width - 1; bit >= 0; --bit) {
+        uint64_t word = v.words[static_cast<size_t>(bit / 64)];
+        out.put(((word >> (bit % 64)) & 1) ? '1' : '0');
+    }
+}
+
+void writeVcdChange(Writer &out, const GenSignal &s, const GenValue &v)
+{
+    if (s.width == 1) {
+        out.put(v.state);
+    } else {
+        out.put('b');
+        if (v.state == 'x' || v.state == 'z')
+            out.put(v.state);
+        else
+            writeBinary(out, v, s.width);
+        out.put(' ');
+    }
+    out.put(s.id);
+    out.put('\n');
+}
+
+void writeVcd(Writer &out, const Options &opt, const std::vector<GenSignal> &sigs)
+{
+    out.put("$date WaveGen $end\n");
+    out.put("$version WaveGen seed ");
+    out.putNumber(static_cast<long long>(opt.seed));
+    out.put(" $end\n$timescale 1ps $end\n");
+
+    std::vector<std::string> open;
+    for (const GenSignal &s : sigs) {
+        std::vector<std::string> path = splitScope(s.scope);
+        size_t common = 0;
+        while (common < open.size() && common < path.size() && open[common] == path[common])
+            ++common;
+        while (open.size() > common) {
+            out.put("$upscope $end\n");
+            open.pop_back();
+        }
+        for (size_t i = common; i < path.size(); ++i) {
+            out.put("$scope module ");
+            out.put(path[i]);
+            out.put(" $end\n");
+            open.push_back(path[i]);
+        }
+        out.put("$var wire ");
+        out.putNumber(s.width);
+        out.put(' ');
+        out.put(s.id);
+        out.put(' ');
+        out.put(s.name);
+        out.put(" $end\n");
+    }
+    while (!open.empty()) {
+        out.put("$upscope $end\n");
+        open.pop_back();
+    }
+    out.put("$enddefinitions $end\n");
+
+    std::vector<SignalStream> streams;
+    streams.reserve(sigs.size());
+    for (size_t i = 0; i < sigs.size(); ++i)
+        streams.emplace_back(opt, sigs[i], static_cast<int>(i));
+
+    Rng timeRng(opt.seed ^ 0x7115EEDull);
+    long long t = 0;
+
+    for (long long step = 0; step < opt.steps && !out.failed(); ++step) {
+        if (step > 0) {
+            t += opt.timestep;
+            if (opt.jitter > 0)
+                t += static_cast<long long>(timeRng.next() % static_cast<uint64_t>(opt.jitter + 1));
+        }
+        // Every step gets its timestamp so sample N of the .wp matches the Nth '#'
+        out.put('#');
+        out.putNumber(t);
+        out.put('\n');
+
+        if (step == 0) {
+            out.put("$dumpvars\n");
+            for (size_t i = 0; i < sigs.size(); ++i) {
+                streams[i].step(step);
+                writeVcdChange(out, sigs[i], streams[i].value());
+            }
+            out.put("$end\n");
+            continue;
+        }
+        for (size_t i = 0; i < sigs.size(); ++i) {
+            if (streams[i].step(step))
+                writeVcdChange(out, sigs[i], streams[i].value());
+        }
+    }
+}
+
+void writeJsonString(Writer &out, const std::string &s)
+{
+    out.put('"');
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out.put('\\');
+        out.put(c);
+    }
+    out.put('"');
+}
+
+void writeHexLabel(Writer &out, const GenValue &v, int width)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    int nibbles = (width + 3) / 4;
+    out.put("\"h");
+    bool leading = true;
+    for (int n = nibbles - 1; n >= 0; --n) {
+        int bit = n * 4;
+        int d = static_cast<int>((v.words[static_cast<size_t>(bit / 64)] >> (bit % 64)) & 0xF);
+        if (leading && d == 0 && n > 0)
+            continue;
+        leading = false;
+        out.put(digits[d]);
+    }
+    out.put('"');
+}
+
+void writeWp(Writer &out, const Options &opt, const std::vector<GenSignal> &sigs)
+{
+    out.put("{\n\"sampleCount\": ");
+    out.putNumber(opt.steps);
+    out.put(",\n\"signals\": [\n");
+
+    for (size_t i = 0; i < sigs.size() && !out.failed(); ++i) {
+        const GenSignal &s = sigs[i];
+        const bool isBit = (s.width == 1);
+
+        if (i > 0)
+            out.put(",\n");
+        out.put("{\"name\": ");
+        writeJsonString(out, s.scope + "." + s.name);
+        out.put(isBit ? ", \"type\": \"bit\", \"color\": \"#ff009600\""
+                      : ", \"type\": \"vector\", \"color\": \"#ff0000b4\"");
+
+        // Values and labels are two passes over the same deterministic stream
+        out.put(",\n \"values\": [");
+        {
+            SignalStream stream(opt, s, static_cast<int>(i));
+            for (long long step = 0; step < opt.steps; ++step) {
+                stream.step(step);
+                const GenValue &v = stream.value();
+                if (step > 0)
+                    out.put(',');
+                if (v.state == 'x' || v.state == 'z')
+                    out.putNumber(-1);
+                else if (isBit)
+                    out.put(v.state);
+                else
+                    out.putNumber(static_cast<long long>(v.words[0] & 0x7FFFFFFFull));
+            }
+        }
+        out.put("],\n \"labels\": [");
+        {
+            SignalStream stream(opt, s, static_cast<int>(i));
+            for (long long step = 0; step < opt.steps; ++step) {
+                stream.step(step);
+                const GenValue &v = stream.value();
+                if (step > 0)
+                    out.put(',');
+                if (isBit || v.state != 'v')
+                    out.put("\"\"");
+                else
+                    writeHexLabel(out, v, s.width);
+            }
+        }
+        out.put("]}");
+    }
+
+    out.put("\n],\n\"markers\": [],\n\"arrows\": []\n}\n");
+}
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "Usage: WaveGen [options] [-o FILE]\n"
+        "Generates a deterministic synthetic waveform (VCD or WavePaint .wp).\n\n"
+        "  -o, --output FILE      output file (default: stdout)\n"
+        "  --format vcd|wp        output format (default: from extension, else vcd)\n"
+        "  --seed N               random seed (default 1)\n"
+        "  --signals N            number of signals (default 1000)\n"
+        "  --depth N              hierarchy depth below 'top' (default 3)\n"
+        "  --fanout N             child scopes per scope (default 4)\n"
+        "  --clocks N             signals toggling every step (default 1)\n"
+        "  --bit-ratio P          fraction of 1-bit signals (default 0.5)\n"
+        "  --width-min N          minimum bus width (default 2)\n"
+        "  --width-max N          maximum bus width (default 32)\n"
+        "  --steps N              number of timestamps/samples (default 10000)\n"
+        "  --timestep N           time units between timestamps (default 10)\n"
+        "  --jitter N             extra random spacing 0..N (default 0)\n"
+        "  --toggle P             change probability per signal and step (default 0.1)\n"
+        "  --xz P                 probability that a change is x/z (default 0.01)\n");
+}
+
+bool parseArgs(int argc, char *argv[], Options &opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "-h" || a == "--help")
+            return false;
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", a.c_str());
+            return false;
+        }
+        const char *v = argv[++i];
+
+        if (a == "-o" || a == "--output")  opt.output = v;
+        else if (a == "--format")          opt.format = v;
+        else if (a == "--seed")            opt.seed = std::strtoull(v, nullptr, 10);
+        else if (a == "--signals")         opt.signalCount = std::atoi(v);
+        else if (a == "--depth")           opt.depth = std::atoi(v);
+        else if (a == "--fanout")          opt.fanout = std::atoi(v);
+        else if (a == "--clocks")          opt.clocks = std::atoi(v);
+        else if (a == "--bit-ratio")       opt.bitRatio = std::atof(v);
+        else if (a == "--width-min")       opt.widthMin = std::atoi(v);
+        else if (a == "--width-max")       opt.widthMax = std::atoi(v);
+        else if (a == "--steps")           opt.steps = std::atoll(v);
+        else if (a == "--timestep")        opt.timestep = std::atoll(v);
+        else if (a == "--jitter")          opt.jitter = std::atoll(v);
+        else if (a == "--toggle")          opt.toggle = std::atof(v);
+        else if (a == "--xz")              opt.xzRate = std::atof(v);
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", a.c_str());
+            return false;
+        }
+    }
+
+    if (opt.format.empty()) {
+        const std::string &o = opt.output;
+        bool isWp = (o.size() > 3 && o.compare(o.size() - 3, 3, ".wp") == 0) ||
+                    (o.size() > 5 && o.compare(o.size() - 5, 5, ".json") == 0);
+        opt.format = isWp ? "wp" : "vcd";
+    }
+    if (opt.format != "vcd" && opt.format != "wp") {
+        std::fprintf(stderr, "Unknown format %s\n", opt.format.c_str());
+        return false;
+    }
+    // steps is the .wp sampleCount, an int in the format
+    if (opt.signalCount <= 0 || opt.steps <= 0 || opt.steps > INT_MAX || opt.depth < 0 ||
+        opt.fanout <= 0 || opt.timestep <= 0 || opt.jitter < 0) {
+        std::fprintf(stderr, "Invalid size parameters\n");
+        return false;
+    }
+    opt.clocks = std::max(0, std::min(opt.clocks, opt.signalCount));
+    opt.widthMin = std::max(2, opt.widthMin);
+    opt.widthMax = std::max(opt.widthMin, opt.widthMax);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage();
+        return 1;
+    }
+
+    FILE *f = opt.output.empty() ? stdout : std::fopen(opt.output.c_str(), "wb");
+    if (!f) {
+        std::fprintf(stderr, "Cannot open %s\n", opt.output.c_str());
+        return 1;
+    }
+
+    std::vector<GenSignal> sigs = buildLayout(opt);
+
+    bool failed = false;
+    {
+        Writer out(f);
+        if (opt.format == "wp")
+            writeWp(out, opt, sigs);
+        else
+            writeVcd(out, opt, sigs);
+        out.flush();
+        failed = out.failed();
+    }
+
+    if (f != stdout)
+        failed = (std::fclose(f) != 0) || failed;
+
+    if (failed) {
+        std::fprintf(stderr, "Write error\n");
+        return 1;
+    }
+    return 0;
+}